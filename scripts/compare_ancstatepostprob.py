@@ -0,0 +1,66 @@
+import sys
+import os
+import glob
+
+# regression check of the ancestral state posterior probabilities (readpb_mpi -anc)
+# run readpb_mpi -anc on the same chain with the two builds to be compared, each in its own directory,
+# then compare the .ancstatepostprob files (one per internal node) of the two directories
+
+def readpostprobs(filename):
+
+    with open(filename, 'r') as infile:
+        infile.readline()
+        return [[float(x) for x in line.split()[1:]] for line in infile if line.strip()]
+
+def compare(refdir, testdir, tol = 1e-4):
+
+    reffiles = sorted(glob.glob(os.path.join(refdir, "*.ancstatepostprob")))
+    if not reffiles:
+        print("error: no .ancstatepostprob file in {0}".format(refdir))
+        sys.exit(1)
+
+    nrow = 0
+    nfailed = 0
+    maxdiff = 0
+    for reffile in reffiles:
+        testfile = os.path.join(testdir, os.path.basename(reffile))
+        if not os.path.exists(testfile):
+            print("error: missing file {0}".format(testfile))
+            sys.exit(1)
+        ref = readpostprobs(reffile)
+        test = readpostprobs(testfile)
+        if len(ref) != len(test):
+            print("error: {0}: files do not have the same number of sites: {1} versus {2}".format(os.path.basename(reffile), len(ref), len(test)))
+            sys.exit(1)
+        for i in range(len(ref)):
+            diff = max(abs(x - y) for (x, y) in zip(ref[i], test[i]))
+            if maxdiff < diff:
+                maxdiff = diff
+            if diff > tol:
+                nfailed += 1
+            nrow += 1
+    return (len(reffiles), nrow, maxdiff, nfailed)
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 3:
+        print()
+        print("compare_ancstatepostprob.py <refdir> <testdir> [tol]")
+        print("<refdir>: directory of the .ancstatepostprob files obtained with the reference build")
+        print("<testdir>: same, test build, on the same chain")
+        print("[tol]: absolute tolerance per posterior probability (default 1e-4; the files are written with 6 significant digits)")
+        print()
+        sys.exit(1)
+
+    tol = 1e-4
+    if len(sys.argv) > 3:
+        tol = float(sys.argv[3])
+
+    (nnode, nrow, maxdiff, nfailed) = compare(sys.argv[1], sys.argv[2], tol)
+
+    print("nodes                 : {0}".format(nnode))
+    print("max abs diff          : {0:.6g}".format(maxdiff))
+    print("rows above tolerance  : {0} / {1}".format(nfailed, nrow))
+
+    if nfailed:
+        sys.exit(1)
@@ -0,0 +1,60 @@
+import sys
+
+# validation of the single-precision storage of the conditional likelihoods (-DFLOAT_CONDL, see sources/Makefile)
+# against the default double-precision build:
+# run readpb_mpi -sitelogl on the same chain with each of the two builds,
+# then compare the two .sitelogl files (site log likelihoods averaged over the sample)
+
+def readsitelogl(filename):
+
+    with open(filename, 'r') as infile:
+        infile.readline()
+        return [float(line.split()[1]) for line in infile if line.strip()]
+
+def compare(ref, test, reltol = 1e-4):
+
+    if len(ref) != len(test):
+        print("error: files do not have the same number of sites: {0} versus {1}".format(len(ref), len(test)))
+        sys.exit(1)
+
+    maxdiff = 0
+    maxreldiff = 0
+    nfailed = 0
+    for i in range(len(ref)):
+        diff = abs(test[i] - ref[i])
+        reldiff = diff / max(1.0, abs(ref[i]))
+        if maxdiff < diff:
+            maxdiff = diff
+        if maxreldiff < reldiff:
+            maxreldiff = reldiff
+        if reldiff > reltol:
+            nfailed += 1
+    return (maxdiff, maxreldiff, nfailed, sum(ref), sum(test))
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 3:
+        print()
+        print("compare_sitelogl.py <ref.sitelogl> <test.sitelogl> [reltol]")
+        print("<ref.sitelogl>: site log likelihoods obtained with the double precision build")
+        print("<test.sitelogl>: same, single precision build, on the same chain")
+        print("[reltol]: relative tolerance per site (default 1e-4; .sitelogl files are written with 6 significant digits)")
+        print()
+        sys.exit(1)
+
+    ref = readsitelogl(sys.argv[1])
+    test = readsitelogl(sys.argv[2])
+    reltol = 1e-4
+    if len(sys.argv) > 3:
+        reltol = float(sys.argv[3])
+
+    (maxdiff, maxreldiff, nfailed, totref, tottest) = compare(ref, test, reltol)
+
+    print("{0:10s} {1:^12s} {2:^12s} {3:^12s}".format("", "ref", "test", "diff"))
+    print("{0:10s} {1:12.4f} {2:12.4f} {3:12.4f}".format("total", totref, tottest, tottest - totref))
+    print("max abs diff per site : {0:.6g}".format(maxdiff))
+    print("max rel diff per site : {0:.6g}".format(maxreldiff))
+    print("sites above tolerance : {0} / {1}".format(nfailed, len(ref)))
+
+    if nfailed:
+        sys.exit(1)
@@ -33,8 +33,8 @@ void AACodonMutSelFinitePhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + ProfileProcess::GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 	int index = 0;
 	dvector[index] = branchalpha;
 	index++;
@@ -100,6 +100,9 @@ void AACodonMutSelFinitePhyloProcess::SlaveExecute(MESSAGE signal)	{
 	case PROFILE_MOVE:
 		SlaveMoveProfile();
 		break;
+	case SHARED_LOGPROB:
+		SlaveSharedParameterLogProb();
+		break;
 	default:
 		PhyloProcess::SlaveExecute(signal);
 	}
@@ -129,7 +132,7 @@ void AACodonMutSelFinitePhyloProcess::GlobalUpdateParameters() {
 	int ivector[ni];
 	double dvector[nd]; 
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	
 	int index = 0;
 	index++;
@@ -179,8 +182,8 @@ void AACodonMutSelFinitePhyloProcess::GlobalUpdateParameters() {
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 
@@ -191,9 +194,9 @@ void AACodonMutSelFinitePhyloProcess::GlobalSetTestData()	{
 	testdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
@@ -201,9 +204,9 @@ void AACodonMutSelFinitePhyloProcess::GlobalSetTestData()	{
 void AACodonMutSelFinitePhyloProcess::SlaveSetTestData()	{
 
     int testnnuc;
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnnuc * GetNtaxa()];
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
     testnsite = testnnuc / 3;
 	
 	SetTestSiteMinAndMax();
@@ -221,15 +224,9 @@ void AACodonMutSelFinitePhyloProcess::SlaveComputeCVScore()	{
 	}
 	
 	for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			AACodonMutSelFiniteProfileProcess::alloc[i] = k;
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
 	}
+	ComputeSiteComponentLogL(GetNcomponent(),sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -248,7 +245,7 @@ void AACodonMutSelFinitePhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -274,19 +271,9 @@ void AACodonMutSelFinitePhyloProcess::SlaveComputeSiteLogL()	{
 	}
 	
 	for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                AACodonMutSelFiniteProfileProcess::alloc[i] = k;
-            }
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-            }
-		}
 	}
+	ComputeSiteComponentLogL(GetNcomponent(),sitelogl);
 
 	double* meansitelogl = new double[ProfileProcess::GetNsite()];
     double* cumul = new double[GetNcomponent()];
@@ -322,7 +309,7 @@ void AACodonMutSelFinitePhyloProcess::SlaveComputeSiteLogL()	{
 	UpdateMatrices();
     UpdateConditionalLikelihoods();
 
-	MPI_Send(meansitelogl,ProfileProcess::GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
@@ -555,7 +542,7 @@ void AACodonMutSelFinitePhyloProcess::ReadMapStats(string name, int burnin, int
 		i++;
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalCollapse();
@@ -1183,11 +1170,11 @@ int AACodonMutSelFinitePhyloProcess::GlobalNonSynMapping()	{
 	assert(myid==0);
 	MESSAGE signal = NONSYNMAPPING;
 	MPI_Status stat;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int i, count, totalcount=0;
 	for (i=1; i<nprocs; ++i)	{
-		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD, &stat);
+		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM, &stat);
 		totalcount += count;
 	}
 	return totalcount;
@@ -1197,6 +1184,6 @@ int AACodonMutSelFinitePhyloProcess::GlobalNonSynMapping()	{
 void AACodonMutSelFinitePhyloProcess::SlaveNonSynMapping()	{
 
 	int nonsyn = CountNonSynMapping();
-	MPI_Send(&nonsyn,1,MPI_INT,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&nonsyn,1,MPI_INT,0,TAG1,PROCESS_COMM);
 
 }
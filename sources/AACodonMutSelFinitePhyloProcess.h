@@ -44,7 +44,7 @@ class AACodonMutSelFinitePhyloProcess : public virtual AACodonMutSelFiniteSubsti
 
 		datafile = indatafile;
 		codetype = incodetype;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		if (dc)	{
@@ -140,7 +140,7 @@ class AACodonMutSelFinitePhyloProcess : public virtual AACodonMutSelFiniteSubsti
 		}
 		is >> dirweightprior;
 		is >> dc;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		const TaxonSet* taxonset = codondata->GetTaxonSet();
@@ -186,6 +186,10 @@ class AACodonMutSelFinitePhyloProcess : public virtual AACodonMutSelFiniteSubsti
 
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
+
+	void SetSiteComponent(int site, int k)	{
+		AACodonMutSelFiniteProfileProcess::alloc[site] = k;
+	}
     void GlobalSetTestData();
     void SlaveSetTestData();
 
@@ -127,7 +127,7 @@ class AACodonMutSelFiniteProfileProcess : public virtual MatrixFiniteProfileProc
 				// profiles
 				GlobalUpdateParameters();
 				GlobalUpdateSiteProfileSuffStat();
-				UpdateModeProfileSuffStat();
+				// component suff stats: summed over slaves in GlobalMoveProfile
 				GlobalMoveProfile(1,1,100);
 				GlobalMoveProfile(1,3,100);
 				GlobalMoveProfile(0.1,3,100);
@@ -225,7 +225,9 @@ class AACodonMutSelFiniteProfileProcess : public virtual MatrixFiniteProfileProc
 	}
 
 	void UpdateMatrix(int k)	{
-		matrixarray[k]->CorruptMatrix();
+		if (matrixarray[k])	{
+			matrixarray[k]->CorruptMatrix();
+		}
 	}
 	/*
 	void CreateMatrices()	{
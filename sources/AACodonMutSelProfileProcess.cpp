@@ -181,7 +181,7 @@ double AACodonMutSelProfileProcess::MoveOmega(double tuning)        {
 
 	int naccepted = 0;
 	double bkomega = *omega;
-	double deltalogprob = -ProfileSuffStatLogProb();
+	double deltalogprob = -SharedParameterLogProb();
 	//double deltalogprob = 0;
 	deltalogprob -= LogOmegaPrior();
 
@@ -189,14 +189,12 @@ double AACodonMutSelProfileProcess::MoveOmega(double tuning)        {
 	double e = exp(h);
 	*omega *= e;
 
-
-	UpdateMatrices();
 	deltalogprob += h;
 	deltalogprob += LogOmegaPrior();
 	//cerr << "before calling ProfileSuffStatLogProb()\t";
 	//cerr.flush();
 
-	deltalogprob += ProfileSuffStatLogProb();
+	deltalogprob += ProposedSharedParameterLogProb();
 
 	//cerr << "in move, omega is " << *omega << "\n";
 	//cerr.flush();
@@ -209,7 +207,7 @@ double AACodonMutSelProfileProcess::MoveOmega(double tuning)        {
 	}
 	else	{
 		*omega = bkomega;
-		UpdateMatrices();
+		RestoreSharedParameters();
 	}
 	return naccepted;	
 }
@@ -220,14 +218,13 @@ double AACodonMutSelProfileProcess::MoveNucRR(double tuning)	{
 
 	int naccepted = 0;
         for (int i=0; i<GetNnucrr(); i++)  {
-                double deltalogratio = - LogNucRRPrior() - ProfileSuffStatLogProb();
+                double deltalogratio = - LogNucRRPrior() - SharedParameterLogProb();
                 double bk = nucrr[i];
                 double m = tuning * (rnd::GetRandom().Uniform() - 0.5);
                 // double m = tuning * (Random::Uniform() - 0.5);
                 double e = exp(m);
                 nucrr[i] *= e;
-                UpdateMatrices();
-                deltalogratio += LogNucRRPrior() + ProfileSuffStatLogProb();
+                deltalogratio += LogNucRRPrior() + ProposedSharedParameterLogProb();
                 deltalogratio += m;
                 int accepted = (rnd::GetRandom().Uniform() < exp(deltalogratio));
                 // int accepted = (Random::Uniform() < exp(deltalogratio));
@@ -236,7 +233,7 @@ double AACodonMutSelProfileProcess::MoveNucRR(double tuning)	{
                 }
                 else    {
                         nucrr[i] = bk;
-                        UpdateMatrices();
+                        RestoreSharedParameters();
                 }
         }
         return ((double) naccepted) / GetNnucrr();
@@ -251,10 +248,9 @@ double AACodonMutSelProfileProcess::MoveNucRR(double tuning, int n)	{
 	for (int k=0; k<GetNnucrr(); k++)  {
 		bk[k] = nucrr[k];
 	}
-	double deltalogprob = -ProfileSuffStatLogProb();
+	double deltalogprob = -SharedParameterLogProb();
 	double loghastings = ProfileProposeMove(nucrr,tuning,n,GetNnucrr());
-	UpdateMatrices();
-	deltalogprob += ProfileSuffStatLogProb();
+	deltalogprob += ProposedSharedParameterLogProb();
 	deltalogprob += loghastings;
 	int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 	// int accepted = (Random::Uniform() < exp(deltalogprob));
@@ -265,7 +261,7 @@ double AACodonMutSelProfileProcess::MoveNucRR(double tuning, int n)	{
 		for (int k=0; k<GetNnucrr(); k++)  {
 			nucrr[k] = bk[k];
 		}
-		UpdateMatrices();
+		RestoreSharedParameters();
 	}
 	delete[] bk;
 	return naccepted; 
@@ -279,10 +275,9 @@ double AACodonMutSelProfileProcess::MoveNucStat(double tuning, int n)	{
 	for (int k=0; k<Nnuc; k++)  {
 		bk[k] = nucstat[k];
 	}
-	double deltalogprob = -ProfileSuffStatLogProb();
+	double deltalogprob = -SharedParameterLogProb();
 	double loghastings = ProfileProposeMove(nucstat,tuning,n,Nnuc);
-	UpdateMatrices();
-	deltalogprob += ProfileSuffStatLogProb();
+	deltalogprob += ProposedSharedParameterLogProb();
 	deltalogprob += loghastings;
 	int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 	// int accepted = (Random::Uniform() < exp(deltalogprob));
@@ -293,7 +288,7 @@ double AACodonMutSelProfileProcess::MoveNucStat(double tuning, int n)	{
 		for (int k=0; k<Nnuc; k++)  {
 			nucstat[k] = bk[k];
 		}
-		UpdateMatrices();
+		RestoreSharedParameters();
 	}
 	delete[] bk;
 	return naccepted; 
@@ -307,10 +302,9 @@ double AACodonMutSelProfileProcess::MoveCodonProfile(double tuning, int n, int n
 		for (int k=0; k<statespace->GetNstate(); k++)  {
 			bk[k] = codonprofile[k];
 		}
-		double deltalogprob = -ProfileSuffStatLogProb();
+		double deltalogprob = -SharedParameterLogProb();
 		double loghastings = ProfileProposeMove(codonprofile,tuning,n,statespace->GetNstate());
-		UpdateMatrices();
-		deltalogprob += ProfileSuffStatLogProb();
+		deltalogprob += ProposedSharedParameterLogProb();
 		deltalogprob += loghastings;
 		int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 		if (accepted)   {
@@ -320,7 +314,7 @@ double AACodonMutSelProfileProcess::MoveCodonProfile(double tuning, int n, int n
 			for (int k=0; k<statespace->GetNstate(); k++)  {
 				codonprofile[k] = bk[k];
 			}
-			UpdateMatrices();
+			RestoreSharedParameters();
 		}
 	}
 	delete[] bk;
@@ -339,11 +333,10 @@ double AACodonMutSelProfileProcess::MoveNucStatCodonProfile(double tuning, int n
 		for (int k=0; k<Nnuc; k++)  {
 			bknuc[k] = nucstat[k];
 		}
-		double deltalogprob = -ProfileSuffStatLogProb();
+		double deltalogprob = -SharedParameterLogProb();
 		ProfileProposeMove(codonprofile,tuning,n,statespace->GetNstate());
 		ProfileProposeMove(nucstat,tuning,n,Nnuc);
-		UpdateMatrices();
-		deltalogprob += ProfileSuffStatLogProb();
+		deltalogprob += ProposedSharedParameterLogProb();
 		int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 		if (accepted)   {
 			naccepted ++;
@@ -355,7 +348,7 @@ double AACodonMutSelProfileProcess::MoveNucStatCodonProfile(double tuning, int n
 			for (int k=0; k<Nnuc; k++)  {
 				nucstat[k] = bknuc[k];
 			}
-			UpdateMatrices();
+			RestoreSharedParameters();
 		}
 	}
 	delete[] bkcodon;
@@ -109,6 +109,39 @@ class AACodonMutSelProfileProcess : public virtual GeneralPathSuffStatMatrixProf
 	double MoveCodonProfile(double tuning, int n, int nrep=1);
 	double MoveNucStatCodonProfile(double tuning, int n, int nrep=1);
 	double MoveOmega(double tuning); 
+
+	// nucrr, nucstat, codonprofile and omega, shared by all matrices
+	virtual int GetNsharedParameter()	{
+		return GetNnucrr() + Nnuc + statespace->GetNstate() + 1;
+	}
+
+	virtual void GetSharedParameters(double* array)	{
+		int index = 0;
+		for (int i=0; i<GetNnucrr(); i++)	{
+			array[index++] = nucrr[i];
+		}
+		for (int i=0; i<Nnuc; i++)	{
+			array[index++] = nucstat[i];
+		}
+		for (int i=0; i<statespace->GetNstate(); i++)	{
+			array[index++] = codonprofile[i];
+		}
+		array[index++] = *omega;
+	}
+
+	virtual void SetSharedParameters(const double* array)	{
+		int index = 0;
+		for (int i=0; i<GetNnucrr(); i++)	{
+			nucrr[i] = array[index++];
+		}
+		for (int i=0; i<Nnuc; i++)	{
+			nucstat[i] = array[index++];
+		}
+		for (int i=0; i<statespace->GetNstate(); i++)	{
+			codonprofile[i] = array[index++];
+		}
+		*omega = array[index++];
+	}
 	
 	int Nnucrr;
 	double* nucrr;
@@ -45,8 +45,8 @@ void AACodonMutSelSBDPPhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + ProfileProcess::GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 	int index = 0;
 	branchalpha = dvector[index];
 	index++;
@@ -91,8 +91,8 @@ void AACodonMutSelSBDPPhyloProcess::SlaveUpdateParameters()	{
 	delete[] dvector;
 	delete[] ivector;
 
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	// this one is really important
 	// in those cases where new components have appeared, or some old ones have disappeared
@@ -117,6 +117,9 @@ void AACodonMutSelSBDPPhyloProcess::SlaveExecute(MESSAGE signal)	{
 	case PROFILE_MOVE:
 		SlaveMoveProfile();
 		break;
+	case SHARED_LOGPROB:
+		SlaveSharedParameterLogProb();
+		break;
 	case MIX_MOVE:
 		SlaveMixMove();
 		break;
@@ -156,7 +159,7 @@ void AACodonMutSelSBDPPhyloProcess::GlobalUpdateParameters() {
 	int ivector[ni];
 	double dvector[nd]; 
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	
 	// GlobalBroadcastTree();
 	// First we assemble the vector of doubles for distribution
@@ -206,21 +209,21 @@ void AACodonMutSelSBDPPhyloProcess::GlobalUpdateParameters() {
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void AACodonMutSelSBDPPhyloProcess::GlobalSetSiteLogLCutoff()  {
 
 	MESSAGE signal = SITELOGLCUTOFF;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void AACodonMutSelSBDPPhyloProcess::SlaveSetSiteLogLCutoff()  {
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void AACodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
@@ -230,9 +233,9 @@ void AACodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
 	testdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
@@ -240,9 +243,9 @@ void AACodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
 void AACodonMutSelSBDPPhyloProcess::SlaveSetTestData()	{
 
     int testnnuc;
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnnuc * GetNtaxa()];
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
     testnsite = testnnuc / 3;
 	
 	SetTestSiteMinAndMax();
@@ -268,16 +271,9 @@ void AACodonMutSelSBDPPhyloProcess::SlaveComputeCVScore()	{
 	}
 	
 	for (int k=0; k<ncomp; k++)	{
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			AACodonMutSelSBDPProfileProcess::alloc[i] = k;
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
 	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -298,7 +294,7 @@ void AACodonMutSelSBDPPhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -326,24 +322,9 @@ void AACodonMutSelSBDPPhyloProcess::SlaveComputeSiteLogL()	{
 	}
 	
 	for (int k=0; k<ncomp; k++)	{
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                AACodonMutSelSBDPProfileProcess::alloc[i] = k;
-            }
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-                if (std::isnan(sitelogl[i][k]))	{
-                    cerr << "error in RASCATGTRSBDP::SlaveComputeSiteLogL: nan\n";
-                    exit(1);
-                }
-            }
-		}
 	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double* meansitelogl = new double[ProfileProcess::GetNsite()];
 	for (int i=0; i<ProfileProcess::GetNsite(); i++)	{
@@ -377,7 +358,7 @@ void AACodonMutSelSBDPPhyloProcess::SlaveComputeSiteLogL()	{
         }
 	}
 
-	MPI_Send(meansitelogl,ProfileProcess::GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
@@ -615,7 +596,7 @@ void AACodonMutSelSBDPPhyloProcess::ReadMapStats(string name, int burnin, int ev
 		i++;
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalCollapse();
@@ -1245,11 +1226,11 @@ int AACodonMutSelSBDPPhyloProcess::GlobalNonSynMapping()	{
 	assert(myid==0);
 	MESSAGE signal = NONSYNMAPPING;
 	MPI_Status stat;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int i, count, totalcount=0;
 	for (i=1; i<nprocs; ++i)	{
-		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD, &stat);
+		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM, &stat);
 		totalcount += count;
 	}
 	return totalcount;
@@ -1259,6 +1240,6 @@ int AACodonMutSelSBDPPhyloProcess::GlobalNonSynMapping()	{
 void AACodonMutSelSBDPPhyloProcess::SlaveNonSynMapping()	{
 
 	int nonsyn = CountNonSynMapping();
-	MPI_Send(&nonsyn,1,MPI_INT,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&nonsyn,1,MPI_INT,0,TAG1,PROCESS_COMM);
 
 }
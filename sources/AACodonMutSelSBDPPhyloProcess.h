@@ -43,7 +43,7 @@ class AACodonMutSelSBDPPhyloProcess : public virtual AACodonMutSelSBDPSubstituti
 
 		datafile = indatafile;
 		codetype = incodetype;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		if (dc)	{
@@ -120,7 +120,7 @@ class AACodonMutSelSBDPPhyloProcess : public virtual AACodonMutSelSBDPSubstituti
 		is >> dirweightprior;
 		is >> mintotweight;
 		is >> dc;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		const TaxonSet* taxonset = codondata->GetTaxonSet();
@@ -169,6 +169,10 @@ class AACodonMutSelSBDPPhyloProcess : public virtual AACodonMutSelSBDPSubstituti
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
 
+	void SetSiteComponent(int site, int k)	{
+		AACodonMutSelSBDPProfileProcess::alloc[site] = k;
+	}
+
     void GlobalSetSiteLogLCutoff();
     void SlaveSetSiteLogLCutoff();
 
@@ -371,7 +371,9 @@ class AACodonMutSelSBDPProfileProcess : public virtual MatrixSBDPProfileProcess,
 	}
 
 	void UpdateMatrix(int k)	{
-		matrixarray[k]->CorruptMatrix();
+		if (matrixarray[k])	{
+			matrixarray[k]->CorruptMatrix();
+		}
 		// matrixarray[k]->UpdateMatrix();
 	}
 
@@ -0,0 +1,184 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "AlignmentCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char cachemagic[8] = {'P','B','A','L','N','C','1','\0'};
+
+const int AlignmentCache::maxnstate;
+const uint8_t AlignmentCache::unknownstate;
+
+size_t AlignmentCache::GetEmpFreqOffset(int nalphabetset, int nameslength)	{
+	size_t offset = sizeof(Header) + nalphabetset + nameslength;
+	return (offset + 7) & ~((size_t) 7);
+}
+
+size_t AlignmentCache::GetLength(const Header& h)	{
+	return GetEmpFreqOffset(h.nalphabetset,h.nameslength) + h.nstate * sizeof(double) + ((size_t) h.ntaxa) * h.nsite + ((size_t) h.nsite) * h.nstate;
+}
+
+bool AlignmentCache::GetDataFileStat(string datafile, int64_t& size, int64_t& mtime)	{
+	struct stat st;
+	if (stat(datafile.c_str(),&st))	{
+		return false;
+	}
+	size = st.st_size;
+	mtime = st.st_mtime;
+	return true;
+}
+
+AlignmentCache* AlignmentCache::Open(string cachefile, string datafile)	{
+
+	int fd = open(cachefile.c_str(),O_RDONLY);
+	if (fd == -1)	{
+		return 0;
+	}
+	struct stat st;
+	if (fstat(fd,&st) || (((size_t) st.st_size) < sizeof(Header)))	{
+		close(fd);
+		return 0;
+	}
+	size_t length = st.st_size;
+	void* map = mmap(0,length,PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if (map == MAP_FAILED)	{
+		return 0;
+	}
+
+	const Header* header = (const Header*) map;
+	bool valid = (! memcmp(header->magic,cachemagic,8)) && (header->ntaxa > 0) && (header->nsite > 0) && (header->nstate > 0) && (header->nstate <= maxnstate) && (header->nalphabetset >= header->nstate) && (header->nameslength >= 0) && (GetLength(*header) == length);
+	if (valid && (datafile != ""))	{
+		int64_t size, mtime;
+		valid = GetDataFileStat(datafile,size,mtime) && (size == header->datasize) && (mtime == header->datamtime);
+	}
+	if (! valid)	{
+		munmap(map,length);
+		return 0;
+	}
+
+	AlignmentCache* cache = new AlignmentCache;
+	cache->map = map;
+	cache->maplength = length;
+	cache->header = header;
+	const char* base = (const char*) map;
+	cache->alphabetset = base + sizeof(Header);
+	cache->names = cache->alphabetset + header->nalphabetset;
+	size_t offset = GetEmpFreqOffset(header->nalphabetset,header->nameslength);
+	cache->empfreq = (const double*) (base + offset);
+	offset += header->nstate * sizeof(double);
+	cache->states = (const uint8_t*) (base + offset);
+	offset += ((size_t) header->ntaxa) * header->nsite;
+	cache->orbit = (const uint8_t*) (base + offset);
+	return cache;
+}
+
+AlignmentCache::~AlignmentCache()	{
+	munmap(map,maplength);
+}
+
+void AlignmentCache::GetNames(string* innames) const	{
+	const char* name = names;
+	for (int i=0; i<header->ntaxa; i++)	{
+		const char* end = (const char*) memchr(name,'\n',names + header->nameslength - name);
+		if (! end)	{
+			cerr << "error in AlignmentCache: corrupted taxon names\n";
+			exit(1);
+		}
+		innames[i] = string(name,end-name);
+		name = end + 1;
+	}
+}
+
+bool AlignmentCache::Write(string cachefile, string datafile, int ntaxa, int nsite, int statespacetag, int nstate, string alphabetset, const string* names, int** data, const double* empfreq)	{
+
+	if (nstate > maxnstate)	{
+		return false;
+	}
+
+	string allnames;
+	for (int i=0; i<ntaxa; i++)	{
+		allnames += names[i];
+		allnames += '\n';
+	}
+
+	Header h;
+	memset(&h,0,sizeof(Header));
+	memcpy(h.magic,cachemagic,8);
+	if (! GetDataFileStat(datafile,h.datasize,h.datamtime))	{
+		return false;
+	}
+	h.ntaxa = ntaxa;
+	h.nsite = nsite;
+	h.statespacetag = statespacetag;
+	h.nstate = nstate;
+	h.nalphabetset = alphabetset.length();
+	h.nameslength = allnames.length();
+
+	string tmpname = cachefile + ".tmp";
+	ofstream os(tmpname.c_str(), ios_base::binary);
+	if (! os)	{
+		return false;
+	}
+	os.write((const char*) &h,sizeof(Header));
+	os.write(alphabetset.data(),h.nalphabetset);
+	os.write(allnames.data(),h.nameslength);
+	size_t padding = GetEmpFreqOffset(h.nalphabetset,h.nameslength) - (sizeof(Header) + h.nalphabetset + h.nameslength);
+	const char zeros[8] = {0,0,0,0,0,0,0,0};
+	os.write(zeros,padding);
+	os.write((const char*) empfreq,nstate * sizeof(double));
+
+	vector<uint8_t> buf(nsite);
+	for (int i=0; i<ntaxa; i++)	{
+		for (int j=0; j<nsite; j++)	{
+			buf[j] = (data[i][j] == -1) ? unknownstate : (uint8_t) data[i][j];
+		}
+		os.write((const char*) buf.data(),nsite);
+	}
+
+	buf.resize(nstate);
+	for (int j=0; j<nsite; j++)	{
+		for (int k=0; k<nstate; k++)	{
+			buf[k] = 0;
+		}
+		for (int i=0; i<ntaxa; i++)	{
+			if (data[i][j] != -1)	{
+				buf[data[i][j]] = 1;
+			}
+		}
+		os.write((const char*) buf.data(),nstate);
+	}
+
+	os.close();
+	if (! os)	{
+		remove(tmpname.c_str());
+		return false;
+	}
+	if (rename(tmpname.c_str(),cachefile.c_str()))	{
+		remove(tmpname.c_str());
+		return false;
+	}
+	return true;
+}
+
@@ -0,0 +1,104 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef ALIGNMENTCACHE_H
+#define ALIGNMENTCACHE_H
+
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+// binary cache of an alignment read from a data file (pb_mpi / readpb_mpi -cache),
+// written next to the data file as <datafile>.pbcache
+//
+// contains the encoded alignment (taxon names, state space, one byte per state),
+// together with what is otherwise recomputed from it at every start:
+// the empirical frequencies (as returned by SequenceAlignment::GetEmpiricalFreq)
+// and the orbits of all sites (from which ZippedSequenceAlignment builds its zip arrays)
+//
+// the file is memory-mapped read-only, so that all processes of a node share the same pages.
+// it records the size and modification time of the data file, and is ignored if these do not match
+
+class AlignmentCache	{
+
+	public:
+
+	// returns 0 if the cache does not exist or is not valid
+	// if datafile is empty, the data file is not checked
+	static AlignmentCache* Open(string cachefile, string datafile);
+
+	// returns false if the cache could not be written
+	// (written into a temporary file, then renamed)
+	static bool Write(string cachefile, string datafile, int ntaxa, int nsite, int statespacetag, int nstate, string alphabetset, const string* names, int** data, const double* empfreq);
+
+	~AlignmentCache();
+
+	int GetNtaxa() const {return header->ntaxa;}
+	int GetNsite() const {return header->nsite;}
+	int GetStateSpaceTag() const {return header->statespacetag;}
+	int GetNstate() const {return header->nstate;}
+	string GetAlphabetSet() const {return string(alphabetset,header->nalphabetset);}
+	void GetNames(string* names) const;
+
+	// unknown (-1) for missing data
+	int GetState(int taxon, int site) const	{
+		uint8_t s = states[((size_t) taxon) * header->nsite + site];
+		return (s == unknownstate) ? -1 : s;
+	}
+
+	const double* GetEmpiricalFreq() const {return empfreq;}
+
+	bool InOrbit(int site, int state) const {return orbit[((size_t) site) * header->nstate + state];}
+
+	// states are stored as single bytes
+	static const int maxnstate = 255;
+
+	private:
+
+	static const uint8_t unknownstate = 255;
+
+	struct Header	{
+		char magic[8];
+		int64_t datasize;
+		int64_t datamtime;
+		int32_t ntaxa;
+		int32_t nsite;
+		int32_t statespacetag;
+		int32_t nstate;
+		int32_t nalphabetset;
+		int32_t nameslength;
+	};
+
+	AlignmentCache() : map(0), maplength(0), header(0), alphabetset(0), names(0), empfreq(0), states(0), orbit(0) {}
+
+	// file layout: header, alphabet set, names ('\n' terminated), padding to 8 bytes,
+	// empirical frequencies, states (taxon-major), orbits (site-major)
+	static size_t GetEmpFreqOffset(int nalphabetset, int nameslength);
+	static size_t GetLength(const Header& h);
+	static bool GetDataFileStat(string datafile, int64_t& size, int64_t& mtime);
+
+	void* map;
+	size_t maplength;
+
+	const Header* header;
+	const char* alphabetset;
+	const char* names;
+	const double* empfreq;
+	const uint8_t* states;
+	const uint8_t* orbit;
+};
+
+#endif
+
@@ -0,0 +1,150 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "AsyncWriter.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+AsyncWriter::AsyncWriter(int inmaxpending) : maxpending(inmaxpending), busy(false), done(false), writer(&AsyncWriter::Loop, this)	{
+}
+
+AsyncWriter::~AsyncWriter()	{
+	{
+		unique_lock<mutex> lock(mtx);
+		done = true;
+	}
+	notempty.notify_all();
+	writer.join();
+	CloseStreams();
+}
+
+void AsyncWriter::Append(string filename, string content)	{
+	Submit(APPEND,filename,content);
+}
+
+void AsyncWriter::Write(string filename, string content)	{
+	Submit(WRITE,filename,content);
+}
+
+void AsyncWriter::AtomicWrite(string filename, string content)	{
+	Submit(ATOMIC,filename,content);
+}
+
+void AsyncWriter::Close()	{
+	Submit(CLOSE,"","");
+	Flush();
+}
+
+void AsyncWriter::Submit(Mode mode, string filename, string content)	{
+	unique_lock<mutex> lock(mtx);
+	notfull.wait(lock, [this]{return (int) queue.size() < maxpending;});
+	Request req;
+	req.mode = mode;
+	req.filename = filename;
+	req.content.swap(content);
+	queue.push_back(req);
+	lock.unlock();
+	notempty.notify_one();
+}
+
+void AsyncWriter::Flush()	{
+	unique_lock<mutex> lock(mtx);
+	idle.wait(lock, [this]{return queue.empty() && (! busy);});
+}
+
+void AsyncWriter::Loop()	{
+
+	deque<Request> batch;
+	while (true)	{
+		{
+			unique_lock<mutex> lock(mtx);
+			notempty.wait(lock, [this]{return done || (! queue.empty());});
+			if (queue.empty())	{
+				// done, and nothing left to write
+				return;
+			}
+			// take everything submitted so far in one go
+			batch.swap(queue);
+			busy = true;
+		}
+		notfull.notify_all();
+
+		for (deque<Request>::iterator i=batch.begin(); i!=batch.end(); i++)	{
+			Process(*i);
+		}
+		batch.clear();
+		FlushStreams();
+
+		{
+			unique_lock<mutex> lock(mtx);
+			busy = false;
+		}
+		idle.notify_all();
+	}
+}
+
+void AsyncWriter::Process(Request& req)	{
+
+	if (req.mode == APPEND)	{
+		ofstream*& os = streams[req.filename];
+		if (! os)	{
+			os = new ofstream(req.filename.c_str(), ios_base::app);
+			if (! *os)	{
+				cerr << "error in AsyncWriter: cannot open " << req.filename << '\n';
+				exit(1);
+			}
+		}
+		(*os) << req.content;
+	}
+	else if (req.mode == WRITE)	{
+		ofstream os(req.filename.c_str());
+		os << req.content;
+	}
+	else if (req.mode == ATOMIC)	{
+		// everything appended before this request should be on disk first
+		FlushStreams();
+		string tmpname = req.filename + ".tmp";
+		ofstream os(tmpname.c_str());
+		os << req.content;
+		os.close();
+		if (! os)	{
+			cerr << "error in AsyncWriter: cannot write " << tmpname << '\n';
+			exit(1);
+		}
+		if (rename(tmpname.c_str(),req.filename.c_str()))	{
+			cerr << "error in AsyncWriter: cannot rename " << tmpname << " into " << req.filename << '\n';
+			exit(1);
+		}
+	}
+	else	{
+		CloseStreams();
+	}
+}
+
+void AsyncWriter::FlushStreams()	{
+	for (map<string,ofstream*>::iterator i=streams.begin(); i!=streams.end(); i++)	{
+		i->second->flush();
+	}
+}
+
+void AsyncWriter::CloseStreams()	{
+	for (map<string,ofstream*>::iterator i=streams.begin(); i!=streams.end(); i++)	{
+		i->second->close();
+		delete i->second;
+	}
+	streams.clear();
+}
+
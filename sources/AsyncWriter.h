@@ -0,0 +1,87 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <string>
+#include <deque>
+#include <map>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// background writer for the output files of a chain (.treelist, .trace, .monitor, .param, .chain)
+// the master serializes everything into strings and hands them over;
+// a single thread writes them in submission order, in batches,
+// keeping the append-only files open across iterations.
+// AtomicWrite goes through a temporary file followed by a rename,
+// after all pending appends have been flushed,
+// so that a .param file always points to a complete .chain on disk.
+
+class AsyncWriter	{
+
+	public:
+
+	AsyncWriter(int inmaxpending = 64);
+	~AsyncWriter();
+
+	// append to file (opened once, kept open)
+	void Append(string filename, string content);
+	// truncate and rewrite
+	void Write(string filename, string content);
+	// write to filename.tmp, then rename onto filename
+	void AtomicWrite(string filename, string content);
+
+	// blocks until all pending requests have been written
+	void Flush();
+	// flushes and closes all files kept open
+	void Close();
+
+	private:
+
+	enum Mode {APPEND, WRITE, ATOMIC, CLOSE};
+
+	struct Request	{
+		Mode mode;
+		string filename;
+		string content;
+	};
+
+	void Submit(Mode mode, string filename, string content);
+	void Loop();
+	void Process(Request& req);
+	void FlushStreams();
+	void CloseStreams();
+
+	deque<Request> queue;
+	map<string,ofstream*> streams;
+
+	mutex mtx;
+	condition_variable notempty;
+	condition_variable notfull;
+	condition_variable idle;
+
+	int maxpending;
+	bool busy;
+	bool done;
+
+	thread writer;
+};
+
+#endif
+
@@ -32,8 +32,8 @@ void CodonMutSelFinitePhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + ProfileProcess::GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 	int index = 0;
 	dvector[index] = branchalpha;
 	index++;
@@ -93,6 +93,9 @@ void CodonMutSelFinitePhyloProcess::SlaveExecute(MESSAGE signal)	{
 	case PROFILE_MOVE:
 		SlaveMoveProfile();
 		break;
+	case SHARED_LOGPROB:
+		SlaveSharedParameterLogProb();
+		break;
 	default:
 		PhyloProcess::SlaveExecute(signal);
 	}
@@ -121,7 +124,7 @@ void CodonMutSelFinitePhyloProcess::GlobalUpdateParameters() {
 	int ivector[ni];
 	double dvector[nd]; 
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	
 	int index = 0;
 	index++;
@@ -163,8 +166,8 @@ void CodonMutSelFinitePhyloProcess::GlobalUpdateParameters() {
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void CodonMutSelFinitePhyloProcess::ReadPB(int argc, char* argv[])	{
@@ -363,9 +366,9 @@ void CodonMutSelFinitePhyloProcess::GlobalSetTestData()	{
 	testdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
@@ -373,9 +376,9 @@ void CodonMutSelFinitePhyloProcess::GlobalSetTestData()	{
 void CodonMutSelFinitePhyloProcess::SlaveSetTestData()	{
 
     int testnnuc;
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnnuc * GetNtaxa()];
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
     testnsite = testnnuc / 3;
 	
 	SetTestSiteMinAndMax();
@@ -393,15 +396,9 @@ void CodonMutSelFinitePhyloProcess::SlaveComputeCVScore()	{
 	}
 	
 	for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			CodonMutSelFiniteProfileProcess::alloc[i] = k;
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
 	}
+	ComputeSiteComponentLogL(GetNcomponent(),sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -420,7 +417,7 @@ void CodonMutSelFinitePhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -446,19 +443,9 @@ void CodonMutSelFinitePhyloProcess::SlaveComputeSiteLogL()	{
 	}
 	
 	for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                CodonMutSelFiniteProfileProcess::alloc[i] = k;
-            }
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-            }
-		}
 	}
+	ComputeSiteComponentLogL(GetNcomponent(),sitelogl);
 
 	double* meansitelogl = new double[ProfileProcess::GetNsite()];
     double* cumul = new double[GetNcomponent()];
@@ -494,7 +481,7 @@ void CodonMutSelFinitePhyloProcess::SlaveComputeSiteLogL()	{
 	UpdateMatrices();
     UpdateConditionalLikelihoods();
 
-	MPI_Send(meansitelogl,ProfileProcess::GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
@@ -41,7 +41,7 @@ class CodonMutSelFinitePhyloProcess : public virtual CodonMutSelFiniteSubstituti
 
 		datafile = indatafile;
 		codetype = incodetype;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		if (dc)	{
@@ -129,7 +129,7 @@ class CodonMutSelFinitePhyloProcess : public virtual CodonMutSelFiniteSubstituti
 		}
 		is >> dirweightprior;
 		is >> dc;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		const TaxonSet* taxonset = codondata->GetTaxonSet();
@@ -175,6 +175,10 @@ class CodonMutSelFinitePhyloProcess : public virtual CodonMutSelFiniteSubstituti
 
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
+
+	void SetSiteComponent(int site, int k)	{
+		CodonMutSelFiniteProfileProcess::alloc[site] = k;
+	}
     void GlobalSetTestData();
     void SlaveSetTestData();
 
@@ -104,7 +104,7 @@ class CodonMutSelFiniteProfileProcess : public virtual MatrixFiniteProfileProces
 				// profiles
 				GlobalUpdateParameters();
 				GlobalUpdateSiteProfileSuffStat();
-				UpdateModeProfileSuffStat();
+				// component suff stats: summed over slaves in GlobalMoveProfile
 				GlobalMoveProfile(1,1,100);
 				GlobalMoveProfile(1,3,100);
 				GlobalMoveProfile(0.1,3,100);
@@ -190,7 +190,9 @@ class CodonMutSelFiniteProfileProcess : public virtual MatrixFiniteProfileProces
 	}
 
 	void UpdateMatrix(int k)	{
-		matrixarray[k]->CorruptMatrix();
+		if (matrixarray[k])	{
+			matrixarray[k]->CorruptMatrix();
+		}
 	}
 	/*
 	void CreateMatrices()	{
@@ -123,14 +123,13 @@ double CodonMutSelProfileProcess::MoveNucRR(double tuning)	{
 
 	int naccepted = 0;
         for (int i=0; i<GetNnucrr(); i++)  {
-                double deltalogratio = - LogNucRRPrior() - ProfileSuffStatLogProb();
+                double deltalogratio = - LogNucRRPrior() - SharedParameterLogProb();
                 double bk = nucrr[i];
                 double m = tuning * (rnd::GetRandom().Uniform() - 0.5);
                 // double m = tuning * (Random::Uniform() - 0.5);
                 double e = exp(m);
                 nucrr[i] *= e;
-                UpdateMatrices();
-                deltalogratio += LogNucRRPrior() + ProfileSuffStatLogProb();
+                deltalogratio += LogNucRRPrior() + ProposedSharedParameterLogProb();
                 deltalogratio += m;
                 int accepted = (rnd::GetRandom().Uniform() < exp(deltalogratio));
                 // int accepted = (Random::Uniform() < exp(deltalogratio));
@@ -139,7 +138,7 @@ double CodonMutSelProfileProcess::MoveNucRR(double tuning)	{
                 }
                 else    {
                         nucrr[i] = bk;
-                        UpdateMatrices();
+                        RestoreSharedParameters();
                 }
         }
         return ((double) naccepted) / GetNnucrr();
@@ -154,10 +153,9 @@ double CodonMutSelProfileProcess::MoveNucRR(double tuning, int n)	{
 	for (int k=0; k<GetNnucrr(); k++)  {
 		bk[k] = nucrr[k];
 	}
-	double deltalogprob = -ProfileSuffStatLogProb();
+	double deltalogprob = -SharedParameterLogProb();
 	double loghastings = ProfileProposeMove(nucrr,tuning,n,GetNnucrr());
-	UpdateMatrices();
-	deltalogprob += ProfileSuffStatLogProb();
+	deltalogprob += ProposedSharedParameterLogProb();
 	deltalogprob += loghastings;
 	int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 	// int accepted = (Random::Uniform() < exp(deltalogprob));
@@ -168,7 +166,7 @@ double CodonMutSelProfileProcess::MoveNucRR(double tuning, int n)	{
 		for (int k=0; k<GetNnucrr(); k++)  {
 			nucrr[k] = bk[k];
 		}
-		UpdateMatrices();
+		RestoreSharedParameters();
 	}
 	delete[] bk;
 	return naccepted; 
@@ -182,10 +180,9 @@ double CodonMutSelProfileProcess::MoveNucStat(double tuning, int n)	{
 	for (int k=0; k<Nnuc; k++)  {
 		bk[k] = nucstat[k];
 	}
-	double deltalogprob = -ProfileSuffStatLogProb();
+	double deltalogprob = -SharedParameterLogProb();
 	double loghastings = ProfileProposeMove(nucstat,tuning,n,Nnuc);
-	UpdateMatrices();
-	deltalogprob += ProfileSuffStatLogProb();
+	deltalogprob += ProposedSharedParameterLogProb();
 	deltalogprob += loghastings;
 	int accepted = (rnd::GetRandom().Uniform() < exp(deltalogprob));
 	// int accepted = (Random::Uniform() < exp(deltalogprob));
@@ -196,7 +193,7 @@ double CodonMutSelProfileProcess::MoveNucStat(double tuning, int n)	{
 		for (int k=0; k<Nnuc; k++)  {
 			nucstat[k] = bk[k];
 		}
-		UpdateMatrices();
+		RestoreSharedParameters();
 	}
 	delete[] bk;
 	return naccepted; 
@@ -86,6 +86,31 @@ class CodonMutSelProfileProcess : public virtual GeneralPathSuffStatMatrixProfil
 	double MoveNucRR(double tuning); 
 	double MoveNucRR(double tuning, int n); 
 	double MoveNucStat(double tuning, int n);
+
+	// nucrr and nucstat, shared by all matrices
+	virtual int GetNsharedParameter()	{
+		return GetNnucrr() + Nnuc;
+	}
+
+	virtual void GetSharedParameters(double* array)	{
+		int index = 0;
+		for (int i=0; i<GetNnucrr(); i++)	{
+			array[index++] = nucrr[i];
+		}
+		for (int i=0; i<Nnuc; i++)	{
+			array[index++] = nucstat[i];
+		}
+	}
+
+	virtual void SetSharedParameters(const double* array)	{
+		int index = 0;
+		for (int i=0; i<GetNnucrr(); i++)	{
+			nucrr[i] = array[index++];
+		}
+		for (int i=0; i<Nnuc; i++)	{
+			nucstat[i] = array[index++];
+		}
+	}
 	
 	int Nnucrr;
 	double* nucrr;
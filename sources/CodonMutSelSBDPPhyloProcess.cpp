@@ -36,8 +36,8 @@ void CodonMutSelSBDPPhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + ProfileProcess::GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 	int index = 0;
 	branchalpha = dvector[index];
 	index++;
@@ -76,8 +76,8 @@ void CodonMutSelSBDPPhyloProcess::SlaveUpdateParameters()	{
 	delete[] dvector;
 	delete[] ivector;
 
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	// this one is really important
 	// in those cases where new components have appeared, or some old ones have disappeared
@@ -102,6 +102,9 @@ void CodonMutSelSBDPPhyloProcess::SlaveExecute(MESSAGE signal)	{
 	case PROFILE_MOVE:
 		SlaveMoveProfile();
 		break;
+	case SHARED_LOGPROB:
+		SlaveSharedParameterLogProb();
+		break;
     case SITELOGLCUTOFF:
         SlaveSetSiteLogLCutoff();
         break;
@@ -137,7 +140,7 @@ void CodonMutSelSBDPPhyloProcess::GlobalUpdateParameters() {
 	int ivector[ni];
 	double dvector[nd]; 
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	
 	// GlobalBroadcastTree();
 	// First we assemble the vector of doubles for distribution
@@ -181,10 +184,10 @@ void CodonMutSelSBDPPhyloProcess::GlobalUpdateParameters() {
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void CodonMutSelSBDPPhyloProcess::ReadPB(int argc, char* argv[])	{
@@ -368,12 +371,12 @@ void CodonMutSelSBDPPhyloProcess::ReadPB(int argc, char* argv[])	{
 void CodonMutSelSBDPPhyloProcess::GlobalSetSiteLogLCutoff()  {
 
 	MESSAGE signal = SITELOGLCUTOFF;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void CodonMutSelSBDPPhyloProcess::SlaveSetSiteLogLCutoff()  {
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void CodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
@@ -383,9 +386,9 @@ void CodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
 	testdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
@@ -393,9 +396,9 @@ void CodonMutSelSBDPPhyloProcess::GlobalSetTestData()	{
 void CodonMutSelSBDPPhyloProcess::SlaveSetTestData()	{
 
     int testnnuc;
-	MPI_Bcast(&testnnuc,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnnuc,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnnuc * GetNtaxa()];
-	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnnuc*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
     testnsite = testnnuc / 3;
 	
 	SetTestSiteMinAndMax();
@@ -421,17 +424,9 @@ void CodonMutSelSBDPPhyloProcess::SlaveComputeCVScore()	{
 	}
 	
 	for (int k=0; k<ncomp; k++)	{
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			CodonMutSelSBDPProfileProcess::alloc[i] = k;
-			//UpdateMatrix(i);
-		}
 		UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
 	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -452,7 +447,7 @@ void CodonMutSelSBDPPhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -483,24 +478,9 @@ void CodonMutSelSBDPPhyloProcess::SlaveComputeSiteLogL()	{
 	// UpdateMatrices();
 
 	for (int k=0; k<ncomp; k++)	{
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                CodonMutSelSBDPProfileProcess::alloc[i] = k;
-            }
-		}
-        UpdateMatrix(k);
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-                if (std::isnan(sitelogl[i][k]))	{
-                    cerr << "error in RASCATGTRSBDP::SlaveComputeSiteLogL: nan\n";
-                    exit(1);
-                }
-            }
-		}
+		UpdateMatrix(k);
 	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double* meansitelogl = new double[ProfileProcess::GetNsite()];
 	for (int i=0; i<ProfileProcess::GetNsite(); i++)	{
@@ -534,7 +514,7 @@ void CodonMutSelSBDPPhyloProcess::SlaveComputeSiteLogL()	{
 		}
 	}
 
-	MPI_Send(meansitelogl,ProfileProcess::GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
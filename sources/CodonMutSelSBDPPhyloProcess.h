@@ -42,7 +42,7 @@ class CodonMutSelSBDPPhyloProcess : public virtual CodonMutSelSBDPSubstitutionPr
 
 		datafile = indatafile;
 		codetype = incodetype;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		if (dc)	{
@@ -110,7 +110,7 @@ class CodonMutSelSBDPPhyloProcess : public virtual CodonMutSelSBDPSubstitutionPr
 		is >> kappaprior;
 		is >> mintotweight;
 		is >> dc;
-		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* nucdata = new FileSequenceAlignment(datafile,0,myid,1);
 		CodonSequenceAlignment* codondata = new CodonSequenceAlignment(nucdata,true,codetype);
 		CodonStateSpace* statespace = codondata->GetCodonStateSpace();
 		const TaxonSet* taxonset = codondata->GetTaxonSet();
@@ -159,6 +159,10 @@ class CodonMutSelSBDPPhyloProcess : public virtual CodonMutSelSBDPSubstitutionPr
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
 
+	void SetSiteComponent(int site, int k)	{
+		CodonMutSelSBDPProfileProcess::alloc[site] = k;
+	}
+
     void GlobalSetSiteLogLCutoff();
     void SlaveSetSiteLogLCutoff();
 
@@ -193,7 +193,9 @@ class CodonMutSelSBDPProfileProcess : public virtual MatrixSBDPProfileProcess, p
 	}
 
 	void UpdateMatrix(int k)	{
-		matrixarray[k]->CorruptMatrix();
+		if (matrixarray[k])	{
+			matrixarray[k]->CorruptMatrix();
+		}
 	}
 };
 
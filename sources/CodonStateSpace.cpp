@@ -124,6 +124,29 @@ CodonStateSpace::CodonStateSpace(GeneticCodeType type)	{
 		exit(1);
 	}
 
+	MakeNeighbourTable();
+}
+
+void CodonStateSpace::MakeNeighbourTable()	{
+
+	Nneighbour = new int[Nstate];
+	Neighbour = new int*[Nstate];
+	NeighbourPos = new int*[Nstate];
+	for (int i=0; i<Nstate; i++)	{
+		Neighbour[i] = new int[Npos*(Nnuc-1)];
+		NeighbourPos[i] = new int[Npos*(Nnuc-1)];
+		int n = 0;
+		// in increasing order of codons, as in a dense scan of a row of the matrix
+		for (int j=0; j<Nstate; j++)	{
+			int pos = GetDifferingPosition(i,j);
+			if ((pos != -1) && (pos != 3))	{
+				Neighbour[i][n] = j;
+				NeighbourPos[i][n] = pos;
+				n++;
+			}
+		}
+		Nneighbour[i] = n;
+	}
 }
 
 CodonStateSpace::~CodonStateSpace()	{
@@ -135,6 +158,14 @@ CodonStateSpace::~CodonStateSpace()	{
 	}
 	delete[] CodonPos;
 
+	for (int i=0; i<Nstate; i++)	{
+		delete[] Neighbour[i];
+		delete[] NeighbourPos[i];
+	}
+	delete[] Neighbour;
+	delete[] NeighbourPos;
+	delete[] Nneighbour;
+
 	delete nucstatespace;
 	delete protstatespace;
 }
@@ -53,6 +53,22 @@ class CodonStateSpace : public StateSpace	{
 	// otherwise, returns the position at which codons differ (i.e. returns 0,1 or 2 if the codons differ at position 1,2 or 3)
 	int GetDifferingPosition(int codon1, int codon2);
 
+	// codons (stops excluded) differing from a given codon at exactly one position
+	// (at most 9, fewer when some of the single-nucleotide mutants are stops)
+	// listed in increasing order
+	int GetNneighbour(int codon)	{
+		return Nneighbour[codon];
+	}
+
+	const int* GetNeighbours(int codon)	{
+		return Neighbour[codon];
+	}
+
+	// for each neighbour, the position at which it differs (0, 1 or 2)
+	const int* GetNeighbourPositions(int codon)	{
+		return NeighbourPos[codon];
+	}
+
 	// return the integer encoding for the base at requested position
 	// stops excluded
 	int GetCodonPosition(int pos, int codon)	{
@@ -124,6 +140,7 @@ class CodonStateSpace : public StateSpace	{
 	private:
 
 	void MakeDegeneracyMap();
+	void MakeNeighbourTable();
 
 	GeneticCodeType code;
 	DNAStateSpace* nucstatespace;
@@ -146,6 +163,10 @@ class CodonStateSpace : public StateSpace	{
 
 	map<int,int> degeneracy;
 
+	int* Nneighbour;
+	int** Neighbour;
+	int** NeighbourPos;
+
 };
 
 #endif
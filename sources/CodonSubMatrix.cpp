@@ -17,21 +17,22 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 
 void CodonSubMatrix::ComputeArray(int i)	{
 
+	// only the single-nucleotide neighbours of codon i have non-zero rates
+	int nneighbour = statespace->GetNneighbour(i);
+	const int* neighbour = statespace->GetNeighbours(i);
+	const int* neighbourpos = statespace->GetNeighbourPositions(i);
+	for (int j=0; j<GetNstate(); j++)	{
+		Q[i][j] = 0;
+	}
+
 	double total = 0;
-	
-	for (int j=0; j<GetNstate(); j++)       {
-		if (i!=j)       {
-			int pos = GetDifferingPosition(i,j);
-			if ((pos != -1) && (pos != 3))  {
-				int a = GetCodonPosition(pos,i);
-				int b = GetCodonPosition(pos,j);
-				Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
-				total += Q[i][j];
-			}
-			else    {
-				Q[i][j] = 0;
-			}
-		}
+	for (int n=0; n<nneighbour; n++)	{
+		int j = neighbour[n];
+		int pos = neighbourpos[n];
+		int a = GetCodonPosition(pos,i);
+		int b = GetCodonPosition(pos,j);
+		Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
+		total += Q[i][j];
 	}
 	Q[i][i] = -total;
 }
@@ -54,55 +55,44 @@ void CodonSubMatrix::ComputeStationary()	{
 
 void AAMutSelProfileSubMatrix::ComputeArray(int i)	{
 
+	// only the single-nucleotide neighbours of codon i have non-zero rates
+	int nneighbour = statespace->GetNneighbour(i);
+	const int* neighbour = statespace->GetNeighbours(i);
+	const int* neighbourpos = statespace->GetNeighbourPositions(i);
+	for (int j=0; j<GetNstate(); j++)	{
+		Q[i][j] = 0;
+	}
+
 	double total = 0;
-	for (int j=0; j<GetNstate(); j++)       {
-		if (i!=j)       {
-			int pos = GetDifferingPosition(i,j);
-			if ((pos != -1) && (pos != 3))  {
-				int a = GetCodonPosition(pos,i);
-				int b = GetCodonPosition(pos,j);
-				if (a == b)     {
-					cerr << "identical states\n";
-					cerr << GetCodonStateSpace()->GetState(i) << '\t' << GetCodonStateSpace()->GetState(j) << '\n';
-					cerr << pos << '\n';
-					exit(1);
-				}
-				//Q[i][j] = (*NucMatrix)(a,b);
-				Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
-				if (! Synonymous(i,j))  {//When event is nonsynonymous, NeffDelta is a function of CodonProfile and AAProfile
-					double deltaF = log((aaprofile)[GetCodonStateSpace()->Translation(j)] / (aaprofile)[GetCodonStateSpace()->Translation(i)]);  
-					if (fabs(deltaF) < TOOSMALL)        {
-						Q[i][j] /= ( 1.0 - (deltaF / 2) );
-					}
-					//else if (deltaF > TOOLARGE)	{
-					//	Q[i][j] *= deltaF;
-					//}
-					//else if (deltaF < TOOLARGENEGATIVE)	{
-					//	Q[i][j] = 0;
-					//}
-					else    {
-						Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
-					}
-				}
+	for (int n=0; n<nneighbour; n++)	{
+		int j = neighbour[n];
+		int pos = neighbourpos[n];
+		int a = GetCodonPosition(pos,i);
+		int b = GetCodonPosition(pos,j);
+		//Q[i][j] = (*NucMatrix)(a,b);
+		Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
+		if (! Synonymous(i,j))  {//When event is nonsynonymous, NeffDelta is a function of CodonProfile and AAProfile
+			double deltaF = log((aaprofile)[GetCodonStateSpace()->Translation(j)] / (aaprofile)[GetCodonStateSpace()->Translation(i)]);  
+			if (fabs(deltaF) < TOOSMALL)        {
+				Q[i][j] /= ( 1.0 - (deltaF / 2) );
 			}
 			else    {
-				Q[i][j] = 0;
+				Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
 			}
-			total += Q[i][j];
+		}
+		total += Q[i][j];
 
-			if (Q[i][j] < 0)        {
-				cerr << "negative entry in matrix\n";
-				exit(1);
-			}
-			if (std::isinf(Q[i][j]))	{
-				cerr << "inf Q[i][j]\n";
-				exit(1);
-			}
-			if (std::isnan(Q[i][j]))	{
-				cerr << "nan Q[i][j]\n";
-				exit(1);
-			}
-			
+		if (Q[i][j] < 0)        {
+			cerr << "negative entry in matrix\n";
+			exit(1);
+		}
+		if (std::isinf(Q[i][j]))	{
+			cerr << "inf Q[i][j]\n";
+			exit(1);
+		}
+		if (std::isnan(Q[i][j]))	{
+			cerr << "nan Q[i][j]\n";
+			exit(1);
 		}
 	}
 	Q[i][i] = -total;
@@ -178,84 +168,71 @@ double AAMutSelProfileSubMatrix::GetRate()	{
 
 void AACodonMutSelProfileSubMatrix::ComputeArray(int i)	{
 
+	// only the single-nucleotide neighbours of codon i have non-zero rates
+	int nneighbour = statespace->GetNneighbour(i);
+	const int* neighbour = statespace->GetNeighbours(i);
+	const int* neighbourpos = statespace->GetNeighbourPositions(i);
+	for (int j=0; j<GetNstate(); j++)	{
+		Q[i][j] = 0;
+	}
+
 	double total = 0;
 	double deltaF;
-	for (int j=0; j<GetNstate(); j++)       {
-		if (i!=j)       {
-			int pos = GetDifferingPosition(i,j);
-			if ((pos != -1) && (pos != 3))  {
-				int a = GetCodonPosition(pos,i);
-				int b = GetCodonPosition(pos,j);
-				if (a == b)     {
-					cerr << "identical states\n";
-					cerr << GetCodonStateSpace()->GetState(i) << '\t' << GetCodonStateSpace()->GetState(j) << '\n';
-					cerr << pos << '\n';
-					exit(1);
-				}
-				Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
-				if (! Synonymous(i,j))  {
-					deltaF = log((aaprofile)[GetCodonStateSpace()->Translation(j)] / (aaprofile)[GetCodonStateSpace()->Translation(i)]) +
-							log( (codonprofile)[j] / (codonprofile)[i] );
-					Q[i][j] *= *omega;
-
-					//cerr << "in ComputeArray, omega is " << *omega << "\n";	
-					//cerr << "Q[" << i << "][" << j << "]: " << Q[i][j] << "\n";
-					//cerr.flush();
-				}
-				else	{
-					deltaF = log( (codonprofile)[j] / (codonprofile)[i] );
-
-				}
-
-				if (fabs(deltaF) < TOOSMALL)        {
-					Q[i][j] /= ( 1.0 - (deltaF / 2) );
-				}
-				else if (deltaF > TOOLARGE)	{
-					Q[i][j] *= deltaF;
-				}
-				else if (deltaF < TOOLARGENEGATIVE)	{
-					Q[i][j] = 0.0;
-					//Q[i][j] = 1e-10;
-				}
-				else    {
-					Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
-				}	
-			}
-			else    {
-				Q[i][j] = 0;
-			}
-			total += Q[i][j];
-
-
+	for (int n=0; n<nneighbour; n++)	{
+		int j = neighbour[n];
+		int pos = neighbourpos[n];
+		int a = GetCodonPosition(pos,i);
+		int b = GetCodonPosition(pos,j);
+		Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
+		if (! Synonymous(i,j))  {
+			deltaF = log((aaprofile)[GetCodonStateSpace()->Translation(j)] / (aaprofile)[GetCodonStateSpace()->Translation(i)]) +
+					log( (codonprofile)[j] / (codonprofile)[i] );
+			Q[i][j] *= *omega;
+		}
+		else	{
+			deltaF = log( (codonprofile)[j] / (codonprofile)[i] );
+		}
 
-			if (Q[i][j] < 0)        {
-				cerr << "negative entry in matrix\n";
-				cerr << "deltaF: " << deltaF << "\n";
-				cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
-				cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
-				exit(1);
-			}
-			if (std::isinf(Q[i][j]))	{
-				cerr << "inf Q[i][j]\n";
-				cerr << "deltaF: " << deltaF << "\n";
-				cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
-				cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
-				exit(1);
-			}
-			if (std::isnan(Q[i][j]))	{
-				cerr << "nan Q[i][j]\n";
-				cerr << "deltaF: " << deltaF << "\n";
-				cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
-				cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
-				cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
-				exit(1);
-			}
-			
+		if (fabs(deltaF) < TOOSMALL)        {
+			Q[i][j] /= ( 1.0 - (deltaF / 2) );
+		}
+		else if (deltaF > TOOLARGE)	{
+			Q[i][j] *= deltaF;
+		}
+		else if (deltaF < TOOLARGENEGATIVE)	{
+			Q[i][j] = 0.0;
+		}
+		else    {
+			Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
+		}	
+		total += Q[i][j];
+
+		if (Q[i][j] < 0)        {
+			cerr << "negative entry in matrix\n";
+			cerr << "deltaF: " << deltaF << "\n";
+			cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
+			cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
+			exit(1);
+		}
+		if (std::isinf(Q[i][j]))	{
+			cerr << "inf Q[i][j]\n";
+			cerr << "deltaF: " << deltaF << "\n";
+			cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
+			cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
+			exit(1);
+		}
+		if (std::isnan(Q[i][j]))	{
+			cerr << "nan Q[i][j]\n";
+			cerr << "deltaF: " << deltaF << "\n";
+			cerr << "codonprofile[" << i << "]: " << codonprofile[i] << "\n";
+			cerr << "codonprofile[" << j << "]: " << codonprofile[j] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(j) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(j)] << "\n";
+			cerr << "aaprofile[" << GetCodonStateSpace()->Translation(i) << "]: " << (aaprofile)[GetCodonStateSpace()->Translation(i)] << "\n";
+			exit(1);
 		}
 	}
 	Q[i][i] = -total;
@@ -315,53 +292,48 @@ double AACodonMutSelProfileSubMatrix::GetRate()	{
 
 void CodonMutSelProfileSubMatrix::ComputeArray(int i)	{
 
+	// only the single-nucleotide neighbours of codon i have non-zero rates
+	int nneighbour = statespace->GetNneighbour(i);
+	const int* neighbour = statespace->GetNeighbours(i);
+	const int* neighbourpos = statespace->GetNeighbourPositions(i);
+	for (int j=0; j<GetNstate(); j++)	{
+		Q[i][j] = 0;
+	}
+
 	double total = 0;
-	for (int j=0; j<GetNstate(); j++)       {
-		if (i!=j)       {
-			int pos = GetDifferingPosition(i,j);
-			if ((pos != -1) && (pos != 3))  {
-				int a = GetCodonPosition(pos,i);
-				int b = GetCodonPosition(pos,j);
-				if (a == b)     {
-					cerr << "identical states\n";
-					cerr << GetCodonStateSpace()->GetState(i) << '\t' << GetCodonStateSpace()->GetState(j) << '\n';
-					cerr << pos << '\n';
-					exit(1);
-				}
-				//Q[i][j] = (*NucMatrix)(a,b);
-				Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
-				double deltaF = log((codonprofile)[j] / (codonprofile)[i]);  
-				if (fabs(deltaF) < TOOSMALL)        {
-					Q[i][j] /= ( 1.0 - (deltaF / 2) );
-				}
-				else if (deltaF > TOOLARGE)	{
-					Q[i][j] *= deltaF;
-				}
-				else if (deltaF < TOOLARGENEGATIVE)	{
-					Q[i][j] = 0;
-				}
-				else    {
-					Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
-				}
-			}
-			else    {
-				Q[i][j] = 0;
-			}
-			total += Q[i][j];
+	for (int n=0; n<nneighbour; n++)	{
+		int j = neighbour[n];
+		int pos = neighbourpos[n];
+		int a = GetCodonPosition(pos,i);
+		int b = GetCodonPosition(pos,j);
+		//Q[i][j] = (*NucMatrix)(a,b);
+		Q[i][j] = nucrr[GetNucRRIndex(a,b)] * nucstat[b];
+		double deltaF = log((codonprofile)[j] / (codonprofile)[i]);  
+		if (fabs(deltaF) < TOOSMALL)        {
+			Q[i][j] /= ( 1.0 - (deltaF / 2) );
+		}
+		else if (deltaF > TOOLARGE)	{
+			Q[i][j] *= deltaF;
+		}
+		else if (deltaF < TOOLARGENEGATIVE)	{
+			Q[i][j] = 0;
+		}
+		else    {
+			Q[i][j] *=  (deltaF)/(1.0 - exp(-deltaF));
+		}
+		total += Q[i][j];
 
-			if (Q[i][j] < 0)        {
-				cerr << "negative entry in matrix\n";
-				exit(1);
-			}
-			if (std::isinf(Q[i][j]))	{
-				cerr << "inf Q[i][j]\n";
-				exit(1);
-			}
-			if (std::isnan(Q[i][j]))	{
-				cerr << "nan Q[i][j]\n";
-				exit(1);
-			}
-			
+		if (Q[i][j] < 0)        {
+			cerr << "negative entry in matrix\n";
+			exit(1);
+		}
+		if (std::isinf(Q[i][j]))	{
+			cerr << "inf Q[i][j]\n";
+			exit(1);
+		}
+		if (std::isnan(Q[i][j]))	{
+			cerr << "nan Q[i][j]\n";
+			exit(1);
 		}
 	}
 	Q[i][i] = -total;
@@ -0,0 +1,290 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "ConvergenceMonitor.h"
+#include "Parallel.h"
+#include "correlation.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+ConvergenceMonitor::ConvergenceMonitor(string inname, int inevery, double inmaxdiff, double inmaxreldiff, double inminsize) :
+	name(inname), every(inevery), maxdiffcutoff(inmaxdiff), maxreldiffcutoff(inmaxreldiff), minsizecutoff(inminsize), ncheck(0), npoint(0), ntaxa(0)	{
+}
+
+void ConvergenceMonitor::SetTraceHeader(string header)	{
+	istringstream is(header);
+	string tmp;
+	is >> tmp >> tmp >> tmp;
+	colnames.clear();
+	while (is >> tmp)	{
+		colnames.push_back(tmp);
+	}
+	colvalues.assign(colnames.size(),vector<double>());
+}
+
+void ConvergenceMonitor::AddPoint(string traceline, const Tree* tree)	{
+
+	istringstream is(traceline);
+	double tmp;
+	is >> tmp >> tmp >> tmp;
+	for (unsigned int j=0; j<colnames.size(); j++)	{
+		if (! (is >> tmp))	{
+			cerr << "error in ConvergenceMonitor::AddPoint: trace line does not match the header\n";
+			exit(1);
+		}
+		colvalues[j].push_back(tmp);
+	}
+	RecordSplits(tree);
+	npoint++;
+}
+
+void ConvergenceMonitor::RecordSplits(const Tree* tree)	{
+
+	if (! ntaxa)	{
+		ntaxa = tree->GetSize(tree->GetRoot());
+	}
+
+	vector<int> leaves;
+	vector<string> splits;
+	const Link* root = tree->GetRoot();
+	for (const Link* link=root->Next(); link!=root; link=link->Next())	{
+		RecursiveGetSplits(link->Out(),leaves,splits);
+	}
+
+	// a bifurcating root gives the same split twice
+	sort(splits.begin(),splits.end());
+	splits.erase(unique(splits.begin(),splits.end()),splits.end());
+	for (unsigned int k=0; k<splits.size(); k++)	{
+		map<string,int>::iterator i = splitindex.find(splits[k]);
+		int index;
+		if (i == splitindex.end())	{
+			index = splitpoints.size();
+			splitindex[splits[k]] = index;
+			splitpoints.push_back(vector<int>());
+		}
+		else	{
+			index = i->second;
+		}
+		splitpoints[index].push_back(npoint);
+	}
+}
+
+void ConvergenceMonitor::RecursiveGetSplits(const Link* from, vector<int>& leaves, vector<string>& splits)	{
+
+	if (from->isLeaf())	{
+		leaves.push_back(from->GetNode()->GetIndex());
+		return;
+	}
+	unsigned int begin = leaves.size();
+	for (const Link* link=from->Next(); link!=from; link=link->Next())	{
+		RecursiveGetSplits(link->Out(),leaves,splits);
+	}
+	int size = leaves.size() - begin;
+	if ((size < 2) || (size > ntaxa - 2))	{
+		return;
+	}
+	string split(ntaxa,0);
+	for (unsigned int i=begin; i<leaves.size(); i++)	{
+		split[leaves[i]] = 1;
+	}
+	if (split[0])	{
+		for (int i=0; i<ntaxa; i++)	{
+			split[i] = 1 - split[i];
+		}
+	}
+	splits.push_back(split);
+}
+
+bool ConvergenceMonitor::Stop(int localstop)	{
+
+	int stop = 0;
+	MPI_Allreduce(&localstop,&stop,1,MPI_INT,MPI_MAX,MASTER_COMM);
+	if (stop)	{
+		return true;
+	}
+	if (npoint && (! (npoint % every)))	{
+		return Check();
+	}
+	return false;
+}
+
+bool ConvergenceMonitor::Check()	{
+
+	int masterid, nchain;
+	MPI_Comm_rank(MASTER_COMM,&masterid);
+	MPI_Comm_size(MASTER_COMM,&nchain);
+	ncheck++;
+
+	int burnin = npoint / 5;
+	int ncol = colnames.size();
+
+	// trace: sample size, then mean, variance and effective size of each column
+	Correlation corr;
+	corr.setParameters(name,colnames,colvalues,burnin,npoint);
+	corr.computeCovariance();
+	corr.computeEffectiveSize();
+	int dim = 3*ncol + 1;
+	vector<double> local(dim);
+	local[0] = npoint - burnin;
+	for (int j=0; j<ncol; j++)	{
+		local[3*j+1] = corr.getMean(j);
+		local[3*j+2] = corr.getVariance(j);
+		local[3*j+3] = corr.getEffectiveSize(j);
+	}
+	vector<double> all(masterid ? 0 : nchain*dim);
+	MPI_Gather(local.data(),dim,MPI_DOUBLE,all.data(),dim,MPI_DOUBLE,0,MASTER_COMM);
+
+	// splits: frequency of each split present after burnin
+	string buf;
+	for (map<string,int>::iterator i=splitindex.begin(); i!=splitindex.end(); i++)	{
+		const vector<int>& points = splitpoints[i->second];
+		int count = points.end() - lower_bound(points.begin(),points.end(),burnin);
+		if (count)	{
+			double freq = ((double) count) / (npoint - burnin);
+			buf += i->first;
+			buf.append((const char*) &freq,sizeof(double));
+		}
+	}
+	int length = buf.size();
+	vector<int> lengths(masterid ? 0 : nchain);
+	MPI_Gather(&length,1,MPI_INT,lengths.data(),1,MPI_INT,0,MASTER_COMM);
+	vector<int> offsets(masterid ? 0 : nchain);
+	int total = 0;
+	for (unsigned int c=0; c<lengths.size(); c++)	{
+		offsets[c] = total;
+		total += lengths[c];
+	}
+	vector<char> allbuf(masterid ? 0 : total);
+	MPI_Gatherv(&buf[0],length,MPI_CHAR,allbuf.data(),lengths.data(),offsets.data(),MPI_CHAR,0,MASTER_COMM);
+
+	int converged = 0;
+	if (! masterid)	{
+
+		int itemsize = ntaxa + sizeof(double);
+		map<string,vector<double> > freqs;
+		for (int c=0; c<nchain; c++)	{
+			for (int k=offsets[c]; k<offsets[c]+lengths[c]; k+=itemsize)	{
+				string split(&allbuf[k],ntaxa);
+				double freq;
+				memcpy(&freq,&allbuf[k+ntaxa],sizeof(double));
+				vector<double>& f = freqs[split];
+				f.resize(nchain,0);
+				f[c] = freq;
+			}
+		}
+		double maxdiff = 0;
+		double meandiff = 0;
+		double weight = 0;
+		for (map<string,vector<double> >::iterator i=freqs.begin(); i!=freqs.end(); i++)	{
+			const vector<double>& f = i->second;
+			double max = 0;
+			double meand = 0;
+			double mean = 0;
+			int count = 0;
+			for (int p=0; p<nchain; p++)	{
+				for (int q=p+1; q<nchain; q++)	{
+					double tmp = fabs(f[p] - f[q]);
+					if (max < tmp)	{
+						max = tmp;
+					}
+					meand += tmp;
+					count++;
+				}
+				mean += f[p];
+			}
+			mean /= nchain;
+			meand /= count;
+			meandiff += mean * meand;
+			weight += mean;
+			if (maxdiff < max)	{
+				maxdiff = max;
+			}
+		}
+		if (weight > 0)	{
+			meandiff /= weight;
+		}
+
+		// same statistics as in tracecomp (compareChainsConvergence)
+		vector<double> effsize(ncol);
+		vector<double> reldiff(ncol);
+		double mineffsize = 0;
+		double maxreldiff = 0;
+		for (int j=0; j<ncol; j++)	{
+			double absdiff = 0;
+			double meanse = 0;
+			effsize[j] = 0;
+			for (int c1=0; c1<nchain; c1++)	{
+				const double* v1 = &all[c1*dim];
+				for (int c2=c1+1; c2<nchain; c2++)	{
+					const double* v2 = &all[c2*dim];
+					double tmp = fabs(v2[3*j+1] - v1[3*j+1]);
+					if (absdiff < tmp)	{
+						absdiff = tmp;
+					}
+				}
+				if (v1[3*j+2] > 1e-12)	{
+					meanse += sqrt(v1[3*j+2]);
+				}
+				effsize[j] += v1[3*j+3];
+			}
+			meanse /= nchain;
+			effsize[j] /= nchain;
+			reldiff[j] = (meanse > 1e-12) ? absdiff / meanse : 0;
+			if ((! j) || (mineffsize > effsize[j]))	{
+				mineffsize = effsize[j];
+			}
+			if (maxreldiff < reldiff[j])	{
+				maxreldiff = reldiff[j];
+			}
+		}
+
+		converged = (maxdiff < maxdiffcutoff) && (maxreldiff < maxreldiffcutoff) && (mineffsize > minsizecutoff);
+
+		ofstream os((name + ".conv").c_str());
+		os << "check " << ncheck << ": " << nchain << " chains\n";
+		os << "points per chain : ";
+		for (int c=0; c<nchain; c++)	{
+			os << all[c*dim] << ' ';
+		}
+		os << "(after burnin of first fifth)\n";
+		os << '\n';
+		os << "maxdiff     : " << maxdiff << "\t(cutoff " << maxdiffcutoff << ")\n";
+		os << "meandiff    : " << meandiff << '\n';
+		os << '\n';
+		os << "name                effsize\trel_diff\n";
+		os << '\n';
+		for (int j=0; j<ncol; j++)	{
+			os << colnames[j];
+			for (int k=colnames[j].length(); k<20; k++)	{
+				os << ' ';
+			}
+			os << (int) effsize[j] << "\t\t" << reldiff[j] << '\n';
+		}
+		os << '\n';
+		os << "min effsize : " << mineffsize << "\t(cutoff " << minsizecutoff << ")\n";
+		os << "max rel_diff: " << maxreldiff << "\t(cutoff " << maxreldiffcutoff << ")\n";
+		os << '\n';
+		os << (converged ? "converged: all chains stopped\n" : "not yet converged\n");
+		os.close();
+	}
+	MPI_Bcast(&converged,1,MPI_INT,0,MASTER_COMM);
+	return converged;
+}
+
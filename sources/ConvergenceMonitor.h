@@ -0,0 +1,84 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef CONVERGENCEMONITOR_H
+#define CONVERGENCEMONITOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Tree.h"
+
+using namespace std;
+
+// online convergence diagnostics over several chains run in the same job (pb_mpi -nchain)
+//
+// one monitor per chain, held by the master of the chain.
+// each point of the chain is recorded as it is produced (trace values, and bipartitions of the tree),
+// and, every <every> points, the masters of all chains compare their chains (over MASTER_COMM),
+// discarding the first fifth of each chain as burnin (as tracecomp and bpcomp do by default):
+// - maxdiff: largest difference in bipartition frequencies between chains (as in bpcomp)
+// - effsize and rel_diff: for each column of the trace, as in tracecomp
+// the chains are all stopped as soon as maxdiff < maxdiff threshold, rel_diff < rel_diff threshold
+// and effsize > minimum effective size, for all columns.
+// the master of the first chain writes the current diagnostics into <name>.conv after each check
+
+class ConvergenceMonitor	{
+
+	public:
+
+	ConvergenceMonitor(string inname, int inevery, double inmaxdiff, double inmaxreldiff, double inminsize);
+
+	// header line of the .trace file (the first three columns, iter, time and topo, are not monitored)
+	void SetTraceHeader(string header);
+
+	// one line of the .trace file, and the current tree
+	void AddPoint(string traceline, const Tree* tree);
+
+	// collective over MASTER_COMM, called after each point:
+	// localstop: whether this chain should stop on its own (.run file, or until reached)
+	// returns true if all chains should stop
+	bool Stop(int localstop);
+
+	private:
+
+	// collective over MASTER_COMM; returns true if converged
+	bool Check();
+
+	void RecordSplits(const Tree* tree);
+	// appends the leaves below from to leaves, and records the splits found along the way
+	void RecursiveGetSplits(const Link* from, vector<int>& leaves, vector<string>& splits);
+
+	string name;
+	int every;
+	double maxdiffcutoff;
+	double maxreldiffcutoff;
+	double minsizecutoff;
+
+	int ncheck;
+	int npoint;
+
+	vector<string> colnames;
+	vector<vector<double> > colvalues;
+
+	int ntaxa;
+	// bipartitions (one byte per taxon, side not containing taxon 0)
+	map<string,int> splitindex;
+	// for each split, the points at which it was present
+	vector<vector<int> > splitpoints;
+};
+
+#endif
+
@@ -174,7 +174,7 @@ void DGamRateProcess::GlobalUpdateRateSuffStat()	{
 	int i,j,nprocs = GetNprocs(),workload = GetNcat();
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_RATE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	for(i=0; i<workload; ++i) {
 		ratesuffstatcount[i] = 0;
@@ -183,14 +183,14 @@ void DGamRateProcess::GlobalUpdateRateSuffStat()	{
 	int ivector[workload];
 	double dvector[workload];
         for(i=1; i<nprocs; ++i) {
-                MPI_Recv(ivector,workload,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+                MPI_Recv(ivector,workload,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
                 for(j=0; j<workload; ++j) {
                         ratesuffstatcount[j] += ivector[j];                      
                 }
         }
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Barrier(PROCESS_COMM);
         for(i=1; i<nprocs; ++i) {
-                MPI_Recv(dvector,workload,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+                MPI_Recv(dvector,workload,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
                 for(j=0; j<workload; ++j) {
                         ratesuffstatbeta[j] += dvector[j]; 
                 }
@@ -215,7 +215,7 @@ void DGamRateProcess::SlaveUpdateRateSuffStat()	{
 
 	UpdateRateSuffStat();
 
-	MPI_Send(ratesuffstatcount,GetNcat(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Send(ratesuffstatbeta,GetNcat(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(ratesuffstatcount,GetNcat(),MPI_INT,0,TAG1,PROCESS_COMM);
+	MPI_Barrier(PROCESS_COMM);
+	MPI_Send(ratesuffstatbeta,GetNcat(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }	
@@ -56,7 +56,7 @@ class ExpoConjugateGTRFiniteProfileProcess : public virtual MatrixFiniteProfileP
 				// profiles
 				GlobalUpdateParameters();
 				GlobalUpdateSiteProfileSuffStat();
-				UpdateModeProfileSuffStat();
+				// component suff stats: summed over slaves in GlobalMoveProfile
 				profilechrono.Start();
 				GlobalMoveProfile(1,1,100);
 				GlobalMoveProfile(1,3,100);
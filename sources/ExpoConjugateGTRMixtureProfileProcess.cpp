@@ -16,6 +16,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 
 #include "ExpoConjugateGTRMixtureProfileProcess.h"
 #include "Random.h"
+#include "Parallel.h"
 
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
@@ -27,23 +28,24 @@ void ExpoConjugateGTRMixtureProfileProcess::Create(int innsite, int indim)	{
 	ExpoConjugateGTRProfileProcess::Create(innsite,indim);
 	if (! profilesuffstatcount)	{
 		GTRMixtureProfileProcess::Create(innsite,indim);
+		// contiguous, so that they can be summed over processes in one go
+		allocprofilesuffstatcount = new int[GetNmodeMax() * GetDim()];
+		allocprofilesuffstatbeta = new double[GetNmodeMax() * GetDim()];
 		profilesuffstatcount = new int*[GetNmodeMax()];
 		profilesuffstatbeta = new double*[GetNmodeMax()];
 		for (int i=0; i<GetNmodeMax(); i++)	{
-			profilesuffstatcount[i] = new int[GetDim()];
-			profilesuffstatbeta[i] = new double[GetDim()];
+			profilesuffstatcount[i] = allocprofilesuffstatcount + i*GetDim();
+			profilesuffstatbeta[i] = allocprofilesuffstatbeta + i*GetDim();
 		}
 	}
 }
 
 void ExpoConjugateGTRMixtureProfileProcess::Delete() {
 	if (profilesuffstatcount)	{
-		for (int i=0; i<GetNmodeMax(); i++)	{
-			delete[] profilesuffstatcount[i];
-			delete[] profilesuffstatbeta[i];
-		}
 		delete[] profilesuffstatcount;
 		delete[] profilesuffstatbeta;
+		delete[] allocprofilesuffstatcount;
+		delete[] allocprofilesuffstatbeta;
 		profilesuffstatcount = 0;
 		profilesuffstatbeta = 0;
 		GTRMixtureProfileProcess::Delete();
@@ -80,6 +82,26 @@ void ExpoConjugateGTRMixtureProfileProcess::UpdateModeProfileSuffStat()	{
 	}
 }
 
+void ExpoConjugateGTRMixtureProfileProcess::ReduceModeProfileSuffStat()	{
+	for (int i=0; i<GetNcomponent()*GetDim(); i++)	{
+		allocprofilesuffstatcount[i] = 0;
+		allocprofilesuffstatbeta[i] = 0;
+	}
+	if (GetMyid())	{
+		for (int i=GetSiteMin(); i<GetSiteMax(); i++)	{
+			const int* count = GetSiteProfileSuffStatCount(i);
+			const double* beta = GetSiteProfileSuffStatBeta(i);
+			int cat = alloc[i];
+			for (int k=0; k<GetDim(); k++)	{
+				profilesuffstatcount[cat][k] += count[k];
+				profilesuffstatbeta[cat][k] += beta[k];
+			}
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE,allocprofilesuffstatcount,GetNcomponent()*GetDim(),MPI_INT,MPI_SUM,PROCESS_COMM);
+	MPI_Allreduce(MPI_IN_PLACE,allocprofilesuffstatbeta,GetNcomponent()*GetDim(),MPI_DOUBLE,MPI_SUM,PROCESS_COMM);
+}
+
 double ExpoConjugateGTRMixtureProfileProcess::ProfileSuffStatLogProb(int cat)	{
 	double total = 0;
 	for (int k=0; k<GetDim(); k++)	{
@@ -122,6 +144,23 @@ double ExpoConjugateGTRMixtureProfileProcess::LogStatProb(int site, int cat)	{
 }
 
 
+// same sums as LogStatProb, state by state, with an inner loop over components on contiguous arrays
+void ExpoConjugateGTRMixtureProfileProcess::LogStatProbs(int site, int ncat, double* logsamp)	{
+	const int* count = GetSiteProfileSuffStatCount(site);
+	const double* beta = GetSiteProfileSuffStatBeta(site);
+	for (int cat=0; cat<ncat; cat++)	{
+		logsamp[cat] = 0;
+	}
+	for (int k=0; k<GetDim(); k++)	{
+		double n = count[k];
+		double b = beta[k];
+		const double* p = profiletable + k*GetNmodeMax();
+		const double* logp = logprofiletable + k*GetNmodeMax();
+		for (int cat=0; cat<ncat; cat++)	{
+			logsamp[cat] += n * logp[cat] - b * p[cat];
+		}
+	}
+}
 
 double ExpoConjugateGTRMixtureProfileProcess::PoissonDiffLogSampling(int cat, int site)	{
 
@@ -54,16 +54,23 @@ class ExpoConjugateGTRMixtureProfileProcess : public virtual GTRMixtureProfilePr
 	double ProfileSuffStatLogProb(int cat);
 	void SwapComponents(int cat1, int cat2);
 	virtual double LogStatProb(int site, int cat);
+	virtual void UpdateLogStatProbs(int ncat)	{
+		UpdateLogProfileTable(ncat);
+	}
+	virtual void LogStatProbs(int site, int ncat, double* logsamp);
 
 	virtual void Create(int innsite, int indim);
 	virtual void Delete();
 
 	// collects site-specific suffstats and pools them componentwise
 	void UpdateModeProfileSuffStat();
+	void ReduceModeProfileSuffStat();
 
 	// component-specific sufficient statistics
 	int** profilesuffstatcount;
 	double** profilesuffstatbeta;
+	int* allocprofilesuffstatcount;
+	double* allocprofilesuffstatbeta;
 
 	double PoissonDiffLogSampling(int cat, int site);
 };
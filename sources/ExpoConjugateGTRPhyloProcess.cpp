@@ -134,7 +134,7 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	int i,j,k,l,width,nalloc,smin[nprocs-1],smax[nprocs-1],workload[nprocs-1];
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_SPROFILE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	// suff stats are contained in 2 arrays
 	// int** siteprofilesuffstatcount
@@ -157,7 +157,7 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	int ivector[nalloc];
 	double dvector[nalloc];
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(ivector,workload[i-1],MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(ivector,workload[i-1],MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 		l = 0;
 		for(j=smin[i-1]; j<smax[i-1]; ++j) {
 			for(k=0; k<GetGlobalNstate(); ++k) {
@@ -166,7 +166,7 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 		}
 	}
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(dvector,workload[i-1],MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(dvector,workload[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 		l = 0;
 		for(j=smin[i-1]; j<smax[i-1]; ++j) {
 			for(k=0; k<GetGlobalNstate(); ++k) {
@@ -175,8 +175,8 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 		}
 	}
 
-	MPI_Bcast(allocsiteprofilesuffstatcount,GetNsite()*GetGlobalNstate(),MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(allocsiteprofilesuffstatbeta,GetNsite()*GetGlobalNstate(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	// not broadcast back: slaves only use the stats of their own sites
+	// (component stats: see ReduceModeProfileSuffStat)
 }
 
 void ExpoConjugateGTRPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
@@ -190,8 +190,8 @@ void ExpoConjugateGTRPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 			ivector[k] = siteprofilesuffstatcount[i][j]; k++;
 		}
 	}
-	MPI_Send(ivector,workload,MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	// MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Send(ivector,workload,MPI_INT,0,TAG1,PROCESS_COMM);
+	// MPI_Barrier(PROCESS_COMM);
 	double dvector[workload];
 	k = 0;
 	for(i=sitemin; i<sitemax; ++i) {
@@ -199,10 +199,7 @@ void ExpoConjugateGTRPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 			dvector[k] = siteprofilesuffstatbeta[i][j]; k++;
 		}
 	}
-	MPI_Send(dvector,workload,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-
-	MPI_Bcast(allocsiteprofilesuffstatcount,GetNsite()*GetGlobalNstate(),MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(allocsiteprofilesuffstatbeta,GetNsite()*GetGlobalNstate(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Send(dvector,workload,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }
 
 void ExpoConjugateGTRPhyloProcess::GlobalUpdateRRSuffStat()	{
@@ -222,7 +219,7 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateRRSuffStat()	{
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_RRATE;
 
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	for(i=0; i<workload; ++i) {
 		rrsuffstatcount[i] = 0;
@@ -232,23 +229,23 @@ void ExpoConjugateGTRPhyloProcess::GlobalUpdateRRSuffStat()	{
 	int ivector[workload];
 	double dvector[workload];
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(ivector,workload,MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
-		// MPI_Recv(ivector,workload,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(ivector,workload,MPI_INT,i,TAG1,PROCESS_COMM,&stat);
+		// MPI_Recv(ivector,workload,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		for(j=0; j<workload; ++j) {
 			rrsuffstatcount[j] += ivector[j];
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(PROCESS_COMM);
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(dvector,workload,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
-		// MPI_Recv(dvector,workload,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(dvector,workload,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
+		// MPI_Recv(dvector,workload,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		for(j=0; j<workload; ++j) {
 			rrsuffstatbeta[j] += dvector[j];
 		}
 	}
 
-	MPI_Bcast(rrsuffstatcount,Nrr,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(rrsuffstatbeta,Nrr,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(rrsuffstatcount,Nrr,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(rrsuffstatbeta,Nrr,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void ExpoConjugateGTRPhyloProcess::SlaveUpdateRRSuffStat()	{
@@ -256,12 +253,12 @@ void ExpoConjugateGTRPhyloProcess::SlaveUpdateRRSuffStat()	{
 	UpdateRRSuffStat();
 	int workload = Nrr;
 
-	MPI_Send(rrsuffstatcount,workload,MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Send(rrsuffstatbeta,workload,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(rrsuffstatcount,workload,MPI_INT,0,TAG1,PROCESS_COMM);
+	MPI_Barrier(PROCESS_COMM);
+	MPI_Send(rrsuffstatbeta,workload,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 
-	MPI_Bcast(rrsuffstatcount,Nrr,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(rrsuffstatbeta,Nrr,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(rrsuffstatcount,Nrr,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(rrsuffstatbeta,Nrr,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 int ExpoConjugateGTRPhyloProcess::GlobalCountMapping()	{
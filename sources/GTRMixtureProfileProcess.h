@@ -61,7 +61,7 @@ class GTRMixtureProfileProcess : public virtual GTRProfileProcess, public virtua
 	virtual void UpdateMatrix(int k);
 
 	GTRSubMatrix* GetGTRMatrix(int k)	{
-		GTRSubMatrix* tmp = dynamic_cast<GTRSubMatrix*>(matrixarray[k]);
+		GTRSubMatrix* tmp = dynamic_cast<GTRSubMatrix*>(GetComponentMatrix(k));
 		if (!tmp)	{
 			cerr << "error in GetGTRMatrix: null matrix \n";
 			exit(1);
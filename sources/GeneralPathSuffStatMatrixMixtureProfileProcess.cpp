@@ -16,6 +16,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 
 #include "GeneralPathSuffStatMatrixMixtureProfileProcess.h"
 #include "Random.h"
+#include "Parallel.h"
 
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
@@ -24,75 +25,142 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 //-------------------------------------------------------------------------
 
 void GeneralPathSuffStatMatrixMixtureProfileProcess::Create(int innsite, int indim)	{
-	if (! profilepaircount)	{
+	if (! profilepathsuffstat)	{
 		MatrixMixtureProfileProcess::Create(innsite,indim);
-		profilepaircount = new map< pair<int,int>, int>[GetNmodeMax()];
-		profilewaitingtime = new map<int,double>[GetNmodeMax()];
-		profilerootcount = new map<int,int>[GetNmodeMax()];
+		profilepathsuffstat = new PathSuffStat[GetNmodeMax()];
 	}
 }
 
 void GeneralPathSuffStatMatrixMixtureProfileProcess::Delete() {
-	if (profilepaircount)	{
-		delete[] profilepaircount;
-		delete[] profilerootcount;
-		delete[] profilewaitingtime;
-		profilepaircount = 0;
-		profilerootcount = 0;
-		profilewaitingtime = 0;
+	if (profilepathsuffstat)	{
+		delete[] profilepathsuffstat;
+		profilepathsuffstat = 0;
 		MatrixMixtureProfileProcess::Delete();
 	}
 }
 
 void GeneralPathSuffStatMatrixMixtureProfileProcess::UpdateModeProfileSuffStat()	{
-	for (int i=0; i<GetNcomponent(); i++)	{
-		profilepaircount[i].clear();
-		profilerootcount[i].clear();
-		profilewaitingtime[i].clear();
-	}
-	for (int i=0; i<GetNsite(); i++)	{
-		
-		map<pair<int,int>, int>& paircount = GetSitePairCount(i);
-		map<int,double>& waitingtime = GetSiteWaitingTime(i);
-		int rootstate = GetSiteRootState(i);
-		/*
-		if (rootstate < 0)	{
-			cerr << "error : negative root state \n";
-			cerr << rootstate << '\n';
-			exit(1);
-		}
-		*/
-		int cat = alloc[i];
-		if (rootstate != -1)	{
-			profilerootcount[cat][rootstate]++;
-			for (map<int,double>::iterator i = waitingtime.begin(); i!= waitingtime.end(); i++)	{
-				profilewaitingtime[cat][i->first] += i->second;
-			}
-			for (map<pair<int,int>, int>::iterator i = paircount.begin(); i!= paircount.end(); i++)	{
-				profilepaircount[cat][i->first] += i->second;
+
+	PoolModeProfileSuffStat(0,GetNsite());
+	modesuffstatstamp++;
+}
+
+void GeneralPathSuffStatMatrixMixtureProfileProcess::PoolModeProfileSuffStat(int sitemin, int sitemax)	{
+
+	int nstate = GetSitePathSuffStat(sitemin).GetNstate();
+	for (int k=0; k<GetNcomponent(); k++)	{
+		profilepathsuffstat[k].Clear(nstate);
+	}
+
+	// sites grouped by component, in increasing order
+	// (so that waiting times are summed in the same order as site by site)
+	vector<int> start(GetNcomponent()+1,0);
+	for (int i=sitemin; i<sitemax; i++)	{
+		start[alloc[i]+1]++;
+	}
+	for (int k=0; k<GetNcomponent(); k++)	{
+		start[k+1] += start[k];
+	}
+	vector<int> next(start.begin(),start.end()-1);
+	vector<int> sites(sitemax-sitemin);
+	for (int i=sitemin; i<sitemax; i++)	{
+		sites[next[alloc[i]]++] = i;
+	}
+
+	// pair counts of all sites of a component are merged through a dense nstate*nstate buffer
+	if ((int) pairbuffer.size() != nstate*nstate)	{
+		pairbuffer.assign(nstate*nstate,0);
+	}
+	for (int k=0; k<GetNcomponent(); k++)	{
+		PathSuffStat& stat = profilepathsuffstat[k];
+		for (int m=start[k]; m<start[k+1]; m++)	{
+			const PathSuffStat& sitestat = GetSitePathSuffStat(sites[m]);
+			if (! sitestat.IsEmpty())	{
+				stat.AddRootAndTime(sitestat);
+				stat.AddPairs(sitestat,pairbuffer.data(),pairtouched);
 			}
 		}
+		stat.FlushPairs(pairbuffer.data(),pairtouched);
 	}
 }
 
-double GeneralPathSuffStatMatrixMixtureProfileProcess::ProfileSuffStatLogProb(int cat)	{
-	double total = 0;
-	SubMatrix* mat = matrixarray[cat];
-	if (! mat)	{
-		cerr << "error : null matrix\n";
-		cerr << cat << '\t' << Ncomponent << '\n';
-		cerr << occupancy[cat] << '\n';
+// each slave pools its own sites, and sends the packed componentwise stats to all processes,
+// which then merge them component by component, in the order of the slaves
+void GeneralPathSuffStatMatrixMixtureProfileProcess::ReduceModeProfileSuffStat()	{
+
+	vector<int> iv;
+	vector<double> dv;
+	if (GetMyid())	{
+		PoolModeProfileSuffStat(GetSiteMin(),GetSiteMax());
+		for (int k=0; k<GetNcomponent(); k++)	{
+			profilepathsuffstat[k].Pack(iv,dv);
+		}
+	}
+
+	int nprocs = GetNprocs();
+	int size[2];
+	size[0] = iv.size();
+	size[1] = dv.size();
+	vector<int> allsize(2*nprocs);
+	MPI_Allgather(size,2,MPI_INT,allsize.data(),2,MPI_INT,PROCESS_COMM);
+
+	vector<int> icount(nprocs);
+	vector<int> ioffset(nprocs);
+	vector<int> dcount(nprocs);
+	vector<int> doffset(nprocs);
+	int itotal = 0;
+	int dtotal = 0;
+	for (int i=0; i<nprocs; i++)	{
+		icount[i] = allsize[2*i];
+		ioffset[i] = itotal;
+		itotal += icount[i];
+		dcount[i] = allsize[2*i+1];
+		doffset[i] = dtotal;
+		dtotal += dcount[i];
+	}
+	vector<int> alliv(itotal);
+	vector<double> alldv(dtotal);
+	MPI_Allgatherv(iv.data(),size[0],MPI_INT,alliv.data(),icount.data(),ioffset.data(),MPI_INT,PROCESS_COMM);
+	MPI_Allgatherv(dv.data(),size[1],MPI_DOUBLE,alldv.data(),dcount.data(),doffset.data(),MPI_DOUBLE,PROCESS_COMM);
+
+	// partial stats: component k of slave i in part[(i-1)*Ncomponent + k]
+	vector<PathSuffStat> part((nprocs-1)*GetNcomponent());
+	int ii = 0;
+	int di = 0;
+	for (int i=1; i<nprocs; i++)	{
+		for (int k=0; k<GetNcomponent(); k++)	{
+			part[(i-1)*GetNcomponent() + k].Unpack(alliv.data(),ii,alldv.data(),di);
+		}
+	}
+	if ((ii != itotal) || (di != dtotal))	{
+		cerr << "error in ReduceModeProfileSuffStat: count error for component suff stats\n";
 		exit(1);
 	}
-	const double* stat = matrixarray[cat]->GetStationary();
-	for (map<int,int>::iterator i = profilerootcount[cat].begin(); i!= profilerootcount[cat].end(); i++)	{
-		total += i->second * log(stat[i->first]);
+
+	int nstate = part[0].GetNstate();
+	if ((int) pairbuffer.size() != nstate*nstate)	{
+		pairbuffer.assign(nstate*nstate,0);
 	}
-	for (map<int,double>::iterator i = profilewaitingtime[cat].begin(); i!= profilewaitingtime[cat].end(); i++)	{
-		total += i->second * (*mat)(i->first,i->first);
+	for (int k=0; k<GetNcomponent(); k++)	{
+		PathSuffStat& stat = profilepathsuffstat[k];
+		stat.Clear(nstate);
+		for (int i=1; i<nprocs; i++)	{
+			const PathSuffStat& partstat = part[(i-1)*GetNcomponent() + k];
+			if (! partstat.IsEmpty())	{
+				stat.AddRootAndTime(partstat);
+				stat.AddPairs(partstat,pairbuffer.data(),pairtouched);
+			}
+		}
+		stat.FlushPairs(pairbuffer.data(),pairtouched);
 	}
-	for (map<pair<int,int>, int>::iterator i = profilepaircount[cat].begin(); i!= profilepaircount[cat].end(); i++)	{
-		total += i->second * log((*mat)(i->first.first, i->first.second));
+	modesuffstatstamp++;
+}
+
+double GeneralPathSuffStatMatrixMixtureProfileProcess::ProfileSuffStatLogProb(int cat)	{
+	double total = 0;
+	// empty components: no need for their matrix
+	if (! profilepathsuffstat[cat].IsEmpty())	{
+		total = profilepathsuffstat[cat].LogProb(GetComponentMatrix(cat));
 	}
 	profilesuffstatlogprob[cat] = total;
 	return total;
@@ -101,83 +169,208 @@ double GeneralPathSuffStatMatrixMixtureProfileProcess::ProfileSuffStatLogProb(in
 void GeneralPathSuffStatMatrixMixtureProfileProcess::SwapComponents(int cat1, int cat2)	{
 
 	MatrixMixtureProfileProcess::SwapComponents(cat1,cat2);
+	swap(profilepathsuffstat[cat1],profilepathsuffstat[cat2]);
+	modesuffstatstamp++;
+}
+
 
-	// booh! inefficient copies!
-	//cerr << "swap in general path suff stat matrix mixture profile process\n";
-	//exit(1);
+double GeneralPathSuffStatMatrixMixtureProfileProcess::LogStatProb(int site, int cat)	{
+	return GetSitePathSuffStat(site).LogProb(GetComponentMatrix(cat));
+}
 
-	map<int,int> roottmp = profilerootcount[cat1];
-	profilerootcount[cat1] = profilerootcount[cat2];
-	profilerootcount[cat2] = roottmp;
 
-	map<int,double> timetmp = profilewaitingtime[cat1];
-	profilewaitingtime[cat1] = profilewaitingtime[cat2];
-	profilewaitingtime[cat2] = timetmp;
+void GeneralPathSuffStatMatrixMixtureProfileProcess::AddSite(int site, int cat)	{
+	alloc[site] = cat;
+	occupancy[cat] ++;
+}
 
-	map<pair<int,int>,int> pairtmp = profilepaircount[cat1];
-	profilepaircount[cat1] = profilepaircount[cat2];
-	profilepaircount[cat2] = pairtmp;
+void GeneralPathSuffStatMatrixMixtureProfileProcess::RemoveSite(int site, int cat)	{
+	occupancy[cat] --;
 }
 
+//-------------------------------------------------------------------------
+//	* moves on the parameters shared by all matrices
+//-------------------------------------------------------------------------
+
+// with slaves, the master broadcasts a command (current, proposed or restore),
+// the values of the shared parameters,
+// and, with the first command following a change of the componentwise suff stats, a copy of these stats.
+// each slave computes the log probs of its share of the non-empty components, and sends them back,
+// the master then sums them over components in the same order as ProfileSuffStatLogProb()
 
-double GeneralPathSuffStatMatrixMixtureProfileProcess::LogStatProb(int site, int cat)	{
-	double total = 0;
-	SubMatrix* mat = matrixarray[cat];
-	const double* stat = matrixarray[cat]->GetStationary();
-	if (GetSiteRootState(site) != -1)	{
-		total += log(stat[GetSiteRootState(site)]);
-
-		map<int,double>& waitingtime = GetSiteWaitingTime(site);
-		for (map<int,double>::iterator i = waitingtime.begin(); i!= waitingtime.end(); i++)	{
-			total += i->second * (*mat)(i->first,i->first);
-		}
+void GeneralPathSuffStatMatrixMixtureProfileProcess::GetSharedComponents(int proc, int nproc, vector<int>& comp)	{
 
-		map<pair<int,int>, int>& paircount = GetSitePairCount(site);
-		for (map<pair<int,int>, int>::iterator i = paircount.begin(); i!= paircount.end(); i++)	{
-			total += i->second * log((*mat)(i->first.first, i->first.second));
+	comp.clear();
+	int n = 0;
+	for (int k=0; k<GetNcomponent(); k++)	{
+		if (! profilepathsuffstat[k].IsEmpty())	{
+			if ((n % nproc) == proc)	{
+				comp.push_back(k);
+			}
+			n++;
 		}
 	}
+}
+
+double GeneralPathSuffStatMatrixMixtureProfileProcess::SharedParameterLogProb()	{
+
+	if (GetNprocs() > 1)	{
+		return GlobalSharedParameterLogProb(SHARED_CURRENT);
+	}
+	double total = ProfileSuffStatLogProb();
+	GetSharedComponents(0,1,sharedcomp);
+	for (unsigned int j=0; j<sharedcomp.size(); j++)	{
+		matrixarray[sharedcomp[j]]->Backup();
+	}
 	return total;
 }
 
+double GeneralPathSuffStatMatrixMixtureProfileProcess::ProposedSharedParameterLogProb()	{
 
-void GeneralPathSuffStatMatrixMixtureProfileProcess::AddSite(int site, int cat)	{
-	alloc[site] = cat;
-	occupancy[cat] ++;
-		
-	/*
-	if (activesuffstat)	{
-		profilerootcount[cat][GetSiteRootState(site)]++;
-
-		map<int,double>& waitingtime = GetSiteWaitingTime(site);
-		for (map<int,double>::iterator i = waitingtime.begin(); i!= waitingtime.end(); i++)	{
-			profilewaitingtime[cat][i->first] += i->second;
+	UpdateMatrices();
+	if (GetNprocs() > 1)	{
+		return GlobalSharedParameterLogProb(SHARED_PROPOSED);
+	}
+	return ProfileSuffStatLogProb();
+}
+
+void GeneralPathSuffStatMatrixMixtureProfileProcess::RestoreSharedParameters()	{
+
+	UpdateMatrices();
+	if (GetNprocs() > 1)	{
+		GlobalSharedParameterLogProb(SHARED_RESTORE);
+		return;
+	}
+	for (unsigned int j=0; j<sharedcomp.size(); j++)	{
+		matrixarray[sharedcomp[j]]->Restore();
+	}
+}
+
+double GeneralPathSuffStatMatrixMixtureProfileProcess::GlobalSharedParameterLogProb(SHAREDCOMMAND command)	{
+
+	if (GetMyid())	{
+		cerr << "error in GlobalSharedParameterLogProb: should be called by master\n";
+		exit(1);
+	}
+
+	MESSAGE signal = SHARED_LOGPROB;
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+
+	int header[3];
+	header[0] = command;
+	header[1] = GetNcomponent();
+	header[2] = (command == SHARED_CURRENT) && (modesuffstatstamp != sentmodesuffstatstamp);
+	MPI_Bcast(header,3,MPI_INT,0,PROCESS_COMM);
+
+	if (header[2])	{
+		vector<int> iv;
+		vector<double> dv;
+		for (int k=0; k<GetNcomponent(); k++)	{
+			profilepathsuffstat[k].Pack(iv,dv);
 		}
+		int size[2];
+		size[0] = iv.size();
+		size[1] = dv.size();
+		MPI_Bcast(size,2,MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(iv.data(),size[0],MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(dv.data(),size[1],MPI_DOUBLE,0,PROCESS_COMM);
+		sentmodesuffstatstamp = modesuffstatstamp;
+	}
+
+	int nparam = GetNsharedParameter();
+	double param[nparam];
+	GetSharedParameters(param);
+	MPI_Bcast(param,nparam,MPI_DOUBLE,0,PROCESS_COMM);
 
-		map<pair<int,int>, int>& paircount = GetSitePairCount(site);
-		for (map<pair<int,int>, int>::iterator i = paircount.begin(); i!= paircount.end(); i++)	{
-			profilepaircount[cat][i->first] += i->second;
+	if (command == SHARED_RESTORE)	{
+		return 0;
+	}
+
+	for (int k=0; k<GetNcomponent(); k++)	{
+		profilesuffstatlogprob[k] = 0;
+	}
+	double tmp[GetNcomponent()+1];
+	vector<int> comp;
+	MPI_Status stat;
+	for (int i=1; i<GetNprocs(); i++)	{
+		GetSharedComponents(i-1,GetNprocs()-1,comp);
+		MPI_Recv(tmp,comp.size(),MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
+		for (unsigned int j=0; j<comp.size(); j++)	{
+			profilesuffstatlogprob[comp[j]] = tmp[j];
 		}
 	}
-	*/
+	double total = 0;
+	for (int k=0; k<GetNcomponent(); k++)	{
+		total += profilesuffstatlogprob[k];
+	}
+	return total;
 }
 
-void GeneralPathSuffStatMatrixMixtureProfileProcess::RemoveSite(int site, int cat)	{
-	occupancy[cat] --;
-		
-	/*
-	if (activesuffstat)	{
-		profilerootcount[cat][GetSiteRootState(site)]--;
-
-		map<int,double>& waitingtime = GetSiteWaitingTime(site);
-		for (map<int,double>::iterator i = waitingtime.begin(); i!= waitingtime.end(); i++)	{
-			profilewaitingtime[cat][i->first] -= i->second;
+void GeneralPathSuffStatMatrixMixtureProfileProcess::SlaveSharedParameterLogProb()	{
+
+	int header[3];
+	MPI_Bcast(header,3,MPI_INT,0,PROCESS_COMM);
+	SHAREDCOMMAND command = (SHAREDCOMMAND) header[0];
+	if (header[1] != GetNcomponent())	{
+		cerr << "error in SlaveSharedParameterLogProb: non matching number of components\n";
+		cerr << header[1] << '\t' << GetNcomponent() << '\n';
+		exit(1);
+	}
+
+	if (header[2])	{
+		int size[2];
+		MPI_Bcast(size,2,MPI_INT,0,PROCESS_COMM);
+		int* iv = new int[size[0]];
+		double* dv = new double[size[1]];
+		MPI_Bcast(iv,size[0],MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(dv,size[1],MPI_DOUBLE,0,PROCESS_COMM);
+		int ii = 0;
+		int di = 0;
+		for (int k=0; k<GetNcomponent(); k++)	{
+			profilepathsuffstat[k].Unpack(iv,ii,dv,di);
 		}
+		if ((ii != size[0]) || (di != size[1]))	{
+			cerr << "error in SlaveSharedParameterLogProb: count error for component suff stats\n";
+			exit(1);
+		}
+		delete[] iv;
+		delete[] dv;
+	}
+
+	int nparam = GetNsharedParameter();
+	double param[nparam];
+	double current[nparam];
+	MPI_Bcast(param,nparam,MPI_DOUBLE,0,PROCESS_COMM);
+	GetSharedParameters(current);
+	bool changed = false;
+	for (int i=0; i<nparam; i++)	{
+		if (param[i] != current[i])	{
+			changed = true;
+		}
+	}
+	if (changed)	{
+		SetSharedParameters(param);
+		UpdateMatrices();
+	}
+
+	if (command == SHARED_RESTORE)	{
+		for (unsigned int j=0; j<sharedcomp.size(); j++)	{
+			matrixarray[sharedcomp[j]]->Restore();
+		}
+		return;
+	}
 
-		map<pair<int,int>, int>& paircount = GetSitePairCount(site);
-		for (map<pair<int,int>, int>::iterator i = paircount.begin(); i!= paircount.end(); i++)	{
-			profilepaircount[cat][i->first] -= i->second;
+	if (command == SHARED_CURRENT)	{
+		GetSharedComponents(GetMyid()-1,GetNprocs()-1,sharedcomp);
+	}
+	double tmp[sharedcomp.size()+1];
+	for (unsigned int j=0; j<sharedcomp.size(); j++)	{
+		tmp[j] = ProfileSuffStatLogProb(sharedcomp[j]);
+	}
+	if (command == SHARED_CURRENT)	{
+		for (unsigned int j=0; j<sharedcomp.size(); j++)	{
+			matrixarray[sharedcomp[j]]->Backup();
 		}
 	}
-	*/
+	MPI_Send(tmp,sharedcomp.size(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }
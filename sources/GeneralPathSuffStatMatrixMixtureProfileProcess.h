@@ -24,7 +24,7 @@ class GeneralPathSuffStatMatrixMixtureProfileProcess : public virtual MatrixMixt
 
 	public:
 
-	GeneralPathSuffStatMatrixMixtureProfileProcess() : profilerootcount(0), profilepaircount(0) , profilewaitingtime(0) {}
+	GeneralPathSuffStatMatrixMixtureProfileProcess() : profilepathsuffstat(0), modesuffstatstamp(0), sentmodesuffstatstamp(0) {}
 	virtual ~GeneralPathSuffStatMatrixMixtureProfileProcess() {}
 
 	protected:
@@ -37,9 +37,8 @@ class GeneralPathSuffStatMatrixMixtureProfileProcess : public virtual MatrixMixt
 		SampleStat(k);
 		// useful?
 		if (activesuffstat)	{
-			profilepaircount[k].clear();
-			profilerootcount[k].clear();
-			profilewaitingtime[k].clear();
+			profilepathsuffstat[k].Clear(profilepathsuffstat[k].GetNstate());
+			modesuffstatstamp++;
 		}
 		CreateMatrix(k);
 		UpdateMatrix(k);
@@ -62,7 +61,11 @@ class GeneralPathSuffStatMatrixMixtureProfileProcess : public virtual MatrixMixt
 
 	// collects site-specific suffstats and pools them componentwise
 	void UpdateModeProfileSuffStat();
+	void ReduceModeProfileSuffStat();
+	// pools the suffstats of sites sitemin <= i < sitemax componentwise
+	void PoolModeProfileSuffStat(int sitemin, int sitemax);
 
+	using MixtureProfileProcess::ProfileSuffStatLogProb;
 	double ProfileSuffStatLogProb(int cat);
 	void SwapComponents(int cat1, int cat2);
 
@@ -71,10 +74,34 @@ class GeneralPathSuffStatMatrixMixtureProfileProcess : public virtual MatrixMixt
 	// implemented in phyloprocess
 	// virtual double logSiteProbPath(int site, SubMatrix* mat) = 0;
 
+	// moves on the parameters shared by all matrices (see GeneralPathSuffStatMatrixProfileProcess)
+	// the log probs of the non-empty components are computed by the slaves,
+	// which keep a backup of their matrices under the current parameters,
+	// so that a rejected proposal restores the matrices instead of recomputing them
+	virtual double SharedParameterLogProb();
+	virtual double ProposedSharedParameterLogProb();
+	virtual void RestoreSharedParameters();
+
+	enum SHAREDCOMMAND {SHARED_CURRENT,SHARED_PROPOSED,SHARED_RESTORE};
+	double GlobalSharedParameterLogProb(SHAREDCOMMAND command);
+	void SlaveSharedParameterLogProb();
+
+	// the non-empty components handled by process proc out of nproc (dealt in turn)
+	void GetSharedComponents(int proc, int nproc, vector<int>& comp);
+
 	// componentwise
-	map<int,int>* profilerootcount;
-	map< pair<int,int>, int>* profilepaircount;
-	map<int,double>* profilewaitingtime;
+	PathSuffStat* profilepathsuffstat;
+
+	// reusable buffers for merging site pair counts into components (see UpdateModeProfileSuffStat)
+	vector<int> pairbuffer;
+	vector<int> pairtouched;
+
+	// changes of the componentwise stats, and state of the copy held by the slaves
+	int modesuffstatstamp;
+	int sentmodesuffstatstamp;
+
+	// components whose matrices were backed up by the last SharedParameterLogProb
+	vector<int> sharedcomp;
 
 };
 
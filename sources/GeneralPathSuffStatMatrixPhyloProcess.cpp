@@ -83,7 +83,7 @@ void GeneralPathSuffStatMatrixPhyloProcess::GlobalUnfold()	{
 	CreateMatrices();
 
 	MESSAGE signal = UNFOLD;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	GlobalUpdateConditionalLikelihoods();
 }
@@ -99,6 +99,7 @@ void GeneralPathSuffStatMatrixPhyloProcess::CreateSuffStat()	{
 	siterootstate = new int[GetNsite()];
 	sitepaircount = new map<pair<int,int>, int>[GetNsite()];
 	sitewaitingtime = new map<int,double>[GetNsite()];
+	sitepathsuffstat = new PathSuffStat[GetNsite()];
 }
 
 void GeneralPathSuffStatMatrixPhyloProcess::DeleteSuffStat()	{
@@ -112,9 +113,11 @@ void GeneralPathSuffStatMatrixPhyloProcess::DeleteSuffStat()	{
 	delete[] siterootstate;
 	delete[] sitepaircount;
 	delete[] sitewaitingtime;
+	delete[] sitepathsuffstat;
 	siterootstate = 0;
 	sitepaircount = 0;
 	sitewaitingtime = 0;
+	sitepathsuffstat = 0;
 	PhyloProcess::DeleteSuffStat();
 }
 
@@ -130,6 +133,14 @@ void GeneralPathSuffStatMatrixPhyloProcess::UpdateSiteProfileSuffStat()	{
 		// AddSiteProfileSuffStat(siterootstate,sitepaircount,sitewaitingtime,submap[j],blarray[j],(j == 0));
 		AddSiteProfileSuffStat(siterootstate,sitepaircount,sitewaitingtime,submap[j],blarray[j],missingmap[j]);
 	}
+	FlattenSiteProfileSuffStat(sitemin,sitemax);
+}
+
+void GeneralPathSuffStatMatrixPhyloProcess::FlattenSiteProfileSuffStat(int min, int max)	{
+
+	for (int i=min; i<max; i++)	{
+		sitepathsuffstat[i].FromMaps(GetGlobalNstate(),siterootstate[i],sitepaircount[i],sitewaitingtime[i]);
+	}
 }
 
 void GeneralPathSuffStatMatrixPhyloProcess::UpdateSiteRateSuffStat()	{
@@ -182,16 +193,12 @@ void GeneralPathSuffStatMatrixPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	int width,inalloc,dnalloc,smin[nprocs-1],smax[nprocs-1],iworkload[nprocs-1],dworkload[nprocs-1];
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_SPROFILE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-
-	// suff stats are contained in 2 arrays
-	// int** siteprofilesuffstatcount
-	// double** siteprofilesuffstatbeta
-	// [site][state]
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
-	// each slave computes its array for sitemin <= site < sitemax
-	// thus, one just needs to gather all arrays into the big master array 0 <= site < Nsite
-	// (gather)
+	// each slave computes its stats for sitemin <= site < sitemax
+	// thus, one just needs to gather all of them on the master, 0 <= site < Nsite
+	// (gather; not broadcast back: slaves only use the stats of their own sites,
+	// component stats: see ReduceModeProfileSuffStat)
 	width = GetNsite()/(nprocs-1);
 	inalloc = 0;
 	dnalloc = 0;
@@ -208,72 +215,56 @@ void GeneralPathSuffStatMatrixPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	int* ivector = new int[inalloc];
 	double* dvector = new double[dnalloc];
 
-	int iload = GetNsite() * (GetGlobalNstate()*GetGlobalNstate() + 1);
-	int dload = GetNsite() * GetGlobalNstate();
-	int* iivector = new int[iload];
-	double* ddvector = new double[dload];
-
-	int im = 0;
 	for(int i=1; i<nprocs; ++i) {
-		MPI_Recv(ivector,iworkload[i-1],MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(ivector,iworkload[i-1],MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 		int m = 0;
 		for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 			siterootstate[j] = ivector[m];
-			iivector[im] = ivector[m];
-			im++;
 			m++;
 			for(int k=0; k<GetGlobalNstate(); ++k) {
 				for(int l=0; l<GetGlobalNstate(); ++l) {
 					if (ivector[m])	{
 						sitepaircount[j][pair<int,int>(k,l)] = ivector[m];
 					}
-					iivector[im] = ivector[m];
 					m++;
-					im++;
 				}
 			}
 		}
+		// checksum
+		if (m != iworkload[i-1])	{
+			cerr << "count error for gen path suff stat counts\n";
+			cerr << m << '\t' << iworkload[i-1] << '\n';
+			exit(1);
+		}
 	}
 
-	int dm = 0;
 	for(int i=1; i<nprocs; ++i) {
-		MPI_Recv(dvector,dworkload[i-1],MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(dvector,dworkload[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 		int m = 0;
 		for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 			for(int k=0; k<GetGlobalNstate(); ++k) {
 				if (dvector[m])	{
 					sitewaitingtime[j][k] = dvector[m];
 				}
-				ddvector[dm] = dvector[m];
 				m++;
-				dm++;
 			}
 		}
+		if (m != dworkload[i-1])	{
+			cerr << "count error for gen path suff stat waiting times\n";
+			cerr << m << '\t' << dworkload[i-1] << '\n';
+			exit(1);
+		}
 	}
 
-	// checksum
-	if (im != iload)	{
-		cerr << "count error for gen path suff stat counts\n";
-		cerr << im << '\t' << iload << '\n';
-		exit(1);
-	}
-	if (dm != dload)	{
-		cerr << "count error for gen path suff stat waiting times\n";
-		cerr << dm << '\t' << dload << '\n';
-		exit(1);
-	}
-
-	MPI_Bcast(iivector,iload,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(ddvector,dload,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	FlattenSiteProfileSuffStat(0,GetNsite());
 
 	delete[] ivector;
 	delete[] dvector;
-	delete[] iivector;
-	delete[] ddvector;
 }
 
 void GeneralPathSuffStatMatrixPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 
+	// computes and flattens the stats of my sites
 	UpdateSiteProfileSuffStat();
 	int iworkload = (sitemax- sitemin)*(GetGlobalNstate()*GetGlobalNstate()+1), dworkload = (sitemax - sitemin)*GetGlobalNstate();
 	int* ivector = new int[iworkload];
@@ -283,7 +274,8 @@ void GeneralPathSuffStatMatrixPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 		m++;
 		for(int k=0; k<GetGlobalNstate(); ++k) {
 			for(int l=0; l<GetGlobalNstate(); ++l) {
-				ivector[m] = sitepaircount[j][pair<int,int>(k,l)];
+				map<pair<int,int>,int>::const_iterator i = sitepaircount[j].find(pair<int,int>(k,l));
+				ivector[m] = (i == sitepaircount[j].end()) ? 0 : i->second;
 				m++;
 			}
 		}
@@ -292,13 +284,14 @@ void GeneralPathSuffStatMatrixPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 		cerr << "count error\n";
 		exit(1);
 	}
-	MPI_Send(ivector,iworkload,MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	// MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Send(ivector,iworkload,MPI_INT,0,TAG1,PROCESS_COMM);
+	// MPI_Barrier(PROCESS_COMM);
 	double* dvector = new double[dworkload];
 	m = 0;
 	for(int j=sitemin; j<sitemax; ++j) {
 		for(int k=0; k<GetGlobalNstate(); ++k) {
-			dvector[m] = sitewaitingtime[j][k];
+			map<int,double>::const_iterator i = sitewaitingtime[j].find(k);
+			dvector[m] = (i == sitewaitingtime[j].end()) ? 0 : i->second;
 			m++;
 		}
 	}
@@ -306,61 +299,10 @@ void GeneralPathSuffStatMatrixPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 		cerr << "count error\n";
 		exit(1);
 	}
-	MPI_Send(dvector,dworkload,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-
-	for (int i=0; i<GetNsite(); i++)	{
-		sitepaircount[i].clear();
-		sitewaitingtime[i].clear();
-	}
-
-	int iload = GetNsite() * (GetGlobalNstate()*GetGlobalNstate() + 1);
-	int dload = GetNsite() * GetGlobalNstate();
-	int* iivector = new int[iload];
-	double* ddvector = new double[dload];
-
-	MPI_Bcast(iivector,iload,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(ddvector,dload,MPI_DOUBLE,0,MPI_COMM_WORLD);
-
-	int im = 0;
-	for(int j=0; j<GetNsite(); j++)	{
-		siterootstate[j] = iivector[im];
-		im++;
-		for(int k=0; k<GetGlobalNstate(); ++k) {
-			for(int l=0; l<GetGlobalNstate(); ++l) {
-				if (iivector[im])	{
-					sitepaircount[j][pair<int,int>(k,l)] = iivector[im];
-				}
-				im++;
-			}
-		}
-	}
-
-	int dm = 0;
-	for(int j=0; j<GetNsite(); j++)	{
-		for(int k=0; k<GetGlobalNstate(); ++k) {
-			if (ddvector[dm])	{
-				sitewaitingtime[j][k] = ddvector[dm];
-			}
-			dm++;
-		}
-	}
-
-	// checksum
-	if (im != iload)	{
-		cerr << "count error for gen path suff stat counts\n";
-		cerr << im << '\t' << iload << '\n';
-		exit(1);
-	}
-	if (dm != dload)	{
-		cerr << "count error for gen path suff stat waiting times\n";
-		cerr << dm << '\t' << dload << '\n';
-		exit(1);
-	}
+	MPI_Send(dvector,dworkload,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 
 	delete[] ivector;
 	delete[] dvector;
-	delete[] iivector;
-	delete[] ddvector;
 }
 
 
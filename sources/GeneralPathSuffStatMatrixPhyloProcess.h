@@ -24,7 +24,7 @@ class GeneralPathSuffStatMatrixPhyloProcess : public virtual MatrixPhyloProcess,
 
 	public:
 
-	GeneralPathSuffStatMatrixPhyloProcess() : siterootstate(0), sitepaircount(0), sitewaitingtime(0) {}
+	GeneralPathSuffStatMatrixPhyloProcess() : siterootstate(0), sitepaircount(0), sitewaitingtime(0), sitepathsuffstat(0) {}
 	virtual ~GeneralPathSuffStatMatrixPhyloProcess() {}
 
 	// this is the log of the site likelihood?
@@ -49,6 +49,10 @@ class GeneralPathSuffStatMatrixPhyloProcess : public virtual MatrixPhyloProcess,
 	map<pair<int,int>,int>& GetSitePairCount(int site) {return sitepaircount[site];}
 	int GetSiteRootState(int site) {return siterootstate[site];}
 	map<int,double>& GetSiteWaitingTime(int site) {return sitewaitingtime[site];}
+	const PathSuffStat& GetSitePathSuffStat(int site) {return sitepathsuffstat[site];}
+
+	// rebuilds the compact stats of sites in [min,max) from the maps
+	void FlattenSiteProfileSuffStat(int min, int max);
 
 	// should also create the matrices
 	void GlobalUnfold();
@@ -71,6 +75,7 @@ class GeneralPathSuffStatMatrixPhyloProcess : public virtual MatrixPhyloProcess,
 	int* siterootstate;
 	map< pair<int,int>, int>* sitepaircount;
 	map<int,double>* sitewaitingtime;
+	PathSuffStat* sitepathsuffstat;
 	
 };
 
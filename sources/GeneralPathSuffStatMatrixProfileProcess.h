@@ -18,6 +18,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #define GENPATHSSMATPROFILE_H
 
 #include "MatrixProfileProcess.h"
+#include "PathSuffStat.h"
 
 // superclass for all matrix implementations using generic sufficient statistics
 // generic sufficient statistics are: total time in each state, number of transitions between each pair of states, number of times in each state at the root
@@ -33,6 +34,32 @@ class GeneralPathSuffStatMatrixProfileProcess : public virtual MatrixProfileProc
 	virtual map<pair<int,int>,int>& GetSitePairCount(int site) = 0;
 	virtual map<int,double>& GetSiteWaitingTime(int site) = 0;
 	virtual int GetSiteRootState(int site) = 0;
+	// same, in compact form
+	virtual const PathSuffStat& GetSitePathSuffStat(int site) = 0;
+
+	protected:
+
+	// moves on parameters shared by all matrices (e.g. nucleotide rates or omega of codon models):
+	// suff stat log prob before the proposal, after the proposal (matrices then updated),
+	// and update of the matrices once the old values of the parameters have been put back upon rejection
+	// serial by default (mixtures spread the components over the slaves)
+	virtual double SharedParameterLogProb()	{
+		return ProfileSuffStatLogProb();
+	}
+
+	virtual double ProposedSharedParameterLogProb()	{
+		UpdateMatrices();
+		return ProfileSuffStatLogProb();
+	}
+
+	virtual void RestoreSharedParameters()	{
+		UpdateMatrices();
+	}
+
+	// the shared parameters, in flat form (for sending them to the slaves)
+	virtual int GetNsharedParameter() {return 0;}
+	virtual void GetSharedParameters(double* array) {}
+	virtual void SetSharedParameters(const double* array) {}
 
 };
 
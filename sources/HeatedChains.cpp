@@ -0,0 +1,192 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "HeatedChains.h"
+#include "Parallel.h"
+#include "Random.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+HeatedChains::HeatedChains(PhyloProcess* inprocess, int innchain, double indheat) : process(inprocess), nchain(innchain), dheat(indheat), rank(innchain), nattempt(innchain-1,0), naccept(innchain-1,0)	{
+
+	MPI_Comm_rank(MASTER_COMM,&chainid);
+	for (int c=0; c<nchain; c++)	{
+		rank[c] = c;
+	}
+	process->SetHeat(GetHeat(rank[chainid]));
+}
+
+bool HeatedChains::Stop(int localstop)	{
+
+	int stop = 0;
+	MPI_Allreduce(&localstop,&stop,1,MPI_INT,MPI_MAX,MASTER_COMM);
+	return stop;
+}
+
+void HeatedChains::Swap()	{
+
+	double logl = process->GetLogLikelihood();
+	vector<double> alllogl(nchain);
+	MPI_Allgather(&logl,1,MPI_DOUBLE,alllogl.data(),1,MPI_DOUBLE,MASTER_COMM);
+
+	// move[0]: lower rank of the pair, move[1]: accepted
+	int move[2];
+	if (! chainid)	{
+		int r = (int) ((nchain - 1) * rnd::GetRandom().Uniform());
+		int a = 0;
+		int b = 0;
+		for (int c=0; c<nchain; c++)	{
+			if (rank[c] == r)	{
+				a = c;
+			}
+			if (rank[c] == r+1)	{
+				b = c;
+			}
+		}
+		double logratio = (GetHeat(r) - GetHeat(r+1)) * (alllogl[b] - alllogl[a]);
+		move[0] = r;
+		move[1] = (log(rnd::GetRandom().Uniform()) < logratio);
+	}
+	MPI_Bcast(move,2,MPI_INT,0,MASTER_COMM);
+
+	int r = move[0];
+	nattempt[r]++;
+	if (move[1])	{
+		naccept[r]++;
+		for (int c=0; c<nchain; c++)	{
+			if (rank[c] == r)	{
+				rank[c] = r+1;
+			}
+			else if (rank[c] == r+1)	{
+				rank[c] = r;
+			}
+		}
+		process->SetHeat(GetHeat(rank[chainid]));
+	}
+}
+
+void HeatedChains::Forward(vector<string>& items)	{
+
+	int cold = 0;
+	while (rank[cold])	{
+		cold++;
+	}
+	if (! cold)	{
+		return;
+	}
+
+	int n = items.size();
+	vector<int> lengths(n);
+	if (chainid == cold)	{
+		string buf;
+		for (int k=0; k<n; k++)	{
+			lengths[k] = items[k].size();
+			buf += items[k];
+		}
+		MPI_Send(lengths.data(),n,MPI_INT,0,TAG1,MASTER_COMM);
+		MPI_Send(&buf[0],buf.size(),MPI_CHAR,0,TAG1,MASTER_COMM);
+	}
+	else if (! chainid)	{
+		MPI_Status stat;
+		MPI_Recv(lengths.data(),n,MPI_INT,cold,TAG1,MASTER_COMM,&stat);
+		int total = 0;
+		for (int k=0; k<n; k++)	{
+			total += lengths[k];
+		}
+		string buf(total,' ');
+		MPI_Recv(&buf[0],total,MPI_CHAR,cold,TAG1,MASTER_COMM,&stat);
+		int offset = 0;
+		for (int k=0; k<n; k++)	{
+			items[k] = buf.substr(offset,lengths[k]);
+			offset += lengths[k];
+		}
+	}
+}
+
+void HeatedChains::Monitor(ostream& os)	{
+
+	os << '\n';
+	os << "heated chains (mc3): " << nchain << '\n';
+	os << "rank\theat\tgroup\n";
+	for (int r=0; r<nchain; r++)	{
+		int c = 0;
+		while (rank[c] != r)	{
+			c++;
+		}
+		os << r << '\t' << GetHeat(r) << '\t' << c+1 << '\n';
+	}
+	os << "swap acceptance rates\n";
+	for (int r=0; r<nchain-1; r++)	{
+		os << r << " <-> " << r+1 << '\t';
+		if (nattempt[r])	{
+			os << ((double) naccept[r]) / nattempt[r];
+		}
+		else	{
+			os << '-';
+		}
+		os << '\t' << '(' << naccept[r] << " / " << nattempt[r] << ")\n";
+	}
+}
+
+
+void HeatedChains::ToStream(ostream& os)	{
+
+	os << nchain << '\t' << dheat << '\n';
+	for (int c=0; c<nchain; c++)	{
+		os << rank[c] << '\t';
+	}
+	os << '\n';
+	for (int r=0; r<nchain-1; r++)	{
+		os << nattempt[r] << '\t' << naccept[r] << '\n';
+	}
+}
+
+void HeatedChains::FromFile(string name)	{
+
+	ifstream is((name + ".mc3").c_str());
+	if (! is)	{
+		cerr << "error: cannot open " << name << ".mc3\n";
+		exit(1);
+	}
+	int n;
+	double d;
+	is >> n >> d;
+	if ((n != nchain) || (fabs(d - dheat) > 1e-5 * dheat))	{
+		if (! chainid)	{
+			cerr << "error: " << name << " was run with -mc3 " << n << ' ' << d << '\n';
+		}
+		exit(1);
+	}
+	for (int c=0; c<nchain; c++)	{
+		is >> rank[c];
+	}
+	for (int r=0; r<nchain-1; r++)	{
+		is >> nattempt[r] >> naccept[r];
+	}
+	if (! is)	{
+		cerr << "error when reading " << name << ".mc3\n";
+		exit(1);
+	}
+	process->SetHeat(GetHeat(rank[chainid]));
+}
+
+string HeatedChains::GetStateName(string name, int chain)	{
+
+	ostringstream s;
+	s << name << ".mc3_" << chain + 1;
+	return s.str();
+}
@@ -0,0 +1,106 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef HEATEDCHAINS_H
+#define HEATEDCHAINS_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "PhyloProcess.h"
+
+using namespace std;
+
+// Metropolis-coupled MCMC (pb_mpi -mc3)
+//
+// each group of processes runs its own copy of the model, at inverse temperature
+// heat = 1 / (1 + dheat * r), r = 0 .. nchain-1 being the rank of the chain in the temperature ladder
+// the chain of rank 0 is the cold chain, the only one that is sampled.
+// after each point, the masters of all chains (MASTER_COMM) propose to exchange
+// the temperatures of two chains adjacent in the ladder (rather than their states, which would be much larger),
+// so that the cold chain moves from one group to the other;
+// its output is then sent over to the first master, which writes the files of the run.
+//
+// for the swaps to be valid, each chain should leave prior * likelihood^heat invariant:
+// heated chains therefore only run the moves based on the pruning likelihood (PhyloProcess::HeatedMove),
+// the other parameters being updated only when the chain is cold;
+// during the burn-in (-b), all chains run the complete moves, and no swap is proposed
+//
+// the state of each chain is saved in <name>.mc3_<chain>.param, and the temperature ladder in <name>.mc3;
+// restarting with -mc3 (same arguments) resumes all chains,
+// restarting without it resumes the cold chain alone (from <name>.param)
+
+class HeatedChains	{
+
+	public:
+
+	HeatedChains(PhyloProcess* inprocess, int innchain, double indheat);
+
+	// collective over MASTER_COMM, called after each point:
+	// localstop: whether this chain should stop on its own
+	// returns true if all chains should stop
+	bool Stop(int localstop);
+
+	// collective over MASTER_COMM
+	void Swap();
+
+	// whether this chain is currently the cold one
+	bool IsCold()	{
+		return rank[chainid] == 0;
+	}
+
+	// whether this master writes the output files
+	bool IsWriter()	{
+		return chainid == 0;
+	}
+
+	// collective over MASTER_COMM
+	// the output of the cold chain (items) is sent to the writer
+	void Forward(vector<string>& items);
+
+	// temperatures and swap acceptance rates
+	void Monitor(ostream& os);
+
+	// temperature ladder and swap counts (<name>.mc3)
+	void ToStream(ostream& os);
+	// restart: reads <name>.mc3 and sets the heat of this chain accordingly
+	void FromFile(string name);
+
+	// file in which the state of a chain is saved (without the .param extension)
+	static string GetStateName(string name, int chain);
+	string GetStateName(string name)	{
+		return GetStateName(name,chainid);
+	}
+
+	private:
+
+	double GetHeat(int r)	{
+		return 1.0 / (1.0 + dheat * r);
+	}
+
+	PhyloProcess* process;
+	int nchain;
+	double dheat;
+	int chainid;
+
+	// rank in the temperature ladder, for each chain
+	vector<int> rank;
+	// swaps between ranks r and r+1
+	vector<int> nattempt;
+	vector<int> naccept;
+};
+
+#endif
+
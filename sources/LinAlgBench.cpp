@@ -0,0 +1,160 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "linalg.h"
+#include "Random.h"
+#include "Chrono.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+// micro-benchmark of the diagonalization of reversible rate matrices
+// (random exchangeabilities and stationary probabilities)
+// compares the built-in solver with lapack (when compiled with -DUSE_LAPACK)
+// reports the time per diagonalization and the max error of the reconstruction of the symmetrized matrix
+//
+// usage : linalgbench [dim] [nrep]
+
+double** NewMatrix(int dim)	{
+	double** m = new double*[dim];
+	for (int i=0; i<dim; i++)	{
+		m[i] = new double[dim];
+	}
+	return m;
+}
+
+void DeleteMatrix(double** m, int dim)	{
+	for (int i=0; i<dim; i++)	{
+		delete[] m[i];
+	}
+	delete[] m;
+}
+
+void DrawSymmetricRateMatrix(double** a, int dim)	{
+
+	double* pi = new double[dim];
+	double tot = 0;
+	for (int i=0; i<dim; i++)	{
+		pi[i] = rnd::GetRandom().sExpo();
+		tot += pi[i];
+	}
+	for (int i=0; i<dim; i++)	{
+		pi[i] /= tot;
+	}
+	for (int i=0; i<dim; i++)	{
+		a[i][i] = 0;
+	}
+	for (int i=0; i<dim; i++)	{
+		for (int j=i+1; j<dim; j++)	{
+			double rr = rnd::GetRandom().sExpo();
+			a[i][j] = rr * sqrt(pi[i] * pi[j]);
+			a[j][i] = a[i][j];
+			a[i][i] -= rr * pi[j];
+			a[j][j] -= rr * pi[i];
+		}
+	}
+	delete[] pi;
+}
+
+double ReconstructionError(double** a, int dim, double* eigenval, double** eigenvect)	{
+
+	double max = 0;
+	for (int i=0; i<dim; i++)	{
+		for (int j=0; j<dim; j++)	{
+			double tot = 0;
+			for (int k=0; k<dim; k++)	{
+				tot += eigenvect[i][k] * eigenval[k] * eigenvect[j][k];
+			}
+			double err = fabs(tot - a[i][j]);
+			if (max < err)	{
+				max = err;
+			}
+		}
+	}
+	return max;
+}
+
+int main(int argc, char* argv[])	{
+
+	int dim = (argc > 1) ? atoi(argv[1]) : 61;
+	int nrep = (argc > 2) ? atoi(argv[2]) : 100;
+
+	double*** a = new double**[nrep];
+	for (int rep=0; rep<nrep; rep++)	{
+		a[rep] = NewMatrix(dim);
+		DrawSymmetricRateMatrix(a[rep],dim);
+	}
+	double** eigenvect = NewMatrix(dim);
+	double** work = NewMatrix(LinAlg::DiagWorkSize(dim));
+	double* eigenval = new double[dim];
+
+	cout << "dim " << dim << " nrep " << nrep << '\n';
+	cout << "solver\tms/call\tmax err\tfailed\n";
+
+	// built-in solver
+	int nmax = 1000;
+	Chrono chrono;
+	chrono.Start();
+	for (int rep=0; rep<nrep; rep++)	{
+		LinAlg::QRDiagonalizeSymmetricMatrix(a[rep],dim,nmax,1e-20,eigenval,eigenvect,work);
+	}
+	chrono.Stop();
+	double maxerr = 0;
+	int nfailed = 0;
+	for (int rep=0; rep<nrep; rep++)	{
+		if (LinAlg::QRDiagonalizeSymmetricMatrix(a[rep],dim,nmax,1e-20,eigenval,eigenvect,work) == nmax)	{
+			nfailed++;
+		}
+		double err = ReconstructionError(a[rep],dim,eigenval,eigenvect);
+		if (maxerr < err)	{
+			maxerr = err;
+		}
+	}
+	cout << "qr\t" << chrono.GetTime() / nrep << '\t' << maxerr << '\t' << nfailed << '\n';
+
+#ifdef USE_LAPACK
+	chrono.Reset();
+	chrono.Start();
+	for (int rep=0; rep<nrep; rep++)	{
+		LinAlg::LapackDiagonalizeSymmetricMatrix(a[rep],dim,eigenval,eigenvect);
+	}
+	chrono.Stop();
+	maxerr = 0;
+	nfailed = 0;
+	for (int rep=0; rep<nrep; rep++)	{
+		if (LinAlg::LapackDiagonalizeSymmetricMatrix(a[rep],dim,eigenval,eigenvect))	{
+			nfailed++;
+		}
+		double err = ReconstructionError(a[rep],dim,eigenval,eigenvect);
+		if (maxerr < err)	{
+			maxerr = err;
+		}
+	}
+	cout << "lapack\t" << chrono.GetTime() / nrep << '\t' << maxerr << '\t' << nfailed << '\n';
+#else
+	cout << "lapack\tnot compiled (see USE_LAPACK in Makefile)\n";
+#endif
+
+	delete[] eigenval;
+	DeleteMatrix(work,LinAlg::DiagWorkSize(dim));
+	DeleteMatrix(eigenvect,dim);
+	for (int rep=0; rep<nrep; rep++)	{
+		DeleteMatrix(a[rep],dim);
+	}
+	delete[] a;
+}
+
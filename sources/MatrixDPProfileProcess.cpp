@@ -129,6 +129,7 @@ void MatrixDPProfileProcess::SlaveMixMove()	{
 	int index = 0;
 	for (int site=GetSiteMin(); site<GetSiteMax(); site++)	{
 	
+		rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 		for (int i=Ncomponent; i<h; i++)	{
 			CreateComponent(i);
 			double totstat = 0;
@@ -160,6 +161,7 @@ void MatrixDPProfileProcess::SlaveMixMove()	{
 		for (int i=Ncomponent; i<h; i++)	{
 			DeleteComponent(i);
 		}
+		rnd::GetRandom().CloseStream();
 	}
 
 	if (index != size)	{
@@ -167,9 +169,9 @@ void MatrixDPProfileProcess::SlaveMixMove()	{
 		exit(1);
 	}
 
-	MPI_Send(alloc,size,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(alloc,size,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(PROCESS_COMM);
 
 	delete[] logsamp;
 	delete[] alloc;
@@ -229,7 +231,7 @@ double MatrixDPProfileProcess::GlobalMixMove(int Nrep, int Nprofile)	{
 		// send PROFILE_MOVE Message with n and nrep and tuning
 		
 		MESSAGE signal = MIX_MOVE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 		// mpi send message
 		// mpi send Nmode
@@ -250,7 +252,7 @@ double MatrixDPProfileProcess::GlobalMixMove(int Nrep, int Nprofile)	{
 		for(int i=1; i<GetNprocs(); ++i) {
 			
 			int size = (smax[i-1] - smin[i-1]) * (h + 1 + Nadd*Ninc*GetDim());
-			MPI_Recv(tmpalloc,size,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&status);
+			MPI_Recv(tmpalloc,size,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&status);
 
 			int index = 0;
 			for (int site=smin[i-1]; site<smax[i-1]; site++)	{
@@ -276,7 +278,7 @@ double MatrixDPProfileProcess::GlobalMixMove(int Nrep, int Nprofile)	{
 				exit(1);
 			}
 		}
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(PROCESS_COMM);
 
 		delete[] tmpalloc;
 
@@ -17,6 +17,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "MatrixFiniteProfileProcess.h"
 #include "Random.h"
 #include <cassert>
+#include <algorithm>
 #include "Parallel.h"
 
 
@@ -26,8 +27,8 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 
 	// send command and arguments
 	MESSAGE signal = REALLOC_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
 	// split Nsite among GetNprocs()-1 slaves
 	int width = GetNsite()/(GetNprocs()-1);
@@ -46,13 +47,13 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 		// and send them to slaves
 		UpdateOccupancyNumbers();
 		ResampleWeights();
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// receive new site allocations from slave
 		MPI_Status stat;
 		int tmpalloc[GetNsite()];
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 			for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 				alloc[j] = tmpalloc[j];
 				if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -65,7 +66,8 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 	
 	// final cleanup
 	UpdateOccupancyNumbers();
-	UpdateModeProfileSuffStat();
+	// slaves pool the sites they have just reallocated
+	ReduceModeProfileSuffStat();
 
 	// CHECK that: might be useful depending on the exact submodel
 	// ResampleWeights();
@@ -78,17 +80,20 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 
 	// parse argument sent by master
 	int nrep;
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
 	int NAccepted = 0;
 
 	double* bigarray = new double[Ncomponent * GetNsite()];
 	double* bigcumul = new double[Ncomponent * GetNsite()];
 
+	// profiles do not change during the move
+	UpdateLogStatProbs(Ncomponent);
+
 	for (int rep=0; rep<nrep; rep++)	{
 
 		// receive weights sent by master
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// do the incremental reallocation move on my site range
 		for (int site=GetSiteMin(); site<GetSiteMax(); site++)	{
@@ -97,10 +102,11 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 			double* cumul = bigcumul + site * Ncomponent;
 
 			int bk = alloc[site];
+			rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 
+			LogStatProbs(site,Ncomponent,mLogSamplingArray);
 			double max = 0;
 			for (int mode = 0; mode < Ncomponent; mode++)	{
-				mLogSamplingArray[mode] =  LogStatProb(site,mode);
 				if ((!mode) || (max < mLogSamplingArray[mode]))	{
 					max = mLogSamplingArray[mode];
 				}
@@ -115,13 +121,13 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 			}
 
 			double q = total * rnd::GetRandom().Uniform();
-			int mode = 0;
-			while ( (mode<Ncomponent) && (q > cumul[mode])) mode++;
+			int mode = lower_bound(cumul,cumul+Ncomponent,q) - cumul;
 			if (mode == Ncomponent)	{
 				cerr << "error in switch mode: gibbs overflow\n";
 				exit(1);
 			}
 
+			rnd::GetRandom().CloseStream();
 			int Accepted = (mode != bk);
 			if (Accepted)	{
 				NAccepted ++;
@@ -130,8 +136,10 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 		}
 
 		// send new allocations to master
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 	}
+
+	ReduceModeProfileSuffStat();
 	
 	delete[] bigarray;
 	delete[] bigcumul;
@@ -145,6 +153,8 @@ double MatrixFiniteProfileProcess::IncrementalFiniteMove(int nrep)	{
 	double* mLogSamplingArray = new double[Ncomponent];
 	double* cumul = new double[Ncomponent];
 
+	UpdateLogStatProbs(Ncomponent);
+
 	for (int rep=0; rep<nrep; rep++)	{
 
 		ResampleWeights();
@@ -154,9 +164,9 @@ double MatrixFiniteProfileProcess::IncrementalFiniteMove(int nrep)	{
 			int bk = alloc[site];
 			RemoveSite(site,bk);
 
+			LogStatProbs(site,Ncomponent,mLogSamplingArray);
 			double max = 0;
 			for (int mode = 0; mode < Ncomponent; mode++)	{
-				mLogSamplingArray[mode] =  LogStatProb(site,mode);
 				if ((!mode) || (max < mLogSamplingArray[mode]))	{
 					max = mLogSamplingArray[mode];
 				}
@@ -171,8 +181,7 @@ double MatrixFiniteProfileProcess::IncrementalFiniteMove(int nrep)	{
 			}
 
 			double q = total * rnd::GetRandom().Uniform();
-			int mode = 0;
-			while ( (mode<Ncomponent) && (q > cumul[mode])) mode++;
+			int mode = lower_bound(cumul,cumul+Ncomponent,q) - cumul;
 			if (mode == Ncomponent)	{
 				cerr << "error in switch mode: gibbs overflow\n";
 				exit(1);
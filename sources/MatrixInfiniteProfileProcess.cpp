@@ -42,9 +42,9 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep, int K0)
 
 	// send command and arguments
 	MESSAGE signal = REALLOC_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&K0,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&K0,1,MPI_INT,0,PROCESS_COMM);
 
 	// split Nsite among GetNprocs()-1 slaves
 	int width = GetNsite()/(GetNprocs()-1);
@@ -66,7 +66,7 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep, int K0)
 		ResampleWeights();
 		// here should have a cumulprod;
 
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// MPI loop here:
 		int nreceived = 0;
@@ -76,15 +76,15 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep, int K0)
 			MPI_Status stat;
 
 			int sender;
-			MPI_Recv(&signal,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
-			MPI_Recv(&sender,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(&signal,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
+			MPI_Recv(&sender,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 
 			if (signal == GIVEMEMORE)	{
 
 				int K;
-				MPI_Recv(&K,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+				MPI_Recv(&K,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 				double r;
-				MPI_Recv(&r,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+				MPI_Recv(&r,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 
 				int mode = K-1;
 				while (r > 0)	{
@@ -102,15 +102,15 @@ double MatrixFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep, int K0)
 				}
 
 				// send
-				MPI_Send(mode,1,MPI_INT,sender,TAG1,MPI_COMM_WORLD);
-				MPI_Send(Ncomponent,1,MPI_INT,sender,TAG1,MPI_COMM_WORLD);
-				MPI_Send(weight,Ncomponent,MPI_DOUBLE,sender,TAG1,MPI_COMM_WORLD);
+				MPI_Send(mode,1,MPI_INT,sender,TAG1,PROCESS_COMM);
+				MPI_Send(Ncomponent,1,MPI_INT,sender,TAG1,PROCESS_COMM);
+				MPI_Send(weight,Ncomponent,MPI_DOUBLE,sender,TAG1,PROCESS_COMM);
 			}
 			// if message is slave has finished
 			// fillup the array where it has finished
 			else if (signal == REALLOC_DONE)	{
 				int tmpalloc[GetNsite()];
-				MPI_Recv(tmpalloc,GetNsite(),MPI_INT,sender,TAG1,MPI_COMM_WORLD,&stat);
+				MPI_Recv(tmpalloc,GetNsite(),MPI_INT,sender,TAG1,PROCESS_COMM,&stat);
 				for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 					alloc[j] = tmpalloc[j];
 					if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -142,9 +142,9 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 
 	// parse argument sent by master
 	int nrep;
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 	int K0;
-	MPI_Bcast(&K0,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&K0,1,MPI_INT,0,PROCESS_COMM);
 
 	int NAccepted = 0;
 
@@ -154,7 +154,7 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 	for (int rep=0; rep<nrep; rep++)	{
 
 		// receive weights sent by master
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		double totp = 0;
 		for (int mode = 0; mode<K0; mode++)	{
@@ -191,11 +191,11 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 				while (r > 0)	{
 					if (mode >= Ncomponent)	{
 						MESSAGE gimmemore = GIVEMEMORE;
-						MPI_Send(gimmemore,1,MPI_INT,0,TAG1,MPI_COMM_WORLD);
+						MPI_Send(gimmemore,1,MPI_INT,0,TAG1,PROCESS_COMM);
 						
-						MPI_Recv(&mode,1,MPI_INT,0,TAG1,MPI_COMM_WORLD,&stat);
-						MPI_Recv(&Ncomponent,1,MPI_INT,0,TAG1,MPI_COMM_WORLD,&stat);
-						MPI_Recv(weight,Ncomponent,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD,&stat);
+						MPI_Recv(&mode,1,MPI_INT,0,TAG1,PROCESS_COMM,&stat);
+						MPI_Recv(&Ncomponent,1,MPI_INT,0,TAG1,PROCESS_COMM,&stat);
+						MPI_Recv(weight,Ncomponent,MPI_DOUBLE,0,TAG1,PROCESS_COMM,&stat);
 						r = 0;
 					}
 					else	{
@@ -214,10 +214,10 @@ double MatrixFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 
 		// send incmovedone message
 		MESSAGE done = REALLOC_DONE;
-		MPI_Send(done,1,MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(done,1,MPI_INT,0,TAG1,PROCESS_COMM);
 
 		// send back new allocations 
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 	}
 	
 	return ((double) NAccepted) / GetNsite() / nrep;
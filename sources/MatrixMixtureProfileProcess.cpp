@@ -76,7 +76,7 @@ double MatrixMixtureProfileProcess::GlobalMoveProfile(double tuning, int n, int
 
 	// send PROFILE_MOVE Message with n and nrep and tuning
 	MESSAGE signal = PROFILE_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int* itmp = new int[3+GetNsite()];
 	itmp[0] = n;
 	itmp[1] = nrep;
@@ -84,7 +84,7 @@ double MatrixMixtureProfileProcess::GlobalMoveProfile(double tuning, int n, int
 	for (int i=0; i<GetNsite(); i++)	{
 		itmp[3+i] = alloc[i];
 	}
-	MPI_Bcast(itmp,3+GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,3+GetNsite(),MPI_INT,0,PROCESS_COMM);
 	delete[] itmp;
 
 	int Nocc = GetNOccupiedComponent();
@@ -100,9 +100,12 @@ double MatrixMixtureProfileProcess::GlobalMoveProfile(double tuning, int n, int
 			}
 		}
 	}
-	MPI_Bcast(dtmp,1+Nocc*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(dtmp,1+Nocc*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	delete[] dtmp;
 
+	// component suff stats, for the slaves (and the master)
+	ReduceModeProfileSuffStat();
+
 	// split Ncomponent items among GetNprocs() - 1 slaves
 	int width = Nocc/(GetNprocs()-1);
 	int maxwidth = 0;
@@ -224,7 +227,7 @@ double MatrixMixtureProfileProcess::GlobalMoveProfile(double tuning, int n, int
 	double* tmp = new double[bigdim+1]; // (+1 for the acceptance rate)
 	double total = 0;
 	for(int i=1; i<GetNprocs(); ++i) {
-		MPI_Recv(tmp,(dmax[i-1]-dmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(tmp,(dmax[i-1]-dmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 		int l = 0;
 		for(int j=cmin[i-1]; j<cmax[i-1]; ++j) {
 			if (occupancy[j])	{
@@ -249,7 +252,7 @@ void MatrixMixtureProfileProcess::SlaveMoveProfile()	{
 	// parse arguments sent by master
 
 	int* itmp = new int[3+GetNsite()];
-	MPI_Bcast(itmp,3+GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,3+GetNsite(),MPI_INT,0,PROCESS_COMM);
 	int n = itmp[0];
 	int nrep = itmp[1];
 	Ncomponent = itmp[2];
@@ -262,7 +265,7 @@ void MatrixMixtureProfileProcess::SlaveMoveProfile()	{
 	int Nocc = GetNOccupiedComponent();
 
 	double* dtmp = new double[1 + Nocc*GetDim()];
-	MPI_Bcast(dtmp,1+Nocc*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(dtmp,1+Nocc*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	double tuning = dtmp[0];
 	int k = 1;
 	for (int i=0; i<Ncomponent; i++)	{
@@ -361,13 +364,15 @@ void MatrixMixtureProfileProcess::SlaveMoveProfile()	{
 	*/
 
 	// update sufficient statistics
-	UpdateModeProfileSuffStat();
+	ReduceModeProfileSuffStat();
 	UpdateOccupancyNumbers();
 	// move components in the range just computed
 	double total = 0;
 	for (int i=cmin; i<cmax; i++)	{
 		if (occupancy[i])	{
+			rnd::GetRandom().OpenStream(i,Random::COMPONENT);
 			total += MoveProfile(i,tuning,n,nrep);
+			rnd::GetRandom().CloseStream();
 		}
 		/*
 		else	{
@@ -389,7 +394,7 @@ void MatrixMixtureProfileProcess::SlaveMoveProfile()	{
 		}
 	}
 	tmp[l] = total;
-	MPI_Send(tmp,(dmax-dmin)*GetDim()+1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(tmp,(dmax-dmin)*GetDim()+1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	delete[] tmp;
 }
 
@@ -28,11 +28,17 @@ class MatrixMixtureProfileProcess : public virtual MatrixProfileProcess, public
 	virtual ~MatrixMixtureProfileProcess() {}
 
 	SubMatrix* GetMatrix(int site)	{
-		if (! matrixarray[alloc[site]]) 	{
-			cerr << "error in get matrix : null matrix , site " << site << " and alloc : " << alloc[site] << '\n';
-			exit(1);
+		return GetComponentMatrix(alloc[site]);
+	}
+
+	// matrix of component k, created upon first use
+	// (most components of a truncated stick-breaking process are empty,
+	// and their matrices are needed only when a site is proposed into them)
+	SubMatrix* GetComponentMatrix(int k)	{
+		if (! matrixarray[k])	{
+			CreateMatrix(k);
 		}
-		return matrixarray[alloc[site]];
+		return matrixarray[k];
 	}
 
 	protected:
@@ -55,16 +61,21 @@ class MatrixMixtureProfileProcess : public virtual MatrixProfileProcess, public
 	virtual void UpdateModeProfileSuffStat() = 0;
 
 	// should be called each time global parameters are modified
+	// matrices not yet created are left as they are (they will be up to date when created)
 	virtual void UpdateMatrices()	{
 		for (int k=0; k<GetNcomponent(); k++)	{
-			UpdateMatrix(k);
+			if (matrixarray[k])	{
+				UpdateMatrix(k);
+			}
 		}
 	}
 
+	// creates the matrices of the components that currently have sites
+	// (the others are created upon first use, see GetComponentMatrix)
 	virtual void CreateMatrices()	{
-		for (int k=0; k<GetNcomponent(); k++)	{
-			if (! matrixarray[k])	{
-				CreateMatrix(k);
+		for (int i=0; i<GetNsite(); i++)	{
+			if (! matrixarray[alloc[i]])	{
+				CreateMatrix(alloc[i]);
 			}
 		}
 		for (int k=GetNcomponent(); k<GetNmodeMax(); k++)	{
@@ -87,7 +87,8 @@ void MatrixPhyloProcess::Collapse()	{
 	InactivateSumOverRateAllocations(ratealloc);
 	FillMissingMap();
 	SampleSubstitutionMappings(GetRoot());
-	DeleteMatrices();
+	// matrices are kept: upon Unfold, only those whose parameters have changed are diagonalized again
+	// DeleteMatrices();
 	CreateSuffStat();
 }
 
@@ -17,6 +17,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "MatrixSBDPProfileProcess.h"
 #include "Random.h"
 #include <cassert>
+#include <algorithm>
 #include "Parallel.h"
 
 void MatrixSBDPProfileProcess::SwapComponents(int cat1, int cat2)	{
@@ -50,13 +51,13 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 
 	// send mixmove signal and tuning parameters
 	MESSAGE signal = MIX_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int itmp[4];
 	itmp[0] = nrep;
 	itmp[1] = nallocrep;
 	itmp[2] = K0;
 	itmp[3] = nprofilerep;
-	MPI_Bcast(itmp,4,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,4,MPI_INT,0,PROCESS_COMM);
 
 	// split Nsite among GetNprocs()-1 slaves
 	int width = GetNsite()/(GetNprocs()-1);
@@ -70,7 +71,7 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 
 	/*
 	ResampleEmptyProfiles();
-	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	*/
 
 	double* tmp = new double[Ncomponent * GetDim() + 1];
@@ -81,8 +82,8 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 
 		// mpi send message for realloc move
 		// mpi send profiles and weights
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
-		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
+		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 
 		// here slaves do realloc moves
 
@@ -90,7 +91,7 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 		MPI_Status stat;
 		int tmpalloc[GetNsite()+1];
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 			for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 				alloc[j] = tmpalloc[j];
 				if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -100,13 +101,15 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 			}
 		}
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(PROCESS_COMM);
 
 		// broadcast new allocations
-		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,PROCESS_COMM);
 
 		// here slaves do profile moves
 
+		ReduceModeProfileSuffStat();
+
 		// split Ncomponent items among GetNprocs() - 1 slaves
 		UpdateOccupancyNumbers();
 		int Nocc = GetNOccupiedComponent();
@@ -169,7 +172,7 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 		MPI_Status stat2;
 		double total = 0;
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmp,(dmax[i-1]-dmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat2);
+			MPI_Recv(tmp,(dmax[i-1]-dmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat2);
 			int l = 0;
 			for(int j=cmin[i-1]; j<cmax[i-1]; ++j) {
 				if (occupancy[j])	{
@@ -192,9 +195,9 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 		// resample empty profiles
 		ResampleEmptyProfiles();
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(PROCESS_COMM);
 		// resend all profiles
-		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	}
 
 	// check that profiles are normalized
@@ -219,7 +222,7 @@ double MatrixSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double e
 void MatrixSBDPProfileProcess::SlaveMixMove()	{
 
 	int itmp[4];
-	MPI_Bcast(itmp,4,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,4,MPI_INT,0,PROCESS_COMM);
 	int nrep = itmp[0];
 	int nallocrep = itmp[1];
 	int K0 = itmp[2];
@@ -242,8 +245,9 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 
 		// realloc move
 
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
-		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
+		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+		UpdateLogStatProbs(K0);
 
 		double totp = 0;
 		for (int mode = 0; mode<K0; mode++)	{
@@ -262,11 +266,12 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 			for (int site=smin[GetMyid()-1]; site<smax[GetMyid()-1]; site++)	{
 
 				int bk = alloc[site];
+				rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 
+				LogStatProbs(site,K0,mLogSamplingArray);
 				double max = 0;
 				// double mean = 0;
 				for (int mode = 0; mode<K0; mode++)	{
-					mLogSamplingArray[mode] = LogStatProb(site,mode);
 					if ((!mode) || (max < mLogSamplingArray[mode]))	{
 						max = mLogSamplingArray[mode];
 					}
@@ -288,8 +293,7 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 				double M = 1;
 				total += M * totq;
 				double q = total * rnd::GetRandom().Uniform();
-				int mode = 0;
-				while ( (mode<K0) && (q > cumul[mode])) mode++;
+				int mode = lower_bound(cumul,cumul+K0,q) - cumul;
 				if (mode == K0)	{
 					mode--;
 					double r = (q - cumul[mode]) / M;
@@ -312,6 +316,7 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 					mode = bk;
 				}
 
+				rnd::GetRandom().CloseStream();
 				int Accepted = (mode != bk);
 				if (Accepted)	{
 					NAccepted ++;
@@ -319,13 +324,13 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 				alloc[site] = mode;
 			}
 		}
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(PROCESS_COMM);
 		// profile move
 
 		// receive new allocations
-		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,PROCESS_COMM);
 
 		// determine the range of components to move
 		UpdateOccupancyNumbers();
@@ -370,15 +375,17 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 		}
 
 		// update sufficient statistics
-		UpdateModeProfileSuffStat();
+		ReduceModeProfileSuffStat();
 
 		// move components in the range just computed
 		double total = 0;
 		for (int i=cmin; i<cmax; i++)	{
 			if (occupancy[i])	{
+				rnd::GetRandom().OpenStream(i,Random::COMPONENT);
 				total += MoveProfile(i,1,1,nprofilerep);
 				total += MoveProfile(i,1,3,nprofilerep);
 				total += MoveProfile(i,0.1,3,nprofilerep);
+				rnd::GetRandom().CloseStream();
 			}
 		}
 
@@ -402,11 +409,11 @@ void MatrixSBDPProfileProcess::SlaveMixMove()	{
 		}
 		tmp[l] = total;
 		
-		MPI_Send(tmp,(dmax-dmin)*GetDim()+1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Send(tmp,(dmax-dmin)*GetDim()+1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+		MPI_Barrier(PROCESS_COMM);
 
 		// rereceive all profiles
-		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 		UpdateMatrices();
 	}
 
@@ -443,6 +450,7 @@ double MatrixSBDPProfileProcess::MixMove(int nrep, int nallocrep, double epsilon
 
 
 		ResampleWeights();
+		UpdateLogStatProbs(K0);
 
 		// realloc move
 
@@ -464,10 +472,10 @@ double MatrixSBDPProfileProcess::MixMove(int nrep, int nallocrep, double epsilon
 
 				int bk = alloc[site];
 
+				LogStatProbs(site,K0,mLogSamplingArray);
 				double max = 0;
 				// double mean = 0;
 				for (int mode = 0; mode<K0; mode++)	{
-					mLogSamplingArray[mode] = LogStatProb(site,mode);
 					if ((!mode) || (max < mLogSamplingArray[mode]))	{
 						max = mLogSamplingArray[mode];
 					}
@@ -489,8 +497,7 @@ double MatrixSBDPProfileProcess::MixMove(int nrep, int nallocrep, double epsilon
 				double M = 1;
 				total += M * totq;
 				double q = total * rnd::GetRandom().Uniform();
-				int mode = 0;
-				while ( (mode<K0) && (q > cumul[mode])) mode++;
+				int mode = lower_bound(cumul,cumul+K0,q) - cumul;
 				if (mode == K0)	{
 					mode--;
 					double r = (q - cumul[mode]) / M;
@@ -699,12 +706,12 @@ double MatrixSBDPProfileProcess::GlobalIncrementalDPMove(int nrep, double epsilo
 	GlobalUpdateParameters();
 
 	MESSAGE signal = REALLOC_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&K0,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&K0,1,MPI_INT,0,PROCESS_COMM);
 
 
-	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	for (int rep=0; rep<nrep; rep++)	{
 
@@ -713,13 +720,13 @@ double MatrixSBDPProfileProcess::GlobalIncrementalDPMove(int nrep, double epsilo
 
 		// mpi send message for realloc move
 		// mpi send profiles and weights
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// mpi receive new allocations
 		MPI_Status stat;
 		int tmpalloc[GetNsite()];
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 			for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 				alloc[j] = tmpalloc[j];
 				if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -740,17 +747,17 @@ void MatrixSBDPProfileProcess::SlaveIncrementalDPMove()	{
 
 	int nrep;
 	int K0;
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&K0,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&K0,1,MPI_INT,0,PROCESS_COMM);
 
-	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	int NAccepted = 0;
 
 	for (int rep=0; rep<nrep; rep++)	{
 
 
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		double totp = 0;
 		for (int mode = 0; mode<K0; mode++)	{
@@ -765,6 +772,7 @@ void MatrixSBDPProfileProcess::SlaveIncrementalDPMove()	{
 		for (int site=GetSiteMin(); site<GetSiteMax(); site++)	{
 
 			int bk = alloc[site];
+			rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 
 			double max = 0;
 			double mean = 0;
@@ -812,13 +820,14 @@ void MatrixSBDPProfileProcess::SlaveIncrementalDPMove()	{
 				mode = bk;
 			}
 
+			rnd::GetRandom().CloseStream();
 			int Accepted = (mode != bk);
 			if (Accepted)	{
 				NAccepted ++;
 			}
 			alloc[site] = mode;
 		}
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 	}
 	delete[] cumul;
 	delete[] mLogSamplingArray;
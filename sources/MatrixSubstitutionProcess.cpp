@@ -46,14 +46,17 @@ BranchSitePath** MatrixSubstitutionProcess::SampleRootPaths(int* state)	{
 BranchSitePath** MatrixSubstitutionProcess::SamplePaths(int* stateup, int* statedown, double time) 	{
 	// BranchSitePath** patharray = new BranchSitePath*[sitemax - sitemin];
 	BranchSitePath** patharray = new BranchSitePath*[GetNsite()];
-	for (int i=sitemin; i<sitemax; i++)	{
-	// for (int i=0; i<GetNsite(); i++)	{
+	UpdateSiteOrder();
+	for (int ii=0; ii<sitemax-sitemin; ii++)	{
+		int i = siteorder[ii];
 		double rate = GetRate(i);
 		SubMatrix* matrix = GetMatrix(i);
+		rnd::GetRandom().OpenStream(i,Random::SUBPATH);
 		BranchSitePath* path = ResampleAcceptReject(1000,stateup[i],statedown[i],rate,time,matrix);
 		if (! path)	{
 			path = ResampleUniformized(stateup[i],statedown[i],rate,time,matrix);
 		}
+		rnd::GetRandom().CloseStream();
 		patharray[i] = path;
 	}
 	return patharray;
@@ -37,9 +37,19 @@ class MatrixSubstitutionProcess : public virtual SubstitutionProcess, public vir
 	protected:
 
 	// CPU Level 3: implementations of likelihood propagation and substitution mapping methods
-	void Propagate(double*** from, double*** to, double time, bool condalloc = false);
+	void Propagate(condl_t*** from, condl_t*** to, double time, bool condalloc = false);
+	// down = exp(length * Q) . up for a block of nblock vectors sharing the same matrix (see Propagate)
+	void BlockPropagate(SubMatrix* matrix, int nblock, condl_t** up, condl_t** down, const double* length, double* aux, double* expo);
+	// negative entries (roundoff errors) are set to 0, and counted
+	double ClampProb(double d)	{
+		if (d < 0.0)	{
+			infprobcount++;
+			return 0.0;
+		}
+		return d;
+	}
 
-	void SitePropagate(int site, double** from, double** to, double time, bool condalloc = false);
+	void SitePropagate(int site, condl_t** from, condl_t** to, double time, bool condalloc = false);
 
 	BranchSitePath** SamplePaths(int* stateup, int* statedown, double time);
 	BranchSitePath** SampleRootPaths(int* rootstate);
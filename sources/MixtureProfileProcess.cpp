@@ -56,10 +56,30 @@ void MixtureProfileProcess::Delete()	{
 		delete[] allocprofile;
 		delete[] profile;
 		profile = 0;
+		if (logprofiletable)	{
+			delete[] profiletable;
+			delete[] logprofiletable;
+			logprofiletable = 0;
+		}
 		ProfileProcess::Delete();
 	}
 }
 
+void MixtureProfileProcess::UpdateLogProfileTable(int ncat)	{
+	if (! logprofiletable)	{
+		profiletable = new double[GetNmodeMax() * GetDim()];
+		logprofiletable = new double[GetNmodeMax() * GetDim()];
+	}
+	for (int k=0; k<GetDim(); k++)	{
+		double* p = profiletable + k*GetNmodeMax();
+		double* logp = logprofiletable + k*GetNmodeMax();
+		for (int cat=0; cat<ncat; cat++)	{
+			p[cat] = profile[cat][k];
+			logp[cat] = log(profile[cat][k]);
+		}
+	}
+}
+
 void MixtureProfileProcess::SetEmpiricalDirWeightPrior(double* inalpha, double* inbeta) {
     for (int k=0; k<GetDim(); k++)  {
         empdirweightalpha[k] = inalpha[k];
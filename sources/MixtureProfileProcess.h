@@ -25,13 +25,17 @@ class MixtureProfileProcess: public virtual ProfileProcess	{
 
 	public:
 
-	MixtureProfileProcess() : profile(0) {}
+	MixtureProfileProcess() : profile(0), logprofiletable(0) {}
 	virtual ~MixtureProfileProcess(){}
 
 	double* GetProfile(int site)	{
 		return profile[alloc[site]];
 	}
 
+	int GetSiteComponent(int site)	{
+		return alloc[site];
+	}
+
 	int GetNcomponent() { return Ncomponent;}
 	virtual int GetNDisplayedComponent()	{
 		return Ncomponent;
@@ -85,6 +89,11 @@ class MixtureProfileProcess: public virtual ProfileProcess	{
 
 	virtual void UpdateModeProfileSuffStat() = 0;
 
+	// component suff stats, computed in parallel (collective call: master and all slaves at the same stage of a move)
+	// each slave pools the suff stats of its own range of sites (the only ones it holds),
+	// and the partial stats are summed over all processes, master included
+	virtual void ReduceModeProfileSuffStat() = 0;
+
 	// implements a pure virtual defined in ProfileProcess
 	double ProfileSuffStatLogProb();
 
@@ -94,6 +103,20 @@ class MixtureProfileProcess: public virtual ProfileProcess	{
 	// the component suff stat log prob is yet to be implemented in subclasses
 	virtual double ProfileSuffStatLogProb(int cat) = 0;
 
+	// LogStatProb(site,cat) for all components 0 <= cat < ncat (written into logsamp)
+	// as needed by the reallocation moves
+	// UpdateLogStatProbs(ncat) should be called first, and again each time the profiles have changed
+	virtual void UpdateLogStatProbs(int ncat) {}
+	virtual void LogStatProbs(int site, int ncat, double* logsamp)	{
+		for (int cat=0; cat<ncat; cat++)	{
+			logsamp[cat] = LogStatProb(site,cat);
+		}
+	}
+
+	// profiles of components 0 <= cat < ncat, and their logs, stored state by state
+	// (entry [k*GetNmodeMax() + cat]) so that LogStatProbs can run over components in contiguous arrays
+	void UpdateLogProfileTable(int ncat);
+
 	// called at the beginning and end of the run (see PhyloProcess)
 	virtual void Create(int innsite, int indim);
 	virtual void Delete();
@@ -188,6 +211,8 @@ class MixtureProfileProcess: public virtual ProfileProcess	{
 	double* profilesuffstatlogprob;
     double* empdirweightalpha;
     double* empdirweightbeta;
+	double* profiletable;
+	double* logprofiletable;
 };
 
 #endif
@@ -26,6 +26,9 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "CodonMutSelSBDPPhyloProcess.h"
 
 #include "Parallel.h"
+#include "AsyncWriter.h"
+#include "ConvergenceMonitor.h"
+#include "HeatedChains.h"
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -57,8 +60,15 @@ class Model	{
     int steppingcycle;
     int randstepping;
 
+	// set when several chains are run together (pb_mpi -nchain), master only
+	ConvergenceMonitor* monitor;
+	// set when running Metropolis-coupled chains (pb_mpi -mc3), master only
+	HeatedChains* heated;
+
 	Model(string datafile, string treefile, int modeltype, int nratecat, int mixturetype, int ncat, int nmodemax, GeneticCodeType codetype, int suffstat, int fixncomp, int empmix, string mixtype, string rrtype, int iscodon, int fixtopo, int NSPR, int NNNI, int fixcodonprofile, int fixomega, int fixbl, int omegaprior, int kappaprior, int dirweightprior, double mintotweight, int dc, int inevery, int inuntil, int insaveall, int inincinit, int topoburnin, int insteppingdnsite, int insteppingburnin, int insteppingsize, double insteppingmaxvar, int insteppingmaxsize, int inrandstepping, string inempstepping, double inempramp, string inname, int myid, int nprocs)	{
 
+		monitor = 0;
+		heated = 0;
 		every = inevery;
 		until = inuntil;
 		name = inname;
@@ -184,15 +194,21 @@ class Model	{
 		process->SetTopoBurnin(topoburnin);
 	}
 
-	Model(string inname, int myid, int nprocs)	{
+	// statename: file from which the state is read (default: the chain name)
+	Model(string inname, int myid, int nprocs, string statename = "")	{
 
         steppingdnsite = 0;
+		monitor = 0;
+		heated = 0;
 
 		name = inname;
+		if (statename == "")	{
+			statename = name;
+		}
 
-		ifstream is((name + ".param").c_str());
+		ifstream is((statename + ".param").c_str());
 		if (! is)	{
-			cerr << "error: cannot open " << name << ".param\n";
+			cerr << "error: cannot open " << statename << ".param\n";
 			exit(1);
 		}
 
@@ -269,10 +285,16 @@ class Model	{
 		process->WaitLoop();
 	}
 
-	double Move(double tuning, int nrep)	{
+	// tempered: a heated chain then only runs the tempered moves (see PhyloProcess::HeatedMove)
+	double Move(double tuning, int nrep, bool tempered = false)	{
 		double total = 0;
 		for (int rep=0; rep<nrep; rep++)	{
-			total += process->Move(tuning);
+			if (tempered && (process->GetHeat() < 1))	{
+				total += process->HeatedMove(tuning);
+			}
+			else	{
+				total += process->Move(tuning);
+			}
 		}
 		return total / nrep;
 	}
@@ -285,6 +307,21 @@ class Model	{
 		return i;
 	}
 
+	// with several chains, all of them stop together
+	// (as soon as one of them is stopped, or once they have converged)
+	int StopRun()	{
+		if (heated)	{
+			// only the writer owns the .run file
+			int stop = (heated->IsWriter() && (! RunningStatus())) || ((until != -1) && (GetSize() >= until));
+			return heated->Stop(stop);
+		}
+		int stop = ! (RunningStatus() && ((until == -1) || (GetSize() < until)));
+		if (monitor)	{
+			return monitor->Stop(stop);
+		}
+		return stop;
+	}
+
 	int GetSize()	{
 		return process->GetSize();
 	}
@@ -309,49 +346,137 @@ class Model	{
 				process->SetBurnin(true);
 			}
 		}
-		ofstream ros((name + ".run").c_str()); stringstream buf;
-		buf << 1 << '\n';
-		ros << buf.str();
-		ros.close();
+		bool writes = (! heated) || heated->IsWriter();
+		if (writes)	{
+			ofstream ros((name + ".run").c_str()); stringstream buf;
+			buf << 1 << '\n';
+			ros << buf.str();
+			ros.close();
+		}
 	
-		while (RunningStatus() && ((until == -1) || (GetSize() < until)))	{
+		// output files are serialized here and written by a background thread
+		// so that slaves do not wait on the file system
+		AsyncWriter writer;
+
+		// current size of the .chain file: offset of the next point in .chainindex
+		// (each entry of the index is the offset and the size of a point, see PhyloProcess::MakeChainSchedule)
+		streamoff chainoffset = 0;
+		if (saveall && writes)	{
+			ifstream cis((name + ".chain").c_str(), ios_base::ate);
+			if (cis)	{
+				chainoffset = cis.tellg();
+			}
+		}
+
+		// serialized point: tree, trace, monitor, param and chain
+		enum {TREE, TRACE, MONITOR, PARAM, CHAIN, NITEM};
+		vector<string> point(NITEM);
+
+		if (heated)	{
+			SaveHeatedState(writer);
+		}
+
+		while (! StopRun())	{
 			if (GetSize() >= burnin)	{
 				process->SetBurnin(false);
 			}
 
-			Move(1,every);
+			// heated chains: during the burn-in (-b), all chains run the complete moves and do not swap,
+			// so that the parameters not updated by the heated chains start from reasonable values
+			bool coupled = heated && (GetSize() >= burnin);
+
+			Move(1,every,coupled);
 			
 			process->IncSize();
 
-            if (! process->fixtopo) {
-                ofstream os((name + ".treelist").c_str(), ios_base::app);
-                TreeTrace(os);
-                os.close();
-            }
+			if (coupled)	{
+				heated->Swap();
+			}
 
-			ofstream tos((name + ".trace").c_str(), ios_base::app);
-			Trace(tos);
-			tos.close();
+			// with heated chains, only the cold one is sampled
+			if ((! heated) || heated->IsCold())	{
 
-			ofstream mos((name + ".monitor").c_str());
-			Monitor(mos);
-			mos.close();
+				if (! process->fixtopo) {
+					ostringstream os;
+					TreeTrace(os);
+					point[TREE] = os.str();
+				}
 
-			ofstream pos((name + ".param").c_str());
-			pos.precision(numeric_limits<double>::digits10);
-			ToStream(pos,true);
-			pos.close();
+				ostringstream tos;
+				Trace(tos);
+				point[TRACE] = tos.str();
+				if (monitor)	{
+					monitor->AddPoint(point[TRACE],process->GetTree());
+				}
 
-			if (saveall)	{
-				ofstream cos((name + ".chain").c_str(),ios_base::app);
-				cos.precision(numeric_limits<double>::digits10);
-				ToStream(cos,false);
-				cos.close();
+				ostringstream mos;
+				Monitor(mos);
+				point[MONITOR] = mos.str();
+
+				ostringstream pos;
+				pos.precision(numeric_limits<double>::digits10);
+				ToStream(pos,true);
+				point[PARAM] = pos.str();
+
+				if (saveall)	{
+					ostringstream cos;
+					cos.precision(numeric_limits<double>::digits10);
+					ToStream(cos,false);
+					point[CHAIN] = cos.str();
+				}
+			}
+
+			if (heated)	{
+				SaveHeatedState(writer);
+				heated->Forward(point);
+				if (writes)	{
+					ostringstream mos;
+					heated->Monitor(mos);
+					point[MONITOR] += mos.str();
+				}
 			}
 
+			if (writes)	{
+				if (! process->fixtopo) {
+					writer.Append(name + ".treelist", point[TREE]);
+				}
+				writer.Append(name + ".trace", point[TRACE]);
+				writer.Write(name + ".monitor", point[MONITOR]);
+
+				if (saveall)	{
+					streamoff pointsize = point[CHAIN].size();
+					writer.Append(name + ".chain", point[CHAIN]);
+
+					ostringstream xos;
+					xos << chainoffset << '\t' << pointsize << '\n';
+					writer.Append(name + ".chainindex", xos.str());
+					chainoffset += pointsize;
+				}
+
+				// after the .chain append: a .param on disk never refers to a point not yet saved
+				writer.AtomicWrite(name + ".param", point[PARAM]);
+			}
 		}	
-		cerr << name << ": stopping after " << GetSize() << " points.\n";
-		cerr << '\n';
+		writer.Close();
+		if (writes)	{
+			cerr << name << ": stopping after " << GetSize() << " points.\n";
+			cerr << '\n';
+		}
+	}
+
+	// with heated chains, the .param file only has the state of the cold chain:
+	// each chain also saves its own state, and the writer saves the temperature ladder,
+	// so that the whole run can be restarted
+	void SaveHeatedState(AsyncWriter& writer)	{
+		ostringstream pos;
+		pos.precision(numeric_limits<double>::digits10);
+		ToStream(pos,true);
+		writer.AtomicWrite(heated->GetStateName(name) + ".param", pos.str());
+		if (heated->IsWriter())	{
+			ostringstream hos;
+			heated->ToStream(hos);
+			writer.AtomicWrite(name + ".mc3", hos.str());
+		}
 	}
 
 	void SteppingRun(int step, int burnin, int minnpoint, double maxvar, double maxnpoint, int rand, string empname, double empramp)    {
@@ -369,10 +494,12 @@ class Model	{
         }
 		process->GlobalPrepareStepping(name, GetSize(), rand);
 	
-		ofstream ros((name + ".run").c_str()); stringstream buf;
-		buf << 1 << '\n';
-		ros << buf.str();
-		ros.close();
+		if (! GROUPID)	{
+			ofstream ros((name + ".run").c_str()); stringstream buf;
+			buf << 1 << '\n';
+			ros << buf.str();
+			ros.close();
+		}
 	
         if (! GetSize())    {
             if (empiricalprior)  {
@@ -389,135 +516,143 @@ class Model	{
             ncycle++;
         }
 
-		while (RunningStatus() && (steppingcycle < ncycle)) {
+		// with several groups of processes (pb_mpi -stepgroup),
+		// the steps are independent, and each group deals with one step out of NGROUP;
+		// the rows of the .stepping file are collected by the first group, in order
+		// before each of its steps, a group goes through the fractions of the steps dealt with by the other groups
+		// (burnin points each), so that its chain is annealed as progressively as with a single group
 
-            double frac1 = ((double) steppingcycle) / ncycle;
-            frac1 *= empramp;
-            if (frac1 > 1.0)    {
-                frac1 = 1.0;
-            }
-            int nsite1 = steppingcycle * step;
-            if (nsite1 > process->GetNsite()) {
-                nsite1 = process->GetNsite();
-            }
+		// last step at which the chain was equilibrated (0: prior, no data)
+		int lastcycle = steppingcycle ? steppingcycle - 1 : 0;
 
-            double frac2 = ((double) steppingcycle + 1.0) / ncycle;
-            frac2 *= empramp;
-            if (frac2 > 1.0)    {
-                frac2 = 1.0;
-            }
-            int nsite2 = (steppingcycle + 1) * step;
-            if (nsite2 > process->GetNsite()) {
-                nsite2 = process->GetNsite();
-            }
+		while (SteppingRunning() && (steppingcycle < ncycle)) {
 
-            process->GlobalSetSteppingFraction(0, nsite1);
+			int cycle = steppingcycle + GROUPID;
+			string row;
+			if (cycle < ncycle)	{
+				for (int c=lastcycle+1; c<cycle; c++)	{
+					SteppingAnneal(c, ncycle, step, burnin, empiricalprior, empramp);
+				}
+				row = SteppingStep(cycle, ncycle, step, burnin, minnpoint, maxvar, maxnpoint, empiricalprior, empramp, nrep);
+				lastcycle = cycle;
+			}
+			if (NGROUP > 1)	{
+				row = GatherString(row, MASTER_COMM);
+			}
 
-            // not necessary: increasing series of sites
-            // process->GlobalResetAllConditionalLikelihoods();
+			steppingcycle += NGROUP;
+			if (steppingcycle > ncycle)	{
+				steppingcycle = ncycle;
+			}
 
-            process->GlobalUpdateConditionalLikelihoods();
+			if (! GROUPID)	{
+				ofstream los((name + ".stepping").c_str(), ios_base::app);
+				los << row;
+				los.close();
+
+				// with several groups, the state of one group cannot be used to restart the run
+				if (NGROUP == 1)	{
+					ofstream pos((name + ".param").c_str());
+					pos.precision(numeric_limits<double>::digits10);
+					ToStream(pos,true);
+					pos.close();
+				}
+			}
+		}	
+		if (! GROUPID)	{
+			cerr << name << ": stopping after " << GetSize() << " points.\n";
+			cerr << '\n';
+		}
+	}
 
-            if (empiricalprior)  {
-                process->GlobalSetEmpiricalFrac(frac1);
-            }
+	// with several groups, the first one owns the .run file
+	int SteppingRunning()	{
+		if (NGROUP == 1)	{
+			return RunningStatus();
+		}
+		int running = 0;
+		if (! GROUPID)	{
+			running = RunningStatus();
+		}
+		MPI_Bcast(&running,1,MPI_INT,0,MASTER_COMM);
+		return running;
+	}
 
-            for (int i=0; i<burnin; i++)    {
-                Move(1,every);
-                process->IncSize();
-            }
+	// fraction of the empirical prior, and number of sites, conditioned upon at the start of a step
+	double SteppingFrac(int cycle, int ncycle, double empramp)	{
+        double frac = ((double) cycle) / ncycle;
+        frac *= empramp;
+        if (frac > 1.0)    {
+            frac = 1.0;
+        }
+		return frac;
+	}
 
-            double premaxlogp = 0;
-            double pretotp1 = 0;
-            double pretotp2 = 0;
-            double pretotlogp1 = 0;
-            double pretotlogp2 = 0;
-            double pretotlogprior = 0;
-
-            double prelogZ = 0;
-            double preeffsize = 0;
-            double premeanlogp = 0;
-            double prevarlogp = 0;
-            double premeanlogprior = 0;
-
-            double targetnpoint = minnpoint;
-
-            if (maxvar) {
-                int npoint = 0;
-                while (npoint < minnpoint)  {
-                    Move(1,every);
-                    process->IncSize();
-                    npoint++;
-
-                    process->GlobalSetSteppingFraction(nsite1, nsite2);
-                    double delta = process->GlobalGetSteppingLogLikelihood(nrep, 1);
-
-                    double dlogp = 0;
-                    if (empiricalprior)  {
-                        double lnP1 = process->GetLogPrior();
-                        process->GlobalSetEmpiricalFrac(frac2);
-                        double lnP2 = process->GetLogPrior();
-                        delta += lnP2 - lnP1;
-                        dlogp = lnP2 - lnP1;
-                    }
-                    if (std::isnan(delta))   {
-                        cerr << "nan delta\n";
-                        exit(1);
-                    }
-
-                    pretotlogprior += dlogp;
-                    pretotlogp1 += delta;
-                    pretotlogp2 += delta*delta;
-                    if ((!premaxlogp) || (premaxlogp < delta))    {
-                        pretotp1 *= exp(premaxlogp-delta);
-                        pretotp1 += 1.0;
-                        pretotp2 *= exp(2*(premaxlogp-delta));
-                        pretotp2 += 1.0;
-                        premaxlogp = delta;
-                    }
-                    else    {
-                        pretotp1 += exp(delta - premaxlogp);
-                        pretotp2 += exp(2*(delta - premaxlogp));
-                    }
-
-                    if (npoint == minnpoint)    {
-                        prelogZ = log(pretotp1 / npoint) + premaxlogp;
-                        preeffsize = pretotp1 * pretotp1 / pretotp2;
-                        premeanlogp = pretotlogp1/npoint;
-                        prevarlogp = pretotlogp2/npoint - premeanlogp*premeanlogp;
-                        premeanlogprior = pretotlogprior / npoint;
-                    }
-
-                    process->GlobalSetSteppingFraction(0, nsite1);
-                    process->GlobalSetEmpiricalFrac(frac1);
-                }
+	int SteppingNsite(int cycle, int step)	{
+        int nsite = cycle * step;
+        if (nsite > process->GetNsite()) {
+            nsite = process->GetNsite();
+        }
+		return nsite;
+	}
 
-                if (prevarlogp > maxvar)   {
-                    targetnpoint *= exp(prevarlogp)/exp(maxvar);
-                    if (targetnpoint > maxnpoint) {
-                        targetnpoint = maxnpoint;
-                    }
-                }
-            }
+	// conditions the chain on the sites of the given step, and equilibrates it (burnin points)
+	void SteppingAnneal(int cycle, int ncycle, int step, int burnin, int empiricalprior, double empramp)	{
+
+        process->GlobalSetSteppingFraction(0, SteppingNsite(cycle, step));
+
+        // not necessary: increasing series of sites
+        // process->GlobalResetAllConditionalLikelihoods();
+
+        process->GlobalUpdateConditionalLikelihoods();
+
+        if (empiricalprior)  {
+            process->GlobalSetEmpiricalFrac(SteppingFrac(cycle, ncycle, empramp));
+        }
+
+        for (int i=0; i<burnin; i++)    {
+            Move(1,every);
+            process->IncSize();
+        }
+	}
+
+	// one step of the stepping-stone: returns the corresponding row of the .stepping file
+	string SteppingStep(int cycle, int ncycle, int step, int burnin, int minnpoint, double maxvar, double maxnpoint, int empiricalprior, double empramp, int nrep)	{
+
+		string row;
+
+        double frac1 = SteppingFrac(cycle, ncycle, empramp);
+        int nsite1 = SteppingNsite(cycle, step);
+        double frac2 = SteppingFrac(cycle + 1, ncycle, empramp);
+        int nsite2 = SteppingNsite(cycle + 1, step);
+
+        SteppingAnneal(cycle, ncycle, step, burnin, empiricalprior, empramp);
+
+        double premaxlogp = 0;
+        double pretotp1 = 0;
+        double pretotp2 = 0;
+        double pretotlogp1 = 0;
+        double pretotlogp2 = 0;
+        double pretotlogprior = 0;
 
-            int finalnpoint = int(targetnpoint);
+        double prelogZ = 0;
+        double preeffsize = 0;
+        double premeanlogp = 0;
+        double prevarlogp = 0;
+        double premeanlogprior = 0;
 
-            double maxlogp = 0;
-            double totp1 = 0;
-            double totp2 = 0;
-            double totlogp1 = 0;
-            double totlogp2 = 0;
-            double totlogprior = 0;
+        double targetnpoint = minnpoint;
 
+        if (maxvar) {
             int npoint = 0;
-            while (npoint < finalnpoint)    {
+            while (npoint < minnpoint)  {
                 Move(1,every);
                 process->IncSize();
                 npoint++;
 
                 process->GlobalSetSteppingFraction(nsite1, nsite2);
-                int restore = (npoint == finalnpoint) ? 0 : 1;
-                double delta = process->GlobalGetSteppingLogLikelihood(nrep, restore);
+                double delta = process->GlobalGetSteppingLogLikelihood(nrep, 1);
+
                 double dlogp = 0;
                 if (empiricalprior)  {
                     double lnP1 = process->GetLogPrior();
@@ -531,53 +666,111 @@ class Model	{
                     exit(1);
                 }
 
-                totlogprior += dlogp;
-
-                totlogp1 += delta;
-                totlogp2 += delta*delta;
-                if ((!maxlogp) || (maxlogp < delta))    {
-                    totp1 *= exp(maxlogp-delta);
-                    totp1 += 1.0;
-                    totp2 *= exp(2*(maxlogp-delta));
-                    totp2 += 1.0;
-                    maxlogp = delta;
+                pretotlogprior += dlogp;
+                pretotlogp1 += delta;
+                pretotlogp2 += delta*delta;
+                if ((!premaxlogp) || (premaxlogp < delta))    {
+                    pretotp1 *= exp(premaxlogp-delta);
+                    pretotp1 += 1.0;
+                    pretotp2 *= exp(2*(premaxlogp-delta));
+                    pretotp2 += 1.0;
+                    premaxlogp = delta;
                 }
                 else    {
-                    totp1 += exp(delta - maxlogp);
-                    totp2 += exp(2*(delta - maxlogp));
+                    pretotp1 += exp(delta - premaxlogp);
+                    pretotp2 += exp(2*(delta - premaxlogp));
                 }
 
-                if (npoint < finalnpoint)   {
-                    process->GlobalSetSteppingFraction(0, nsite1);
-                    process->GlobalSetEmpiricalFrac(frac1);
+                if (npoint == minnpoint)    {
+                    prelogZ = log(pretotp1 / npoint) + premaxlogp;
+                    preeffsize = pretotp1 * pretotp1 / pretotp2;
+                    premeanlogp = pretotlogp1/npoint;
+                    prevarlogp = pretotlogp2/npoint - premeanlogp*premeanlogp;
+                    premeanlogprior = pretotlogprior / npoint;
                 }
-                else    {
 
-                    double logZ = log(totp1 / npoint) + maxlogp;
-                    double effsize = totp1 * totp1 / totp2;
-                    double meanlogp = totlogp1/npoint;
-                    double varlogp = totlogp2/npoint - meanlogp*meanlogp;
-                    double meanlogprior = totlogprior / npoint;
-
-                    ofstream los((name + ".stepping").c_str(), ios_base::app);
-                    if (maxvar) {
-                        los << frac1 << '\t' << nsite1 << '\t' << logZ << '\t' << meanlogp << '\t' << meanlogprior << '\t' << varlogp << '\t' << npoint << '\t' << effsize << '\t' << prelogZ << '\t' << premeanlogp << '\t' << premeanlogprior << '\t' << prevarlogp << '\t' << minnpoint << '\t' << preeffsize <<  '\n';
-                    }
-                    else    {
-                        los << frac1 << '\t' << nsite1 << '\t' << logZ << '\t' << meanlogp << '\t' << meanlogprior << '\t' << varlogp << '\t' << npoint << '\t' << effsize << '\n';
-                    }
-                    los.close();
-
-                    steppingcycle++;
-                    ofstream pos((name + ".param").c_str());
-                    pos.precision(numeric_limits<double>::digits10);
-                    ToStream(pos,true);
-                    pos.close();
+                process->GlobalSetSteppingFraction(0, nsite1);
+                process->GlobalSetEmpiricalFrac(frac1);
+            }
+
+            if (prevarlogp > maxvar)   {
+                targetnpoint *= exp(prevarlogp)/exp(maxvar);
+                if (targetnpoint > maxnpoint) {
+                    targetnpoint = maxnpoint;
                 }
             }
-		}	
-		cerr << name << ": stopping after " << GetSize() << " points.\n";
-		cerr << '\n';
+        }
+
+        int finalnpoint = int(targetnpoint);
+
+        double maxlogp = 0;
+        double totp1 = 0;
+        double totp2 = 0;
+        double totlogp1 = 0;
+        double totlogp2 = 0;
+        double totlogprior = 0;
+
+        int npoint = 0;
+        while (npoint < finalnpoint)    {
+            Move(1,every);
+            process->IncSize();
+            npoint++;
+
+            process->GlobalSetSteppingFraction(nsite1, nsite2);
+            int restore = (npoint == finalnpoint) ? 0 : 1;
+            double delta = process->GlobalGetSteppingLogLikelihood(nrep, restore);
+            double dlogp = 0;
+            if (empiricalprior)  {
+                double lnP1 = process->GetLogPrior();
+                process->GlobalSetEmpiricalFrac(frac2);
+                double lnP2 = process->GetLogPrior();
+                delta += lnP2 - lnP1;
+                dlogp = lnP2 - lnP1;
+            }
+            if (std::isnan(delta))   {
+                cerr << "nan delta\n";
+                exit(1);
+            }
+
+            totlogprior += dlogp;
+
+            totlogp1 += delta;
+            totlogp2 += delta*delta;
+            if ((!maxlogp) || (maxlogp < delta))    {
+                totp1 *= exp(maxlogp-delta);
+                totp1 += 1.0;
+                totp2 *= exp(2*(maxlogp-delta));
+                totp2 += 1.0;
+                maxlogp = delta;
+            }
+            else    {
+                totp1 += exp(delta - maxlogp);
+                totp2 += exp(2*(delta - maxlogp));
+            }
+
+            if (npoint < finalnpoint)   {
+                process->GlobalSetSteppingFraction(0, nsite1);
+                process->GlobalSetEmpiricalFrac(frac1);
+            }
+            else    {
+
+                double logZ = log(totp1 / npoint) + maxlogp;
+                double effsize = totp1 * totp1 / totp2;
+                double meanlogp = totlogp1/npoint;
+                double varlogp = totlogp2/npoint - meanlogp*meanlogp;
+                double meanlogprior = totlogprior / npoint;
+
+                ostringstream los;
+                if (maxvar) {
+                    los << frac1 << '\t' << nsite1 << '\t' << logZ << '\t' << meanlogp << '\t' << meanlogprior << '\t' << varlogp << '\t' << npoint << '\t' << effsize << '\t' << prelogZ << '\t' << premeanlogp << '\t' << premeanlogprior << '\t' << prevarlogp << '\t' << minnpoint << '\t' << preeffsize <<  '\n';
+                }
+                else    {
+                    los << frac1 << '\t' << nsite1 << '\t' << logZ << '\t' << meanlogp << '\t' << meanlogprior << '\t' << varlogp << '\t' << npoint << '\t' << effsize << '\n';
+                }
+                row = los.str();
+            }
+        }
+		return row;
 	}
 
 	NewickTree* GetTree() {return process->GetLengthTree();}
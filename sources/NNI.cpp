@@ -105,7 +105,7 @@ int PhyloProcess::GlobalNNI(Link* from, double tuning, int type)	{
 
 	// MPI
 	MESSAGE signal = NNI;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 
 	int n =0;
@@ -113,7 +113,7 @@ int PhyloProcess::GlobalNNI(Link* from, double tuning, int type)	{
 		n = 1 + (int) 5 * rnd::GetRandom().Uniform();
 	}
 	int args[] = {GetLinkIndex(from),n};
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 
 	Link** branches;
 	double logDiffPriorAndHastings = 0.0;
@@ -131,15 +131,21 @@ int PhyloProcess::GlobalNNI(Link* from, double tuning, int type)	{
 	double* vec = new double[2];
 	MPI_Status stat;
 	for(int i=1; i<nprocs; ++i) {
-		MPI_Recv(vec,2,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(vec,2,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 		loglikelihood[1]+=vec[0];
 		loglikelihood[2]+=vec[1];
 	}
 	delete[] vec;
 
 	// Sample a configuration
-	int choice = rnd::GetRandom().DrawFromLogDiscreteDistribution(loglikelihood, 3);
-	MPI_Bcast(&choice,1,MPI_INT,0,MPI_COMM_WORLD);
+	// (heated chain: the likelihood part of each weight is raised to the power heat)
+	double* logweight = new double[3];
+	logweight[0] = loglikelihood[0] + (heat - 1) * loglikelihood[0];
+	logweight[1] = loglikelihood[1] + (heat - 1) * (loglikelihood[1] - logDiffPriorAndHastings);
+	logweight[2] = loglikelihood[2] + (heat - 1) * (loglikelihood[2] - logDiffPriorAndHastings);
+	int choice = rnd::GetRandom().DrawFromLogDiscreteDistribution(logweight, 3);
+	delete[] logweight;
+	MPI_Bcast(&choice,1,MPI_INT,0,PROCESS_COMM);
 	bool success = (choice != 0);
 
 	// Update the logL of the model
@@ -199,8 +205,8 @@ double PhyloProcess::SendRandomBranches(Link* from, double tuning, Link**& branc
 		logDiffPriorAndHastings -= LogBranchLengthPrior(b);
 		br[i]=GetLinkIndex(branches[i]);
 	}
-	MPI_Bcast(br,n,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(m,n,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(br,n,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(m,n,MPI_DOUBLE,0,PROCESS_COMM);
 
 	delete[] m;
 	delete[] br;
@@ -218,8 +224,8 @@ void PhyloProcess::SlaveNNI(Link* from, int n){
 	if(n){
 		br = new int[n];
 		m = new double[n];
-		MPI_Bcast(br,n,MPI_INT,0,MPI_COMM_WORLD);
-		MPI_Bcast(m,n,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(br,n,MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(m,n,MPI_DOUBLE,0,PROCESS_COMM);
 		for(int i=0; i<n; ++i){
 			Link* link = GetLinkForGibbs(br[i]);
 			MoveBranch(link->GetBranch(),m[i]);
@@ -271,11 +277,11 @@ int PhyloProcess::SlaveSendNNILikelihood(Link* from){
 	PropagateOverABranch(from->Next());
 	loglikelihood[1]= ComputeNodeLikelihood(from);
 
-	MPI_Send(loglikelihood,2,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(loglikelihood,2,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	delete[] loglikelihood;
 
 	int choice;
-	MPI_Bcast(&choice,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&choice,1,MPI_INT,0,PROCESS_COMM);
 	return choice;
 }
 
@@ -290,9 +296,9 @@ void PhyloProcess::GlobalPropagateOverABranch(Link* from)	{
 	assert(!from->isRoot());
 	if(! from->isLeaf() ){
 		MESSAGE signal = BRANCHPROPAGATE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		int args[] = {GetLinkIndex(from)};
-		MPI_Bcast(args,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(args,1,MPI_INT,0,PROCESS_COMM);
 	}
 }
 
@@ -324,9 +330,9 @@ void PhyloProcess::GlobalKnit(Link* from)	{
 
 	assert(myid == 0);
 	MESSAGE signal = KNIT;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int args[] = {GetLinkIndex(from)};
-	MPI_Bcast(args,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,1,MPI_INT,0,PROCESS_COMM);
 	from->Knit();
 
 }
@@ -70,6 +70,22 @@ int main(int argc, char* argv[])	{
 	int burnin = 0;
 
 	int randfix = -1;
+	// site-level draws from counter-based streams
+	int crng = 0;
+
+	// several chains in the same job, stopped on convergence
+	int nchain = 1;
+	int convevery = 0;
+	double convmaxdiff = 0;
+	double convmaxreldiff = 0;
+	double convminsize = 0;
+
+	// stepping-stone steps run in parallel
+	int nstepgroup = 1;
+
+	// Metropolis-coupled chains
+	int nheat = 1;
+	double dheat = 0;
 
 	double mintotweight = 0;
 
@@ -117,6 +133,9 @@ int main(int argc, char* argv[])	{
 				i++;
 				randfix = atoi(argv[i]);
 			}
+			else if (s == "-crng")	{
+				crng = 1;
+			}
 			else if (s == "-d")	{
 				i++;
 				datafile = argv[i];
@@ -185,6 +204,14 @@ int main(int argc, char* argv[])	{
             }
             else if (s == "-rndstepping")   {
                 randstepping = 1;
+            }
+            else if (s == "-stepgroup")   {
+                i++;
+                if (i == argc) throw(0);
+                nstepgroup = atoi(argv[i]);
+                if (nstepgroup < 1) {
+                    throw(0);
+                }
             }
 			else if (s == "-fixcodonprofile")	{
 				fixcodonprofile = 1;
@@ -201,6 +228,12 @@ int main(int argc, char* argv[])	{
 			else if (s == "-dc")	{
 				dc = 1;
 			}
+			else if (s == "-cache")	{
+				FileSequenceAlignment::usecache = true;
+			}
+			else if (s == "-sitegroup")	{
+				SubstitutionProcess::sitegrouping = true;
+			}
 			else if (s == "-s")	{
 				saveall = 1;
 			}
@@ -447,6 +480,37 @@ int main(int argc, char* argv[])	{
 				i++;
 				burnin = atoi(argv[i]);
 			}
+			else if (s == "-nchain")	{
+				i++;
+				if (i == argc) throw(0);
+				nchain = atoi(argv[i]);
+				i++;
+				if (i == argc) throw(0);
+				convevery = atoi(argv[i]);
+				i++;
+				if (i == argc) throw(0);
+				convmaxdiff = atof(argv[i]);
+				i++;
+				if (i == argc) throw(0);
+				convmaxreldiff = atof(argv[i]);
+				i++;
+				if (i == argc) throw(0);
+				convminsize = atof(argv[i]);
+				if ((nchain < 2) || (convevery < 1))	{
+					throw(0);
+				}
+			}
+			else if (s == "-mc3")	{
+				i++;
+				if (i == argc) throw(0);
+				nheat = atoi(argv[i]);
+				i++;
+				if (i == argc) throw(0);
+				dheat = atof(argv[i]);
+				if ((nheat < 2) || (dheat <= 0))	{
+					throw(0);
+				}
+			}
 			else if ( (s == "-x") || (s == "-extract") )	{
 				i++;
 				if (i == argc) throw(0);
@@ -500,12 +564,33 @@ int main(int argc, char* argv[])	{
 			cerr << "\t-dgam <ncat>        : discrete gamma. ncat = number of categories (4 by default, 1 = uniform rates model)\n";
 			cerr << '\n';
 			cerr << "\t-dc                 : excludes constant columns\n";
+			cerr << "\t-cache              : reads (or creates) a binary copy of the data file (<datafile>.pbcache)\n";
 			cerr << "\t-t <treefile>       : starts from specified tree\n"; 
 			cerr << "\t-T <treefile>       : chain run under fixed, specified tree\n"; 
 			cerr << '\n';
 			cerr << "\t-x <every> <until>  : saving frequency, and chain length (until = -1 : forever)\n";
 			cerr << "\t-f                  : forcing checks\n";
 			cerr << "\t-s/-S               : -s : save all / -S : save only the trees\n";
+			cerr << "\t-crng               : site-level random draws (allocations, states, mappings) keyed by site and iteration:\n";
+			cerr << "\t                      with -rnd <seed>, they do not depend on the number of processes\n";
+			cerr << "\t-sitegroup          : pruning and mappings visit the sites grouped by mixture component (faster with large mixtures)\n";
+			cerr << "\t                      same likelihoods; the mappings are the same only with -crng\n";
+			cerr << '\n';
+			cerr << "\t-nchain <nchain> <every> <maxdiff> <maxreldiff> <minsize>\n";
+			cerr << "\t                    : runs nchain chains (<chainname>_1, <chainname>_2, ...), each on np/nchain processes\n";
+			cerr << "\t                      every <every> points, compares the chains (after discarding the first fifth),\n";
+			cerr << "\t                      and stops them all once the bpcomp maxdiff < <maxdiff>, and the tracecomp\n";
+			cerr << "\t                      rel_diff < <maxreldiff> and effsize > <minsize> (report in <chainname>.conv)\n";
+			cerr << "\t-mc3 <nchain> <dheat>\n";
+			cerr << "\t                    : Metropolis-coupled mcmc: nchain chains, each on np/nchain processes,\n";
+			cerr << "\t                      the i-th chain raising the likelihood to the power 1/(1+i*dheat) (i=0: cold chain)\n";
+			cerr << "\t                      heated chains (i>0) only run the branch length and topology moves\n";
+			cerr << "\t                      (all chains run all moves and do not swap during the burn-in, see -b)\n";
+			cerr << "\t                      only the cold chain is sampled; to restart, give -mc3 again (same arguments)\n";
+			cerr << "\t-stepgroup <ngroup> : stepping-stone runs: ngroup groups of np/ngroup processes, each dealing with\n";
+			cerr << "\t                      one step out of ngroup (all rows collected in <chainname>.stepping)\n";
+			cerr << "\t                      before each step, a group anneals through the steps of the other groups\n";
+			cerr << "\t                      (stepping burn-in at each of them); such runs cannot be restarted\n";
 			cerr << '\n';
 			
 			cerr << '\n';
@@ -552,8 +637,70 @@ int main(int argc, char* argv[])	{
 			exit(1);
 		}
 	}
+	if (((nheat > 1) || (nchain > 1)) && steppingdnsite)	{
+		if (! myid)	{
+			cerr << "error: -mc3 and -nchain are not available for stepping-stone runs (see -stepgroup)\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	if ((nstepgroup > 1) && (datafile == ""))	{
+		if (! myid)	{
+			cerr << "error: stepping-stone runs with -stepgroup cannot be restarted\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	if ((nstepgroup > 1) && ((! steppingdnsite) || (nchain > 1) || (nheat > 1)))	{
+		if (! myid)	{
+			cerr << "error: -stepgroup is only available for stepping-stone runs, and cannot be combined with -nchain or -mc3\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	if (nstepgroup > 1)	{
+		SplitProcessGroups(nstepgroup);
+		MPI_Comm_rank(PROCESS_COMM,&myid);
+		MPI_Comm_size(PROCESS_COMM,&nprocs);
+	}
+	if ((nchain > 1) && (nheat > 1))	{
+		if (! myid)	{
+			cerr << "error: -nchain and -mc3 cannot be combined\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	if ((nheat > 1) && (! burnin) && (! myid))	{
+		cerr << "warning: with -mc3, heated chains only update the tree and the branch lengths;\n";
+		cerr << "a burn-in (-b <npoints>) first lets all chains run all moves\n";
+	}
+	if (nheat > 1)	{
+		SplitProcessGroups(nheat);
+		MPI_Comm_rank(PROCESS_COMM,&myid);
+		MPI_Comm_size(PROCESS_COMM,&nprocs);
+	}
+
+	string basename = name;
+	if (nchain > 1)	{
+		SplitProcessGroups(nchain);
+		MPI_Comm_rank(PROCESS_COMM,&myid);
+		MPI_Comm_size(PROCESS_COMM,&nprocs);
+		ostringstream s;
+		s << name << '_' << GROUPID + 1;
+		name = s.str();
+	}
+	if ((nstepgroup == 1) && (nheat == 1) && (nchain == 1))	{
+		SplitProcessGroups(1);
+	}
+
 	if (randfix != -1)	{
-		rnd::init(1,randfix);
+		rnd::init(1,randfix + GROUPID);
+	}
+	if (crng)	{
+		// same key on all the processes of a chain
+		int seed = rnd::GetRandom().GetSeed();
+		MPI_Bcast(&seed,1,MPI_INT,0,PROCESS_COMM);
+		rnd::GetRandom().SetCounterBased(seed);
 	}
 
 	Model* model = 0;
@@ -623,7 +770,8 @@ int main(int argc, char* argv[])	{
 			}
 		}
 		model = new Model(datafile,treefile,modeltype,dgam,mixturetype,ncat,nmodemax,type,suffstat,fixncomp,empmix,mixtype,rrtype,iscodon,fixtopo,NSPR,NNNI,fixcodonprofile,fixomega,fixbl,omegaprior,kappaprior,dirweightprior,mintotweight,dc,every,until,saveall,incinit,topoburnin,steppingdnsite,steppingburnin,steppingminnpoint,steppingmaxvar,steppingmaxnpoint,randstepping,empstepping,empramp,name,myid,nprocs);
-		if (! myid)	{
+		// with heated chains or stepping groups, only the first group writes the files of the run
+		if ((! myid) && (((nheat == 1) && (nstepgroup == 1)) || (! GROUPID)))	{
             cerr << '\n';
             cerr << "chain name : " << name << '\n';
 
@@ -647,30 +795,58 @@ int main(int argc, char* argv[])	{
                 pos.close();
                 
                 if (saveall)	{
+                    ostringstream pointos;
+                    model->ToStream(pointos,false);
                     ofstream cos((name + ".chain").c_str());
-                    model->ToStream(cos,false);
+                    cos << pointos.str();
                     cos.close();
+
+                    // byte offsets and sizes of the points saved in the .chain file
+                    ofstream xos((name + ".chainindex").c_str());
+                    xos << 0 << '\t' << pointos.str().size() << '\n';
+                    xos.close();
                 }
             }
             else    {
                 ofstream os((name + ".stepping").c_str());
             }
 		}
+		else if ((! myid) && (! steppingdnsite))	{
+			model->IncSize();
+		}
 	}
 	else	{
-		model = new Model(name,myid,nprocs);
+		if (nheat > 1)	{
+			// each chain restarts from its own state
+			model = new Model(name,myid,nprocs,HeatedChains::GetStateName(name,GROUPID));
+		}
+		else	{
+			model = new Model(name,myid,nprocs);
+		}
 		if (until != -1)	{
 			model->until = until;
 		}
 	}
 
 	if (myid == 0) {
+		if (nchain > 1)	{
+			model->monitor = new ConvergenceMonitor(basename,convevery,convmaxdiff,convmaxreldiff,convminsize);
+			ostringstream os;
+			model->TraceHeader(os);
+			model->monitor->SetTraceHeader(os.str());
+		}
+		if (nheat > 1)	{
+			model->heated = new HeatedChains(model->process,nheat,dheat);
+			if (datafile == "")	{
+				model->heated->FromFile(name);
+			}
+		}
 		cerr << "run started\n";
 		cerr << '\n';
 		// model->Trace(cerr);
 		model->Run(burnin);
 		MESSAGE signal = KILL;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	}
 	else {
 		// MPI slave
@@ -0,0 +1,81 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#include "Parallel.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+MPI_Comm PROCESS_COMM = MPI_COMM_WORLD;
+MPI_Comm MASTER_COMM = MPI_COMM_NULL;
+int NGROUP = 1;
+int GROUPID = 0;
+
+void SplitProcessGroups(int ngroup)	{
+
+	int worldid, worldsize;
+	MPI_Comm_rank(MPI_COMM_WORLD,&worldid);
+	MPI_Comm_size(MPI_COMM_WORLD,&worldsize);
+
+	if ((ngroup < 1) || (worldsize < 2*ngroup))	{
+		if (! worldid)	{
+			cerr << "error: cannot split " << worldsize << " processes into " << ngroup << " groups\n";
+			cerr << "each group needs at least 2 processes (one master and at least one slave)\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+
+	NGROUP = ngroup;
+	GROUPID = (worldid * ngroup) / worldsize;
+
+	if (ngroup == 1)	{
+		PROCESS_COMM = MPI_COMM_WORLD;
+		MASTER_COMM = worldid ? MPI_COMM_NULL : MPI_COMM_SELF;
+		return;
+	}
+
+	MPI_Comm_split(MPI_COMM_WORLD,GROUPID,worldid,&PROCESS_COMM);
+
+	int myid;
+	MPI_Comm_rank(PROCESS_COMM,&myid);
+	MPI_Comm_split(MPI_COMM_WORLD,myid ? MPI_UNDEFINED : 0,worldid,&MASTER_COMM);
+}
+
+string GatherString(const string& s, MPI_Comm comm)	{
+
+	int rank, size;
+	MPI_Comm_rank(comm,&rank);
+	MPI_Comm_size(comm,&size);
+
+	int length = s.size();
+	int* lengths = new int[size];
+	MPI_Gather(&length,1,MPI_INT,lengths,1,MPI_INT,0,comm);
+	int* offsets = new int[size];
+	int total = 0;
+	if (! rank)	{
+		for (int i=0; i<size; i++)	{
+			offsets[i] = total;
+			total += lengths[i];
+		}
+	}
+	string ret(total,' ');
+	MPI_Gatherv((void*) s.data(),length,MPI_CHAR,&ret[0],lengths,offsets,MPI_CHAR,0,comm);
+	delete[] lengths;
+	delete[] offsets;
+	return ret;
+}
+
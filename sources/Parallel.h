@@ -18,10 +18,30 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #define __PARALLELH 
 
 #include "mpi.h"
+#include <string>
+
+using namespace std;
 
 const int TAG1 = 91;
 
-enum MESSAGE {KILL,SCAN,UPDATE_RATE,UPDATE_RRATE,UPDATE_BLENGTH,UPDATE_SRATE,UPDATE_SPROFILE,PARAMETER_DIFFUSION,UNFOLD,COLLAPSE,LIKELIHOOD,RESET,RESETALL,MULTIPLY,SMULTIPLY,INITIALIZE,PROPAGATE,PROPOSE,RESTORE,UPDATE,DETACH,ATTACH,NNI,KNIT,BRANCHPROPAGATE,ROOT,REALLOC_MOVE,PROFILE_MOVE,MIX_MOVE,REALLOC_DONE,GIVEMEMORE,BCAST_TREE,UNCLAMP,SETDATA,SETNODESTATES,CVSCORE,SETTESTDATA,GENE_MOVE,SAMPLE,LENGTH,ALPHA,SAVETREES, LENGTHFACTOR, FROMSTREAM, TOSTREAM, SITELOGL, STEPPINGSITELOGL, FULLSITELOGL, RESTOREDATA, WRITE_MAPPING,NONSYNMAPPING,COUNTMAPPING,SITERATE,SIMULATE,SETRATEPRIOR,SETPROFILEPRIOR,SETROOTPRIOR,STATEPOSTPROBS,SITELOGLCUTOFF,SITELOGCV, PREPARESTEPPING, SETSTEPPINGFRAC, EMPIRICALFRAC, EMPIRICALPRIOR, CREATESITE, DELETESITE};
+// communicator over which one chain is distributed (one master and its slaves)
+// this is MPI_COMM_WORLD, unless the world has been split into groups of processes
+extern MPI_Comm PROCESS_COMM;
+// communicator joining the masters of all groups (MPI_COMM_NULL on slaves)
+// with a single group, it contains only the master
+// both are set by SplitProcessGroups, which should be called once, even with a single group
+extern MPI_Comm MASTER_COMM;
+extern int NGROUP;
+extern int GROUPID;
+
+// splits MPI_COMM_WORLD into ngroup contiguous groups of processes
+// each group should have at least 2 processes
+void SplitProcessGroups(int ngroup);
+
+// concatenation of the strings of all processes of comm, in rank order (returned on rank 0)
+string GatherString(const string& s, MPI_Comm comm);
+
+enum MESSAGE {KILL,SCAN,UPDATE_RATE,UPDATE_RRATE,UPDATE_BLENGTH,UPDATE_SRATE,UPDATE_SPROFILE,PARAMETER_DIFFUSION,UNFOLD,COLLAPSE,LIKELIHOOD,RESET,RESETALL,MULTIPLY,SMULTIPLY,INITIALIZE,PROPAGATE,PROPOSE,RESTORE,UPDATE,DETACH,ATTACH,NNI,KNIT,BRANCHPROPAGATE,ROOT,REALLOC_MOVE,PROFILE_MOVE,MIX_MOVE,REALLOC_DONE,GIVEMEMORE,BCAST_TREE,UNCLAMP,SETDATA,SETNODESTATES,CVSCORE,SETTESTDATA,GENE_MOVE,SAMPLE,LENGTH,ALPHA,SAVETREES, LENGTHFACTOR, FROMSTREAM, TOSTREAM, SITELOGL, STEPPINGSITELOGL, FULLSITELOGL, RESTOREDATA, WRITE_MAPPING,NONSYNMAPPING,COUNTMAPPING,SITERATE,SIMULATE,SETRATEPRIOR,SETPROFILEPRIOR,SETROOTPRIOR,STATEPOSTPROBS,SITELOGLCUTOFF,SITELOGCV, PREPARESTEPPING, SETSTEPPINGFRAC, EMPIRICALFRAC, EMPIRICALPRIOR, CREATESITE, DELETESITE, STEPPINGLOGL, DIAGCOUNT, SHARED_LOGPROB};
 
 #endif
 
@@ -0,0 +1,197 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef PATHSUFFSTAT_H
+#define PATHSUFFSTAT_H
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+#include "SubMatrix.h"
+
+using namespace std;
+
+// compact form of the generic path sufficient statistics of a site, or of a component
+// (number of times in each state at the root, total time in each state, number of transitions between each pair of states):
+// root counts and waiting times as dense vectors over states,
+// pair counts as sorted (from,to,count) triplets, grouped by initial state (CSR-like):
+// the transitions from state pairfrom[i] are the entries pairstart[i] <= m < pairstart[i+1] of pairto and paircount.
+//
+// everything is visited in increasing order of states (as in the std::map's from which the stats are built),
+// so that LogProb sums exactly the same terms in the same order
+
+class PathSuffStat	{
+
+	public:
+
+	PathSuffStat()	{
+		Clear(0);
+	}
+
+	int GetNstate() const {return nstate;}
+	bool IsEmpty() const {return ! nroot;}
+
+	// resets all stats to 0, over nstate states
+	void Clear(int innstate)	{
+		nstate = innstate;
+		nroot = 0;
+		rootcount.assign(nstate,0);
+		waitingtime.assign(nstate,0);
+		pairfrom.clear();
+		pairstart.assign(1,0);
+		pairto.clear();
+		paircount.clear();
+	}
+
+	// stats of one site (rootstate == -1: no data at this site, stats left empty)
+	void FromMaps(int innstate, int rootstate, const map<pair<int,int>,int>& inpaircount, const map<int,double>& inwaitingtime)	{
+		Clear(innstate);
+		if (rootstate == -1)	{
+			return;
+		}
+		rootcount[rootstate] = 1;
+		nroot = 1;
+		for (map<int,double>::const_iterator i=inwaitingtime.begin(); i!=inwaitingtime.end(); i++)	{
+			waitingtime[i->first] = i->second;
+		}
+		for (map<pair<int,int>,int>::const_iterator i=inpaircount.begin(); i!=inpaircount.end(); i++)	{
+			if (i->second)	{
+				PushPair(i->first.first,i->first.second,i->second);
+			}
+		}
+	}
+
+	// adds root counts and waiting times of from (pairs are merged separately, see AddPairs / FlushPairs)
+	void AddRootAndTime(const PathSuffStat& from)	{
+		for (int k=0; k<nstate; k++)	{
+			rootcount[k] += from.rootcount[k];
+		}
+		nroot += from.nroot;
+		for (int k=0; k<nstate; k++)	{
+			waitingtime[k] += from.waitingtime[k];
+		}
+	}
+
+	// accumulates the pair counts of from into a dense nstate*nstate buffer
+	// recording the entries that became non-zero in touched
+	void AddPairs(const PathSuffStat& from, int* buffer, vector<int>& touched) const	{
+		for (unsigned int i=0; i<from.pairfrom.size(); i++)	{
+			int offset = from.pairfrom[i] * nstate;
+			for (int m=from.pairstart[i]; m<from.pairstart[i+1]; m++)	{
+				int index = offset + from.pairto[m];
+				if (! buffer[index])	{
+					touched.push_back(index);
+				}
+				buffer[index] += from.paircount[m];
+			}
+		}
+	}
+
+	// sets the pair counts from the buffer filled by AddPairs, and resets the buffer to 0
+	void FlushPairs(int* buffer, vector<int>& touched)	{
+		sort(touched.begin(),touched.end());
+		for (unsigned int i=0; i<touched.size(); i++)	{
+			int index = touched[i];
+			PushPair(index / nstate, index % nstate, buffer[index]);
+			buffer[index] = 0;
+		}
+		touched.clear();
+	}
+
+	// flat form, for sending the stats over MPI:
+	// appends the integer and real parts to iv and dv
+	void Pack(vector<int>& iv, vector<double>& dv) const	{
+		iv.push_back(nstate);
+		iv.push_back(nroot);
+		iv.insert(iv.end(),rootcount.begin(),rootcount.end());
+		iv.push_back(pairfrom.size());
+		iv.insert(iv.end(),pairfrom.begin(),pairfrom.end());
+		iv.insert(iv.end(),pairstart.begin(),pairstart.end());
+		iv.insert(iv.end(),pairto.begin(),pairto.end());
+		iv.insert(iv.end(),paircount.begin(),paircount.end());
+		dv.insert(dv.end(),waitingtime.begin(),waitingtime.end());
+	}
+
+	// reads back stats packed by Pack, starting at iv[ii] and dv[di] (ii and di are moved past them)
+	void Unpack(const int* iv, int& ii, const double* dv, int& di)	{
+		Clear(iv[ii++]);
+		nroot = iv[ii++];
+		for (int k=0; k<nstate; k++)	{
+			rootcount[k] = iv[ii++];
+		}
+		int nfrom = iv[ii++];
+		pairfrom.assign(iv+ii,iv+ii+nfrom);
+		ii += nfrom;
+		pairstart.assign(iv+ii,iv+ii+nfrom+1);
+		ii += nfrom+1;
+		int npair = pairstart.back();
+		pairto.assign(iv+ii,iv+ii+npair);
+		ii += npair;
+		paircount.assign(iv+ii,iv+ii+npair);
+		ii += npair;
+		for (int k=0; k<nstate; k++)	{
+			waitingtime[k] = dv[di++];
+		}
+	}
+
+	// log probability of the stats under the (unnormalized) path density of matrix mat
+	double LogProb(SubMatrix* mat) const	{
+		double total = 0;
+		if (! nroot)	{
+			return total;
+		}
+		const double* stat = mat->GetStationary();
+		for (int k=0; k<nstate; k++)	{
+			if (rootcount[k])	{
+				total += rootcount[k] * log(stat[k]);
+			}
+		}
+		for (int k=0; k<nstate; k++)	{
+			total += waitingtime[k] * (*mat)(k,k);
+		}
+		for (unsigned int i=0; i<pairfrom.size(); i++)	{
+			const double* row = mat->GetRow(pairfrom[i]);
+			for (int m=pairstart[i]; m<pairstart[i+1]; m++)	{
+				total += paircount[m] * log(row[pairto[m]]);
+			}
+		}
+		return total;
+	}
+
+	private:
+
+	void PushPair(int from, int to, int count)	{
+		if (pairfrom.empty() || (pairfrom.back() != from))	{
+			pairfrom.push_back(from);
+			pairstart.push_back(pairstart.back());
+		}
+		pairto.push_back(to);
+		paircount.push_back(count);
+		pairstart.back()++;
+	}
+
+	int nstate;
+	int nroot;
+	vector<int> rootcount;
+	vector<double> waitingtime;
+	vector<int> pairfrom;
+	vector<int> pairstart;
+	vector<int> pairto;
+	vector<int> paircount;
+};
+
+#endif
+
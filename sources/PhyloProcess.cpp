@@ -146,7 +146,7 @@ void PhyloProcess::CreateConditionalLikelihoods()	{
 void PhyloProcess::GlobalResetAllConditionalLikelihoods()  {
 	assert(myid == 0);
 	MESSAGE signal = RESETALL;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveResetAllConditionalLikelihoods()	{
@@ -225,7 +225,7 @@ double PhyloProcess::ComputeNodeLikelihood(const Link* from, int auxindex)	{
 		cerr << "error : master doing slave's work\n";
 		exit(1);
 	}
-	double*** aux = 0;
+	condl_t*** aux = 0;
 	bool localaux = false;
 	if (auxindex != -1)	{
 		aux = condlmap[auxindex];
@@ -261,7 +261,7 @@ double PhyloProcess::ComputeNodeLikelihood(const Link* from, int auxindex)	{
 	return lnL;
 }
 
-void PhyloProcess::PostOrderPruning(const Link* from, double*** aux)	{
+void PhyloProcess::PostOrderPruning(const Link* from, condl_t*** aux)	{
 
 	if (from->isLeaf())	{
         Initialize(aux,GetData(from));
@@ -283,7 +283,7 @@ void PhyloProcess::PostOrderPruning(const Link* from, double*** aux)	{
 	}	
 }
 
-void PhyloProcess::PreOrderPruning(const Link* from, double*** aux)	{
+void PhyloProcess::PreOrderPruning(const Link* from, condl_t*** aux)	{
 
 	for (const Link* link=from->Next(); link!=from; link=link->Next())	{
 		Reset(aux);
@@ -308,6 +308,86 @@ void PhyloProcess::PreOrderPruning(const Link* from, double*** aux)	{
 	}
 }
 
+void PhyloProcess::ComputeSiteComponentLogL(int ncomp, double** sitelogl)	{
+
+	if (! ncomp)	{
+		return;
+	}
+	if (ncomp > sitecompncomp)	{
+		DeleteSiteComponentConditionalLikelihoods();
+		sitecompncomp = ncomp;
+	}
+	for (int i=sitemin; i<sitemax; i++)	{
+		if (ActiveSite(i))	{
+			PrepareSiteComponents(i,ncomp);
+			SiteComponentPostOrderPruning(i,ncomp,GetRoot(),0);
+			condl_t*** aux = GetSiteComponentVector(1);
+			SiteComponentMultiplyByStationaries(i,ncomp,aux);
+			for (int k=0; k<ncomp; k++)	{
+				sitelogl[i][k] = SiteComputeLikelihood(i,aux[k]);
+			}
+		}
+	}
+}
+
+void PhyloProcess::SiteComponentPostOrderPruning(int site, int ncomp, const Link* from, int depth)	{
+
+	condl_t*** aux = GetSiteComponentVector(depth+1);
+	if (from->isLeaf())	{
+		int state = GetData(from)[site];
+		for (int k=0; k<ncomp; k++)	{
+			SiteInitialize(site,aux[k],state);
+		}
+	}
+	else	{
+		for (int k=0; k<ncomp; k++)	{
+			SiteReset(site,aux[k]);
+		}
+		for (const Link* link=from->Next(); link!=from; link=link->Next())	{
+			SiteComponentPostOrderPruning(site,ncomp,link->Out(),depth+1);
+			condl_t*** prop = GetSiteComponentVector(0);
+			SiteComponentPropagate(site,ncomp,GetSiteComponentVector(depth+2),prop,GetLength(link->GetBranch()));
+			for (int k=0; k<ncomp; k++)	{
+				SiteMultiply(site,prop[k],aux[k]);
+			}
+		}
+		for (int k=0; k<ncomp; k++)	{
+			SiteOffset(site,aux[k]);
+		}
+	}
+}
+
+condl_t*** PhyloProcess::GetSiteComponentVector(int index)	{
+
+	while ((int) sitecompcondl.size() <= index)	{
+		int stride = GetGlobalNstate() + 1;
+		condl_t* alloc = new condl_t[sitecompncomp * GetMaxNrate() * stride];
+		condl_t*** condl = new condl_t**[sitecompncomp];
+		for (int k=0; k<sitecompncomp; k++)	{
+			condl[k] = new condl_t*[GetMaxNrate()];
+			for (int j=0; j<GetMaxNrate(); j++)	{
+				condl[k][j] = alloc + (k*GetMaxNrate() + j)*stride;
+			}
+		}
+		sitecompcondl.push_back(condl);
+	}
+	return sitecompcondl[index];
+}
+
+void PhyloProcess::DeleteSiteComponentConditionalLikelihoods()	{
+
+	for (unsigned int d=0; d<sitecompcondl.size(); d++)	{
+		condl_t*** condl = sitecompcondl[d];
+		delete[] condl[0][0];
+		for (int k=0; k<sitecompncomp; k++)	{
+			delete[] condl[k];
+		}
+		delete[] condl;
+	}
+	sitecompcondl.clear();
+	sitecompncomp = 0;
+}
+
 void PhyloProcess::GlobalRecursiveComputeLikelihood(const Link* from, int auxindex, vector<double>& logl)	{
 
 	double lnL = GlobalComputeNodeLikelihood(from,auxindex);
@@ -356,7 +436,7 @@ void PhyloProcess::RecursiveSimulateForward(const Link* from)	{
 }
 
 
-void PhyloProcess::SampleNodeStates(const Link* from, double*** aux)	{
+void PhyloProcess::SampleNodeStates(const Link* from, condl_t*** aux)	{
 	
 	if (from->isLeaf())	{
 		Initialize(aux,GetData(from));
@@ -468,7 +548,7 @@ double PhyloProcess::LocalBranchLengthMove(const Link* from, double tuning)	{
 	double newloglikelihood = GlobalComputeNodeLikelihood(from);
 	// double newloglikelihood = ComputeNodeLikelihood(from);
 	double newlogprior = LogBranchLengthPrior(from->GetBranch());
-	double delta = newlogprior + newloglikelihood - currentlogprior - currentloglikelihood + loghastings;
+	double delta = newlogprior + heat * newloglikelihood - currentlogprior - heat * currentloglikelihood + loghastings;
 	
 	int accepted = (log(rnd::GetRandom().Uniform()) < delta);
 	if (!accepted)	{
@@ -547,7 +627,7 @@ double PhyloProcess::LocalNonMPIBranchLengthMove(const Link* from, double tuning
 
 	double newloglikelihood = ComputeNodeLikelihood(from);
 	double newlogprior = LogBranchLengthPrior(from->GetBranch());
-	double delta = newlogprior + newloglikelihood - currentlogprior - currentloglikelihood + loghastings;
+	double delta = newlogprior + heat * newloglikelihood - currentlogprior - heat * currentloglikelihood + loghastings;
 	
 	int accepted = (log(rnd::GetRandom().Uniform()) < delta);
 	if (!accepted)	{
@@ -572,6 +652,23 @@ double PhyloProcess::MoveTopo(int spr, int nni){
 	return success;
 }
 
+double PhyloProcess::HeatedMove(double tuning)	{
+
+	// the moves based on the sufficient statistics of the substitution mappings
+	// (profiles, rates, branch lengths given the mapping, hyperparameters)
+	// sample from the untempered conditional posterior: they are not run here
+	if (! fixbl)	{
+		BranchLengthMove(tuning);
+		BranchLengthMove(0.1 * tuning);
+	}
+	if (! fixtopo)	{
+		MoveTopo(NSPR,NNNI);
+	}
+	// log likelihood of the current state, for the swaps between chains
+	GlobalUpdateConditionalLikelihoods();
+	return 1;
+}
+
 double PhyloProcess::GibbsSPR(int nrep)	{
 	// useless, assuming that preceding move maintains conditinal likelihoods correctly updated
 	GlobalUpdateConditionalLikelihoods();
@@ -599,7 +696,7 @@ double PhyloProcess::GibbsSPR(int nrep)	{
 	/*
 	MPI_Status stat;
 	MESSAGE signal = BCAST_TREE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	GlobalBroadcastTree();
 	*/
 	
@@ -702,7 +799,7 @@ void PhyloProcess::RecursiveGibbsSPRScan(Link* from, Link* fromup, Link* down, L
 
 	if (! from->isRoot())	{
 		GetTree()->Attach(down,up,from,fromup);
-		double*** aux = condlmap[0];
+		condl_t*** aux = condlmap[0];
 		Reset(aux);
 		for (const Link* link=up->Next(); link!=up; link=link->Next())	{
 			if (link->isRoot())	{
@@ -736,7 +833,7 @@ void PhyloProcess::RecursiveGibbsFillMap(Link* from, Link* fromup, map<pair<Link
 			cerr << "branch overflow\n";
 			exit(1);
 		}
-		loglmap[pair<Link*,Link*>(from,fromup)] = loglarray[n];
+		loglmap[pair<Link*,Link*>(from,fromup)] = heat * loglarray[n];
 		n++;
 	}
 	Link* trailer = from;
@@ -821,7 +918,7 @@ void PhyloProcess::RecursiveNonMPIGibbsSPRScan(Link* from, Link* fromup, Link* d
 
 	if (! from->isRoot())	{
 		GetTree()->Attach(down,up,from,fromup);
-		double*** aux = condlmap[0];
+		condl_t*** aux = condlmap[0];
 		Reset(aux);
 		for (const Link* link=up->Next(); link!=up; link=link->Next())	{
 			if (link->isRoot())	{
@@ -832,7 +929,7 @@ void PhyloProcess::RecursiveNonMPIGibbsSPRScan(Link* from, Link* fromup, Link* d
 		}
 		Propagate(aux,GetConditionalLikelihoodVector(up->Out()),GetLength(up->GetBranch()));
 		double logl = ComputeNodeLikelihood(up->Out(),0);
-		loglmap[pair<Link*,Link*>(from,fromup)] = logl;
+		loglmap[pair<Link*,Link*>(from,fromup)] = heat * logl;
 		GetTree()->Detach(down,up);
 		// Link* tmp1 = GetTree()->Detach(down,up);
 	}
@@ -875,7 +972,7 @@ void PhyloProcess::Create(Tree* intree, SequenceAlignment* indata,int indim)	{
 				submap[j] = 0;
 			}
 			nodestate = new int*[GetNnode()];
-			condlmap = new double***[GetNlink()];
+			condlmap = new condl_t***[GetNlink()];
 			CreateNodeStates();
 			CreateMissingMap();
 			CreateMappings();
@@ -1006,6 +1103,7 @@ void PhyloProcess::Delete() {
 		// MPI slaves only
 		if (myid > 0) {
 			DeleteConditionalLikelihoods();
+			DeleteSiteComponentConditionalLikelihoods();
 			DeleteNodeStates();
 			DeleteMappings();
 			delete[] submap;
@@ -1026,7 +1124,7 @@ void PhyloProcess::GlobalUnclamp()	{
 
 	assert(myid == 0);
 	MESSAGE signal = UNCLAMP;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	dataclamped = 0;
 }
 
@@ -1034,7 +1132,7 @@ void PhyloProcess::GlobalRestoreData()	{
 
 	assert(myid == 0);
 	MESSAGE signal = RESTOREDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	dataclamped = 1;
 }
 
@@ -1042,7 +1140,7 @@ void PhyloProcess::GlobalSetDataFromLeaves()	{
 
 	assert(myid == 0);
 	MESSAGE signal = SETDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int width = GetNsite()/(GetNprocs()-1);
 	int smin[GetNprocs()-1];
@@ -1061,7 +1159,7 @@ void PhyloProcess::GlobalSetDataFromLeaves()	{
 	int* tmp = new int[maxwidth * GetNtaxa()];
 
 	for(int i=0; i<GetNprocs()-1; ++i) {
-		MPI_Recv(tmp,(smax[i] - smin[i]) * GetNtaxa(),MPI_INT,i+1,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(tmp,(smax[i] - smin[i]) * GetNtaxa(),MPI_INT,i+1,TAG1,PROCESS_COMM,&stat);
 		int k = 0;
 		for (int l=0; l<GetNtaxa(); l++)	{
 			for (int j=smin[i]; j<smax[i]; j++)	{
@@ -1077,7 +1175,7 @@ void PhyloProcess::GlobalSetNodeStates()	{
 
 	assert(myid == 0);
 	MESSAGE signal = SETNODESTATES;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int width = GetNsite()/(GetNprocs()-1);
 	int smin[GetNprocs()-1];
@@ -1096,7 +1194,7 @@ void PhyloProcess::GlobalSetNodeStates()	{
 	int* tmp = new int[maxwidth * GetNnode()];
 
 	for(int i=0; i<GetNprocs()-1; ++i) {
-		MPI_Recv(tmp,(smax[i] - smin[i]) * GetNnode(),MPI_INT,i+1,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(tmp,(smax[i] - smin[i]) * GetNnode(),MPI_INT,i+1,TAG1,PROCESS_COMM,&stat);
 		int k = 0;
 		for (int l=0; l<GetNnode(); l++)	{
 			for (int j=smin[i]; j<smax[i]; j++)	{
@@ -1114,14 +1212,14 @@ double PhyloProcess::GlobalGetMeanDiversity()	{
 
 	assert(myid == 0);
 	MESSAGE signal = GETDIV;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	MPI_Status stat;
 
 	double total = 0;
 	for(int i=1; i<nprocs; ++i) {
 		double tmp;
-		MPI_Recv(&tmp,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(&tmp,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		total += tmp;
 	}
 	return total / GetNsite();
@@ -1131,14 +1229,14 @@ double PhyloProcess::GlobalGetMeanSquaredFreq()	{
 
 	assert(myid == 0);
 	MESSAGE signal = GETSQUAREDFREQ;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	MPI_Status stat;
 
 	double total = 0;
 	for(int i=1; i<nprocs; ++i) {
 		double tmp;
-		MPI_Recv(&tmp,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(&tmp,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		total += tmp;
 	}
 	return total / GetNsite();
@@ -1148,7 +1246,7 @@ double PhyloProcess::GlobalGetMeanFreqVariance()	{
 
 	assert(myid == 0);
 	MESSAGE signal = GETFREQVAR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	MPI_Status stat;
 
@@ -1160,7 +1258,7 @@ double PhyloProcess::GlobalGetMeanFreqVariance()	{
 
     double* tmp = new double[2*GetDim()];
 	for(int i=1; i<nprocs; ++i) {
-		MPI_Recv(tmp,2*GetDim(),MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(tmp,2*GetDim(),MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
         for (int k=0; k<GetDim(); k++)  {
             total1[k] += tmp[k];
             total2[k] += tmp[k+GetDim()];
@@ -1185,13 +1283,13 @@ void PhyloProcess::GlobalSetRatePrior(int inrateprior)	{
 	assert(myid == 0);
 	rateprior = inrateprior;
 	MESSAGE signal = SETRATEPRIOR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&rateprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&rateprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveSetRatePrior()	{
 
-	MPI_Bcast(&rateprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&rateprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalSetProfilePrior(int inprofileprior)	{
@@ -1199,13 +1297,13 @@ void PhyloProcess::GlobalSetProfilePrior(int inprofileprior)	{
 	assert(myid == 0);
 	profileprior = inprofileprior;
 	MESSAGE signal = SETPROFILEPRIOR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&profileprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&profileprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveSetProfilePrior()	{
 
-	MPI_Bcast(&profileprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&profileprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalSetRootPrior(int inrootprior)	{
@@ -1213,13 +1311,13 @@ void PhyloProcess::GlobalSetRootPrior(int inrootprior)	{
 	assert(myid == 0);
 	rootprior = inrootprior;
 	MESSAGE signal = SETROOTPRIOR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&rootprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&rootprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveSetRootPrior()	{
 
-	MPI_Bcast(&rootprior,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&rootprior,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveRestoreData()	{
@@ -1244,7 +1342,7 @@ void PhyloProcess::SlaveSetDataFromLeaves()	{
 			k++;
 		}
 	}
-	MPI_Send(tmp,(sitemax-sitemin)*GetNtaxa(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(tmp,(sitemax-sitemin)*GetNtaxa(),MPI_INT,0,TAG1,PROCESS_COMM);
 
 	delete[] tmp;
 
@@ -1261,7 +1359,7 @@ void PhyloProcess::SlaveSetNodeStates()	{
 			k++;
 		}
 	}
-	MPI_Send(tmp,(sitemax-sitemin)*GetNnode(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(tmp,(sitemax-sitemin)*GetNnode(),MPI_INT,0,TAG1,PROCESS_COMM);
 
 	delete[] tmp;
 
@@ -1271,14 +1369,14 @@ void PhyloProcess::SlaveSetNodeStates()	{
 void PhyloProcess::SlaveGetMeanDiversity()	{
 
 	double div = GetData()->GetTotalDiversity(sitemin,sitemax);
-	MPI_Send(&div,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&div,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 }
 
 void PhyloProcess::SlaveGetMeanSquaredFreq()	{
 
 	double div = GetData()->GetTotalSquaredFreq(sitemin,sitemax);
-	MPI_Send(&div,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&div,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 }
 
@@ -1289,7 +1387,7 @@ void PhyloProcess::SlaveGetMeanFreqVariance()	{
         m[k] = 0;
     }
 	GetData()->GetTotalFreqMoments(m,sitemin,sitemax);
-	MPI_Send(m,2*GetDim(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(m,2*GetDim(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
     delete[] m;
 }
 */
@@ -1299,7 +1397,7 @@ void PhyloProcess::GlobalSimulateForward()	{
 	// MPI
 	assert(myid == 0);
 	MESSAGE signal = SIMULATE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 }
 
 
@@ -1310,7 +1408,7 @@ void PhyloProcess::GlobalUnfold()	{
 	GlobalUpdateParameters();
 
 	MESSAGE signal = UNFOLD;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	GlobalUpdateConditionalLikelihoods();
 }
@@ -1323,7 +1421,7 @@ void PhyloProcess::GlobalCollapse()	{
 	// conflag = false;
 	assert(myid == 0);
 	MESSAGE signal = COLLAPSE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	CreateSuffStat();
 }
@@ -1337,9 +1435,9 @@ double PhyloProcess::GlobalComputeNodeLikelihood(const Link* from, int auxindex)
 	assert(myid == 0);
 	MESSAGE signal = LIKELIHOOD;
 	MPI_Status stat;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int i,args[] = {GetLinkIndex(from),auxindex};
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 	// master : sums up all values sent by slaves
 	// store this sum into member variable logL
 	// and return it
@@ -1347,7 +1445,7 @@ double PhyloProcess::GlobalComputeNodeLikelihood(const Link* from, int auxindex)
 	logL = 0.0;
 	double sum;
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(&sum,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(&sum,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		logL += sum;
 	}
 	return logL;
@@ -1362,10 +1460,10 @@ void PhyloProcess::GlobalReset(const Link* link, bool condalloc)	{
 	assert(myid == 0);
 	MESSAGE signal = RESET;
 	int args[2];
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	args[0] = GetLinkIndex(link);
 	args[1] = (condalloc) ? 1 : 0;
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 }
 
 
@@ -1378,11 +1476,11 @@ void PhyloProcess::GlobalMultiply(const Link* from, const Link* to, bool condall
 	assert(myid == 0);
 	MESSAGE signal = MULTIPLY;
 	int args[3];
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	args[0] = GetLinkIndex(from);
 	args[1] = GetLinkIndex(to);
 	args[2] = (condalloc) ? 1 : 0;
-	MPI_Bcast(args,3,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,3,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalMultiplyByStationaries(const Link* from, bool condalloc)	{
@@ -1391,10 +1489,10 @@ void PhyloProcess::GlobalMultiplyByStationaries(const Link* from, bool condalloc
 	assert(myid == 0);
 	MESSAGE signal = SMULTIPLY;
 	int args[2];
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	args[0] = GetLinkIndex(from);
 	args[1] = (condalloc) ? 1 : 0;
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalInitialize(const Link* from, const Link* link, bool condalloc)	{
@@ -1403,11 +1501,11 @@ void PhyloProcess::GlobalInitialize(const Link* from, const Link* link, bool con
 	assert(myid == 0);
 	MESSAGE signal = INITIALIZE;
 	int args[3];
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	args[0] = GetLinkIndex(from);
 	args[1] = GetLinkIndex(link);
 	args[2] = (condalloc) ? 1 : 0;
-	MPI_Bcast(args,3,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,3,MPI_INT,0,PROCESS_COMM);
 }
 
 
@@ -1416,13 +1514,13 @@ void PhyloProcess::GlobalPropagate(const Link* from, const Link* to, double time
 	// MPI
 	assert(myid == 0);
 	MESSAGE signal = PROPAGATE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
     int args[3];
 	args[0] = GetLinkIndex(from);
 	args[1] = GetLinkIndex(to);
 	args[2] = (condalloc) ? 1 : 0;
-	MPI_Bcast(args,3,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&time,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,3,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&time,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 double PhyloProcess::GlobalProposeMove(const Branch* branch, double tuning)	{
@@ -1433,11 +1531,11 @@ double PhyloProcess::GlobalProposeMove(const Branch* branch, double tuning)	{
 	// slaves should interpret the message, and apply on branch with index received as message argument
 	assert(myid == 0);
 	MESSAGE signal = PROPOSE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	double m = tuning * (rnd::GetRandom().Uniform() - 0.5);
 	int index = branch->GetIndex();
-	MPI_Bcast(&index,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&m,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&index,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&m,1,MPI_DOUBLE,0,PROCESS_COMM);
 	MoveBranch(branch,m);
 	return m;
 }
@@ -1448,9 +1546,9 @@ void PhyloProcess::GlobalRestore(const Branch* branch)	{
 	// master and all slaves should all call RestoreBranch(branch)
 	assert(myid == 0);
 	MESSAGE signal = RESTORE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int n = branch->GetIndex();
-	MPI_Bcast(&n,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&n,1,MPI_INT,0,PROCESS_COMM);
 	Restore(branch);
 }
 
@@ -1460,7 +1558,7 @@ void PhyloProcess::GlobalUpdateConditionalLikelihoods()	{
 	// just send Updateconlikelihood message to all slaves
 	assert(myid == 0);
 	MESSAGE signal = UPDATE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	GlobalComputeNodeLikelihood(GetRoot(),0);
 	// GlobalCheckLikelihood();
@@ -1474,10 +1572,10 @@ Link* PhyloProcess::GlobalDetach(Link* down, Link* up)	{
 	// but message passing will again  use link to index, then index to link, translations.
 	assert(myid == 0);
 	MESSAGE signal = DETACH;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int args[] = {GetLinkIndex(down),GetLinkIndex(up)};
 	// int args[] = {down->GetIndex(),up->GetIndex(),fromdown->GetIndex(),fromup->GetIndex()};
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 	return GetTree()->Detach(down,up);
 }
 
@@ -1487,10 +1585,10 @@ void PhyloProcess::GlobalAttach(Link* down, Link* up, Link* fromdown, Link* from
 	// same thing as for detach
 	assert(myid == 0);
 	MESSAGE signal = ATTACH;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int args[] = {GetLinkIndex(down),GetLinkIndex(up),GetLinkIndex(fromdown),GetLinkIndex(fromup)};
 	// int args[] = {down->GetIndex(),up->GetIndex(),fromdown->GetIndex(),fromup->GetIndex()};
-	MPI_Bcast(args,4,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(args,4,MPI_INT,0,PROCESS_COMM);
 	GetTree()->Attach(down,up,fromdown,fromup);
 }
 
@@ -1508,8 +1606,8 @@ void PhyloProcess::GlobalRootAtRandom()	{
 	// MPI
 	// call slaves, send a reroot message with argument newroot
 	MESSAGE signal = ROOT;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&choose,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&choose,1,MPI_INT,0,PROCESS_COMM);
 
 	Link* tmp = 0;
 	Link* newroot = GetTree()->ChooseInternalNode(GetRoot(),tmp,choose);
@@ -1532,8 +1630,8 @@ void PhyloProcess::GlobalGibbsSPRScan(Link* down, Link* up, double* loglarray)
 	args[1] = GetLinkIndex(up);
 
 	// MPI3 : send message : GibbsSPRScan(idown,iup);
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(args,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(args,2,MPI_INT,0,PROCESS_COMM);
 
 	//
 	// gather all slaves'arrays
@@ -1545,7 +1643,7 @@ void PhyloProcess::GlobalGibbsSPRScan(Link* down, Link* up, double* loglarray)
 		loglarray[i] = 0.0;
 	}
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(dvector,nbranch,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(dvector,nbranch,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
 		for(j=0; j<nbranch; ++j) {
 			loglarray[j] += dvector[j];
 		}
@@ -1567,8 +1665,11 @@ void PhyloProcess::GlobalGibbsSPRScan(Link* down, Link* up, double* loglarray)
 void PhyloProcess::WaitLoop()	{
 	MESSAGE signal;
 	do {
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		if (signal == KILL) break;
+		// all slaves receive the same messages, in the same order:
+		// counting them gives an epoch that is common to all processes
+		rnd::GetRandom().NextEpoch();
 		SlaveExecute(signal);
 	} while(true);
 }
@@ -1594,24 +1695,24 @@ void PhyloProcess::SlaveExecute(MESSAGE signal)	{
 		SlaveSetRootPrior();
 		break;
 	case ROOT:
-		MPI_Bcast(&n,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&n,1,MPI_INT,0,PROCESS_COMM);
 		SlaveRoot(n);
 		break;
 	case LIKELIHOOD:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		SlaveLikelihood(arg[0],arg[1]);
 		break;
 	case SCAN:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		SlaveGibbsSPRScan(arg[0],arg[1]);
 		break;
 	case PROPOSE:
-		MPI_Bcast(&branchindex,1,MPI_INT,0,MPI_COMM_WORLD);
-		MPI_Bcast(&time,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(&branchindex,1,MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(&time,1,MPI_DOUBLE,0,PROCESS_COMM);
 		SlavePropose(branchindex,time);
 		break;
 	case RESTORE:
-		MPI_Bcast(&n,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&n,1,MPI_INT,0,PROCESS_COMM);
 		SlaveRestore(n);
 		break;
     case PREPARESTEPPING:
@@ -1621,7 +1722,7 @@ void PhyloProcess::SlaveExecute(MESSAGE signal)	{
         SlaveSetSteppingFraction();
         break;
 	case RESET:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		tvalue = (arg[1] == 1) ? true : false;
 		SlaveReset(arg[0],tvalue);
 		break;
@@ -1629,44 +1730,44 @@ void PhyloProcess::SlaveExecute(MESSAGE signal)	{
         SlaveResetAllConditionalLikelihoods();
         break;
 	case MULTIPLY:
-		MPI_Bcast(arg,3,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,3,MPI_INT,0,PROCESS_COMM);
 		tvalue = (arg[2] == 1) ? true : false;
 		SlaveMultiply(arg[0],arg[1],tvalue);
 		break;
 	case SMULTIPLY:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		tvalue = (arg[1] == 1) ? true : false;
 		SlaveSMultiply(arg[0],tvalue);
 		break;
 	case INITIALIZE:
-		MPI_Bcast(arg,3,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,3,MPI_INT,0,PROCESS_COMM);
 		tvalue = (arg[2] == 1) ? true : false;
 		SlaveInitialize(arg[0],arg[1],tvalue);
 		break;
 	case PROPAGATE:
-		MPI_Bcast(arg,3,MPI_INT,0,MPI_COMM_WORLD);
-		MPI_Bcast(&time,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,3,MPI_INT,0,PROCESS_COMM);
+		MPI_Bcast(&time,1,MPI_DOUBLE,0,PROCESS_COMM);
 		tvalue = (arg[2] == 1) ? true : false;
 		SlavePropagate(arg[0], arg[1], tvalue, time);
 		break;
 	case ATTACH:
-		MPI_Bcast(arg,4,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,4,MPI_INT,0,PROCESS_COMM);
 		SlaveAttach(arg[0],arg[1],arg[2],arg[3]);
 		break;
 	case DETACH:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		SlaveDetach(arg[0],arg[1]);
 		break;
 	case NNI:
-		MPI_Bcast(arg,2,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,2,MPI_INT,0,PROCESS_COMM);
 		SlaveNNI(GetLinkForGibbs(arg[0]),arg[1]);
 		break;
 	case KNIT:
-		MPI_Bcast(arg,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,1,MPI_INT,0,PROCESS_COMM);
 		GetLinkForGibbs(arg[0])->Knit();
 		break;
 	case BRANCHPROPAGATE:
-		MPI_Bcast(arg,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(arg,1,MPI_INT,0,PROCESS_COMM);
 		PropagateOverABranch(GetLinkForGibbs(arg[0]));
 		break;
 	case UNFOLD:
@@ -1725,12 +1826,18 @@ void PhyloProcess::SlaveExecute(MESSAGE signal)	{
 	case STEPPINGSITELOGL:
 		SlaveGetSiteSteppingLogLikelihood();
 		break;
+	case STEPPINGLOGL:
+		SlaveGetSteppingLogLikelihood();
+		break;
 	case STATEPOSTPROBS:
 		SlaveComputeStatePostProbs();
 		break;
 	case SITERATE:
 		SlaveSendMeanSiteRate();
 		break;
+	case DIAGCOUNT:
+		SlaveSendDiagCount();
+		break;
 	case SETTESTDATA:
 		SlaveSetTestData();
 		break;
@@ -1775,7 +1882,7 @@ void PhyloProcess::SlaveRoot(int n) {
 void PhyloProcess::SlaveLikelihood(int fromindex,int auxindex) {
 	assert(myid > 0);
 	double lvalue = ComputeNodeLikelihood(GetLinkForGibbs(fromindex),auxindex);
-	MPI_Send(&lvalue,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&lvalue,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveGibbsSPRScan(int idown, int iup)	{
@@ -1787,7 +1894,7 @@ void PhyloProcess::SlaveGibbsSPRScan(int idown, int iup)	{
 	RecursiveGibbsSPRScan(GetRoot(),GetRoot(),down,up,loglarray,n);
 
 	// MPI3 : send loglarray
-	MPI_Send(loglarray,GetNbranch(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(loglarray,GetNbranch(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }
 
 void PhyloProcess::SlavePropose(int n,double x) {
@@ -1872,7 +1979,7 @@ void PhyloProcess::GlobalUpdateBranchLengthSuffStat()	{
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_BLENGTH;
 
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	for(i=0; i<nbranch; ++i) {
 		branchlengthsuffstatcount[i] = 0;
@@ -1882,14 +1989,14 @@ void PhyloProcess::GlobalUpdateBranchLengthSuffStat()	{
 	int ivector[nbranch];
 	double dvector[nbranch];
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(ivector,nbranch,MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(ivector,nbranch,MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 		for(j=0; j<nbranch; ++j) {
 			branchlengthsuffstatcount[j] += ivector[j];
 		}
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(PROCESS_COMM);
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(dvector,nbranch,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(dvector,nbranch,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 		for(j=0; j<nbranch; ++j) {
 			branchlengthsuffstatbeta[j] += dvector[j];
 		}
@@ -1923,15 +2030,15 @@ void PhyloProcess::SlaveUpdateBranchLengthSuffStat()	{
 		cerr << "error at root in slave " << GetMyid() << "\n";
 		cerr << branchlengthsuffstatbeta[0] << '\n';
 	}
-	MPI_Send(branchlengthsuffstatcount,GetNbranch(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Send(branchlengthsuffstatbeta,GetNbranch(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(branchlengthsuffstatcount,GetNbranch(),MPI_INT,0,TAG1,PROCESS_COMM);
+	MPI_Barrier(PROCESS_COMM);
+	MPI_Send(branchlengthsuffstatbeta,GetNbranch(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalUpdateSiteRateSuffStat()	{
 
 	MESSAGE signal = UPDATE_SRATE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 }
 
 void PhyloProcess::SlaveUpdateSiteRateSuffStat()	{
@@ -1956,7 +2063,7 @@ void PhyloProcess::GlobalGetMeanSiteRate()	{
 	MPI_Status stat;
 	MESSAGE signal = SITERATE;
 
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	width = GetNsite()/(nprocs-1);
 	for(i=0; i<nprocs-1; ++i) {
@@ -1965,13 +2072,39 @@ void PhyloProcess::GlobalGetMeanSiteRate()	{
 		if (i == (nprocs-2)) smax[i] = GetNsite();
 	}
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(meansiterate+smin[i-1],smax[i-1]-smin[i-1],MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(meansiterate+smin[i-1],smax[i-1]-smin[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 	}
 }
 
 void PhyloProcess::SlaveSendMeanSiteRate()	{
 	assert(myid > 0);
-	MPI_Send(meansiterate+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansiterate+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+}
+
+void PhyloProcess::GlobalGetDiagCount(int& ndiag, int& nreuse)	{
+
+	assert(myid == 0);
+	MESSAGE signal = DIAGCOUNT;
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+
+	int count[2];
+	count[0] = SubMatrix::GetDiagCount();
+	count[1] = SubMatrix::GetDiagReuseCount();
+	SubMatrix::ResetDiagCount();
+	int tot[2];
+	MPI_Reduce(count,tot,2,MPI_INT,MPI_SUM,0,PROCESS_COMM);
+	ndiag = tot[0];
+	nreuse = tot[1];
+}
+
+void PhyloProcess::SlaveSendDiagCount()	{
+
+	assert(myid > 0);
+	int count[2];
+	count[0] = SubMatrix::GetDiagCount();
+	count[1] = SubMatrix::GetDiagReuseCount();
+	SubMatrix::ResetDiagCount();
+	MPI_Reduce(count,0,2,MPI_INT,MPI_SUM,0,PROCESS_COMM);
 }
 
 void PhyloProcess::GlobalBroadcastTree()	{
@@ -1986,8 +2119,8 @@ void PhyloProcess::GlobalBroadcastTree()	{
 	for (unsigned int i=0; i<len; i++)	{
 		bvector[i] = s[i];
 	}
-	MPI_Bcast(&len,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,MPI_COMM_WORLD);
+	MPI_Bcast(&len,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,PROCESS_COMM);
 	delete[] bvector;
 
 }
@@ -1996,9 +2129,9 @@ void PhyloProcess::GlobalBroadcastTree()	{
 void PhyloProcess::SlaveBroadcastTree()	{
 
 	int len;
-	MPI_Bcast(&len,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&len,1,MPI_INT,0,PROCESS_COMM);
 	unsigned char* bvector = new unsigned char[len];
-	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,MPI_COMM_WORLD);
+	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,PROCESS_COMM);
 	ostringstream os;
 	for (int i=0; i<len; i++)	{
 		os << bvector[i];
@@ -2016,6 +2149,223 @@ void PhyloProcess::ReadPB(int argc, char* argv[])	{
 	exit(1);
 }
 
+void PhyloProcess::MakeChainSchedule(string name, int burnin, int every, int until)	{
+
+	// samples: burnin, burnin + every, burnin + 2*every, ... < until
+	// sample number s goes to group s % NGROUP
+	chainpoint.clear();
+	int s = 0;
+	for (int i=burnin; i<until; i+=every)	{
+		if ((s % NGROUP) == GROUPID)	{
+			chainpoint.push_back(i);
+		}
+		s++;
+	}
+	nextpoint = 0;
+	chainpos = 0;
+
+	// the index (offset and size of each point, see Model::Run) can be used only if its entries
+	// exactly tile the .chain file, from the very first point up to the end of the file:
+	// the .chain and .chainindex appends are not atomic together, and after an interrupted run,
+	// an entry missing or left over would otherwise shift all subsequent points
+	chainindex.clear();
+	ifstream xis((name + ".chainindex").c_str());
+	ifstream cis((name + ".chain").c_str(), ios_base::ate);
+	bool valid = false;
+	if (xis && cis)	{
+		streamoff chainsize = cis.tellg();
+		streamoff offset, size;
+		streamoff next = 0;
+		valid = true;
+		while (valid && (xis >> offset >> size))	{
+			if ((offset != next) || (size <= 0))	{
+				valid = false;
+			}
+			else	{
+				chainindex.push_back(offset);
+				next = offset + size;
+			}
+		}
+		if (next != chainsize)	{
+			valid = false;
+		}
+		if ((! valid) && (! myid) && (! GROUPID))	{
+			cerr << "warning: " << name << ".chainindex does not match " << name << ".chain (interrupted run?); the chain will be parsed sequentially\n";
+		}
+	}
+	if ((! valid) || ((int) chainindex.size() < until))	{
+		chainindex.clear();
+	}
+	if ((NGROUP > 1) && (! chainindex.size()) && (! myid) && (! GROUPID))	{
+		cerr << "warning: no valid " << name << ".chainindex; each group will parse the chain sequentially\n";
+	}
+}
+
+bool PhyloProcess::ReadNextPoint(istream& is)	{
+
+	if (nextpoint == (int) chainpoint.size())	{
+		return false;
+	}
+	int target = chainpoint[nextpoint];
+	if (chainindex.size())	{
+		is.clear();
+		is.seekg(chainindex[target]);
+	}
+	else	{
+		while (chainpos < target)	{
+			FromStream(is);
+			chainpos++;
+		}
+	}
+	FromStream(is);
+	chainpos = target + 1;
+	nextpoint++;
+	return true;
+}
+
+int PhyloProcess::GroupReduceSum(int n)	{
+
+	if (NGROUP == 1)	{
+		return n;
+	}
+	int tot = 0;
+	MPI_Reduce(&n,&tot,1,MPI_INT,MPI_SUM,0,MASTER_COMM);
+	return tot;
+}
+
+void PhyloProcess::GroupReduceSum(double* array, int n)	{
+
+	if (NGROUP == 1)	{
+		return;
+	}
+	double* tmp = new double[n];
+	MPI_Reduce(array,tmp,n,MPI_DOUBLE,MPI_SUM,0,MASTER_COMM);
+	if (! GROUPID)	{
+		for (int j=0; j<n; j++)	{
+			array[j] = tmp[j];
+		}
+	}
+	delete[] tmp;
+}
+
+void PhyloProcess::GroupGatherSamples(vector<double>* series, int n)	{
+
+	if (NGROUP == 1)	{
+		return;
+	}
+
+	int localsize = n ? series[0].size() : 0;
+	int groupsize[NGROUP];
+	MPI_Gather(&localsize,1,MPI_INT,groupsize,1,MPI_INT,0,MASTER_COMM);
+
+	double* sendbuf = new double[n*localsize + 1];
+	for (int j=0; j<n; j++)	{
+		for (int k=0; k<localsize; k++)	{
+			sendbuf[j*localsize + k] = series[j][k];
+		}
+	}
+
+	int count[NGROUP];
+	int displ[NGROUP];
+	int total = 0;
+	double* recvbuf = 0;
+	if (! GROUPID)	{
+		for (int g=0; g<NGROUP; g++)	{
+			count[g] = n*groupsize[g];
+			displ[g] = total;
+			total += count[g];
+		}
+		recvbuf = new double[total + 1];
+	}
+
+	MPI_Gatherv(sendbuf,n*localsize,MPI_DOUBLE,recvbuf,count,displ,MPI_DOUBLE,0,MASTER_COMM);
+
+	if (! GROUPID)	{
+		int nsample = 0;
+		for (int g=0; g<NGROUP; g++)	{
+			nsample += groupsize[g];
+		}
+		for (int j=0; j<n; j++)	{
+			series[j].assign(nsample,0);
+			for (int g=0; g<NGROUP; g++)	{
+				for (int k=0; k<groupsize[g]; k++)	{
+					series[j][g + NGROUP*k] = recvbuf[displ[g] + j*groupsize[g] + k];
+				}
+			}
+		}
+		delete[] recvbuf;
+	}
+	delete[] sendbuf;
+}
+
+void PhyloProcess::GroupMergeSiteLogL(SiteLogLStat* sitestat)	{
+
+	if (NGROUP == 1)	{
+		return;
+	}
+
+	int n = GetNsite() * SiteLogLStat::dim;
+	double* sendbuf = new double[n];
+	for (int i=0; i<GetNsite(); i++)	{
+		sitestat[i].ToArray(sendbuf + i*SiteLogLStat::dim);
+	}
+	double* recvbuf = 0;
+	if (! GROUPID)	{
+		recvbuf = new double[NGROUP*n];
+	}
+	MPI_Gather(sendbuf,n,MPI_DOUBLE,recvbuf,n,MPI_DOUBLE,0,MASTER_COMM);
+
+	if (! GROUPID)	{
+		for (int g=1; g<NGROUP; g++)	{
+			for (int i=0; i<GetNsite(); i++)	{
+				SiteLogLStat from;
+				from.FromArray(recvbuf + g*n + i*SiteLogLStat::dim);
+				sitestat[i].Merge(from);
+			}
+		}
+		delete[] recvbuf;
+	}
+	delete[] sendbuf;
+}
+
+string PhyloProcess::GetSiteLogLFileName(string name, int group)	{
+
+	if (NGROUP == 1)	{
+		return name + ".mcmcsitelogls";
+	}
+	ostringstream s;
+	s << name << ".mcmcsitelogls." << group;
+	return s.str();
+}
+
+void PhyloProcess::MergeSiteLogLFiles(string name)	{
+
+	// all groups have closed their file before the (collective) merge of the site summaries
+	ifstream* gis = new ifstream[NGROUP];
+	for (int g=0; g<NGROUP; g++)	{
+		gis[g].open(GetSiteLogLFileName(name,g).c_str());
+	}
+	ofstream os((name + ".mcmcsitelogls").c_str());
+	string line;
+	bool more = true;
+	while (more)	{
+		for (int g=0; (g<NGROUP) && more; g++)	{
+			if (getline(gis[g],line))	{
+				os << line << '\n';
+			}
+			else	{
+				more = false;
+			}
+		}
+	}
+	// samples are dealt round-robin: once a group runs out, later groups have no more rows either
+	for (int g=0; g<NGROUP; g++)	{
+		gis[g].close();
+		remove(GetSiteLogLFileName(name,g).c_str());
+	}
+	delete[] gis;
+}
+
 void PhyloProcess::Read(string name, int burnin, int every, int until)	{
 
 	ifstream is((name + ".chain").c_str());
@@ -2079,11 +2429,7 @@ void PhyloProcess::ReadSiteRates(string name, int burnin, int every, int until)
 
 	cerr << "burnin : " << burnin << "\n";
 	cerr << "until : " << until << '\n';
-	int i=0;
-	while ((i < until) && (i < burnin))	{
-		FromStream(is);
-		i++;
-	}
+	MakeChainSchedule(name,burnin,every,until);
 	int samplesize = 0;
 
 	double* meanrate = new double[GetNsite()];
@@ -2091,12 +2437,10 @@ void PhyloProcess::ReadSiteRates(string name, int burnin, int every, int until)
 		meanrate[i] = 0;
 	}
 
-	while (i < until)	{
+	while (ReadNextPoint(is))	{
 		cerr << ".";
 		cerr.flush();
 		samplesize++;
-		FromStream(is);
-		i++;
 
 		QuickUpdate();
 
@@ -2107,15 +2451,16 @@ void PhyloProcess::ReadSiteRates(string name, int burnin, int every, int until)
 			// meansiterate[i] *= length;
 			meanrate[i] += meansiterate[i];
 		}
-
-		int nrep = 1;
-		while ((i<until) && (nrep < every))	{
-			FromStream(is);
-			i++;
-			nrep++;
-		}
 	}
 	cerr << '\n';
+
+	samplesize = GroupReduceSum(samplesize);
+	GroupReduceSum(meanrate,GetNsite());
+	if (GROUPID)	{
+		delete[] meanrate;
+		return;
+	}
+
 	ofstream os((name + ".meansiterates").c_str());
 	for (int i=0; i<GetNsite(); i++)	{
 		meanrate[i] /= samplesize;
@@ -2181,7 +2526,7 @@ void PhyloProcess::AllPostPred(string name, int burnin, int every, int until, in
 		i++;
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalUnclamp();
@@ -2357,7 +2702,7 @@ void PhyloProcess::PostPred(int ppredtype, string name, int burnin, int every, i
 		}
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalUnclamp();
@@ -2502,18 +2847,18 @@ void PhyloProcess::GlobalSetTestData()	{
 	testdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
 
 void PhyloProcess::SlaveSetTestData()	{
 
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnsite * GetNtaxa()];
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 	
 	SetTestSiteMinAndMax();
 	data->SetTestData(testnsite,sitemin,testsitemin,testsitemax,tmp);
@@ -2540,43 +2885,36 @@ void PhyloProcess::ReadCV(string testdatafile, string name, int burnin, int ever
 
 	cerr << "burnin: " << burnin << '\n';
 	cerr << "every " << every << " points until " << until << '\n';
-	int i=0;
-	while ((i < until) && (i < burnin))	{
-		FromStream(is);
-		i++;
-	}
+	MakeChainSchedule(name,burnin,every,until);
 	int samplesize = 0;
 	vector<double> scorelist;
 
-	while (i < until)	{
+	while (ReadNextPoint(is))	{
 		cerr << ".";
 		samplesize++;
-		FromStream(is);
-		i++;
 		QuickUpdate();
 		MPI_Status stat;
 		MESSAGE signal = CVSCORE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 		double tmp = 0;
 		double score = 0;
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(&tmp,1,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(&tmp,1,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 			score += tmp;
 		}
 		scorelist.push_back(score);
 		// cerr << score << '\n';
-		
-		int nrep = 1;
-		while ((i<until) && (nrep < every))	{
-			FromStream(is);
-			i++;
-			nrep++;
-		}
 	}
 
 	cerr << '\n';
 
+	GroupGatherSamples(&scorelist,1);
+	if (GROUPID)	{
+		return;
+	}
+	samplesize = scorelist.size();
+
 	double max = 0;
 	for (int j=0; j<samplesize; j++)	{
 		if ((!j) || (max < scorelist[j]))	{
@@ -2616,11 +2954,7 @@ void PhyloProcess::ReadSiteCV(string testdatafile, string name, int burnin, int
 
 	cerr << "burnin: " << burnin << '\n';
 	cerr << "every " << every << " points until " << until << '\n';
-	int i=0;
-	while ((i < until) && (i < burnin))	{
-		FromStream(is);
-		i++;
-	}
+	MakeChainSchedule(name,burnin,every,until);
 	int samplesize = 0;
 
     int testwidth = testnsite/(nprocs-1);
@@ -2647,19 +2981,18 @@ void PhyloProcess::ReadSiteCV(string testdatafile, string name, int burnin, int
 	double* tmp = new double[GetNsite()];
 	vector<double>* logl = new vector<double>[testnsite];
 
-	while (i < until)	{
+	while (ReadNextPoint(is))	{
 		cerr << ".";
 		samplesize++;
-		FromStream(is);
-		i++;
 		QuickUpdate();
 		MPI_Status stat;
 		MESSAGE signal = SITELOGL;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
         int count = 0;
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmp,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+			// slaves send their whole slice of training sites, of which the first smax-smin hold the test sites
+			MPI_Recv(tmp+smin[i-1],GetNsite()-smin[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 			for (int j=smin[i-1]; j<smax[i-1]; j++)	{
 				if (std::isnan(tmp[j]))	{
 					cerr << "error: nan logl received by master\n";
@@ -2675,16 +3008,17 @@ void PhyloProcess::ReadSiteCV(string testdatafile, string name, int burnin, int
             cerr << "error in read site cv: non matching number of sites (testnsite)\n";
             exit(1);
         }
-		
-		int nrep = 1;
-		while ((i<until) && (nrep < every))	{
-			FromStream(is);
-			i++;
-			nrep++;
-		}
 	}
     cerr << '\n';
 
+	GroupGatherSamples(logl,testnsite);
+	if (GROUPID)	{
+		delete[] logl;
+		delete[] tmp;
+		return;
+	}
+	samplesize = testnsite ? logl[0].size() : 0;
+
     /*
     ofstream sos((name + ".cvsitelogl").c_str());
     for (int j=0; j<samplesize; j++)    {
@@ -2803,19 +3137,13 @@ void PhyloProcess::ReadSiteLogL(string name, int burnin, int every, int until, i
 
 	cerr << "burnin: " << burnin << '\n';
 	cerr << "every " << every << " points until " << until << '\n';
-	int i=0;
-	while ((i < until) && (i < burnin))	{
-		FromStream(is);
-		i++;
-	}
+	MakeChainSchedule(name,burnin,every,until);
 	int samplesize = 0;
 
-    // posterior mean and variance (across the chain) of site-specific logls
-    vector<double> site_postmeanlogl(GetNsite(),0);
-    vector<double> site_postvarlogl(GetNsite(),0);
-
+	// site logls are summarized on the fly (see SiteLogLStat.h)
+	// so that memory does not grow with the number of points read from the chain
+	SiteLogLStat* sitestat = new SiteLogLStat[GetNsite()];
 	double* tmp = new double[GetNsite()];
-	vector<double>* logl = new vector<double>[GetNsite()];
 
 	int width = GetNsite()/(GetNprocs()-1);
 	int smin[GetNprocs()-1];
@@ -2830,19 +3158,23 @@ void PhyloProcess::ReadSiteLogL(string name, int burnin, int every, int until, i
 		}
 	}
 
-	while (i < until)	{
+	// in verbose mode, the raw site logls are written out as they come
+	// (one file per group if the chain is shared among several groups, merged at the end)
+	ofstream* sos = 0;
+	if (verbose)	{
+		sos = new ofstream(GetSiteLogLFileName(name,GROUPID).c_str());
+	}
+
+	while (ReadNextPoint(is))	{
 		cerr << ".";
 		samplesize++;
-		FromStream(is);
-		i++;
 		QuickUpdate();
 		MPI_Status stat;
 		MESSAGE signal = SITELOGL;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
-		double total = 0;
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmp,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmp+smin[i-1],smax[i-1]-smin[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
 			for (int j=smin[i-1]; j<smax[i-1]; j++)	{
 				if (std::isnan(tmp[j]))	{
 					cerr << "error: nan logl received by master\n";
@@ -2850,43 +3182,50 @@ void PhyloProcess::ReadSiteLogL(string name, int burnin, int every, int until, i
 					cerr << "proc : " << i << '\n';
 					exit(1);
 				}
-				logl[j].push_back(tmp[j]);
-				site_postmeanlogl[j] += tmp[j];
-                site_postvarlogl[j] += tmp[j]*tmp[j];
-				total += tmp[j];
+				sitestat[j].Add(tmp[j]);
 			}
 		}
-		
-		int nrep = 1;
-		while ((i<until) && (nrep < every))	{
-			FromStream(is);
-			i++;
-			nrep++;
+		if (sos)	{
+			for (int j=0; j<GetNsite(); j++)	{
+				(*sos) << tmp[j] << '\t';
+			}
+			(*sos) << '\n';
 		}
 	}
     cerr << '\n';
+	delete[] tmp;
 
-    if (verbose)    {
-        ofstream sos((name + ".mcmcsitelogls").c_str());
-        for (int j=0; j<samplesize; j++)    {
-            for (int i=0; i<GetNsite(); i++) {
-                sos << logl[i][j] << '\t';
-            }
-            sos << '\n';
-        }
+	if (sos)	{
+		sos->close();
+		delete sos;
+	}
 
+	GroupMergeSiteLogL(sitestat);
+	if (GROUPID)	{
+		delete[] sitestat;
+		return;
+	}
+	samplesize = GetNsite() ? sitestat[0].GetCount() : 0;
+
+    if (verbose)    {
+		if (NGROUP > 1)	{
+			MergeSiteLogLFiles(name);
+		}
         cerr << "site log likelihoods over the mcmc in " << name << ".mcmcsitelogls\n";
     }
 
+    // posterior mean and variance (across the chain) of site-specific logls
+    vector<double> site_postmeanlogl(GetNsite(),0);
+    vector<double> site_postvarlogl(GetNsite(),0);
+
     double mean_postmeanlogl = 0;
     double var_postmeanlogl = 0;
     double mean_postvarlogl = 0;
     double var_postvarlogl = 0;
 
     for (int i=0; i<GetNsite(); i++)    {
-        site_postmeanlogl[i] /= samplesize;
-        site_postvarlogl[i] /= samplesize;
-        site_postvarlogl[i] -= site_postmeanlogl[i] * site_postmeanlogl[i];
+        site_postmeanlogl[i] = sitestat[i].GetMean();
+        site_postvarlogl[i] = sitestat[i].GetVar();
         mean_postmeanlogl += site_postmeanlogl[i];
         var_postmeanlogl += site_postmeanlogl[i] * site_postmeanlogl[i];
         mean_postvarlogl += site_postvarlogl[i];
@@ -2926,66 +3265,29 @@ void PhyloProcess::ReadSiteLogL(string name, int burnin, int every, int until, i
     double postmeanl_ness10 = 0;
 
 	for (int i=0; i<GetNsite(); i++)	{
-		double min = 0;
-        double max = 0;
-		int count = 0;
-		for (vector<double>::iterator j=logl[i].begin(); j != logl[i].end(); j++)	{
-			if ((!count) || (min > (*j)))	{
-				min = *j;
-			}
-			if ((!count) || (max < (*j)))	{
-				max = *j;
-			}
-			count++;
-		}
 
         // cpo
-        double site_cpo = 0;
-        vector<double> cpo_weight;
-		for (vector<double>::iterator j=logl[i].begin(); j != logl[i].end(); j++)	{
-			site_cpo += exp(min - (*j));
-            cpo_weight.push_back(exp(min-(*j)));
-		}
-
-        double cpo_invess = 0;
-        for (int j=0; j<count; j++) {
-            cpo_weight[j] /= site_cpo;
-            cpo_invess += cpo_weight[j] * cpo_weight[j];
-        }
-		site_cpo /= count;
-		site_logcpo[i] = min - log(site_cpo);
+		site_logcpo[i] = sitestat[i].GetLogCPO();
 		mean_logcpo += site_logcpo[i];
 		var_logcpo += site_logcpo[i] * site_logcpo[i];
-        cpo_siteess[i] = 1.0 / cpo_invess;
+        cpo_siteess[i] = sitestat[i].GetCPOESS();
         cpo_meaness += cpo_siteess[i];
         if (cpo_siteess[i] < 10.0)  {
             cpo_ness10 ++;
         }
 
         // postmeanl
-        double site_postmeanl = 0;
-        vector<double> postmeanl_weight;
-		for (vector<double>::iterator j=logl[i].begin(); j != logl[i].end(); j++)	{
-			site_postmeanl += exp((*j) - max);
-            postmeanl_weight.push_back(exp((*j) - max));
-		}
-
-        double postmeanl_invess = 0;
-        for (int j=0; j<count; j++) {
-            postmeanl_weight[j] /= site_postmeanl;
-            postmeanl_invess += postmeanl_weight[j] * postmeanl_weight[j];
-        }
-		site_postmeanl /= count;
-		site_logpostmeanl[i] = log(site_postmeanl) + max;
+		site_logpostmeanl[i] = sitestat[i].GetLogPostMeanL();
         mean_logpostmeanl += site_logpostmeanl[i];
         var_logpostmeanl += site_logpostmeanl[i] * site_logpostmeanl[i];
         
-        postmeanl_siteess[i] = 1.0 / postmeanl_invess;
+        postmeanl_siteess[i] = sitestat[i].GetPostMeanLESS();
         postmeanl_meaness += postmeanl_siteess[i];
         if (postmeanl_siteess[i] < 10.0)  {
             postmeanl_ness10 ++;
         }
 	}
+	delete[] sitestat;
 
 	mean_logcpo /= GetNsite();
 	var_logcpo /= GetNsite();
@@ -3030,11 +3332,7 @@ void PhyloProcess::ReadAncestral(string name, int burnin, int every, int until)
 
 	cerr << "burnin: " << burnin << '\n';
 	cerr << "every " << every << " points until " << until << '\n';
-	int i=0;
-	while ((i < until) && (i < burnin))	{
-		FromStream(is);
-		i++;
-	}
+	MakeChainSchedule(name,burnin,every,until);
 	int samplesize = 0;
 
 	double* allocmeanstatepostprob = new double[GetNsite()*GetNnode()*GetGlobalNstate()];
@@ -3067,18 +3365,16 @@ void PhyloProcess::ReadAncestral(string name, int burnin, int every, int until)
 		}
 	}
 
-	while (i < until)	{
+	while (ReadNextPoint(is))	{
 		cerr << ".";
 		samplesize++;
-		FromStream(is);
-		i++;
 		QuickUpdate();
 		MPI_Status stat;
 		MESSAGE signal = STATEPOSTPROBS;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 		for(int proc=1; proc<GetNprocs(); proc++) {
-			MPI_Recv(allocstatepostprob+smin[proc-1]*GetNnode()*GetGlobalNstate(),(smax[proc-1]-smin[proc-1])*GetNnode()*GetGlobalNstate(),MPI_DOUBLE,proc,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(allocstatepostprob+smin[proc-1]*GetNnode()*GetGlobalNstate(),(smax[proc-1]-smin[proc-1])*GetNnode()*GetGlobalNstate(),MPI_DOUBLE,proc,TAG1,PROCESS_COMM,&stat);
 			for (int i=smin[proc-1]; i<smax[proc-1]; i++)	{
 				for (int j=0; j<GetNnode(); j++)	{
 					double tot = 0;
@@ -3096,15 +3392,11 @@ void PhyloProcess::ReadAncestral(string name, int burnin, int every, int until)
 				}
 			}
 		}
-		
-		int nrep = 1;
-		while ((i<until) && (nrep < every))	{
-			FromStream(is);
-			i++;
-			nrep++;
-		}
 	}
 
+	samplesize = GroupReduceSum(samplesize);
+	GroupReduceSum(allocmeanstatepostprob,GetNsite()*GetNnode()*GetGlobalNstate());
+
 	for (int i=0; i<GetNsite(); i++)	{
 		for (int j=0; j<GetNnode(); j++)	{
 			for (int k=0; k<GetGlobalNstate(); k++)	{
@@ -3113,11 +3405,13 @@ void PhyloProcess::ReadAncestral(string name, int burnin, int every, int until)
 		}
 	}
 
-	WriteStatePostProbs(meanstatepostprob,name,GetRoot());
-	cerr << '\n';
-	cerr << "ancestral state posterior probabilities in " << name << "_nodelabel_taxon1_taxon2_.ancstatepostprob\n";
-	cerr << "for MRCA of taxon1 and taxon2\n";
-	cerr << '\n';
+	if (! GROUPID)	{
+		WriteStatePostProbs(meanstatepostprob,name,GetRoot());
+		cerr << '\n';
+		cerr << "ancestral state posterior probabilities in " << name << "_nodelabel_taxon1_taxon2_.ancstatepostprob\n";
+		cerr << "for MRCA of taxon1 and taxon2\n";
+		cerr << '\n';
+	}
 
 	for (int i=0; i<GetNsite(); i++)	{
 		delete[] meanstatepostprob[i];
@@ -3161,7 +3455,7 @@ void PhyloProcess::SlaveComputeStatePostProbs()	{
 	*/
 
 	// send
-	MPI_Send(allocstatepostprob,(GetSiteMax()-GetSiteMin())*GetNnode()*GetGlobalNstate(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(allocstatepostprob,(GetSiteMax()-GetSiteMin())*GetNnode()*GetGlobalNstate(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 
 	// delete
 	for (int i=GetSiteMin(); i<GetSiteMax(); i++)	{
@@ -3177,7 +3471,7 @@ void PhyloProcess::ComputeStatePostProbs(double*** statepostprob, const Link* fr
 		cerr << "error : master doing slave's work\n";
 		exit(1);
 	}
-	double*** aux = 0;
+	condl_t*** aux = 0;
 	bool localaux = false;
 	if (auxindex != -1)	{
 		aux = condlmap[auxindex];
@@ -3252,7 +3546,7 @@ double PhyloProcess::GlobalGetFullLogLikelihood()  {
 
     MPI_Status stat;
     MESSAGE signal = SITELOGL;
-    MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+    MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int width = GetNsite()/(GetNprocs()-1);
 	int smin[GetNprocs()-1];
@@ -3270,7 +3564,7 @@ double PhyloProcess::GlobalGetFullLogLikelihood()  {
 	double* tmp = new double[GetNsite()];
     double total = 0;
     for(int i=1; i<GetNprocs(); ++i) {
-        MPI_Recv(tmp,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+        MPI_Recv(tmp+smin[i-1],smax[i-1]-smin[i-1],MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
         for (int j=smin[i-1]; j<smax[i-1]; j++)	{
             if (ActiveSite(j))  {
                 if (std::isnan(tmp[j]))	{
@@ -3327,7 +3621,7 @@ void PhyloProcess::ReadMap(string name, int burnin, int every, int until){
 
 		// quick update and mapping on the fly
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalCollapse();
@@ -3394,7 +3688,7 @@ void PhyloProcess::ReadMap(string name, int burnin, int every, int until){
 
 void PhyloProcess::GlobalWriteMappings(string name){
 	MESSAGE signal = WRITE_MAPPING;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	 //send the chain name
 	ostringstream os;
@@ -3405,8 +3699,8 @@ void PhyloProcess::GlobalWriteMappings(string name){
 	for (unsigned int i=0; i<len; i++)	{
 		bvector[i] = s[i];
 	}
-	MPI_Bcast(&len,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,MPI_COMM_WORLD);
+	MPI_Bcast(&len,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,PROCESS_COMM);
 	delete[] bvector;
 
 }
@@ -3414,9 +3708,9 @@ void PhyloProcess::GlobalWriteMappings(string name){
 void PhyloProcess::SlaveWriteMappings(){
 
 	int len;
-	MPI_Bcast(&len,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&len,1,MPI_INT,0,PROCESS_COMM);
 	unsigned char* bvector = new unsigned char[len];
-	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,MPI_COMM_WORLD);
+	MPI_Bcast(bvector,len,MPI_UNSIGNED_CHAR,0,PROCESS_COMM);
 	ostringstream os;
 	for (int i=0; i<len; i++)	{
 		os << bvector[i];
@@ -3497,11 +3791,11 @@ int PhyloProcess::GlobalCountMapping()	{
 	assert(myid==0);
 	MESSAGE signal = COUNTMAPPING;
 	MPI_Status stat;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	int i, count, totalcount=0;
 	for (i=1; i<nprocs; ++i)	{
-		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD, &stat);
+		MPI_Recv(&count,1,MPI_INT,MPI_ANY_SOURCE,TAG1,PROCESS_COMM, &stat);
 		totalcount += count;
 	}
 	return totalcount;
@@ -3511,7 +3805,7 @@ int PhyloProcess::GlobalCountMapping()	{
 void PhyloProcess::SlaveCountMapping()	{
 
 	int count = CountMapping();
-	MPI_Send(&count,1,MPI_INT,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&count,1,MPI_INT,0,TAG1,PROCESS_COMM);
 
 }
 
@@ -25,6 +25,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "BranchProcess.h"
 
 #include "Parallel.h"
+#include "SiteLogLStat.h"
 
 #include <map>
 #include <vector>
@@ -53,7 +54,7 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	// virtual void SlaveUpdate();
 
 	// default constructor: pointers set to nil
-	PhyloProcess() : missingmap(0), sitecondlmap(0), condlmap(0), siteratesuffstatcount(0), siteratesuffstatbeta(0), branchlengthsuffstatcount(0), branchlengthsuffstatbeta(0), condflag(false), data(0), bkdata(0), steppingrank(0), minsitecutoff(-1), maxsitecutoff(-1), myid(-1), nprocs(0), size(0), version("1.9"), totaltime(0), dataclamped(1), rateprior(0), profileprior(0), rootprior(1), topoburnin(0) {
+	PhyloProcess() : missingmap(0), sitecondlmap(0), sitecompncomp(0), condlmap(0), siteratesuffstatcount(0), siteratesuffstatbeta(0), branchlengthsuffstatcount(0), branchlengthsuffstatbeta(0), condflag(false), data(0), bkdata(0), steppingrank(0), minsitecutoff(-1), maxsitecutoff(-1), myid(-1), nprocs(0), size(0), version("1.9"), totaltime(0), dataclamped(1), rateprior(0), profileprior(0), rootprior(1), topoburnin(0), heat(1) {
 		fixbl = 0;
 		sitesuffstat = 1;
 	}
@@ -113,6 +114,12 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 
 	virtual void Monitor(ostream& os)  {
 		os << "matrix uni" << '\t' << SubMatrix::GetUniSubCount() << '\n';
+		os << "uni reuse " << '\t' << SubMatrix::GetUniReuseRate() << '\n';
+		os << "uni rows  " << '\t' << SubMatrix::GetUniRowCount() << '\n';
+		int ndiag, nreuse;
+		GlobalGetDiagCount(ndiag,nreuse);
+		os << "diag      " << '\t' << ndiag << '\n';
+		os << "diag reuse" << '\t' << nreuse << '\n';
 		os << "inf prob  " << '\t' << GetInfProbCount() << '\n';
 		os << "stat inf  " << '\t' << GetStatInfCount() << '\n';
 	}
@@ -225,9 +232,25 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
     virtual double GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int restore);
     virtual void SlaveGetSiteSteppingLogLikelihood();
 
+    // all the sites added at this step (active sites), in one round-trip:
+    // each slave sums over its own sites
+    virtual void SlaveGetSteppingLogLikelihood();
+    // active sites, in increasing order
+    void GetSteppingSites(vector<int>& sites);
+
 	virtual double SiteLogLikelihood(int site);
 	void SitePostOrderPruning(int site, const Link* from);
 
+	// log likelihood of each site of the slave (sitemin <= i < sitemax, active sites only)
+	// under each of the first ncomp components of the mixture: sitelogl[i][k]
+	// one post-order traversal per site, all components being propagated together at each node
+	// (instead of one full traversal of all sites per component)
+	void ComputeSiteComponentLogL(int ncomp, double** sitelogl);
+	void SiteComponentPostOrderPruning(int site, int ncomp, const Link* from, int depth);
+	// [0]: scratch; [d+1]: vector of the node currently processed at depth d
+	condl_t*** GetSiteComponentVector(int index);
+	void DeleteSiteComponentConditionalLikelihoods();
+
     void SetSteppingFraction(int cutoff1, int cutoff2);
     void GlobalSetSteppingFraction(int cutoff1, int cutoff2);
     void SlaveSetSteppingFraction();
@@ -296,7 +319,7 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	virtual void QuickUpdate()	{
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		
 		GlobalUpdateConditionalLikelihoods();
@@ -362,6 +385,25 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 
 	void ReadSiteRates(string name, int burnin, int every, int until);
 
+	// points of the chain to be read in post-analysis (burnin, every, until)
+	// in sample-parallel mode (readpb_mpi -ngroup <n>), samples are dealt round-robin over groups of processes
+	// points are reached directly through the .chainindex file whenever available
+	void MakeChainSchedule(string name, int burnin, int every, int until);
+	bool ReadNextPoint(istream& is);
+
+	// merging the results of all groups onto the master of group 0
+	int GroupReduceSum(int n);
+	void GroupReduceSum(double* array, int n);
+	// series[j] contains the values of this group's samples, j = 0..n-1
+	// on return (group 0), it contains the values of all samples, in chain order
+	void GroupGatherSamples(vector<double>* series, int n);
+	// merges the site logl summaries of all groups (readpb_mpi -sitelogl)
+	void GroupMergeSiteLogL(SiteLogLStat* sitestat);
+	// raw site logls (-sitelogl -v): name.mcmcsitelogls, or one temporary file per group
+	string GetSiteLogLFileName(string name, int group);
+	// interleaves the per-group files back into chain order (group 0 only)
+	void MergeSiteLogLFiles(string name);
+
 	// The following methids are here to write the mappings.
 	void ReadMap(string name, int burnin, int every, int until);
 	void ReadPostPredMap(string name, int burnin, int every, int until);
@@ -398,7 +440,10 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 
     double GlobalGetFullLogLikelihood();
 
-    virtual double GlobalGetSteppingLogLikelihood(int nrep, int restore) {
+    virtual double GlobalGetSteppingLogLikelihood(int nrep, int restore);
+
+    // one site at a time
+    double GlobalGetSteppingLogLikelihoodBySite(int nrep, int restore) {
         double tot = 0;
         for (int i=0; i<GetNsite(); i++)    {
             if (ActiveSite(i))  {
@@ -442,6 +487,12 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	double SendRandomBranches(Link*,double,Link**&, int);
 	double MoveTopo(int spr, int nni);
 
+	// move of a heated chain (heat < 1, pb_mpi -mc3)
+	// only the moves based on the pruning likelihood, which are tempered,
+	// so that the chain leaves prior * likelihood^heat invariant;
+	// all other parameters are left unchanged until the chain becomes cold again
+	double HeatedMove(double tuning = 1.0);
+
 	// MCMC on branch lengths
 	double BranchLengthMove(double tuning);
 	double NonMPIBranchLengthMove(double tuning);
@@ -463,14 +514,14 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	// and that conditional likelihoods are updated
 	// those conditional likelihoods will be corrupted
 	void SampleNodeStates();
-	void SampleNodeStates(const Link* from, double*** aux);
+	void SampleNodeStates(const Link* from, condl_t*** aux);
 
 	// assumes that states at nodes have been sampled (using ResampleState())
 	void SampleSubstitutionMappings(const Link* from);
 
 	// conditional likelihood propagations
-	void PostOrderPruning(const Link* from, double*** aux);
-	void PreOrderPruning(const Link* from, double*** aux);
+	void PostOrderPruning(const Link* from, condl_t*** aux);
+	void PreOrderPruning(const Link* from, condl_t*** aux);
 	void RecursiveComputeLikelihood(const Link* from, int auxindex, vector<double>& logl);
 	void GlobalRecursiveComputeLikelihood(const Link* from, int auxindex, vector<double>& logl);
 
@@ -535,7 +586,7 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	void DeleteConditionalLikelihoods();
 	virtual void UpdateConditionalLikelihoods();
 
-	double*** GetConditionalLikelihoodVector(const Link* link)	{
+	condl_t*** GetConditionalLikelihoodVector(const Link* link)	{
 		return condlmap[GetLinkIndex(link)];
 	}
 
@@ -574,6 +625,10 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	void GlobalGetMeanSiteRate();
 	void SlaveSendMeanSiteRate();
 
+	// number of matrix diagonalizations (performed, and avoided) since the last call, summed over all processes
+	void GlobalGetDiagCount(int& ndiag, int& nreuse);
+	void SlaveSendDiagCount();
+
 	virtual int CountMapping();
 	virtual int CountMapping(int site);
 	virtual int GlobalCountMapping();
@@ -595,8 +650,10 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 		return myid;
 	}
 
-	double*** sitecondlmap;
-	double**** condlmap;
+	condl_t*** sitecondlmap;
+	vector<condl_t***> sitecompcondl;
+	int sitecompncomp;
+	condl_t**** condlmap;
 	BranchSitePath*** submap;
 	int** nodestate;
 
@@ -650,11 +707,27 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 		topoburnin = intopoburnin;
 	}
 
+	// inverse temperature of the chain (pb_mpi -mc3): 1 for the cold chain
+	// raises the likelihood to the power heat in the moves based on the pruning likelihood
+	// (branch lengths and topology), which are the only ones run by a heated chain (see HeatedMove);
+	// master only
+	void SetHeat(double inheat)	{
+		heat = inheat;
+	}
+	double GetHeat()	{
+		return heat;
+	}
+
 	double GetNormFactor() {return GetNormalizationFactor();}
 
 	string version;
 	double totaltime;
 
+	vector<int> chainpoint;
+	vector<streamoff> chainindex;
+	int nextpoint;
+	int chainpos;
+
 	SequenceAlignment* testdata;
 	int testnsite;
 	int testsitemin;
@@ -667,6 +740,7 @@ class PhyloProcess : public virtual SubstitutionProcess, public virtual BranchPr
 	int rootprior;
 
 	int topoburnin;
+	double heat;
 	int fixbl;
 
 	int sitesuffstat;
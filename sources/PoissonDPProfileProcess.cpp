@@ -94,10 +94,10 @@ double PoissonDPProfileProcess::IncrementalDPMove(int nrep)	{
 		double* mModeGibbsGrid = new double[h];
 		double* mLogSamplingArray = new double[h];
 
+		DiffLogSampling(site,h,mLogSamplingArray);
 		double max = 0;
 		for (int mode = 0; mode < h; mode++)	{
 			// mLogSamplingArray[mode] =  LogStatProb(site,mode);
-			mLogSamplingArray[mode] =  DiffLogSampling(mode,site);
 			if ((!mode) || (max < mLogSamplingArray[mode]))	{
 				max = mLogSamplingArray[mode];
 			}
@@ -17,6 +17,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "PoissonFiniteProfileProcess.h"
 #include "Random.h"
 #include <cassert>
+#include <algorithm>
 #include "Parallel.h"
 
 
@@ -76,8 +77,8 @@ double PoissonFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 
 	// send command and arguments
 	MESSAGE signal = REALLOC_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
 	// split Nsite among GetNprocs()-1 slaves
 	int width = GetNsite()/(GetNprocs()-1);
@@ -96,13 +97,13 @@ double PoissonFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 		// and send them to slaves
 		UpdateOccupancyNumbers();
 		ResampleWeights();
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// receive new site allocations from slave
 		MPI_Status stat;
 		int tmpalloc[GetNsite()];
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 			for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 				alloc[j] = tmpalloc[j];
 				if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -115,7 +116,8 @@ double PoissonFiniteProfileProcess::GlobalIncrementalFiniteMove(int nrep)	{
 	
 	// final cleanup
 	UpdateOccupancyNumbers();
-	UpdateModeProfileSuffStat();
+	// slaves pool the sites they have just reallocated
+	ReduceModeProfileSuffStat();
 
 	// CHECK that: might be useful depending on the exact submodel
 	// ResampleWeights();
@@ -128,17 +130,20 @@ double PoissonFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 
 	// parse argument sent by master
 	int nrep;
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
 	int NAccepted = 0;
 
 	double* bigarray = new double[Ncomponent * GetNsite()];
 	double* bigcumul = new double[Ncomponent * GetNsite()];
 
+	// profiles do not change during the move
+	UpdateLogStatProbs(Ncomponent);
+
 	for (int rep=0; rep<nrep; rep++)	{
 
 		// receive weights sent by master
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// do the incremental reallocation move on my site range
 		for (int site=GetSiteMin(); site<GetSiteMax(); site++)	{
@@ -147,10 +152,11 @@ double PoissonFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 			double* cumul = bigcumul + site * Ncomponent;
 
 			int bk = alloc[site];
+			rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 
+			LogStatProbs(site,Ncomponent,mLogSamplingArray);
 			double max = 0;
 			for (int mode = 0; mode < Ncomponent; mode++)	{
-				mLogSamplingArray[mode] =  LogStatProb(site,mode);
 				if ((!mode) || (max < mLogSamplingArray[mode]))	{
 					max = mLogSamplingArray[mode];
 				}
@@ -165,13 +171,13 @@ double PoissonFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 			}
 
 			double q = total * rnd::GetRandom().Uniform();
-			int mode = 0;
-			while ( (mode<Ncomponent) && (q > cumul[mode])) mode++;
+			int mode = lower_bound(cumul,cumul+Ncomponent,q) - cumul;
 			if (mode == Ncomponent)	{
 				cerr << "error in switch mode: gibbs overflow\n";
 				exit(1);
 			}
 
+			rnd::GetRandom().CloseStream();
 			int Accepted = (mode != bk);
 			if (Accepted)	{
 				NAccepted ++;
@@ -180,8 +186,10 @@ double PoissonFiniteProfileProcess::SlaveIncrementalFiniteMove()	{
 		}
 
 		// send new allocations to master
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 	}
+
+	ReduceModeProfileSuffStat();
 	
 	delete[] bigarray;
 	delete[] bigcumul;
@@ -16,6 +16,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 
 #include "PoissonMixtureProfileProcess.h"
 #include "Random.h"
+#include "Parallel.h"
 
 
 //-------------------------------------------------------------------------
@@ -29,20 +30,22 @@ void PoissonMixtureProfileProcess::Create(int innsite, int indim)	{
 	if (! profilesuffstatcount)	{
 		PoissonProfileProcess::Create(innsite,indim);
 		MixtureProfileProcess::Create(innsite,indim);
+		// contiguous, so that it can be summed over processes in one go
+		allocprofilesuffstatcount = new int[GetNmodeMax() * GetDim()];
 		profilesuffstatcount  = new int*[GetNmodeMax()];
 		for (int i=0; i<GetNmodeMax(); i++)	{
-			profilesuffstatcount[i] = new int[GetDim()];
+			profilesuffstatcount[i] = allocprofilesuffstatcount + i*GetDim();
 		}
+		loggammadirweight.assign(GetDim(),vector<double>());
+		loggammadirweightkey.assign(GetDim(),-1);
 		// SampleProfile();
 	}
 }
 
 void PoissonMixtureProfileProcess::Delete() {
 	if (profilesuffstatcount)	{
-		for (int i=0; i<GetNmodeMax(); i++)	{
-			delete[] profilesuffstatcount[i];
-		}
 		delete[] profilesuffstatcount;
+		delete[] allocprofilesuffstatcount;
 		profilesuffstatcount = 0;
 		PoissonProfileProcess::Delete();
 		MixtureProfileProcess::Delete();
@@ -64,12 +67,28 @@ void PoissonMixtureProfileProcess::UpdateModeProfileSuffStat()	{
 	}
 }
 
+void PoissonMixtureProfileProcess::ReduceModeProfileSuffStat()	{
+	for (int i=0; i<GetNcomponent()*GetDim(); i++)	{
+		allocprofilesuffstatcount[i] = 0;
+	}
+	if (GetMyid())	{
+		for (int i=GetSiteMin(); i<GetSiteMax(); i++)	{
+			const int* count = GetSiteProfileSuffStatCount(i);
+			int* catcount = profilesuffstatcount[alloc[i]];
+			for (int k=0; k<GetDim(); k++)	{
+				catcount[k] += count[k];
+			}
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE,allocprofilesuffstatcount,GetNcomponent()*GetDim(),MPI_INT,MPI_SUM,PROCESS_COMM);
+}
+
 double PoissonMixtureProfileProcess::ProfileSuffStatLogProb(int cat)	{
 	double total = 0;
 	double priorweight = 0;
 	double postweight = 0;
 	for (int k=0; k<GetDim(); k++)	{
-		total += rnd::GetRandom().logGamma(dirweight[k] + profilesuffstatcount[cat][k]) - rnd::GetRandom().logGamma(dirweight[k]);
+		total += LogGammaDirWeight(k,profilesuffstatcount[cat][k]) - LogGammaDirWeight(k,0);
 		priorweight += dirweight[k];
 		postweight += dirweight[k] + profilesuffstatcount[cat][k];
 	}
@@ -102,6 +121,43 @@ double PoissonMixtureProfileProcess::DiffLogSampling(int cat, int site)	{
 	return total;
 }
 
+void PoissonMixtureProfileProcess::DiffLogSampling(int site, int ncat, double* logsamp)	{
+
+	// the non-zero counts of the site, and the prior weight, are collected once for all components
+	const int* nsub = GetSiteProfileSuffStatCount(site);
+	int nstate = 0;
+	int* state = new int[GetDim()];
+	int totalsub = 0;
+	double priorweight = 0;
+	for (int k=0; k<GetDim(); k++)	{
+		if (nsub[k])	{
+			state[nstate++] = k;
+		}
+		totalsub += nsub[k];
+		priorweight += dirweight[k];
+	}
+
+	for (int cat=0; cat<ncat; cat++)	{
+		const int* catnsub = profilesuffstatcount[cat];
+		int grandtotal = 0;
+		for (int k=0; k<GetDim(); k++)	{
+			grandtotal += catnsub[k];
+		}
+		double total = 0;
+		for (int j=0; j< totalsub; j++)	{
+			total -= log(priorweight + grandtotal + j);
+		}
+		for (int i=0; i<nstate; i++)	{
+			int k = state[i];
+			for (int j=0; j< nsub[k]; j++)	{
+				total += log(dirweight[k] + catnsub[k] + j);
+			}
+		}
+		logsamp[cat] = total;
+	}
+	delete[] state;
+}
+
 double PoissonMixtureProfileProcess::LogStatProb(int site, int cat)	{
 	const int* nsub = GetSiteProfileSuffStatCount(site);
 	double total = 0;
@@ -111,6 +167,24 @@ double PoissonMixtureProfileProcess::LogStatProb(int site, int cat)	{
 	return total;
 }
 
+// same sums as LogStatProb, state by state over the non-zero counts of the site
+// the inner loop over components runs on contiguous arrays (and gets vectorized)
+void PoissonMixtureProfileProcess::LogStatProbs(int site, int ncat, double* logsamp)	{
+	const int* nsub = GetSiteProfileSuffStatCount(site);
+	for (int cat=0; cat<ncat; cat++)	{
+		logsamp[cat] = 0;
+	}
+	for (int k=0; k<GetDim(); k++)	{
+		if (nsub[k])	{
+			double n = nsub[k];
+			const double* logp = logprofiletable + k*GetNmodeMax();
+			for (int cat=0; cat<ncat; cat++)	{
+				logsamp[cat] += n * logp[cat];
+			}
+		}
+	}
+}
+
 double PoissonMixtureProfileProcess::MoveProfile()	{
 	for (int i=0; i<GetNcomponent(); i++)	{
 		MoveProfile(i);
@@ -149,8 +223,8 @@ double PoissonMixtureProfileProcess::LogStatIntPrior(int cat)	{
 	int tot = 0;
 	double totweight = 0;
 	for (int k=0; k<GetDim(); k++)	{
-		total += rnd::GetRandom().logGamma(dirweight[k] + profilesuffstatcount[cat][k]);
-		total -= rnd::GetRandom().logGamma(dirweight[k]);
+		total += LogGammaDirWeight(k,profilesuffstatcount[cat][k]);
+		total -= LogGammaDirWeight(k,0);
 		totweight += dirweight[k];
 		tot += profilesuffstatcount[cat][k];
 	}
@@ -163,27 +237,79 @@ double PoissonMixtureProfileProcess::MoveDirWeights(double tuning, int nrep)	{
 
 	UpdateOccupancyNumbers();
 	UpdateModeProfileSuffStat();
+
+	// LogStatIntPrior() is a sum of one term per state, depending on dirweight[k] only,
+	// and of a term depending on the total weight:
+	// a move on dirweight[k] recomputes only those two terms
+	int Nocc = 0;
+	int* occupied = new int[GetNcomponent()];
+	int* occupiedtot = new int[GetNcomponent()];
+	for (int i=0; i<GetNcomponent(); i++)	{
+		if (occupancy[i])	{
+			occupied[Nocc] = i;
+			occupiedtot[Nocc] = 0;
+			for (int k=0; k<GetDim(); k++)	{
+				occupiedtot[Nocc] += profilesuffstatcount[i][k];
+			}
+			Nocc++;
+		}
+	}
+
+	double* statelogprob = new double[GetDim()];
+	double totweight = 0;
+	for (int k=0; k<GetDim(); k++)	{
+		statelogprob[k] = 0;
+		for (int j=0; j<Nocc; j++)	{
+			statelogprob[k] += LogGammaDirWeight(k,profilesuffstatcount[occupied[j]][k]);
+		}
+		statelogprob[k] -= Nocc * LogGammaDirWeight(k,0);
+		totweight += dirweight[k];
+	}
+	double totlogprob = Nocc * rnd::GetRandom().logGamma(totweight);
+	for (int j=0; j<Nocc; j++)	{
+		totlogprob -= rnd::GetRandom().logGamma(totweight + occupiedtot[j]);
+	}
+
 	double naccepted = 0;
 	for (int rep=0; rep<nrep; rep++)	{
 		for (int k=0; k<GetDim(); k++)	{
-			double deltalogprob = - LogHyperPrior() - LogStatIntPrior();
+			double deltalogprob = - LogHyperPrior() - statelogprob[k] - totlogprob;
 			double m = tuning * (rnd::GetRandom().Uniform() - 0.5);
 			double e = exp(m);
+			double bkweight = dirweight[k];
 			dirweight[k] *= e;
-			deltalogprob += LogHyperPrior() + LogStatIntPrior();
+			double newtotweight = totweight + dirweight[k] - bkweight;
+			double newstatelogprob = - Nocc * rnd::GetRandom().logGamma(dirweight[k]);
+			for (int j=0; j<Nocc; j++)	{
+				newstatelogprob += rnd::GetRandom().logGamma(dirweight[k] + profilesuffstatcount[occupied[j]][k]);
+			}
+			double newtotlogprob = Nocc * rnd::GetRandom().logGamma(newtotweight);
+			for (int j=0; j<Nocc; j++)	{
+				newtotlogprob -= rnd::GetRandom().logGamma(newtotweight + occupiedtot[j]);
+			}
+			deltalogprob += LogHyperPrior() + newstatelogprob + newtotlogprob;
 			deltalogprob += m;
 			int accepted = (log(rnd::GetRandom().Uniform()) < deltalogprob);
 			if (accepted)	{
 				naccepted++;
+				statelogprob[k] = newstatelogprob;
+				totlogprob = newtotlogprob;
+				totweight = newtotweight;
 			}
 			else	{
-				dirweight[k] /= e;
+				dirweight[k] = bkweight;
 			}
 		}
 	}
+
+	delete[] occupied;
+	delete[] occupiedtot;
+	delete[] statelogprob;
+
 	SampleStat();
 	return naccepted / nrep / GetDim();
 }
+
 void PoissonMixtureProfileProcess::RemoveSite(int site, int cat)	{
 	occupancy[cat] --;
 	if (activesuffstat)	{
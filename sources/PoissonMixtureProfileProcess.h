@@ -16,8 +16,10 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #ifndef POISSONMIXTUREPROFILE_H
 #define POISSONMIXTUREPROFILE_H
 
+#include <vector>
 #include "PoissonProfileProcess.h"
 #include "MixtureProfileProcess.h"
+#include "Random.h"
 
 // superclass for Poisson (F81) implementations
 class PoissonMixtureProfileProcess: public virtual PoissonProfileProcess, public virtual MixtureProfileProcess	{
@@ -49,6 +51,7 @@ class PoissonMixtureProfileProcess: public virtual PoissonProfileProcess, public
 	// posterior
 	// collects sufficient statistics across sites, pools them componentwise
 	void UpdateModeProfileSuffStat();
+	void ReduceModeProfileSuffStat();
 
 	// virtual void CreateComponent(int k)	{}
 
@@ -59,7 +62,13 @@ class PoissonMixtureProfileProcess: public virtual PoissonProfileProcess, public
 	// suffstat lnL of all sites allocated to component cat when site <site> is among them, and
 	// suffstat lnL of all sites allocated to component cat when site <site> is not among them
 	double DiffLogSampling(int cat, int site);
+	// same, for components 0 <= cat < ncat, in one pass (written into logsamp)
+	void DiffLogSampling(int site, int ncat, double* logsamp);
 	virtual double LogStatProb(int site, int cat);
+	virtual void UpdateLogStatProbs(int ncat)	{
+		UpdateLogProfileTable(ncat);
+	}
+	virtual void LogStatProbs(int site, int ncat, double* logsamp);
 	double LogStatIntPrior(int cat);
 	double LogStatIntPrior();
 	double MoveDirWeights(double tuning, int nrep);
@@ -104,8 +113,31 @@ class PoissonMixtureProfileProcess: public virtual PoissonProfileProcess, public
 		return norm;
 	}
 
+	// logGamma(dirweight[k] + n), memoized
+	// the entries of a state are computed upon first request,
+	// and all discarded as soon as dirweight[k] is found to differ from the value they were computed for
+	double LogGammaDirWeight(int k, int n)	{
+		vector<double>& row = loggammadirweight[k];
+		if (loggammadirweightkey[k] != dirweight[k])	{
+			row.clear();
+			loggammadirweightkey[k] = dirweight[k];
+		}
+		if (n >= ((int) row.size()))	{
+			// -1 is never reached by logGamma over positive reals (minimum ~ -0.12)
+			row.resize(n+1,-1);
+		}
+		if (row[n] == -1)	{
+			row[n] = rnd::GetRandom().logGamma(dirweight[k] + n);
+		}
+		return row[n];
+	}
+
 	// private:
 	int** profilesuffstatcount;
+	int* allocprofilesuffstatcount;
+
+	vector<vector<double> > loggammadirweight;
+	vector<double> loggammadirweightkey;
 };
 
 #endif
@@ -190,7 +190,7 @@ void PoissonPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	int i,j,k,l,width,nalloc,smin[nprocs-1],smax[nprocs-1],workload[nprocs-1];
 	MPI_Status stat;
 	MESSAGE signal = UPDATE_SPROFILE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	// suff stats are contained in 2 arrays
 	// int** siteprofilesuffstatcount
@@ -211,7 +211,7 @@ void PoissonPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 	}
 	int ivector[nalloc];
 	for(i=1; i<nprocs; ++i) {
-		MPI_Recv(ivector,workload[i-1],MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+		MPI_Recv(ivector,workload[i-1],MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 		l = 0;
 		for(j=smin[i-1]; j<smax[i-1]; ++j) {
 			for(k=0; k<GetDim(); ++k) {
@@ -219,8 +219,9 @@ void PoissonPhyloProcess::GlobalUpdateSiteProfileSuffStat()	{
 			}
 		}
 	}
-	// MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Bcast(allocsiteprofilesuffstatcount,GetNsite()*GetDim(),MPI_INT,0,MPI_COMM_WORLD);
+	// MPI_Barrier(PROCESS_COMM);
+	// not broadcast back: slaves only use the stats of their own sites
+	// (component stats: see ReduceModeProfileSuffStat)
 }
 
 void PoissonPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
@@ -233,9 +234,7 @@ void PoissonPhyloProcess::SlaveUpdateSiteProfileSuffStat()	{
 			ivector[k] = siteprofilesuffstatcount[i][j]; k++;
 		}
 	}
-	MPI_Send(ivector,workload,MPI_INT,0,TAG1,MPI_COMM_WORLD);
-	// MPI_Barrier(MPI_COMM_WORLD);
-	MPI_Bcast(allocsiteprofilesuffstatcount,GetNsite()*GetDim(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Send(ivector,workload,MPI_INT,0,TAG1,PROCESS_COMM);
 }
 
 /*
@@ -306,9 +305,9 @@ void PoissonPhyloProcess::GlobalSetTestData()	{
 	*/
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 
@@ -327,9 +326,9 @@ void PoissonPhyloProcess::GlobalSetTestData()	{
 
 void PoissonPhyloProcess::SlaveSetTestData()	{
 
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnsite * GetNtaxa()];
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 	
 	SetTestSiteMinAndMax();
 	truedata->SetTestData(testnsite,sitemin,testsitemin,testsitemax,tmp);
@@ -387,18 +386,18 @@ void PoissonPhyloProcess::GlobalSetTestData()	{
 	ziptestdata->GetDataVector(tmp);
 
 	MESSAGE signal = SETTESTDATA;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 
 	delete[] tmp;
 }
 
 void PoissonPhyloProcess::SlaveSetTestData()	{
 
-	MPI_Bcast(&testnsite,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&testnsite,1,MPI_INT,0,PROCESS_COMM);
 	int* tmp = new int[testnsite * GetNtaxa()];
-	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(tmp,testnsite*GetNtaxa(),MPI_INT,0,PROCESS_COMM);
 	
 	SetTestSiteMinAndMax();
 	zipdata->SetTestData(testnsite,sitemin,testsitemin,testsitemax,tmp);
@@ -17,6 +17,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "PoissonSBDPProfileProcess.h"
 #include "Random.h"
 #include <cassert>
+#include <algorithm>
 #include "Parallel.h"
 
 double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double epsilon)	{
@@ -41,12 +42,12 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 
 	// send mixmove signal and tuning parameters
 	MESSAGE signal = MIX_MOVE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	int itmp[3];
 	itmp[0] = nrep;
 	itmp[1] = nallocrep;
 	itmp[2] = K0;
-	MPI_Bcast(itmp,3,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,3,MPI_INT,0,PROCESS_COMM);
 
 	// split Nsite among GetNprocs()-1 slaves
 	int width = GetNsite()/(GetNprocs()-1);
@@ -60,7 +61,7 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 
 	/*
 	ResampleEmptyProfiles();
-	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	*/
 
 	double* tmp = new double[Ncomponent * GetDim() + 1];
@@ -69,7 +70,7 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 
 		ResampleWeights();
 
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
 
 		// here slaves do realloc moves
 
@@ -77,7 +78,7 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 		MPI_Status stat;
 		int tmpalloc[GetNsite()+1];
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,MPI_COMM_WORLD,&stat);
+			MPI_Recv(tmpalloc,GetNsite(),MPI_INT,i,TAG1,PROCESS_COMM,&stat);
 			for(int j=smin[i-1]; j<smax[i-1]; ++j) {
 				alloc[j] = tmpalloc[j];
 				if ((alloc[j] < 0) || (alloc[j] >= Ncomponent))	{
@@ -87,14 +88,15 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 			}
 		}
 
-		// MPI_Barrier(MPI_COMM_WORLD);
+		// MPI_Barrier(PROCESS_COMM);
 
 		// broadcast new allocations
-		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,PROCESS_COMM);
 
 		// here slaves do profile moves
 
 		UpdateOccupancyNumbers();
+		ReduceModeProfileSuffStat();
 
 		// collect final values of profiles (+ total acceptance rate) from slaves
 
@@ -111,7 +113,7 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 		MPI_Status stat2;
 		double total = 0;
 		for(int i=1; i<GetNprocs(); ++i) {
-			MPI_Recv(tmp,(mmax[i-1]-mmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat2);
+			MPI_Recv(tmp,(mmax[i-1]-mmin[i-1])*GetDim()+1,MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat2);
 			int l = 0;
 			for(int j=mmin[i-1]; j<mmax[i-1]; ++j) {
 				for (int k=0; k<GetDim(); k++)	{
@@ -122,9 +124,9 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 			total += tmp[l]; // (sum all acceptance rates)
 		}
 
-		// MPI_Barrier(MPI_COMM_WORLD);
+		// MPI_Barrier(PROCESS_COMM);
 		// resend all profiles
-		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	}
 
 	delete[] tmp;
@@ -135,7 +137,7 @@ double PoissonSBDPProfileProcess::GlobalMixMove(int nrep, int nallocrep, double
 void PoissonSBDPProfileProcess::SlaveMixMove()	{
 
 	int itmp[3];
-	MPI_Bcast(itmp,3,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(itmp,3,MPI_INT,0,PROCESS_COMM);
 	int nrep = itmp[0];
 	int nallocrep = itmp[1];
 	int K0 = itmp[2];
@@ -157,8 +159,9 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 
 		// realloc move
 
-		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,MPI_COMM_WORLD);
-		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(weight,Ncomponent,MPI_DOUBLE,0,PROCESS_COMM);
+		// MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+		UpdateLogStatProbs(K0);
 
 		double totp = 0;
 		for (int mode = 0; mode<K0; mode++)	{
@@ -178,11 +181,12 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 			// for (int site=GetSiteMin(); site<GetSiteMax(); site++)	{
 
 				int bk = alloc[site];
+				rnd::GetRandom().OpenStream(site,Random::MIXALLOC);
 
+				LogStatProbs(site,K0,mLogSamplingArray);
 				double max = 0;
 				// double mean = 0;
 				for (int mode = 0; mode<K0; mode++)	{
-					mLogSamplingArray[mode] = LogStatProb(site,mode);
 					if ((!mode) || (max < mLogSamplingArray[mode]))	{
 						max = mLogSamplingArray[mode];
 					}
@@ -204,8 +208,7 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 				double M = 1;
 				total += M * totq;
 				double q = total * rnd::GetRandom().Uniform();
-				int mode = 0;
-				while ( (mode<K0) && (q > cumul[mode])) mode++;
+				int mode = lower_bound(cumul,cumul+K0,q) - cumul;
 				if (mode == K0)	{
 					mode--;
 					double r = (q - cumul[mode]) / M;
@@ -228,6 +231,7 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 					mode = bk;
 				}
 
+				rnd::GetRandom().CloseStream();
 				int Accepted = (mode != bk);
 				if (Accepted)	{
 					NAccepted ++;
@@ -235,19 +239,19 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 				alloc[site] = mode;
 			}
 		}
-		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,MPI_COMM_WORLD);
+		MPI_Send(alloc,GetNsite(),MPI_INT,0,TAG1,PROCESS_COMM);
 
-		// MPI_Barrier(MPI_COMM_WORLD);
+		// MPI_Barrier(PROCESS_COMM);
 		// profile move
 
 		// receive new allocations
-		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(alloc,GetNsite(),MPI_INT,0,PROCESS_COMM);
 
 		// determine the range of components to move
 		UpdateOccupancyNumbers();
 
 		// update sufficient statistics
-		UpdateModeProfileSuffStat();
+		ReduceModeProfileSuffStat();
 
 		// split Nmode among GetNprocs()-1 slaves
 		int mwidth = GetNcomponent()/(GetNprocs()-1);
@@ -261,7 +265,9 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 
 		double total = 0;
 		for (int mode=mmin[GetMyid()-1]; mode<mmax[GetMyid()-1]; mode++)	{
+			rnd::GetRandom().OpenStream(mode,Random::COMPONENT);
 			total += MoveProfile(mode);
+			rnd::GetRandom().CloseStream();
 		}
 		int l = 0;
 		for (int mode=mmin[GetMyid()-1]; mode<mmax[GetMyid()-1]; mode++)	{
@@ -272,11 +278,11 @@ void PoissonSBDPProfileProcess::SlaveMixMove()	{
 		}
 		tmp[l] = total;
 
-		MPI_Send(tmp,(mmax[GetMyid()-1] - mmin[GetMyid()-1])*GetDim()+1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-		// MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Send(tmp,(mmax[GetMyid()-1] - mmin[GetMyid()-1])*GetDim()+1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+		// MPI_Barrier(PROCESS_COMM);
 
 		// rereceive all profiles
-		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+		MPI_Bcast(allocprofile,Ncomponent*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 	}
 
 	delete[] cumul;
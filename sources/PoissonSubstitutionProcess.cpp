@@ -33,14 +33,14 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 //	(CPU level 3)
 //-------------------------------------------------------------------------
 
-void PoissonSubstitutionProcess::Propagate(double*** from, double*** to, double time, bool condalloc)	{
+void PoissonSubstitutionProcess::Propagate(condl_t*** from, condl_t*** to, double time, bool condalloc)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
             const double* stat = GetStationary(i);
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmpfrom = from[i][j];
-                    double* tmpto = to[i][j];
+                    condl_t* tmpfrom = from[i][j];
+                    condl_t* tmpto = to[i][j];
                     double expo = exp(-GetRate(i,j) * time);
                     double tot = 0;
                     int nstate = GetNstate(i);
@@ -101,6 +101,7 @@ void PoissonSubstitutionProcess::SimuPropagate(int* stateup, int* statedown, dou
 		int nstate = GetNstate(i);
 		int j = ratealloc[i];
 		double expo = exp(-GetRate(i,j) * time);
+		rnd::GetRandom().OpenStream(i,Random::NODESTATE);
 		if (rnd::GetRandom().Uniform() < expo)	{
 			statedown[i] = stateup[i];
 		}
@@ -118,6 +119,7 @@ void PoissonSubstitutionProcess::SimuPropagate(int* stateup, int* statedown, dou
 			}
 			statedown[i] = k;
 		}
+		rnd::GetRandom().CloseStream();
 	}
 }
 
@@ -150,6 +152,7 @@ BranchSitePath** PoissonSubstitutionProcess::SamplePaths(int* stateup, int* stat
 		int m = 0;
 		int mmax = 1000;
 		
+		rnd::GetRandom().OpenStream(i,Random::SUBPATH);
 		if (dup == ddown)	{
 			double fact = pi * exp(-l);
 			double total = exp(-l);
@@ -176,6 +179,7 @@ BranchSitePath** PoissonSubstitutionProcess::SamplePaths(int* stateup, int* stat
 				suboverflowcount ++;
 			}
 		}
+		rnd::GetRandom().CloseStream();
 		patharray[i] = new BranchSitePath(m,ddown);
 	}
 	return patharray;
@@ -263,7 +267,7 @@ void PoissonSubstitutionProcess::ChooseRootTrueStates(int* nodestate)	{
 	}
 }
 
-void PoissonSubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(double*** aux,double*** statepostprob, int nodelabel, bool condalloc)	{
+void PoissonSubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(condl_t*** aux,double*** statepostprob, int nodelabel, bool condalloc)	{
 
 	SubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(aux,statepostprob,nodelabel,condalloc);
 	ZipToTruePostProbs(statepostprob,nodelabel);
@@ -348,14 +352,16 @@ void PoissonSubstitutionProcess::UpdateZip(int i)	{
 int PoissonSubstitutionProcess::GetRandomStateFromZip(int site, int zipstate)	{
 	int truestate = 0;
 	if ((GetZipSize(site) != GetOrbitSize(site)) && (zipstate == GetOrbitSize(site)))	{
+		rnd::GetRandom().OpenStream(site,Random::SUBPATH);
 		double v = rnd::GetRandom().Uniform();
+		rnd::GetRandom().CloseStream();
 		double u = zipstat[site][GetOrbitSize(site)] * v;
 		double total = 0;
 		double* pi = GetProfile(site);
 
 		/*
 		int myid;
-		MPI_Comm_rank(MPI_COMM_WORLD,&myid);
+		MPI_Comm_rank(PROCESS_COMM,&myid);
 		if (myid == 4)	{
 			cerr << myid << "??" << '\t' << site << '\t' << v << '\t' << u << '\t' << GetOrbitSize(site) << '\t' << zipstat[site][GetOrbitSize(site)] << '\n';
 			for (int k=0; k<GetDim(); k++)	{
@@ -405,6 +411,7 @@ int PoissonSubstitutionProcess::GetRandomStateFromZip(int site, int zipstate)	{
 
 void PoissonSubstitutionProcess::UnzipBranchSitePath(BranchSitePath** patharray, int* nodestateup, int* nodestatedown){
 	for (int i=sitemin; i<sitemax; i++)	{
+		rnd::GetRandom().OpenStream(i,Random::SUBPATH);
 		int nsub = patharray[i]->GetNsub();
 		patharray[i]->nsub=0;
 		double* times = new double[nsub+1];
@@ -447,17 +454,18 @@ void PoissonSubstitutionProcess::UnzipBranchSitePath(BranchSitePath** patharray,
 		}
 		patharray[i]->Last()->SetRelativeTime(times[nsub]);
 		delete[] times;
+		rnd::GetRandom().CloseStream();
 	}
 }
 
 
-void PoissonSubstitutionProcess::SitePropagate(int i, double** from, double** to, double time, bool condalloc)	{
+void PoissonSubstitutionProcess::SitePropagate(int i, condl_t** from, condl_t** to, double time, bool condalloc)	{
 
 	const double* stat = GetStationary(i);
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmpfrom = from[j];
-			double* tmpto = to[j];
+			condl_t* tmpfrom = from[j];
+			condl_t* tmpto = to[j];
 			double expo = exp(-GetRate(i,j) * time);
 			double tot = 0;
 			int nstate = GetNstate(i);
@@ -480,3 +488,72 @@ void PoissonSubstitutionProcess::SitePropagate(int i, double** from, double** to
 	}
 }
 
+void PoissonSubstitutionProcess::PrepareSiteComponents(int i, int ncomp)	{
+
+	if (ncomp > compzipcapacity)	{
+		DeleteComponentZip();
+		compzipcapacity = ncomp;
+		compzipstat = new double*[compzipcapacity];
+		for (int k=0; k<compzipcapacity; k++)	{
+			compzipstat[k] = new double[GetDim()];
+		}
+	}
+	int nstate = GetNstate(i);
+	for (int k=0; k<ncomp; k++)	{
+		SetSiteComponent(i,k);
+		for (int l=0; l<nstate; l++)	{
+			compzipstat[k][l] = zipstat[i][l];
+		}
+	}
+}
+
+void PoissonSubstitutionProcess::DeleteComponentZip()	{
+	for (int k=0; k<compzipcapacity; k++)	{
+		delete[] compzipstat[k];
+	}
+	delete[] compzipstat;
+	compzipstat = 0;
+	compzipcapacity = 0;
+}
+
+void PoissonSubstitutionProcess::SiteComponentPropagate(int i, int ncomp, condl_t*** from, condl_t*** to, double time)	{
+
+	int nrate = GetNrate(i);
+	int nstate = GetNstate(i);
+	double expo[nrate];
+	for (int j=0; j<nrate; j++)	{
+		expo[j] = exp(-GetRate(i,j) * time);
+	}
+	for (int k=0; k<ncomp; k++)	{
+		const double* stat = compzipstat[k];
+		for (int j=0; j<nrate; j++)	{
+			condl_t* tmpfrom = from[k][j];
+			condl_t* tmpto = to[k][j];
+			double tot = 0;
+			for (int l=0; l<nstate; l++)	{
+				tot += tmpfrom[l] * stat[l];
+			}
+			tot *= (1-expo[j]);
+			for (int l=0; l<nstate; l++)	{
+				tmpto[l] = expo[j] * tmpfrom[l] + tot;
+			}
+			tmpto[nstate] = tmpfrom[nstate];
+		}
+	}
+}
+
+void PoissonSubstitutionProcess::SiteComponentMultiplyByStationaries(int i, int ncomp, condl_t*** to)	{
+
+	int nrate = GetNrate(i);
+	int nstate = GetNstate(i);
+	for (int k=0; k<ncomp; k++)	{
+		const double* stat = compzipstat[k];
+		for (int j=0; j<nrate; j++)	{
+			condl_t* tmpto = to[k][j];
+			for (int l=0; l<nstate; l++)	{
+				tmpto[l] *= stat[l];
+			}
+		}
+	}
+}
+
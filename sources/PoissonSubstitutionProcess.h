@@ -25,22 +25,29 @@ class PoissonSubstitutionProcess : public virtual SubstitutionProcess, public vi
 
 	public:
 
-	PoissonSubstitutionProcess() : zipstat(0) {}
+	PoissonSubstitutionProcess() : zipstat(0), compzipstat(0), compzipcapacity(0) {}
 	virtual ~PoissonSubstitutionProcess() {}
 
 
 	const double* GetStationary(int site) {return zipstat[site];}
 	int GetNstate(int site) {return GetZipSize(site);}
 
-	virtual void ConditionalLikelihoodsToStatePostProbs(double*** aux,double*** statepostprob, int nodelabel, bool condalloc = false);
+	virtual void ConditionalLikelihoodsToStatePostProbs(condl_t*** aux,double*** statepostprob, int nodelabel, bool condalloc = false);
 
 	protected:
 
 	// CPU Level 3: implementations of likelihood propagation and substitution mapping methods
-	void Propagate(double*** from, double*** to, double time, bool condalloc = false);
+	void Propagate(condl_t*** from, condl_t*** to, double time, bool condalloc = false);
 
 	// CPU Level 3: implementations of likelihood propagation and substitution mapping methods
-	void SitePropagate(int site, double** from, double** to, double time, bool condalloc = false);
+	void SitePropagate(int site, condl_t** from, condl_t** to, double time, bool condalloc = false);
+
+	// batched over the components of the mixture at a given site:
+	// the recoded stationaries of all components are computed once per site,
+	// and the branch transition factors once per branch and rate category
+	void PrepareSiteComponents(int site, int ncomp);
+	void SiteComponentPropagate(int site, int ncomp, condl_t*** from, condl_t*** to, double time);
+	void SiteComponentMultiplyByStationaries(int site, int ncomp, condl_t*** to);
 
 	BranchSitePath** SamplePaths(int* stateup, int* statedown, double time);
 	BranchSitePath** SampleRootPaths(int* rootstate);
@@ -61,11 +68,13 @@ class PoissonSubstitutionProcess : public virtual SubstitutionProcess, public vi
 
 	virtual void Delete() {
 		DeleteZip();
+		DeleteComponentZip();
 		SubstitutionProcess::Delete();
 	}
 
 	void CreateZip();
 	void DeleteZip();
+	void DeleteComponentZip();
 	void UpdateZip();
 	void UpdateZip(int site);
 	void UnzipBranchSitePath(BranchSitePath** patharray, int* nodestateup, int* nodestatedown);
@@ -84,6 +93,10 @@ class PoissonSubstitutionProcess : public virtual SubstitutionProcess, public vi
 	private:
 
 	double** zipstat;
+
+	// compzipstat[k] : recoded stationaries of the current site under component k
+	double** compzipstat;
+	int compzipcapacity;
 };
 
 #endif
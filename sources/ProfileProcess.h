@@ -59,6 +59,8 @@ class ProfileProcess {
 	int GetDim() {return dim;}
 	int GetNsite() {return nsite;}
 	virtual double* GetProfile(int site) = 0;
+	// component of the mixture to which the site is allocated (0 if not a mixture)
+	virtual int GetSiteComponent(int site) {return 0;}
 
 	// virtual int GetNOccupiedComponent()  = 0;
 	virtual StateSpace* GetStateSpace() = 0;
@@ -58,7 +58,9 @@ void MatrixSubstitutionProcess::SimuPropagate(int* stateup, int* statedown, doub
 			exit(1);
 		}
 
+		rnd::GetRandom().OpenStream(i,Random::NODESTATE);
 		double u = rnd::GetRandom().Uniform();
+		rnd::GetRandom().CloseStream();
 		int k = 0;
 		while ((k<nstate) && (u>cumul[k]))	{
 			k++;
@@ -79,163 +81,206 @@ void MatrixSubstitutionProcess::SimuPropagate(int* stateup, int* statedown, doub
 //	(CPU level 3)
 //-------------------------------------------------------------------------
 
-void MatrixSubstitutionProcess::Propagate(double*** from, double*** to, double time, bool condalloc)	{
+// conditional likelihood vectors sharing the same matrix are propagated in blocks of up to propblocksize vectors:
+// the rows of P and P^{-1} are then read once for the whole block (register-blocked matrix.matrix product)
+// per site, the vectors of all rate categories share the matrix of the site;
+// across sites, runs of consecutive sites with the same matrix are obtained with -sitegroup (see UpdateSiteOrder)
+//
+// each entry is still summed in the same order as in the per-site product, so that the results do not depend on the blocking
+
+static const int propblocksize = 4;
+
+void MatrixSubstitutionProcess::Propagate(condl_t*** from, condl_t*** to, double time, bool condalloc)	{
 
 	// propchrono.Start();
-	int i,j,k,l,offset;
-	double length,max,maxup;
+	int i,j;
 	const int nstate = GetMatrix(sitemin)->GetNstate();
-	// double* bigaux = new double[(sitemax - sitemin) * GetNrate(0) * nstate];
-	double* aux = new double[GetNsite() * GetNrate(0) * nstate];
-	for(i=sitemin; i<sitemax; i++)	{
-        if (ActiveSite(i))  {
-            SubMatrix* matrix = GetMatrix(i);
-            double** eigenvect = matrix->GetEigenVect();
-            double** inveigenvect = matrix->GetInvEigenVect();
-            double* eigenval = matrix->GetEigenVal();
-            for(j=0; j<GetNrate(i); j++)	{
-                if ((!condalloc) || (ratealloc[i] == j))	{
-                    double* up = from[i][j];
-                    double* down = to[i][j];
-                    //SubMatrix* matrix = GetMatrix(i);
-                    length = time * GetRate(i,j);
-
-                    //double** eigenvect = matrix->GetEigenVect();
-                    //double** inveigenvect= matrix->GetInvEigenVect();
-                    //double* eigenval = matrix->GetEigenVal();
-
-                    // substitution matrix Q = P L P^{-1} where L is diagonal (eigenvalues) and P is the eigenvector matrix
-                    // we need to compute 
-                    // down = exp(length * Q) . up
-                    // which we express as 
-                    // down = P ( exp(length * L) . (P^{-1} . up) )  
-            
-                    // thus we successively do the following matrix.vector products
-
-                    // P^{-1} . up  -> aux
-                    // exp(length * L) . aux  -> aux 	(where exp(length*L) is diagonal, so this is linear)
-                    // P . aux -> down
-
-                    /*
-                    int nstate = GetNstate();
-                    double* aux = new double[nstate];
-                    */
-                    //double* aux = bigaux + nstate * (i*GetNrate(0)  + j);
-                    offset = nstate*(i*GetNrate(0) + j);
-                    // P^{-1} . up  -> aux
-                    //double* tmpaux = aux;
-                    for(k=0; k<nstate; k++)	{
-                        //(*tmpaux++) = 0;
-                        aux[offset+k] = 0.0;
-                    }
-                    //tmpaux -= nstate;
-                    //double* tmpup = up;
-                    for(k=0; k<nstate; k++)	{
-                        //double* tmpinveigen = inveigenvect[i];
-                        for(l=0; l<nstate; l++)	{
-                            //(*tmpaux) += (*tmpinveigen++) * (*tmpup++);
-                            aux[offset+k] += inveigenvect[k][l] * up[l];
-                        }
-                        //tmpaux++;
-                        //tmpup -= nstate;
-                    }
-                    //tmpaux -= nstate;
-
-                    // exp(length * L) . aux  -> aux
-                    //double* tmpval = eigenval;
-                    for(k=0; k<nstate; k++)	{
-                        //(*tmpaux++) *= exp(length * (*tmpval++));
-                        aux[offset+k] *= exp(length * eigenval[k]);
-                    }
-                    //tmpaux -= nstate;
-                    //tmpval -= nstate;
-
-                    // P . aux -> down
-                    //double* tmpdown = down;
-                    for(k=0; k<nstate; k++)	{
-                        //(*tmpdown++) = 0;
-                        down[k] = 0.0;
-                    }
-                    //tmpdown -= nstate;
-
-                    for(k=0; k<nstate; k++)	{
-                        //double* tmpeigen = eigenvect[i];
-                        for(l=0; l<nstate; l++)	{
-                            //(*tmpdown) += (*tmpeigen++) * (*tmpaux++);
-                            down[k] += eigenvect[k][l] * aux[offset+l]; 
-                        }
-                        //tmpdown++;
-                        //tmpaux -= nstate;
-                    }
-                    //tmpdown -= nstate;
-
-                    // exit in case of numerical errors
-                    for(k=0; k<nstate; k++)	{
-                        if (std::isnan(down[k]))	{
-                            cerr << "error in back prop\n";
-                            for(l=0; l<nstate; l++)	{
-                                cerr << up[l] << '\t' << down[l] << '\t' << matrix->Stationary(l) << '\n';
-                            }
-                            exit(1);
-                        }
-                    }
-                    maxup = 0.0;
-                    for(k=0; k<nstate; k++)	{
-                        if (up[k] < 0.0)	{
-                            cerr << "error in backward propagate: negative prob : " << up[k] << "\n";
-                            exit(1);
-                        }
-                        if (maxup < up[k])	{
-                            maxup = up[k];
-                        }
-                    }
-                    max = 0.0;
-                    for(k=0; k<nstate; k++)	{
-                        if (down[k] < 0.0)	{
-                            infprobcount++;
-                            down[k] = 0.0;
-                        }
-                        if (max < down[k])	{
-                            max = down[k];
-                        }
-                    }
-                    /*
-                    if (maxup == 0.0)	{
-                        cerr << "error in backward propagate: null up array\n";
-                        cerr << "site : " << i << '\n';
-                        for(l=0; l<nstate; l++)	{
-                            cerr << matrix->Stationary(l) << '\n';
-                        }
-                        cerr << time << '\t' << length << '\n';
-                        cerr << GetDim() << '\n';
-                        cerr << GetMinStat(i) << '\n';
-                        exit(1);
-                    }
-                    if (max == 0.0)	{
-                        cerr << "error in backward propagate: null array\n";
-                        for(k=0; k<nstate; k++)	{
-                            cerr << up[k] << '\t' << down[k] << '\n';
-                        }
-                        cerr << length << '\n';
-                        cerr << '\n';
-                        exit(1);
-                    }
-                    */
-
-                    // this is the offset (in log)
-                    down[nstate] = up[nstate];
-                }
-            }
-        }
-    }
-    delete[] aux;
+	double* aux = new double[propblocksize * nstate];
+	double* expo = new double[propblocksize * nstate];
+
+	SubMatrix* blockmatrix = 0;
+	condl_t* blockup[propblocksize];
+	condl_t* blockdown[propblocksize];
+	double blocklength[propblocksize];
+	int nblock = 0;
+
+	UpdateSiteOrder();
+	for(int ii=0; ii<sitemax-sitemin; ii++)	{
+		i = siteorder[ii];
+		if (ActiveSite(i))	{
+			SubMatrix* matrix = GetMatrix(i);
+			for(j=0; j<GetNrate(i); j++)	{
+				if ((!condalloc) || (ratealloc[i] == j))	{
+					if (nblock && ((matrix != blockmatrix) || (nblock == propblocksize)))	{
+						BlockPropagate(blockmatrix,nblock,blockup,blockdown,blocklength,aux,expo);
+						nblock = 0;
+					}
+					blockmatrix = matrix;
+					blockup[nblock] = from[i][j];
+					blockdown[nblock] = to[i][j];
+					blocklength[nblock] = time * GetRate(i,j);
+					nblock++;
+				}
+			}
+		}
+	}
+	if (nblock)	{
+		BlockPropagate(blockmatrix,nblock,blockup,blockdown,blocklength,aux,expo);
+	}
+	delete[] aux;
+	delete[] expo;
+}
+
+void MatrixSubstitutionProcess::BlockPropagate(SubMatrix* matrix, int nblock, condl_t** up, condl_t** down, const double* length, double* aux, double* expo)	{
+
+	int b,k,l;
+	double** eigenvect = matrix->GetEigenVect();
+	double** inveigenvect = matrix->GetInvEigenVect();
+	double* eigenval = matrix->GetEigenVal();
+	const int nstate = matrix->GetNstate();
+
+	// substitution matrix Q = P L P^{-1} where L is diagonal (eigenvalues) and P is the eigenvector matrix
+	// we need to compute, for each vector b of the block
+	// down_b = exp(length_b * Q) . up_b
+	// which we express as
+	// down_b = P ( exp(length_b * L) . (P^{-1} . up_b) )
+
+	// thus we successively do the following matrix.matrix products
+
+	// P^{-1} . [up_0 ... up_nblock-1] -> aux
+	// exp(length_b * L) . aux_b -> aux_b	(where exp(length_b * L) is diagonal, so this is linear)
+	// P . aux -> [down_0 ... down_nblock-1]
+
+	// P^{-1} . up  -> aux
+	if (nblock == propblocksize)	{
+		const condl_t* up0 = up[0];
+		const condl_t* up1 = up[1];
+		const condl_t* up2 = up[2];
+		const condl_t* up3 = up[3];
+		for(k=0; k<nstate; k++)	{
+			const double* row = inveigenvect[k];
+			double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+			for(l=0; l<nstate; l++)	{
+				a0 += row[l] * up0[l];
+				a1 += row[l] * up1[l];
+				a2 += row[l] * up2[l];
+				a3 += row[l] * up3[l];
+			}
+			aux[k] = a0;
+			aux[nstate+k] = a1;
+			aux[2*nstate+k] = a2;
+			aux[3*nstate+k] = a3;
+		}
+	}
+	else	{
+		for(b=0; b<nblock; b++)	{
+			const condl_t* upb = up[b];
+			double* auxb = aux + b*nstate;
+			for(k=0; k<nstate; k++)	{
+				const double* row = inveigenvect[k];
+				double a = 0.0;
+				for(l=0; l<nstate; l++)	{
+					a += row[l] * upb[l];
+				}
+				auxb[k] = a;
+			}
+		}
+	}
+
+	// exp(length * L) . aux  -> aux
+	// (the exponentials are computed once for vectors sharing the same length)
+	for(b=0; b<nblock; b++)	{
+		double* expob = expo + b*nstate;
+		if (b && (length[b] == length[b-1]))	{
+			for(k=0; k<nstate; k++)	{
+				expob[k] = expob[k-nstate];
+			}
+		}
+		else	{
+			for(k=0; k<nstate; k++)	{
+				expob[k] = exp(length[b] * eigenval[k]);
+			}
+		}
+		double* auxb = aux + b*nstate;
+		for(k=0; k<nstate; k++)	{
+			auxb[k] *= expob[k];
+		}
+	}
+
+	// P . aux -> down
+	if (nblock == propblocksize)	{
+		const double* aux0 = aux;
+		const double* aux1 = aux + nstate;
+		const double* aux2 = aux + 2*nstate;
+		const double* aux3 = aux + 3*nstate;
+		condl_t* down0 = down[0];
+		condl_t* down1 = down[1];
+		condl_t* down2 = down[2];
+		condl_t* down3 = down[3];
+		for(k=0; k<nstate; k++)	{
+			const double* row = eigenvect[k];
+			double d0 = 0.0, d1 = 0.0, d2 = 0.0, d3 = 0.0;
+			for(l=0; l<nstate; l++)	{
+				d0 += row[l] * aux0[l];
+				d1 += row[l] * aux1[l];
+				d2 += row[l] * aux2[l];
+				d3 += row[l] * aux3[l];
+			}
+			down0[k] = ClampProb(d0);
+			down1[k] = ClampProb(d1);
+			down2[k] = ClampProb(d2);
+			down3[k] = ClampProb(d3);
+		}
+	}
+	else	{
+		for(b=0; b<nblock; b++)	{
+			const double* auxb = aux + b*nstate;
+			condl_t* downb = down[b];
+			for(k=0; k<nstate; k++)	{
+				const double* row = eigenvect[k];
+				double d = 0.0;
+				for(l=0; l<nstate; l++)	{
+					d += row[l] * auxb[l];
+				}
+				downb[k] = ClampProb(d);
+			}
+		}
+	}
+
+	for(b=0; b<nblock; b++)	{
+
+		condl_t* upb = up[b];
+		condl_t* downb = down[b];
+
+#ifdef DEBUG_CONDL
+		// exit in case of numerical errors
+		for(k=0; k<nstate; k++)	{
+			if (std::isnan(downb[k]))	{
+				cerr << "error in back prop\n";
+				for(l=0; l<nstate; l++)	{
+					cerr << upb[l] << '\t' << downb[l] << '\t' << matrix->Stationary(l) << '\n';
+				}
+				exit(1);
+			}
+		}
+		for(k=0; k<nstate; k++)	{
+			if (upb[k] < 0.0)	{
+				cerr << "error in backward propagate: negative prob : " << upb[k] << "\n";
+				exit(1);
+			}
+		}
+#endif
+
+		// this is the offset (binary exponent)
+		downb[nstate] = upb[nstate];
+	}
 }
 
-void MatrixSubstitutionProcess::SitePropagate(int i, double** from, double** to, double time, bool condalloc)	{
+void MatrixSubstitutionProcess::SitePropagate(int i, condl_t** from, condl_t** to, double time, bool condalloc)	{
 
 	// propchrono.Start();
 	int j,k,l;
-	double length,max,maxup;
+	double length;
 
 	// should be dependent on site
 	// const int nstate = GetMatrix(GetSiteMin())->GetNstate();
@@ -253,8 +298,8 @@ void MatrixSubstitutionProcess::SitePropagate(int i, double** from, double** to,
 
 		if ((!condalloc) || (ratealloc[i] == j))	{
 
-			double* up = from[j];
-			double* down = to[j];
+			condl_t* up = from[j];
+			condl_t* down = to[j];
 
 			length = time * GetRate(i,j);
 
@@ -298,6 +343,7 @@ void MatrixSubstitutionProcess::SitePropagate(int i, double** from, double** to,
 				}
 			}
 
+#ifdef DEBUG_CONDL
 			// exit in case of numerical errors
 			for(k=0; k<nstate; k++)	{
 				if (isnan(down[k]))	{
@@ -308,25 +354,15 @@ void MatrixSubstitutionProcess::SitePropagate(int i, double** from, double** to,
 					exit(1);
 				}
 			}
-			maxup = 0.0;
 			for(k=0; k<nstate; k++)	{
 				if (up[k] < 0.0)	{
 					cerr << "error in backward propagate: negative prob : " << up[k] << "\n";
 					exit(1);
 				}
-				if (maxup < up[k])	{
-					maxup = up[k];
-				}
 			}
-			max = 0.0;
+#endif
 			for(k=0; k<nstate; k++)	{
-				if (down[k] < 0.0)	{
-					infprobcount++;
-					down[k] = 0.0;
-				}
-				if (max < down[k])	{
-					max = down[k];
-				}
+				down[k] = ClampProb(down[k]);
 			}
 			/*
 			if (maxup == 0.0)	{
@@ -348,7 +384,7 @@ void MatrixSubstitutionProcess::SitePropagate(int i, double** from, double** to,
 				exit(1);
 			}
 			*/
-			// this is the offset (in log)
+			// this is the offset (binary exponent)
 			down[nstate] = up[nstate];
 		}
 	}
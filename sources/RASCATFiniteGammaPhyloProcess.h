@@ -79,7 +79,7 @@ class RASCATFiniteGammaPhyloProcess : public virtual PoissonPhyloProcess, public
 		dc = indc;
 
 		datafile = indatafile;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -162,7 +162,7 @@ class RASCATFiniteGammaPhyloProcess : public virtual PoissonPhyloProcess, public
 			NNNI = 0;
 		}
 		is >> dc;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -205,24 +205,25 @@ class RASCATFiniteGammaPhyloProcess : public virtual PoissonPhyloProcess, public
     void GlobalSetEmpiricalPrior(istream& is);
     void SlaveSetEmpiricalPrior();
 
-    double GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int restore)  {
+    double GlobalGetSteppingLogLikelihood(int nrep, int restore)  {
         if (fixncomp && (GetNcomponent() == 1))    {
-            return PhyloProcess::GlobalGetSiteSteppingLogLikelihood(site, nrep, restore);
+            return PhyloProcess::GlobalGetSteppingLogLikelihood(nrep, restore);
         }
-        return GlobalGetSiteSteppingLogLikelihoodNonIS(site, nrep, restore);
+        return GlobalGetSteppingLogLikelihoodNonIS(restore);
     }
 
-    void SlaveGetSiteSteppingLogLikelihood()    {
+    void SlaveGetSteppingLogLikelihood()    {
         if (fixncomp && (GetNcomponent() == 1))    {
-            PhyloProcess::SlaveGetSiteSteppingLogLikelihood();
+            PhyloProcess::SlaveGetSteppingLogLikelihood();
         }
         else    {
-            SlaveGetSiteSteppingLogLikelihoodNonIS();
+            SlaveGetSteppingLogLikelihoodNonIS();
         }
     }
 
-    double GlobalGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore);
-    void SlaveGetSiteSteppingLogLikelihoodNonIS();
+    // sums over the components of the mixture (each slave dealing with some of them), for all sites of the step
+    double GlobalGetSteppingLogLikelihoodNonIS(int restore);
+    void SlaveGetSteppingLogLikelihoodNonIS();
 
 	double GetLogProb()	{
 		return GetLogPrior() + GetLogLikelihood();
@@ -317,6 +318,11 @@ class RASCATFiniteGammaPhyloProcess : public virtual PoissonPhyloProcess, public
 	// void SlaveComputeSiteLogCVScore();
 	void SlaveComputeSiteLogL();
 
+	void SetSiteComponent(int site, int k)	{
+		PoissonFiniteProfileProcess::alloc[site] = k;
+		UpdateZip(site);
+	}
+
 	void ToStreamHeader(ostream& os)	{
 		PhyloProcess::ToStreamHeader(os);
 		os << datafile << '\n';
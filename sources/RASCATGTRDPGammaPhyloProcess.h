@@ -69,7 +69,7 @@ class RASCATGTRDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProcess
 		kappaprior = inkappaprior;
 
 		datafile = indatafile;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -121,7 +121,7 @@ class RASCATGTRDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProcess
 		is >> inrrtype;
 		is >> fixtopo;
 		is >> dc;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -76,7 +76,7 @@ class RASCATGTRFiniteGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloPro
 		dc = indc;
 
 		datafile = indatafile;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -162,7 +162,7 @@ class RASCATGTRFiniteGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloPro
 			NNNI = 0;
 		}
 		is >> dc;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -205,24 +205,25 @@ class RASCATGTRFiniteGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloPro
     void GlobalSetEmpiricalPrior(istream& is);
     void SlaveSetEmpiricalPrior();
 
-    double GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int restore)  {
+    double GlobalGetSteppingLogLikelihood(int nrep, int restore)  {
         if (fixncomp && (GetNcomponent() == 1))    {
-            return PhyloProcess::GlobalGetSiteSteppingLogLikelihood(site, nrep, restore);
+            return PhyloProcess::GlobalGetSteppingLogLikelihood(nrep, restore);
         }
-        return GlobalGetSiteSteppingLogLikelihoodNonIS(site, nrep, restore);
+        return GlobalGetSteppingLogLikelihoodNonIS(restore);
     }
 
-    void SlaveGetSiteSteppingLogLikelihood()    {
+    void SlaveGetSteppingLogLikelihood()    {
         if (fixncomp && (GetNcomponent() == 1))    {
-            PhyloProcess::SlaveGetSiteSteppingLogLikelihood();
+            PhyloProcess::SlaveGetSteppingLogLikelihood();
         }
         else    {
-            SlaveGetSiteSteppingLogLikelihoodNonIS();
+            SlaveGetSteppingLogLikelihoodNonIS();
         }
     }
 
-    double GlobalGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore);
-    void SlaveGetSiteSteppingLogLikelihoodNonIS();
+    // sums over the components of the mixture (each slave dealing with some of them), for all sites of the step
+    double GlobalGetSteppingLogLikelihoodNonIS(int restore);
+    void SlaveGetSteppingLogLikelihoodNonIS();
 
 
 	double GetLogProb()	{
@@ -371,6 +372,10 @@ class RASCATGTRFiniteGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloPro
 	virtual void ReadPB(int argc, char* argv[]);
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
+
+	void SetSiteComponent(int site, int k)	{
+		ExpoConjugateGTRFiniteProfileProcess::alloc[site] = k;
+	}
 	void ReadPostHyper(string name, int burnin, int every, int until);
 
 	void ReadRelRates(string name, int burnin, int every, int until, int verbose);
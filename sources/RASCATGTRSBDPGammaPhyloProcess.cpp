@@ -59,7 +59,7 @@ void RASCATGTRSBDPGammaPhyloProcess::GlobalUpdateParameters()	{
 	int ivector[ni];
 	double dvector[nd]; 
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	// GlobalBroadcastTree();
 
@@ -103,10 +103,10 @@ void RASCATGTRSBDPGammaPhyloProcess::GlobalUpdateParameters()	{
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 
@@ -150,8 +150,8 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 	int index = 0;
 	SetAlpha(dvector[index]);
 	index++;
@@ -188,8 +188,8 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveUpdateParameters()	{
 	delete[] dvector;
 	delete[] ivector;
 
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	UpdateMatrices();
 }
@@ -442,12 +442,12 @@ void RASCATGTRSBDPGammaPhyloProcess::ReadPB(int argc, char* argv[])	{
 void RASCATGTRSBDPGammaPhyloProcess::GlobalSetSiteLogLCutoff()  {
 
 	MESSAGE signal = SITELOGLCUTOFF;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATGTRSBDPGammaPhyloProcess::SlaveSetSiteLogLCutoff()  {
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATGTRSBDPGammaPhyloProcess::ReadSiteProfileSuffStat(string name, int burnin, int every, int until){
@@ -482,7 +482,7 @@ void RASCATGTRSBDPGammaPhyloProcess::ReadSiteProfileSuffStat(string name, int bu
 		i++;
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalCollapse();
@@ -790,16 +790,7 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveComputeCVScore()	{
 	
 	// UpdateMatrices();
 
-	for (int k=0; k<ncomp; k++)	{
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			ExpoConjugateGTRSBDPProfileProcess::alloc[i] = k;
-		}
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
-	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -820,7 +811,7 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -854,23 +845,7 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveComputeSiteLogL()	{
 	
 	// UpdateMatrices();
 
-	for (int k=0; k<ncomp; k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                ExpoConjugateGTRSBDPProfileProcess::alloc[i] = k;
-            }
-		}
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-                if (std::isnan(sitelogl[i][k]))	{
-                    cerr << "error in RASCATGTRSBDP::SlaveComputeSiteLogL: nan\n";
-                    exit(1);
-                }
-            }
-		}
-	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double* meansitelogl = new double[GetNsite()];
 	for (int i=0; i<GetNsite(); i++)	{
@@ -902,7 +877,7 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveComputeSiteLogL()	{
         }
 	}
 
-	MPI_Send(meansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
@@ -930,19 +905,19 @@ void RASCATGTRSBDPGammaPhyloProcess::GlobalSetEmpiricalPrior(istream& is)    {
     is >> empkappaalpha >> empkappabeta;
 
 	MESSAGE signal = EMPIRICALPRIOR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,PROCESS_COMM);
     if (!dirweightprior)    {
-        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     }
-    MPI_Bcast(emprralpha,GetNrr(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-    MPI_Bcast(emprrbeta,GetNrr(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(emprralpha,GetNrr(),MPI_DOUBLE,0,PROCESS_COMM);
+    MPI_Bcast(emprrbeta,GetNrr(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,PROCESS_COMM);
 
     /*
     empcount = new double[GetNsite()*GetDim()];
@@ -953,117 +928,125 @@ void RASCATGTRSBDPGammaPhyloProcess::GlobalSetEmpiricalPrior(istream& is)    {
     for (int k=0; k<GetNsite()*GetDim(); k++)   {
         is >> empbeta[k];
     }
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-    MPI_Bcast(empbeta,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+    MPI_Bcast(empbeta,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     */
 }
 
 void RASCATGTRSBDPGammaPhyloProcess::SlaveSetEmpiricalPrior()    {
 
-	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,PROCESS_COMM);
     if (!dirweightprior)    {
-        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     }
-    MPI_Bcast(emprralpha,GetNrr(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-    MPI_Bcast(emprrbeta,GetNrr(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(emprralpha,GetNrr(),MPI_DOUBLE,0,PROCESS_COMM);
+    MPI_Bcast(emprrbeta,GetNrr(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,PROCESS_COMM);
 
     /*
     empcount = new double[GetNsite()*GetDim()];
     empbeta = new double[GetNsite()*GetDim()];
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-    MPI_Bcast(empbeta,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+    MPI_Bcast(empbeta,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     */
 }
 
-double RASCATGTRSBDPGammaPhyloProcess::GlobalGetSiteSteppingLogLikelihood(int site, int nrep0, int restore) {
+double RASCATGTRSBDPGammaPhyloProcess::GlobalGetSteppingLogLikelihoodNonIS(int restore) {
 
-    int nrep_per_proc = nrep0 / (GetNprocs()-1);
-    if (nrep0 % (GetNprocs() - 1))  {
-        nrep_per_proc ++;
-    }
-    // int nrep = nrep_per_proc * (GetNprocs()-1);
+    MESSAGE signal = STEPPINGLOGL;
+    MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+    MPI_Bcast(&restore,1,MPI_INT,0,PROCESS_COMM);
 
-    MESSAGE signal = STEPPINGSITELOGL;
-    MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-    int param[3];
-    param[0] = site;
-    param[1] = nrep_per_proc;
-    param[2] = restore;
-    MPI_Bcast(param,3,MPI_INT,0,MPI_COMM_WORLD);
+    // all sites of the step at once: logl and alloc of site j sent by slave i in [i*nsite + j]
+    vector<int> sites;
+    GetSteppingSites(sites);
+    int nsite = sites.size();
 
-    int oldalloc = ExpoConjugateGTRSBDPProfileProcess::alloc[site];
+    double* master_logl = new double[GetNprocs()*nsite];
+    int* master_alloc = new int[GetNprocs()*nsite];
+    double* slave_logl = new double[nsite];
+    int* slave_alloc = new int[nsite];
+    for (int j=0; j<nsite; j++) {
+        slave_logl[j] = 0;
+        slave_alloc[j] = -1;
+    }
 
-    double master_logl[GetNprocs()];
-    double slave_logl;
+    MPI_Gather(slave_logl, nsite, MPI_DOUBLE, master_logl, nsite, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(slave_alloc, nsite, MPI_INT, master_alloc, nsite, MPI_INT, 0, PROCESS_COMM);
 
-    int master_alloc[GetNprocs()];
-    int slave_alloc = -1;
+    double total = 0;
+    for (int j=0; j<nsite; j++) {
 
-    MPI_Gather(&slave_logl, 1, MPI_DOUBLE, master_logl, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        int site = sites[j];
 
-    double max = 0;
-    for (int i=1; i<GetNprocs(); i++)   {
-        if (master_alloc[i] != -1)    {
-            if ((!max) || (max < master_logl[i]))    {
-                max = master_logl[i];
+        double max = 0;
+        for (int i=1; i<GetNprocs(); i++)   {
+            if (master_alloc[i*nsite+j] != -1)    {
+                if ((!max) || (max < master_logl[i*nsite+j]))    {
+                    max = master_logl[i*nsite+j];
+                }
             }
         }
-    }
-
-    double tot = 0;
-    double post[GetNprocs()-1];
-    for (int i=1; i<GetNprocs(); i++)   {
-        if (master_alloc[i] != -1)    {
-            double tmp = exp(master_logl[i]-max);
-            post[i-1] = tmp;
-            tot += tmp;
+        double tot = 0;
+        double post[GetNprocs()-1];
+        for (int i=1; i<GetNprocs(); i++)   {
+            if (master_alloc[i*nsite+j] != -1)    {
+                double tmp = exp(master_logl[i*nsite+j]-max);
+                post[i-1] = tmp;
+                tot += tmp;
+            }
+            else    {
+                post[i-1] = 0;
+            }
         }
-        else    {
-            post[i-1] = 0;
+        if (! tot)  {
+            cerr << "error in stepping logl: total likelihood is 0\n";
+            exit(1);
         }
-    }
-    if (! tot)  {
-        cerr << "error in stepping logl: total likelihood is 0\n";
-        exit(1);
-    }
 
-    double L = log(tot) + max;
+        double L = log(tot) + max;
 
-    for (int i=1; i<GetNprocs(); i++)   {
-        post[i-1] /= tot;
-    }
-    int procalloc = rnd::GetRandom().FiniteDiscrete(GetNprocs()-1, post) + 1;
+        for (int i=1; i<GetNprocs(); i++)   {
+            post[i-1] /= tot;
+        }
+        int procalloc = rnd::GetRandom().FiniteDiscrete(GetNprocs()-1, post) + 1;
 
+        if (! restore)  {
+            int newalloc = master_alloc[procalloc*nsite+j];
+            RemoveSite(site, ExpoConjugateGTRSBDPProfileProcess::alloc[site]);
+            AddSite(site, newalloc);
+        }
+        total += L;
+    }
     if (! restore)  {
-        int newalloc = master_alloc[procalloc];
-        RemoveSite(site, oldalloc);
-        AddSite(site, newalloc);
         GlobalUpdateParameters();
     }
-    return L;
+
+    delete[] master_logl;
+    delete[] master_alloc;
+    delete[] slave_logl;
+    delete[] slave_alloc;
+    return total;
 }
 
-void RASCATGTRSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihood()    {
+void RASCATGTRSBDPGammaPhyloProcess::SlaveGetSteppingLogLikelihoodNonIS()    {
 
 	if (! SumOverRateAllocations())	{
 		cerr << "rate error\n";
 		exit(1);
 	}
 
-    int param[3];
-    MPI_Bcast(param,3,MPI_INT,0,MPI_COMM_WORLD);
-    int site = param[0];
-    // int nrep = param[1];
-    int restore = param[2];
+    int restore;
+    MPI_Bcast(&restore,1,MPI_INT,0,PROCESS_COMM);
 
-    int bkalloc = ExpoConjugateGTRSBDPProfileProcess::alloc[site];
+    vector<int> sites;
+    GetSteppingSites(sites);
+    int nsite = sites.size();
 
 	int width = GetNcomponent() / (GetNprocs()-1);
     int r = GetNcomponent() % (GetNprocs()-1);
@@ -1089,46 +1072,56 @@ void RASCATGTRSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihood()    {
     int kmax = smax[myid-1];
     int krange = kmax - kmin;
 
-    double sitelogl[krange];
-    for (int k=kmin; k<kmax; k++)	{
-        ExpoConjugateGTRSBDPProfileProcess::alloc[site] = k;
-        double tmp = SiteLogLikelihood(site);
-        sitelogl[k-kmin] = tmp;
-    }
+    double* slave_logl = new double[nsite];
+    int* slave_alloc = new int[nsite];
 
-    double max = 0;
-    for (int k=kmin; k<kmax; k++)	{
-        if ((!max) || (max < sitelogl[k-kmin]))	{
-            max = sitelogl[k-kmin];
-        }
-    }
+    for (int j=0; j<nsite; j++) {
 
-    double post[krange];
-    double tot= 0;
-    for (int k=kmin; k<kmax; k++)   {
-        post[k-kmin] = weight[k] * exp(sitelogl[k-kmin] - max);
-        tot += post[k-kmin];
-    }
+        int site = sites[j];
+        int bkalloc = ExpoConjugateGTRSBDPProfileProcess::alloc[site];
 
-    double slave_logl = 0;
-    if (tot > 0)    {
-        slave_logl = log(tot) + max;
-    }
+        double sitelogl[krange];
+        for (int k=kmin; k<kmax; k++)	{
+            ExpoConjugateGTRSBDPProfileProcess::alloc[site] = k;
+            double tmp = SiteLogLikelihood(site);
+            sitelogl[k-kmin] = tmp;
+        }
 
-    int slave_alloc = -1;
-    if (tot > 0)    {
+        double max = 0;
+        for (int k=kmin; k<kmax; k++)	{
+            if ((!max) || (max < sitelogl[k-kmin]))	{
+                max = sitelogl[k-kmin];
+            }
+        }
+
+        double post[krange];
+        double tot= 0;
         for (int k=kmin; k<kmax; k++)   {
-            post[k-kmin] /= tot;
+            post[k-kmin] = weight[k] * exp(sitelogl[k-kmin] - max);
+            tot += post[k-kmin];
+        }
+
+        slave_logl[j] = 0;
+        if (tot > 0)    {
+            slave_logl[j] = log(tot) + max;
         }
-        slave_alloc = rnd::GetRandom().FiniteDiscrete(krange, post) + kmin;
-    }
 
-    double master_logl[GetNprocs()];
-    int master_alloc[GetNprocs()];
+        slave_alloc[j] = -1;
+        if (tot > 0)    {
+            for (int k=kmin; k<kmax; k++)   {
+                post[k-kmin] /= tot;
+            }
+            slave_alloc[j] = rnd::GetRandom().FiniteDiscrete(krange, post) + kmin;
+        }
 
-    MPI_Gather(&slave_logl, 1, MPI_DOUBLE, master_logl, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    if (restore)    {
-        ExpoConjugateGTRSBDPProfileProcess::alloc[site] = bkalloc;
+        if (restore)    {
+            ExpoConjugateGTRSBDPProfileProcess::alloc[site] = bkalloc;
+        }
     }
+
+    MPI_Gather(slave_logl, nsite, MPI_DOUBLE, 0, nsite, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(slave_alloc, nsite, MPI_INT, 0, nsite, MPI_INT, 0, PROCESS_COMM);
+
+    delete[] slave_logl;
+    delete[] slave_alloc;
 }
@@ -84,11 +84,11 @@ class RASCATGTRSBDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProce
 		datafile = indatafile;
 		SequenceAlignment* plaindata;
 		if (iscodon)	{
-			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid);
+			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid,1);
 			plaindata = new CodonSequenceAlignment(tempdata,true,codetype);
 		}
 		else	{
-			plaindata = new FileSequenceAlignment(datafile,0,myid);
+			plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		}
 		if (dc)	{
 			plaindata->DeleteConstantSites();
@@ -179,11 +179,11 @@ class RASCATGTRSBDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProce
 		//SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
 		SequenceAlignment* plaindata;
 		if (iscodon)	{
-			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid);
+			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid,1);
 			plaindata = new CodonSequenceAlignment(tempdata,true,codetype);
 		}
 		else	{
-			plaindata = new FileSequenceAlignment(datafile,0,myid);
+			plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		}
 		if (dc)	{
 			plaindata->DeleteConstantSites();
@@ -228,8 +228,16 @@ class RASCATGTRSBDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProce
     void GlobalSetEmpiricalPrior(istream& is);
     void SlaveSetEmpiricalPrior();
 
-    double GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int restore);
-    void SlaveGetSiteSteppingLogLikelihood();
+    double GlobalGetSteppingLogLikelihood(int nrep, int restore)  {
+        return GlobalGetSteppingLogLikelihoodNonIS(restore);
+    }
+    void SlaveGetSteppingLogLikelihood()    {
+        SlaveGetSteppingLogLikelihoodNonIS();
+    }
+
+    // sums over the components of the mixture (each slave dealing with some of them), for all sites of the step
+    double GlobalGetSteppingLogLikelihoodNonIS(int restore);
+    void SlaveGetSteppingLogLikelihoodNonIS();
 
 	void TraceHeader(ostream& os)	{
 		os << "iter\ttime\ttopo\tloglik\tlength\talpha\tNmode\tstatent\tstatalpha";
@@ -388,6 +396,10 @@ class RASCATGTRSBDPGammaPhyloProcess : public virtual ExpoConjugateGTRPhyloProce
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
 
+	void SetSiteComponent(int site, int k)	{
+		ExpoConjugateGTRSBDPProfileProcess::alloc[site] = k;
+	}
+
 	protected:
 
 	virtual void Create(Tree* intree, SequenceAlignment* indata, int nratecat, string inrrtype, int insitemin,int insitemax)	{
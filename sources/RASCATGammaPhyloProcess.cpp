@@ -54,7 +54,7 @@ void RASCATGammaPhyloProcess::GlobalUpdateParameters()	{
 	int ivector[ni];
 	double dvector[nd];
 	MESSAGE signal = PARAMETER_DIFFUSION;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 
 	// First we assemble the vector of doubles for distribution
 	int index = 0;
@@ -89,8 +89,8 @@ void RASCATGammaPhyloProcess::GlobalUpdateParameters()	{
 	}
 
 	// Now send out the doubles and ints over the wire...
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATGammaPhyloProcess::SlaveExecute(MESSAGE signal)	{
@@ -124,8 +124,8 @@ void RASCATGammaPhyloProcess::SlaveUpdateParameters()	{
 	ni = 1 + GetNsite();
 	int* ivector = new int[ni];
 	double* dvector = new double[nd];
-	MPI_Bcast(ivector,ni,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(ivector,ni,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(dvector,nd,MPI_DOUBLE,0,PROCESS_COMM);
 
 	int index = 0;
 	SetAlpha(dvector[index]);
@@ -528,55 +528,55 @@ void RASCATGammaPhyloProcess::GlobalSetEmpiricalPrior(istream& is)    {
     is >> empkappaalpha >> empkappabeta;
 
 	MESSAGE signal = EMPIRICALPRIOR;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,PROCESS_COMM);
     if (!dirweightprior)    {
-        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     }
-	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,PROCESS_COMM);
 
     /*
     empcount = new double[GetNsite()*GetDim()];
     for (int k=0; k<GetNsite()*GetDim(); k++)   {
         is >> empcount[k];
     }
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     */
 }
 
 void RASCATGammaPhyloProcess::SlaveSetEmpiricalPrior()    {
 
-	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&empalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empbeta,1,MPI_DOUBLE,0,PROCESS_COMM);
     if (!dirweightprior)    {
-        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+        MPI_Bcast(empdirweightalpha,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
+        MPI_Bcast(empdirweightbeta,GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     }
-	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(branchempalpha,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(branchempbeta,GetNbranch(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappaalpha,1,MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(&empkappabeta,1,MPI_DOUBLE,0,PROCESS_COMM);
 
     /*
     empcount = new double[GetNsite()*GetDim()];
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
     */
 }
 
 void RASCATGammaPhyloProcess::GlobalSetSiteLogLCutoff()  {
 
 	MESSAGE signal = SITELOGLCUTOFF;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATGammaPhyloProcess::SlaveSetSiteLogLCutoff()  {
-	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&siteloglcutoff,1,MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATGammaPhyloProcess::ReadSiteProfileSuffStat(string name, int burnin, int every, int until){
@@ -609,7 +609,7 @@ void RASCATGammaPhyloProcess::ReadSiteProfileSuffStat(string name, int burnin, i
 		i++;
 
 		MESSAGE signal = BCAST_TREE;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 		GlobalBroadcastTree();
 		GlobalUpdateConditionalLikelihoods();
 		GlobalCollapse();
@@ -684,16 +684,16 @@ void RASCATGammaPhyloProcess::ReadISSiteLogL(string name, string empname, int bu
     QuickUpdate();
     MPI_Status stat;
     MESSAGE signal = ISSITELOGL;
-    MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-    MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+    MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	double* meansitelogl = new double[GetNsite()];
 	double* varsitelogl = new double[GetNsite()];
 
     for(int i=1; i<GetNprocs(); ++i) {
-        MPI_Recv(meansitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
-        MPI_Recv(varsitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+        MPI_Recv(meansitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
+        MPI_Recv(varsitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
     }
 
     cerr << "ok\n";
@@ -706,8 +706,8 @@ void RASCATGammaPhyloProcess::ReadISSiteLogL(string name, string empname, int bu
     cerr << '\n';
 
     for(int i=1; i<GetNprocs(); ++i) {
-        MPI_Recv(meansitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
-        MPI_Recv(varsitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,MPI_COMM_WORLD,&stat);
+        MPI_Recv(meansitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
+        MPI_Recv(varsitelogl,GetNsite(),MPI_DOUBLE,i,TAG1,PROCESS_COMM,&stat);
     }
 
     cerr << "ok\n";
@@ -740,10 +740,10 @@ void RASCATGammaPhyloProcess::SlaveComputeISSiteLogL()	{
     }
 	
     int nrep;
-    MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+    MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
     double* empcount = new double[GetNsite()*GetDim()];
-    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+    MPI_Bcast(empcount,GetNsite()*GetDim(),MPI_DOUBLE,0,PROCESS_COMM);
 
 	double** sitelogl = new double*[GetNsite()];
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -800,8 +800,8 @@ void RASCATGammaPhyloProcess::SlaveComputeISSiteLogL()	{
         }
     }
 
-	MPI_Send(priormeansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-	MPI_Send(priorvarsitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(priormeansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+	MPI_Send(priorvarsitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	delete[] priormeansitelogl;
 	delete[] priorvarsitelogl;
@@ -857,8 +857,8 @@ void RASCATGammaPhyloProcess::SlaveComputeISSiteLogL()	{
         }
     }
 
-	MPI_Send(postmeansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
-	MPI_Send(postvarsitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(postmeansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+	MPI_Send(postvarsitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	delete[] postmeansitelogl;
 	delete[] postvarsitelogl;
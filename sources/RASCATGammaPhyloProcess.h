@@ -74,7 +74,7 @@ class RASCATGammaPhyloProcess : public virtual PoissonPhyloProcess, public virtu
 		SetMinTotWeight(inmintotweight);
 
 		datafile = indatafile;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -147,7 +147,7 @@ class RASCATGammaPhyloProcess : public virtual PoissonPhyloProcess, public virtu
 			NNNI = 0;
 		}
 		is >> dc;
-		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
+		SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		if (dc)	{
 			plaindata->DeleteConstantSites();
 		}
@@ -22,15 +22,15 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 void RASCATSBDPGammaPhyloProcess::GlobalUpdateParameters()	{
 
 	RASCATGammaPhyloProcess::GlobalUpdateParameters();
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATSBDPGammaPhyloProcess::SlaveUpdateParameters()	{
 
 	RASCATGammaPhyloProcess::SlaveUpdateParameters();
-	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
-	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(V,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
+	MPI_Bcast(weight,GetNcomponent(),MPI_DOUBLE,0,PROCESS_COMM);
 }
 
 void RASCATSBDPGammaPhyloProcess::SlaveExecute(MESSAGE signal)	{
@@ -82,17 +82,7 @@ void RASCATSBDPGammaPhyloProcess::SlaveComputeCVScore()	{
 	
 	// UpdateMatrices();
 
-	for (int k=0; k<ncomp; k++) {
-	// for (int k=0; k<GetNcomponent(); k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-			PoissonSBDPProfileProcess::alloc[i] = k;
-			UpdateZip(i);
-		}
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-			sitelogl[i][k] = sitelogL[i];
-		}
-	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double total = 0;
 	for (int i=sitemin; i<sitemax; i++)	{
@@ -113,7 +103,7 @@ void RASCATSBDPGammaPhyloProcess::SlaveComputeCVScore()	{
 		total += log(tot) + max;
 	}
 
-	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(&total,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -191,7 +181,7 @@ void RASCATSBDPGammaPhyloProcess::SlaveComputeSiteLogCVScore()	{
 		total += meansitelogl[i] ;
 	}
 
-	MPI_Send(meansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
 		delete[] sitelogl[i];
@@ -230,20 +220,7 @@ void RASCATSBDPGammaPhyloProcess::SlaveComputeSiteLogL()	{
         }
 	}
 	
-	for (int k=0; k<ncomp; k++)	{
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                PoissonSBDPProfileProcess::alloc[i] = k;
-                UpdateZip(i);
-            }
-		}
-		UpdateConditionalLikelihoods();
-		for (int i=sitemin; i<sitemax; i++)	{
-            if (ActiveSite(i))  {
-                sitelogl[i][k] = sitelogL[i];
-            }
-		}
-	}
+	ComputeSiteComponentLogL(ncomp,sitelogl);
 
 	double* meansitelogl = new double[GetNsite()];
 	for (int i=0; i<GetNsite(); i++)	{
@@ -269,7 +246,7 @@ void RASCATSBDPGammaPhyloProcess::SlaveComputeSiteLogL()	{
         }
     }
 
-	MPI_Send(meansitelogl,GetNsite(),MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+	MPI_Send(meansitelogl+sitemin,sitemax-sitemin,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
 	
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
@@ -297,19 +274,14 @@ double RASCATSBDPGammaPhyloProcess::GlobalGetSiteSteppingLogLikelihood(int site,
     int nrep = nrep_per_proc * (GetNprocs()-1);
 
     MESSAGE signal = STEPPINGSITELOGL;
-    MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+    MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
     int param[3];
     param[0] = site;
     param[1] = nrep_per_proc;
     param[2] = restore;
-    MPI_Bcast(param,3,MPI_INT,0,MPI_COMM_WORLD);
-    double ret = 0;
-    if (nrep0)  {
-        ret = GlobalGetSiteSteppingLogLikelihoodIS(site, nrep, restore);
-    }
-    else    {
-        ret = GlobalGetSiteSteppingLogLikelihoodNonIS(site, nrep, restore);
-    }
+    MPI_Bcast(param,3,MPI_INT,0,PROCESS_COMM);
+    // without importance sampling, all sites are dealt with at once (GlobalGetSteppingLogLikelihoodNonIS)
+    double ret = GlobalGetSiteSteppingLogLikelihoodIS(site, nrep, restore);
     return ret;
 }
 
@@ -321,17 +293,12 @@ void RASCATSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihood()    {
 	}
 
     int param[3];
-    MPI_Bcast(param,3,MPI_INT,0,MPI_COMM_WORLD);
+    MPI_Bcast(param,3,MPI_INT,0,PROCESS_COMM);
     int site = param[0];
     int nrep = param[1];
     int restore = param[2];
 
-    if (nrep)   {
-        SlaveGetSiteSteppingLogLikelihoodIS(site, nrep, restore);
-    }
-    else    {
-        SlaveGetSiteSteppingLogLikelihoodNonIS(site, nrep, restore);
-    }
+    SlaveGetSiteSteppingLogLikelihoodIS(site, nrep, restore);
 }
 
 
@@ -355,9 +322,9 @@ double RASCATSBDPGammaPhyloProcess::GlobalGetSiteSteppingLogLikelihoodIS(int sit
         slave_profile[k] = 0;
     }
 
-    MPI_Gather(slave_logl, 2, MPI_DOUBLE, master_logl, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather(slave_profile, GetDim(), MPI_DOUBLE, master_profile, GetDim(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather(slave_logl, 2, MPI_DOUBLE, master_logl, 2, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, PROCESS_COMM);
+    MPI_Gather(slave_profile, GetDim(), MPI_DOUBLE, master_profile, GetDim(), MPI_DOUBLE, 0, PROCESS_COMM);
 
     double max1 = 0;
     for (int i=1; i<GetNprocs(); i++)   {
@@ -591,9 +558,9 @@ void RASCATSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihoodIS(int site,
         }
     }
 
-    MPI_Gather(slave_logl, 2, MPI_DOUBLE, master_logl, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather(slave_profile, GetDim(), MPI_DOUBLE, master_profile, GetDim(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather(slave_logl, 2, MPI_DOUBLE, master_logl, 2, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, PROCESS_COMM);
+    MPI_Gather(slave_profile, GetDim(), MPI_DOUBLE, master_profile, GetDim(), MPI_DOUBLE, 0, PROCESS_COMM);
 
     if (restore)    {
         PoissonSBDPProfileProcess::alloc[site] = bkalloc;
@@ -604,63 +571,97 @@ void RASCATSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihoodIS(int site,
     }
 }
 
-double RASCATSBDPGammaPhyloProcess::GlobalGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore) {
+double RASCATSBDPGammaPhyloProcess::GlobalGetSteppingLogLikelihoodNonIS(int restore) {
 
-    int oldalloc = PoissonSBDPProfileProcess::alloc[site];
+    MESSAGE signal = STEPPINGLOGL;
+    MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+    MPI_Bcast(&restore,1,MPI_INT,0,PROCESS_COMM);
 
-    double master_logl[GetNprocs()];
-    double slave_logl;
+    // all sites of the step at once: logl and alloc of site j sent by slave i in [i*nsite + j]
+    vector<int> sites;
+    GetSteppingSites(sites);
+    int nsite = sites.size();
 
-    int master_alloc[GetNprocs()];
-    int slave_alloc = -1;
+    double* master_logl = new double[GetNprocs()*nsite];
+    int* master_alloc = new int[GetNprocs()*nsite];
+    double* slave_logl = new double[nsite];
+    int* slave_alloc = new int[nsite];
+    for (int j=0; j<nsite; j++) {
+        slave_logl[j] = 0;
+        slave_alloc[j] = -1;
+    }
 
-    MPI_Gather(&slave_logl, 1, MPI_DOUBLE, master_logl, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather(slave_logl, nsite, MPI_DOUBLE, master_logl, nsite, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(slave_alloc, nsite, MPI_INT, master_alloc, nsite, MPI_INT, 0, PROCESS_COMM);
 
-    double max = 0;
-    for (int i=1; i<GetNprocs(); i++)   {
-        if (master_alloc[i] != -1)    {
-            if ((!max) || (max < master_logl[i]))    {
-                max = master_logl[i];
+    double total = 0;
+    for (int j=0; j<nsite; j++) {
+
+        int site = sites[j];
+
+        double max = 0;
+        for (int i=1; i<GetNprocs(); i++)   {
+            if (master_alloc[i*nsite+j] != -1)    {
+                if ((!max) || (max < master_logl[i*nsite+j]))    {
+                    max = master_logl[i*nsite+j];
+                }
             }
         }
-    }
-    double tot = 0;
-    double post[GetNprocs()-1];
-    for (int i=1; i<GetNprocs(); i++)   {
-        if (master_alloc[i] != -1)    {
-            double tmp = exp(master_logl[i]-max);
-            post[i-1] = tmp;
-            tot += tmp;
+        double tot = 0;
+        double post[GetNprocs()-1];
+        for (int i=1; i<GetNprocs(); i++)   {
+            if (master_alloc[i*nsite+j] != -1)    {
+                double tmp = exp(master_logl[i*nsite+j]-max);
+                post[i-1] = tmp;
+                tot += tmp;
+            }
+            else    {
+                post[i-1] = 0;
+            }
         }
-        else    {
-            post[i-1] = 0;
+        if (! tot)  {
+            cerr << "error in stepping logl: total likelihood is 0\n";
+            exit(1);
         }
-    }
-    if (! tot)  {
-        cerr << "error in stepping logl: total likelihood is 0\n";
-        exit(1);
-    }
 
-    double L = log(tot) + max;
+        double L = log(tot) + max;
 
-    for (int i=1; i<GetNprocs(); i++)   {
-        post[i-1] /= tot;
-    }
-    int procalloc = rnd::GetRandom().FiniteDiscrete(GetNprocs()-1, post) + 1;
+        for (int i=1; i<GetNprocs(); i++)   {
+            post[i-1] /= tot;
+        }
+        int procalloc = rnd::GetRandom().FiniteDiscrete(GetNprocs()-1, post) + 1;
 
+        if (! restore)  {
+            int newalloc = master_alloc[procalloc*nsite+j];
+            RemoveSite(site, PoissonSBDPProfileProcess::alloc[site]);
+            AddSite(site, newalloc);
+        }
+        total += L;
+    }
     if (! restore)  {
-        int newalloc = master_alloc[procalloc];
-        RemoveSite(site, oldalloc);
-        AddSite(site, newalloc);
         GlobalUpdateParameters();
     }
-    return L;
+
+    delete[] master_logl;
+    delete[] master_alloc;
+    delete[] slave_logl;
+    delete[] slave_alloc;
+    return total;
 }
 
-void RASCATSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore)    {
+void RASCATSBDPGammaPhyloProcess::SlaveGetSteppingLogLikelihoodNonIS()    {
 
-    int bkalloc = PoissonSBDPProfileProcess::alloc[site];
+	if (! SumOverRateAllocations())	{
+		cerr << "rate error\n";
+		exit(1);
+	}
+
+    int restore;
+    MPI_Bcast(&restore,1,MPI_INT,0,PROCESS_COMM);
+
+    vector<int> sites;
+    GetSteppingSites(sites);
+    int nsite = sites.size();
 
 	int width = GetNcomponent() / (GetNprocs()-1);
     int r = GetNcomponent() % (GetNprocs()-1);
@@ -686,48 +687,58 @@ void RASCATSBDPGammaPhyloProcess::SlaveGetSiteSteppingLogLikelihoodNonIS(int sit
     int kmax = smax[myid-1];
     int krange = kmax - kmin;
 
-    double sitelogl[krange];
-    for (int k=kmin; k<kmax; k++)	{
-        PoissonSBDPProfileProcess::alloc[site] = k;
-        double tmp = SiteLogLikelihood(site);
-        sitelogl[k-kmin] = tmp;
-    }
+    double* slave_logl = new double[nsite];
+    int* slave_alloc = new int[nsite];
 
-    double max = 0;
-    for (int k=kmin; k<kmax; k++)	{
-        if ((!max) || (max < sitelogl[k-kmin]))	{
-            max = sitelogl[k-kmin];
-        }
-    }
+    for (int j=0; j<nsite; j++) {
 
-    double post[krange];
-    double tot= 0;
-    for (int k=kmin; k<kmax; k++)   {
-        post[k-kmin] = weight[k] * exp(sitelogl[k-kmin] - max);
-        tot += post[k-kmin];
-    }
+        int site = sites[j];
+        int bkalloc = PoissonSBDPProfileProcess::alloc[site];
 
-    double slave_logl = 0;
-    if (tot > 0)    {
-        slave_logl = log(tot) + max;
-    }
+        double sitelogl[krange];
+        for (int k=kmin; k<kmax; k++)	{
+            PoissonSBDPProfileProcess::alloc[site] = k;
+            double tmp = SiteLogLikelihood(site);
+            sitelogl[k-kmin] = tmp;
+        }
 
-    int slave_alloc = -1;
-    if (tot > 0)    {
+        double max = 0;
+        for (int k=kmin; k<kmax; k++)	{
+            if ((!max) || (max < sitelogl[k-kmin]))	{
+                max = sitelogl[k-kmin];
+            }
+        }
+
+        double post[krange];
+        double tot= 0;
         for (int k=kmin; k<kmax; k++)   {
-            post[k-kmin] /= tot;
+            post[k-kmin] = weight[k] * exp(sitelogl[k-kmin] - max);
+            tot += post[k-kmin];
         }
-        slave_alloc = rnd::GetRandom().FiniteDiscrete(krange, post) + kmin;
-    }
 
-    double master_logl[GetNprocs()];
-    int master_alloc[GetNprocs()];
+        slave_logl[j] = 0;
+        if (tot > 0)    {
+            slave_logl[j] = log(tot) + max;
+        }
 
-    MPI_Gather(&slave_logl, 1, MPI_DOUBLE, master_logl, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    MPI_Gather(&slave_alloc, 1, MPI_INT, master_alloc, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    if (restore)    {
-        PoissonSBDPProfileProcess::alloc[site] = bkalloc;
-        UpdateZip(site);
+        slave_alloc[j] = -1;
+        if (tot > 0)    {
+            for (int k=kmin; k<kmax; k++)   {
+                post[k-kmin] /= tot;
+            }
+            slave_alloc[j] = rnd::GetRandom().FiniteDiscrete(krange, post) + kmin;
+        }
+
+        if (restore)    {
+            PoissonSBDPProfileProcess::alloc[site] = bkalloc;
+                UpdateZip(site);
+        }
     }
+
+    MPI_Gather(slave_logl, nsite, MPI_DOUBLE, 0, nsite, MPI_DOUBLE, 0, PROCESS_COMM);
+    MPI_Gather(slave_alloc, nsite, MPI_INT, 0, nsite, MPI_INT, 0, PROCESS_COMM);
+
+    delete[] slave_logl;
+    delete[] slave_alloc;
 }
 
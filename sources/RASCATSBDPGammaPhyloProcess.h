@@ -83,11 +83,11 @@ class RASCATSBDPGammaPhyloProcess : public virtual RASCATGammaPhyloProcess, publ
 		datafile = indatafile;
 		SequenceAlignment* plaindata;
 		if (iscodon)	{
-			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid);
+			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid,1);
 			plaindata = new CodonSequenceAlignment(tempdata,true,codetype);
 		}
 		else	{
-			plaindata = new FileSequenceAlignment(datafile,0,myid);
+			plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		}
 		if (dc)	{
 			plaindata->DeleteConstantSites();
@@ -171,11 +171,11 @@ class RASCATSBDPGammaPhyloProcess : public virtual RASCATGammaPhyloProcess, publ
 		//SequenceAlignment* plaindata = new FileSequenceAlignment(datafile,0,myid);
 		SequenceAlignment* plaindata;
 		if (iscodon)	{
-			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid);
+			SequenceAlignment* tempdata = new FileSequenceAlignment(datafile,0,myid,1);
 			plaindata = new CodonSequenceAlignment(tempdata,true,codetype);
 		}
 		else	{
-			plaindata = new FileSequenceAlignment(datafile,0,myid);
+			plaindata = new FileSequenceAlignment(datafile,0,myid,1);
 		}
 		if (dc)	{
 			plaindata->DeleteConstantSites();
@@ -242,6 +242,11 @@ class RASCATSBDPGammaPhyloProcess : public virtual RASCATGammaPhyloProcess, publ
 	void SlaveComputeCVScore();
 	void SlaveComputeSiteLogL();
 
+	void SetSiteComponent(int site, int k)	{
+		PoissonSBDPProfileProcess::alloc[site] = k;
+		UpdateZip(site);
+	}
+
 	void FromStream(istream& is)	{
 		GammaBranchProcess::FromStream(is);
 		DGamRateProcess::FromStream(is);
@@ -322,8 +327,21 @@ class RASCATSBDPGammaPhyloProcess : public virtual RASCATGammaPhyloProcess, publ
     void SlaveGetSiteSteppingLogLikelihood();
     double GlobalGetSiteSteppingLogLikelihoodIS(int site, int nrep, int restore);
     void SlaveGetSiteSteppingLogLikelihoodIS(int site, int nrep, int restore);
-    double GlobalGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore);
-    void SlaveGetSiteSteppingLogLikelihoodNonIS(int site, int nrep, int restore);
+
+    // importance sampling (nrep > 0): one site at a time
+    double GlobalGetSteppingLogLikelihood(int nrep, int restore)  {
+        if (nrep)   {
+            return GlobalGetSteppingLogLikelihoodBySite(nrep, restore);
+        }
+        return GlobalGetSteppingLogLikelihoodNonIS(restore);
+    }
+    void SlaveGetSteppingLogLikelihood()    {
+        SlaveGetSteppingLogLikelihoodNonIS();
+    }
+
+    // sums over the components of the mixture (each slave dealing with some of them), for all sites of the step
+    double GlobalGetSteppingLogLikelihoodNonIS(int restore);
+    void SlaveGetSteppingLogLikelihoodNonIS();
 };
 
 #endif
@@ -83,6 +83,13 @@ Random::Random(int seed)	{
 	count = 0;
 	Seed = 0;
 	mt_index = 0;
+	counterbased = false;
+	instream = false;
+	streamseed = 0;
+	epoch = 0;
+	streamunit = 0;
+	streamslot = 0;
+	streamdraw = 0;
 	InitRandom(seed);
 }
 
@@ -99,6 +106,10 @@ double Random::Uniform() {
 
 	count++;
 
+	if (instream)	{
+		return StreamUniform();
+	}
+
     // Mersenne twister 
     // Matsumora and Nishimora 1996
     // 32-bit generator
@@ -167,6 +178,94 @@ double Random::Uniform() {
 
 
 
+// ---------------------------------------------------------------------------------
+//		 counter-based streams
+// ---------------------------------------------------------------------------------
+
+void Random::SetCounterBased(int seed)	{
+	counterbased = true;
+	streamseed = (uint32_t) seed;
+	epoch = 0;
+	unitdraw.clear();
+	unitepoch.clear();
+}
+
+void Random::OpenStream(int unit, int purpose)	{
+
+	if (! counterbased)	{
+		return;
+	}
+	if (instream)	{
+		cerr << "error in Random::OpenStream: stream already open\n";
+		exit(1);
+	}
+	int slot = unit * NPURPOSE + purpose;
+	if (slot >= (int) unitdraw.size())	{
+		unitdraw.resize(slot+1,0);
+		unitepoch.resize(slot+1,0);
+	}
+	if (unitepoch[slot] != epoch)	{
+		unitepoch[slot] = epoch;
+		unitdraw[slot] = 0;
+	}
+	instream = true;
+	streamunit = unit;
+	streamslot = slot;
+	streamkey[0] = streamseed;
+	streamkey[1] = (uint32_t) purpose;
+	streamdraw = unitdraw[slot];
+	if (streamdraw & 3)	{
+		// resuming in the middle of a block
+		uint32_t ctr[4] = {streamdraw >> 2, (uint32_t) unit, (uint32_t) epoch, (uint32_t) (epoch >> 32)};
+		Philox(ctr,streamkey,streamblock);
+	}
+}
+
+void Random::CloseStream()	{
+
+	if (! instream)	{
+		return;
+	}
+	unitdraw[streamslot] = streamdraw;
+	instream = false;
+}
+
+double Random::StreamUniform()	{
+
+	if (! (streamdraw & 3))	{
+		uint32_t ctr[4] = {streamdraw >> 2, (uint32_t) streamunit, (uint32_t) epoch, (uint32_t) (epoch >> 32)};
+		Philox(ctr,streamkey,streamblock);
+	}
+	uint32_t r = streamblock[streamdraw & 3];
+	streamdraw++;
+	// in (0,1), boundaries excluded
+	return (r + 0.5) / 4294967296.0;
+}
+
+void Random::Philox(const uint32_t* ctr, const uint32_t* key, uint32_t* out)	{
+
+	uint32_t c0 = ctr[0];
+	uint32_t c1 = ctr[1];
+	uint32_t c2 = ctr[2];
+	uint32_t c3 = ctr[3];
+	uint32_t k0 = key[0];
+	uint32_t k1 = key[1];
+	for (int round=0; round<10; round++)	{
+		uint64_t p0 = ((uint64_t) 0xD2511F53) * c0;
+		uint64_t p1 = ((uint64_t) 0xCD9E8D57) * c2;
+		c0 = ((uint32_t) (p1 >> 32)) ^ c1 ^ k0;
+		c1 = (uint32_t) p1;
+		c2 = ((uint32_t) (p0 >> 32)) ^ c3 ^ k1;
+		c3 = (uint32_t) p0;
+		k0 += 0x9E3779B9;
+		k1 += 0xBB67AE85;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
 // ---------------------------------------------------------------------------------
 //		 Gamma()
 // ---------------------------------------------------------------------------------
@@ -23,6 +23,8 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
+#include <stdint.h>
 
 #define MT_LEN       624
 
@@ -75,13 +77,44 @@ class Random {
 
 	long int GetCount() {return count;}
 
+	// counter-based streams (Philox4x32-10, Salmon et al 2011)
+	// between OpenStream and CloseStream, all draws come from a generator keyed by (seed, purpose)
+	// and indexed by (epoch, unit, draw number) instead of from the Mersenne twister.
+	// a unit is a site (or a component): the draws made for it in a given epoch
+	// thus do not depend on which process handles it, nor on how many processes there are.
+	// slaves start a new epoch upon each message received from the master.
+	// OpenStream and CloseStream do nothing unless SetCounterBased has been called
+	enum Purpose {RATEALLOC, NODESTATE, SUBPATH, MIXALLOC, COMPONENT, NPURPOSE};
+
+	void SetCounterBased(int seed);
+	bool IsCounterBased() {return counterbased;}
+	void NextEpoch() {epoch++;}
+	void OpenStream(int unit, int purpose);
+	void CloseStream();
+
 	private:
 
+	double StreamUniform();
+	static void Philox(const uint32_t* ctr, const uint32_t* key, uint32_t* out);
+
 	long int count;
 	int Seed;
 	int mt_index;
 	unsigned long mt_buffer[MT_LEN];
 
+	bool counterbased;
+	bool instream;
+	uint32_t streamseed;
+	uint64_t epoch;
+	int streamunit;
+	int streamslot;
+	uint32_t streamkey[2];
+	uint32_t streamdraw;
+	uint32_t streamblock[4];
+	// number of draws made by each unit, for each purpose, in the current epoch
+	vector<uint32_t> unitdraw;
+	vector<uint64_t> unitepoch;
+
 
   };
 
@@ -26,13 +26,48 @@ int main(int argc, char* argv[])	{
 	MPI_Comm_rank(MPI_COMM_WORLD,&myid);
 	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
 
+	// sample-parallel mode: -ngroup <n>
+	// the processes are split into n groups (one master and its slaves each)
+	// samples are dealt over groups, and the results are merged at the end
+	// the option is removed from the command line before being passed on to the model
+	// (as is -cache: reading the data through a binary cache, see AlignmentCache.h)
+	int ngroup = 1;
+	int samplepar = 0;
+	vector<char*> args;
+	for (int i=0; i<argc; i++)	{
+		string s = argv[i];
+		if ((s == "-ngroup") && (i < argc-2))	{
+			i++;
+			ngroup = atoi(argv[i]);
+		}
+		else if (s == "-cache")	{
+			FileSequenceAlignment::usecache = true;
+		}
+		else	{
+			if ((s == "-sitelogl") || (s == "-jointcv") || (s == "-sitecv") || (s == "-r") || (s == "-anc"))	{
+				samplepar = 1;
+			}
+			args.push_back(argv[i]);
+		}
+	}
+	if ((ngroup > 1) && (! samplepar))	{
+		if (! myid)	{
+			cerr << "error: -ngroup is only available with -sitelogl, -jointcv, -sitecv, -r or -anc\n";
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	SplitProcessGroups(ngroup);
+	MPI_Comm_rank(PROCESS_COMM,&myid);
+	MPI_Comm_size(PROCESS_COMM,&nprocs);
+
 	string name = argv[argc-1];
 	
 	Model* model = new Model(name,myid,nprocs);
 	if (myid == 0) {
-		model->ReadPB(argc,argv);
+		model->ReadPB(args.size(),args.data());
 		MESSAGE signal = KILL;
-		MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+		MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
 	}
 	else	{
 		model->WaitLoop();
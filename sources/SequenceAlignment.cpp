@@ -16,8 +16,15 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "SequenceAlignment.h"
 #include "StringStreamUtils.h"
 #include "BiologicalSequences.h"
+#include "Parallel.h"
 
 #include <fstream>
+#include <cstdio>
+#include <cctype>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
@@ -35,6 +42,13 @@ double Double(string s)	{
 }
 
 void SequenceAlignment::GetEmpiricalFreq(double* in)	{
+	if (GetCache())	{
+		const double* empfreq = GetCache()->GetEmpiricalFreq();
+		for (int i=0; i<GetNstate(); i++)	{
+			in[i] = empfreq[i];
+		}
+		return;
+	}
 	int n = GetNstate();
 	for (int i=0; i<GetNstate(); i++)	{
 		in[i] = 0;
@@ -171,12 +185,172 @@ void SequenceAlignment::ToStream(ostream& os)	{
 	os << '\n';
 }
 
-FileSequenceAlignment::FileSequenceAlignment(string filename,int fullline,int myid)	{
+// ---------------------------------------------------------------------------
+//		 DataBuffer
+// ---------------------------------------------------------------------------
+
+// read-only memory mapping of a data file,
+// offering the few istream-like operations needed by the phylip reader
+// (with the same end-of-file semantics: eof() is set by a read attempted past the end)
+
+class DataBuffer	{
+
+	public:
+
+	DataBuffer(string filename) : buf(0), len(0), pos(0), eofflag(false)	{
+		fd = open(filename.c_str(),O_RDONLY);
+		if (fd == -1)	{
+			cerr << "error : cannot find data file " << filename << '\n';
+			cerr << "\n";
+			exit(1);
+		}
+		struct stat st;
+		if (fstat(fd,&st))	{
+			cerr << "error : cannot access data file " << filename << '\n';
+			exit(1);
+		}
+		len = st.st_size;
+		if (len)	{
+			void* p = mmap(0,len,PROT_READ,MAP_PRIVATE,fd,0);
+			if (p == MAP_FAILED)	{
+				cerr << "error : cannot map data file " << filename << '\n';
+				exit(1);
+			}
+			madvise(p,len,MADV_SEQUENTIAL);
+			buf = (const unsigned char*) p;
+		}
+	}
+
+	~DataBuffer()	{
+		if (buf)	{
+			munmap((void*) buf,len);
+		}
+		close(fd);
+	}
+
+	bool eof() {return eofflag;}
+
+	size_t Tell() {return pos;}
+
+	void Seek(size_t inpos)	{
+		pos = inpos;
+		eofflag = false;
+	}
+
+	int get()	{
+		if (pos < len)	{
+			return buf[pos++];
+		}
+		eofflag = true;
+		return EOF;
+	}
+
+	int peek()	{
+		if (pos < len)	{
+			return buf[pos];
+		}
+		eofflag = true;
+		return EOF;
+	}
+
+	// next whitespace-delimited word (as in >> string)
+	string Word()	{
+		SkipSpace();
+		size_t begin = pos;
+		while ((pos < len) && (! isspace(buf[pos])))	{
+			pos++;
+		}
+		if (pos == len)	{
+			eofflag = true;
+		}
+		return string((const char*) buf + begin, pos - begin);
+	}
+
+	// skips a (...) or {...} group of characters, the opening one having already been read
+	void SkipGroup(int open)	{
+		int closing = (open == '(') ? ')' : '}';
+		int c = open;
+		while ((c != closing) && (! eofflag))	{
+			SkipSpace();
+			c = get();
+		}
+	}
+
+	void SkipNewLines()	{
+		int c = peek();
+		while ((! eofflag) && ((c == '\n') || (c == '\r')))	{
+			get();
+			c = peek();
+		}
+	}
+
+	private:
+
+	void SkipSpace()	{
+		while ((pos < len) && isspace(buf[pos]))	{
+			pos++;
+		}
+	}
+
+	const unsigned char* buf;
+	size_t len;
+	size_t pos;
+	bool eofflag;
+	int fd;
+};
+
+bool FileSequenceAlignment::usecache = false;
+
+static string GetCacheName(string filename)	{
+	return Path + filename + ".pbcache";
+}
+
+FileSequenceAlignment::FileSequenceAlignment(string filename,int fullline,int myid,int shared)	{
 
 	SpeciesNames = 0;
-	if (myid == 0) cerr << "read data from file : " << filename << "\n";
-	ReadDataFromFile(filename,0);
-	taxset = new TaxonSet(SpeciesNames,Ntaxa);
+	cache = 0;
+	// in shared mode, the alignment is read once for the whole job,
+	// even when processes are split into several groups (pb_mpi -nchain, readpb_mpi -ngroup)
+	if (shared)	{
+		MPI_Comm_rank(MPI_COMM_WORLD,&myid);
+	}
+	if ((! shared) || (myid == 0))	{
+		if (usecache)	{
+			cache = AlignmentCache::Open(GetCacheName(filename),Path + filename);
+		}
+		if (cache)	{
+			if (myid == 0) cerr << "read data from cache : " << GetCacheName(filename) << "\n";
+			ReadDataFromCache();
+		}
+		else	{
+			if (myid == 0) cerr << "read data from file : " << filename << "\n";
+			ReadDataFromFile(filename,0);
+		}
+		taxset = new TaxonSet(SpeciesNames,Ntaxa);
+		if (usecache && (! cache) && (myid == 0))	{
+			WriteCache(filename);
+		}
+	}
+	if (shared)	{
+		// if there is a cache on disk, all processes map it (sharing the same pages within a node)
+		// otherwise, process 0 sends what it has read
+		int cached = (cache != 0);
+		MPI_Bcast(&cached,1,MPI_INT,0,MPI_COMM_WORLD);
+		if (! cached)	{
+			BroadcastData(myid);
+		}
+		else if (myid)	{
+			cache = AlignmentCache::Open(GetCacheName(filename),"");
+			if (! cache)	{
+				cerr << "error: cannot open alignment cache " << GetCacheName(filename) << '\n';
+				exit(1);
+			}
+			ReadDataFromCache();
+		}
+		if (myid)	{
+			taxset = new TaxonSet(SpeciesNames,Ntaxa);
+		}
+	}
 	if (myid == 0) {
 		cerr << "number of taxa  : " << GetNtaxa() << '\n';
 		cerr << "number of sites : " << GetNsite() << '\n';
@@ -185,54 +359,182 @@ FileSequenceAlignment::FileSequenceAlignment(string filename,int fullline,int my
 	delete[] SpeciesNames;
 }
 
+FileSequenceAlignment::~FileSequenceAlignment()	{
+	delete cache;
+}
+
 int FileSequenceAlignment::ReadDataFromFile (string filespec, int forceinterleaved)	{
 	
-	string tmp;
-	ifstream is((Path + filespec).c_str());
-	if (!is)	{
-		cerr << "error : cannot find data file " << filespec << '\n';
-		cerr << "\n";
+	DataBuffer buffer(Path + filespec);
+	string tmp = buffer.Word();
+	if (tmp == "#NEXUS")	{
+		ReadNexus(filespec);
+	}
+	else if (tmp == "#SPECIALALPHABET")	{
+		ReadSpecial(filespec);
+	}
+	else	{
+		buffer.Seek(0);
+		ReadPhylip(buffer,forceinterleaved);
+	}
+	return 1;
+}
+
+// state space tags, used by BroadcastData and by the binary cache
+static const int DNAtag = 0;
+static const int RNAtag = 1;
+static const int AAtag = 2;
+static const int Specialtag = 3;
+
+static int GetStateSpaceTag(StateSpace* statespace)	{
+	if (dynamic_cast<DNAStateSpace*>(statespace))	{
+		return DNAtag;
+	}
+	if (dynamic_cast<RNAStateSpace*>(statespace))	{
+		return RNAtag;
+	}
+	if (dynamic_cast<ProteinStateSpace*>(statespace))	{
+		return AAtag;
+	}
+	return Specialtag;
+}
+
+static StateSpace* MakeStateSpace(int tag, int nstate, int nalphabetset, char* alphabetset)	{
+	if (tag == DNAtag)	{
+		return new DNAStateSpace;
+	}
+	if (tag == RNAtag)	{
+		return new RNAStateSpace;
+	}
+	if (tag == AAtag)	{
+		return new ProteinStateSpace;
+	}
+	// special alphabets: the alphabet is the beginning of the alphabet set
+	return new SimpleStateSpace(nstate,nalphabetset,alphabetset,alphabetset);
+}
+
+static SimpleStateSpace* GetSimpleStateSpace(StateSpace* statespace)	{
+	SimpleStateSpace* simplespace = dynamic_cast<SimpleStateSpace*>(statespace);
+	if (! simplespace)	{
+		cerr << "error in FileSequenceAlignment: not a one-letter state space\n";
 		exit(1);
 	}
-	is >> tmp;
-	try{
-		if (tmp == "#NEXUS")	{
-			ReadNexus(filespec);
-			return 1;
+	return simplespace;
+}
+
+static string GetAlphabetSet(SimpleStateSpace* simplespace)	{
+	string alphabetset;
+	for (int p=0; p<simplespace->GetNAlphabetSet(); p++)	{
+		alphabetset += simplespace->GetCharState(p);
+	}
+	return alphabetset;
+}
+
+void FileSequenceAlignment::ReadDataFromCache()	{
+
+	Ntaxa = cache->GetNtaxa();
+	Nsite = cache->GetNsite();
+	string alphabetset = cache->GetAlphabetSet();
+	statespace = MakeStateSpace(cache->GetStateSpaceTag(),cache->GetNstate(),alphabetset.length(),&alphabetset[0]);
+	SpeciesNames = new string[Ntaxa];
+	cache->GetNames(SpeciesNames);
+	Data = new int*[Ntaxa];
+	for (int i=0; i<Ntaxa; i++)	{
+		Data[i] = new int[Nsite];
+		for (int j=0; j<Nsite; j++)	{
+			Data[i][j] = cache->GetState(i,j);
 		}
-		else if (tmp == "#SPECIALALPHABET")	{
-			ReadSpecial(filespec);
-			return 1;
+	}
+}
+
+void FileSequenceAlignment::WriteCache(string filename)	{
+
+	SimpleStateSpace* simplespace = GetSimpleStateSpace(statespace);
+	double* empfreq = new double[GetNstate()];
+	GetEmpiricalFreq(empfreq);
+	if (AlignmentCache::Write(GetCacheName(filename),Path + filename,Ntaxa,Nsite,GetStateSpaceTag(statespace),GetNstate(),GetAlphabetSet(simplespace),SpeciesNames,Data,empfreq))	{
+		cache = AlignmentCache::Open(GetCacheName(filename),Path + filename);
+		cerr << "data written into cache : " << GetCacheName(filename) << '\n';
+	}
+	else	{
+		cerr << "warning: could not write alignment cache " << GetCacheName(filename) << '\n';
+	}
+	delete[] empfreq;
+}
+
+void FileSequenceAlignment::BroadcastData(int myid)	{
+
+	// ntaxa, nsite, state space tag, nstate, size of the alphabet set, total length of the taxon names
+	int header[6];
+	string names;
+	string alphabetset;
+	if (! myid)	{
+		SimpleStateSpace* simplespace = GetSimpleStateSpace(statespace);
+		for (int i=0; i<Ntaxa; i++)	{
+			names += SpeciesNames[i];
+			names += '\n';
+		}
+		alphabetset = GetAlphabetSet(simplespace);
+		header[0] = Ntaxa;
+		header[1] = Nsite;
+		header[2] = GetStateSpaceTag(statespace);
+		header[3] = simplespace->GetNstate();
+		header[4] = alphabetset.length();
+		header[5] = names.length();
+	}
+	MPI_Bcast(header,6,MPI_INT,0,MPI_COMM_WORLD);
+
+	int nstate = header[3];
+	int nalphabetset = header[4];
+	char* buf = new char[nalphabetset + header[5]];
+	if (! myid)	{
+		alphabetset.copy(buf,nalphabetset);
+		names.copy(buf + nalphabetset,header[5]);
+	}
+	MPI_Bcast(buf,nalphabetset + header[5],MPI_CHAR,0,MPI_COMM_WORLD);
+
+	if (myid)	{
+		Ntaxa = header[0];
+		Nsite = header[1];
+		statespace = MakeStateSpace(header[2],nstate,nalphabetset,buf);
+		SpeciesNames = new string[Ntaxa];
+		const char* name = buf + nalphabetset;
+		for (int i=0; i<Ntaxa; i++)	{
+			const char* end = name;
+			while (*end != '\n') end++;
+			SpeciesNames[i] = string(name,end-name);
+			name = end + 1;
 		}
-		else	{
-			// cerr << "PHYLIP\n";
-			if (! forceinterleaved)	{
-				// cerr << "test sequential phylip\n";
-				int returnvalue = TestPhylipSequential(filespec);
-				if (returnvalue)	{
-					// cerr << "assuming phylip sequential format\n";
-					ReadPhylipSequential(filespec);
-					return 1;
+		Data = new int*[Ntaxa];
+		for (int i=0; i<Ntaxa; i++)	{
+			Data[i] = new int[Nsite];
+		}
+	}
+	delete[] buf;
+
+	// states are sent one byte each whenever possible, one taxon at a time
+	if (nstate < 128)	{
+		signed char* seq = new signed char[Nsite];
+		for (int i=0; i<Ntaxa; i++)	{
+			if (! myid)	{
+				for (int k=0; k<Nsite; k++)	{
+					seq[k] = Data[i][k];
 				}
 			}
-			// cerr << "test interleaved phylip\n";
-			int returnvalue = TestPhylip(filespec,1);
-			if (returnvalue)	{
-				// cerr << "assuming phylip interleaved format\n";
-				ReadPhylip(filespec,1);
-				return 1;
+			MPI_Bcast(seq,Nsite,MPI_SIGNED_CHAR,0,MPI_COMM_WORLD);
+			if (myid)	{
+				for (int k=0; k<Nsite; k++)	{
+					Data[i][k] = seq[k];
+				}
 			}
-			TestPhylip(filespec,0);
-			// cerr << "assuming phylip interleaved format\n";
-			ReadPhylip(filespec,0);
-			return 1;
 		}
+		delete[] seq;
 	}
-	catch(...)	{
-		exit(1);
-		return 0;
+	else	{
+		for (int i=0; i<Ntaxa; i++)	{
+			MPI_Bcast(Data[i],Nsite,MPI_INT,0,MPI_COMM_WORLD);
+		}
 	}
-	return 1;
 }
 
 int FileSequenceAlignment::ReadNexus(string filespec)	{
@@ -253,20 +555,22 @@ int FileSequenceAlignment::ReadNexus(string filespec)	{
 		
 
 
+		SimpleStateSpace* simplespace = 0;
 		if (EquivalentStrings(type,"protein"))	{
-			statespace = new ProteinStateSpace();
+			simplespace = new ProteinStateSpace();
 		}
 		else if (EquivalentStrings(type,"dna"))	{
-			statespace = new DNAStateSpace();
+			simplespace = new DNAStateSpace();
 		}
 		else if (EquivalentStrings(type,"rna"))	{
-			statespace = new RNAStateSpace();
+			simplespace = new RNAStateSpace();
 		}
 		else	{
 			cerr << "error cannot recognise data type\n";
 			cerr << type << "\n";
 			exit(1);
 		}
+		statespace = simplespace;
 
 		if (Data)	{
 			for (int i=0; i<Ntaxa; i++)	{
@@ -330,9 +634,11 @@ int FileSequenceAlignment::ReadNexus(string filespec)	{
 							}
 						}
 						else	{
-							ostringstream s;
-							s << c;
-							Data[i][k] = statespace->GetState(s.str());
+							Data[i][k] = simplespace->GetByteState(c);
+							if (Data[i][k] == SimpleStateSpace::notastate)	{
+								cout << "error: does not recognise character " << c << '\n';
+								exit(1);
+							}
 						}
 						k++;
 					}
@@ -477,503 +783,230 @@ int FileSequenceAlignment::ReadSpecial(string filespec)	{
 //		 ReadPhylip()
 // ---------------------------------------------------------------------------
 
-int FileSequenceAlignment::TestPhylipSequential (string filespec)	{
-
-	ifstream theStream((Path + filespec).c_str());
-	try	{
-
-		// cerr << "beware: phylip data sets only for amino acids for the moment\n";
-		// cerr.flush();
-	
-		string temp;
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		Ntaxa = atoi(temp.c_str());
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		Nsite = atoi(temp.c_str());
-		//cerr << Ntaxa << '\t' << Nsite << '\n';
-
-		delete[] SpeciesNames;
-		SpeciesNames = new string[Ntaxa];
-
-		int AAcomp = 1;
-		int DNAcomp = 1;
-		int RNAcomp = 1;
+// the file is mapped once, and scanned in a single pass,
+// first assuming the sequential format, then the interleaved format if this fails.
+// during the scan, the characters are stored as they are (one byte each),
+// while keeping track of the alphabets (dna, rna or protein) compatible with all of them.
+// once the alphabet is known, they are decoded through the byte-to-state table of the state space.
+
+static const int DNAcomp = 1;
+static const int RNAcomp = 2;
+static const int AAcomp = 4;
+
+// (...) and {...} groups are stored as '?', which codes for unknown in all three alphabets
+static const unsigned char unknownbyte = '?';
+
+static void PhylipFormatError()	{
+	cerr << "data should be formatted as follows:\n";
+	cerr << "#taxa #sites\n";
+	cerr << "name1 seq1.....\n";
+	cerr << "name2 seq2.....\n";
+	cerr << "...\n";
+	cerr << '\n';
+	exit(1);
+}
 
-		int ntaxa = 0;
-		while ((!theStream.eof()) && (ntaxa<Ntaxa))	{
-			theStream >> temp;
-			SpeciesNames[ntaxa] = temp;
-			int nsite = 0;
+void FileSequenceAlignment::ReadPhylipHeader(DataBuffer& buffer)	{
 
-			char c = ' ';
-			do	{
-				c = theStream.get();
-				if ((!theStream.eof()) && (! isspace(c)))	{
-				// if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c!='\t') && (c != 13))	{
-					if (c == '(')	{
-						while (c != ')')	{
-							theStream >> c;
-						}
-					}
-					else if (c == '{')	{
-						while (c != '}')	{
-							theStream >> c;
-						}
-					}
-					else	{
-						int p =0;
-						if (DNAcomp)	{
-							while ((p < DNAN) && (c != DNAset[p])) p++;
-							if (p == DNAN) {
-								DNAcomp = 0;
-							}
-						}
-						p =0;
-						if (RNAcomp)	{
-							while ((p < RNAN) && (c != RNAset[p])) p++;
-							if (p == RNAN) RNAcomp = 0;
-						}
-						p =0;
-						if (AAcomp)	{
-							while ((p < AAN) && (c != AAset[p])) p++;
-							if (p == AAN)	{
-								AAcomp = 0;
-							}
-						}
-					}
-					nsite++;
-				}
-			}
-			while ((!theStream.eof()) && (nsite < Nsite));
-			if (theStream.eof())	{
-				if (nsite < Nsite)	{
-					// cerr << "taxon : " << ntaxa << " : " << SpeciesNames[ntaxa]  << "contain only " << nsite << " sites\n"; 
-					return 0;
-				}
-			}
-			ntaxa++;
-		}
-		if (theStream.eof())	{
-			if (ntaxa < Ntaxa)	{
-				// cerr << "found only " << ntaxa << " taxa\n";
-				return 0;
-			}
-		}
-		if (DNAcomp)	{
-			statespace = new DNAStateSpace;
-			// cerr << "dna sequences\n";
-		}
-		else if (RNAcomp)	{
-			statespace = new RNAStateSpace;
-			// cerr << "rna sequences\n";
-		}
-		else if (AAcomp)	{
-			statespace = new ProteinStateSpace;
-			// cerr << "protein sequences\n";
-		}
-		else	{
-			// cerr << "format not recognised\n";
-			return 0;
-		}
+	string temp = buffer.Word();
+	if (!IsInt(temp))	{
+		cerr << "error when reading data\n";
+		PhylipFormatError();
 	}
-	catch(...)	{
-		return 0;
+	Ntaxa = Int(temp);
+	temp = buffer.Word();
+	if (!IsInt(temp))	{
+		cerr << "error when reading data\n";
+		PhylipFormatError();
 	}
-	return 1;
+	Nsite = Int(temp);
 }
 
+void FileSequenceAlignment::ReadPhylip(DataBuffer& buffer, int forceinterleaved)	{
 
-void FileSequenceAlignment::ReadPhylipSequential (string filespec)	{
-
-	ifstream theStream((Path + filespec).c_str());
-	try	{
-
-		// cerr << "beware: phylip data sets only for amino acids for the moment\n";
-		// cerr.flush();
-	
-		string temp;
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
+	// for each byte, the alphabets in which it is a valid character
+	DNAStateSpace dna;
+	RNAStateSpace rna;
+	ProteinStateSpace protein;
+	unsigned char alphabets[256];
+	for (int b=0; b<256; b++)	{
+		alphabets[b] = 0;
+		if (dna.GetByteState(b) != SimpleStateSpace::notastate)	{
+			alphabets[b] |= DNAcomp;
 		}
-		Ntaxa = Int(temp);
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
+		if (rna.GetByteState(b) != SimpleStateSpace::notastate)	{
+			alphabets[b] |= RNAcomp;
 		}
-		Nsite = Int(temp);
-
-		Data = new int *[Ntaxa];
-		for (int i=0; i<Ntaxa; i++)	{
-			Data[i] = new int[Nsite];
+		if (protein.GetByteState(b) != SimpleStateSpace::notastate)	{
+			alphabets[b] |= AAcomp;
 		}
-		SpeciesNames = new string[Ntaxa];
+	}
 
-		int ntaxa = 0;
-		while ((!theStream.eof()) && (ntaxa<Ntaxa))	{
-			theStream >> temp;
-			SpeciesNames[ntaxa] = temp;
-			int nsite = 0;
+	ReadPhylipHeader(buffer);
+	delete[] SpeciesNames;
+	SpeciesNames = new string[Ntaxa];
+	unsigned char* raw = new unsigned char[((size_t) Ntaxa) * Nsite];
+
+	int comp = 0;
+	if (! forceinterleaved)	{
+		size_t start = buffer.Tell();
+		comp = ScanPhylipSequential(buffer,alphabets,raw);
+		buffer.Seek(start);
+	}
+	if (! comp)	{
+		comp = ScanPhylip(buffer,alphabets,raw);
+	}
 
-			char c;
-			do	{
-				c = theStream.get();
-				if ((!theStream.eof()) && (! isspace(c)))	{
-				// if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c != '\t') && (c!=13))	{
-					if (c == '(')	{
-						Data[ntaxa][nsite] = unknown;
-						while (c != ')')	{
-							theStream >> c;
-						}
-					}
-					else if (c == '{')	{
-						Data[ntaxa][nsite] = unknown;
-						while (c != '}')	{
-							theStream >> c;
-						}
-					}
-					else	{
-						ostringstream s;
-						s << c;
-						Data[ntaxa][nsite] = statespace->GetState(s.str());
-					}
-					nsite++;
-				}
-			}
-			while ((!theStream.eof()) && (nsite < Nsite));
-			ntaxa++;
-		}
+	SimpleStateSpace* simplespace = 0;
+	if (comp & DNAcomp)	{
+		simplespace = new DNAStateSpace;
 	}
-	catch(...)	{
-		cerr << "error while reading data file\n";
+	else if (comp & RNAcomp)	{
+		simplespace = new RNAStateSpace;
+	}
+	else if (comp & AAcomp)	{
+		simplespace = new ProteinStateSpace;
+	}
+	else	{
+		cerr << "error when reading data: characters are not recognised as dna, rna or amino acids\n";
 		exit(1);
 	}
-}
+	statespace = simplespace;
 
-int FileSequenceAlignment::TestPhylip (string filespec, int repeattaxa)	{
-
-	ifstream theStream((Path + filespec).c_str());
-	try	{
-
-		string temp;
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		Ntaxa = Int(temp);
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
+	Data = new int *[Ntaxa];
+	for (int i=0; i<Ntaxa; i++)	{
+		Data[i] = new int[Nsite];
+		const unsigned char* seq = raw + ((size_t) i) * Nsite;
+		for (int k=0; k<Nsite; k++)	{
+			Data[i][k] = simplespace->GetByteState(seq[k]);
 		}
-		Nsite = Int(temp);
-
-		delete[] SpeciesNames;
-		SpeciesNames = new string[Ntaxa];
-
-		int AAcomp = 1;
-		int DNAcomp = 1;
-		int RNAcomp = 1;
-
-		int l = 0;
-		int block = 0;
-		while (l<Nsite)	{
-			block++;
-			int m = 0;
-			for (int i=0; i<Ntaxa; i++)	{
-				
-				if ((!l) || repeattaxa)	{
-					string temp;
-					theStream >> temp;
-					if (!l)	{
-						SpeciesNames[i] = temp;
-					}
-					else	{
-						if (temp != SpeciesNames[i])	{
-							return 0;
-						}
-					}
-				}
+	}
+	delete[] raw;
+}
 
-				unsigned char c;
-				int k = l;
-				do	{
-					c = theStream.get();
-					if ((!theStream.eof()) && (! isspace(c)))	{
-					// if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c!='\t') && (c != 13))	{
-						if (c == '(')	{
-							while (c != ')')	{
-								theStream >> c;
-							}
-						}
-						else if (c == '{')	{
-							while (c != '}')	{
-								theStream >> c;
-							}
-						}
-						else	{
-							int p =0;
-							if (DNAcomp)	{
-								while ((p < DNAN) && (c != DNAset[p])) p++;
-								if (p == DNAN) DNAcomp = 0;
-							}
-							p =0;
-							if (RNAcomp)	{
-								while ((p < RNAN) && (c != RNAset[p])) p++;
-								if (p == RNAN) RNAcomp = 0;
-							}
-							p =0;
-							if (AAcomp)	{
-								while ((p < AAN) && (c != AAset[p])) p++;
-								if (p == AAN)	{
-									AAcomp = 0;
-								}
-							}
-						}
-						k++;
-					}
-				}
-				while ((!theStream.eof()) && (c != '\n') && (c != '\r'));
-				// while ((!theStream.eof()) && (! isspace(c)));
-				// while ((!theStream.eof()) && (c != '\n') && (c != 13) && (c != 10));
-				if (theStream.eof())	{
-					if (i < Ntaxa-1)	{
-						cerr << "error : found " << i << " taxa instead of " << Ntaxa << " in datafile\n";
-						exit(1);
-					}
-				}
-				c = theStream.peek();
-				while ((!theStream.eof()) && ((c == '\n') || (c == '\r')))	{
-				// while ((!theStream.eof()) && ((c == '\n') || (c == 13)))	{
-					c = theStream.get();
-					c = theStream.peek();
-				}
-				if (!m)	{
-					m = k;
+// returns the compatible alphabets, or 0 if the file does not look like sequential phylip
+int FileSequenceAlignment::ScanPhylipSequential(DataBuffer& buffer, const unsigned char* alphabets, unsigned char* raw)	{
+
+	int comp = DNAcomp | RNAcomp | AAcomp;
+	int ntaxa = 0;
+	while ((! buffer.eof()) && (ntaxa < Ntaxa))	{
+		SpeciesNames[ntaxa] = buffer.Word();
+		unsigned char* seq = raw + ((size_t) ntaxa) * Nsite;
+		int nsite = 0;
+		do	{
+			int c = buffer.get();
+			if ((! buffer.eof()) && (! isspace(c)))	{
+				if ((c == '(') || (c == '{'))	{
+					buffer.SkipGroup(c);
+					seq[nsite] = unknownbyte;
 				}
 				else	{
-					if (m != k)	{
-						cerr << "in test phylip\n";
-						cerr << "error when reading data non matching number of sequences in block number " << block << " for taxon " << i+1 << " " << SpeciesNames[i] << '\n';
-						cerr << "taxa : " << i << '\t' << SpeciesNames[i] << '\n';
-						cerr << "read " << m << " instead of " << k << " characters\n";
-						exit(1);
+					comp &= alphabets[c];
+					if (! comp)	{
+						return 0;
 					}
+					seq[nsite] = c;
 				}
+				nsite++;
 			}
-			l= m;
-		}
-		if (l<Nsite)	{
-			cerr << "error : reached end of stream \n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		if (DNAcomp)	{
-			statespace = new DNAStateSpace;
-			// cerr << "dna sequences\n";
-		}
-		else if (RNAcomp)	{
-			statespace = new DNAStateSpace;
-			// cerr << "rna sequences\n";
-		}
-		else if (AAcomp)	{
-			statespace = new ProteinStateSpace;
-			// cerr << "protein sequences\n";
 		}
-		else	{
-			// cerr << "format not recognised\n";
+		while ((! buffer.eof()) && (nsite < Nsite));
+		if (nsite < Nsite)	{
 			return 0;
 		}
+		ntaxa++;
 	}
-	catch(...)	{
-		cerr << "error while reading data file\n";
+	if (ntaxa < Ntaxa)	{
 		return 0;
 	}
-	return 1;
+	return comp;
 }
 
-void
-FileSequenceAlignment::ReadPhylip (string filespec, int repeattaxa)	{
-
-	ifstream theStream((Path + filespec).c_str());
-	try	{
+// interleaved phylip: one line per taxon in each block,
+// taxon names being optionally repeated in the blocks after the first one
+// (which is decided upon reading the first line of the second block)
+int FileSequenceAlignment::ScanPhylip(DataBuffer& buffer, const unsigned char* alphabets, unsigned char* raw)	{
 
-		string temp;
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		Ntaxa = Int(temp);
-		theStream >> temp;
-		if (!IsInt(temp))	{
-			cerr << "error when reading data\n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
-		}
-		Nsite = Int(temp);
-		// cerr << Ntaxa << '\t' << Nsite << '\n';
+	int comp = DNAcomp | RNAcomp | AAcomp;
+	int repeattaxa = 1;
 
-		Data = new int *[Ntaxa];
+	int l = 0;
+	int block = 0;
+	while (l<Nsite)	{
+		block++;
+		int m = 0;
 		for (int i=0; i<Ntaxa; i++)	{
-			Data[i] = new int[Nsite];
-		}
-		SpeciesNames = new string[Ntaxa];
 
-		int l = 0;
-		int block = 0;
-		while (l<Nsite)	{
-			block++;
-			int m = 0;
-			for (int i=0; i<Ntaxa; i++)	{
-				
-				if ((!l) || repeattaxa)	{
-					string temp;
-					theStream >> temp;
-					if (!l)	{
-						SpeciesNames[i] = temp;
+			if ((!l) || repeattaxa)	{
+				size_t start = buffer.Tell();
+				string temp = buffer.Word();
+				if (!l)	{
+					SpeciesNames[i] = temp;
+				}
+				else if (temp != SpeciesNames[i])	{
+					if ((block == 2) && (! i))	{
+						repeattaxa = 0;
+						buffer.Seek(start);
 					}
 					else	{
-						if (temp != SpeciesNames[i])	{
-							cerr << "error when reading data: read " << temp << " instead of " << SpeciesNames[i] << '\n';
-							exit(1);
-						}
+						cerr << "error when reading data: read " << temp << " instead of " << SpeciesNames[i] << '\n';
+						exit(1);
 					}
 				}
+			}
 
-				unsigned char c;
-				int k = l;
-				do	{
-
-					c = theStream.get();
-					if ((!theStream.eof()) && (! isspace(c)))	{
-					// if ((!theStream.eof()) && (c != ' ') && (c != '\n') && (c != '\t') && (c!=13))	{
-						if (c == '(')	{
-							Data[i][k] = unknown;
-							while (c != ')')	{
-								theStream >> c;
-							}
-						}
-						else if (c == '{')	{
-							Data[i][k] = unknown;
-							while (c != '}')	{
-								theStream >> c;
-							}
-						}
-						else	{
-							ostringstream s;
-							s << c;
-							Data[i][k] = statespace->GetState(s.str());
-						}
-						k++;
-					}
-				}
-				while ((!theStream.eof()) && (c != '\n') && (c != '\r'));
-				// while ((!theStream.eof()) && (c != '\n') && (c != 13));
-				if (theStream.eof())	{
-					if (i < Ntaxa-1)	{
-						cerr << "error : found " << i << " taxa instead of " << Ntaxa << " in datafile\n";
+			unsigned char* seq = raw + ((size_t) i) * Nsite;
+			int c;
+			int k = l;
+			do	{
+				c = buffer.get();
+				if ((! buffer.eof()) && (! isspace(c)))	{
+					if (k == Nsite)	{
+						cerr << "error when reading data: more than " << Nsite << " characters for taxon " << i+1 << " " << SpeciesNames[i] << '\n';
 						exit(1);
 					}
+					if ((c == '(') || (c == '{'))	{
+						buffer.SkipGroup(c);
+						seq[k] = unknownbyte;
+					}
+					else	{
+						comp &= alphabets[c];
+						seq[k] = c;
+					}
+					k++;
 				}
-				c = theStream.peek();
-				while ((!theStream.eof()) && ((c == '\n') || (c == '\r')))	{
-				// while ((!theStream.eof()) && ((c == '\n') || (c == 13)))	{
-					c = theStream.get();
-					c = theStream.peek();
-				}
-				
-				if (!m)	{
-					m = k;
+			}
+			while ((! buffer.eof()) && (c != '\n') && (c != '\r'));
+			if (buffer.eof())	{
+				if (i < Ntaxa-1)	{
+					cerr << "error : found " << i << " taxa instead of " << Ntaxa << " in datafile\n";
+					exit(1);
 				}
-				else	{
-					if (m != k)	{
-						cerr << "error when reading data non matching number of sequences in block number " << block << " for taxon " << i << " " << SpeciesNames[i] << '\n';
-						cerr << "taxa : " << i << '\t' << SpeciesNames[i] << '\n';
-						cerr << "read " << k << " instead of " << m << "characters\n";
-						exit(1);
-					}
+			}
+			buffer.SkipNewLines();
+
+			if (!m)	{
+				m = k;
+			}
+			else	{
+				if (m != k)	{
+					cerr << "error when reading data non matching number of sequences in block number " << block << " for taxon " << i+1 << " " << SpeciesNames[i] << '\n';
+					cerr << "taxa : " << i << '\t' << SpeciesNames[i] << '\n';
+					cerr << "read " << k << " instead of " << m << " characters\n";
+					exit(1);
 				}
 			}
-			l= m;
 		}
-		if (l<Nsite)	{
-			cerr << "error : reached end of stream \n";
-			cerr << "data should be formatted as follows:\n";
-			cerr << "#taxa #sites\n";
-			cerr << "name1 seq1.....\n";
-			cerr << "name2 seq2.....\n";
-			cerr << "...\n";
-			cerr << '\n';
-			exit(1);
+		if (buffer.eof() && (m < Nsite))	{
+			break;
 		}
+		l= m;
 	}
-	catch(...)	{
-		cerr << "error while reading data file\n";
+	if (l<Nsite)	{
+		cerr << "error : reached end of stream \n";
+		PhylipFormatError();
 	}
+	return comp;
 }
 
 // ---------------------------------------------------------------------------
@@ -19,6 +19,7 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "StateSpace.h"
 #include "TaxonSet.h"
 #include "Random.h"
+#include "AlignmentCache.h"
 
 // this class works like an interface
 // it does not do any job
@@ -459,6 +460,10 @@ class SequenceAlignment	{
 
 	void GetSiteEmpiricalFreq(double** in);
 
+	// precomputed summaries of the data (empirical frequencies, site orbits)
+	// only available for an alignment loaded from a binary cache, and as long as its sites are unchanged
+	virtual const AlignmentCache* GetCache() {return 0;}
+
 	void ToStream(ostream& os);
 	void ToFasta(ostream& os);
 
@@ -739,22 +744,42 @@ class SequenceAlignment	{
 	
 };
 
+class DataBuffer;
+
 class FileSequenceAlignment : public SequenceAlignment	{
 
 
 	public:
 		FileSequenceAlignment(istream& is);
-		FileSequenceAlignment(string filename,int fullline,int myid);
+		// if shared is set, all processes of PROCESS_COMM should construct the alignment together:
+		// only process 0 reads the file, and then broadcasts the data to the others
+		FileSequenceAlignment(string filename,int fullline,int myid,int shared = 0);
+		~FileSequenceAlignment();
+
+		const AlignmentCache* GetCache()	{
+			if (cache && (cache->GetNsite() == Nsite))	{
+				return cache;
+			}
+			return 0;
+		}
+
+		// read and write the data through a binary cache (<datafile>.pbcache)
+		static bool usecache;
 
 	private:
 
 	int 			ReadDataFromFile(string filename, int forceinterleaved = 0);
 	int 			ReadNexus(string filename);
-	int 			TestPhylipSequential(string filename);
-	void 			ReadPhylipSequential(string filename);
-	int 			TestPhylip(string filename, int repeattaxa);
-	void 			ReadPhylip(string filename, int repeattaxa);
+	void			ReadPhylipHeader(DataBuffer& buffer);
+	void 			ReadPhylip(DataBuffer& buffer, int forceinterleaved);
+	int 			ScanPhylipSequential(DataBuffer& buffer, const unsigned char* alphabets, unsigned char* raw);
+	int 			ScanPhylip(DataBuffer& buffer, const unsigned char* alphabets, unsigned char* raw);
 	int			ReadSpecial(string filename);
+	void			BroadcastData(int myid);
+	void			ReadDataFromCache();
+	void			WriteCache(string filename);
+
+	AlignmentCache* cache;
 
 	string* SpeciesNames;
 };
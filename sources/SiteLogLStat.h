@@ -0,0 +1,158 @@
+/********************
+
+PhyloBayes MPI. Copyright 2010-2013 Nicolas Lartillot, Nicolas Rodrigue, Daniel Stubbs, Jacques Richer.
+
+PhyloBayes is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+PhyloBayes is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details. You should have received a copy of the GNU General Public License
+along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
+
+**********************/
+
+#ifndef SITELOGLSTAT_H
+#define SITELOGLSTAT_H
+
+#include <cmath>
+
+// running summary of the log likelihoods of one site across the mcmc
+// (as used by readpb_mpi -sitelogl)
+//
+// keeps the mean and variance of the logl (for wAIC),
+// and two log-sum-exp accumulators:
+// sum_j exp(min - logl_j) for the cpo (LOO-CV),
+// and sum_j exp(logl_j - max) for the posterior mean likelihood (wAIC),
+// each together with the sum of squares of its terms, from which the ESS of the importance weights follows.
+// the reference (min or max) is updated on the fly, rescaling the sums whenever it moves,
+// so that the whole series of logl's never needs to be stored
+
+class SiteLogLStat	{
+
+	public:
+
+	// number of doubles used by ToArray / FromArray
+	static const int dim = 9;
+
+	SiteLogLStat() : count(0), sum(0), sum2(0), minlogl(0), cposum(0), cposum2(0), maxlogl(0), postsum(0), postsum2(0) {}
+
+	void Add(double logl)	{
+		if (! count)	{
+			minlogl = logl;
+			maxlogl = logl;
+		}
+		if (logl < minlogl)	{
+			Rescale(cposum,cposum2,logl - minlogl);
+			minlogl = logl;
+		}
+		if (logl > maxlogl)	{
+			Rescale(postsum,postsum2,maxlogl - logl);
+			maxlogl = logl;
+		}
+		double c = exp(minlogl - logl);
+		cposum += c;
+		cposum2 += c*c;
+		double p = exp(logl - maxlogl);
+		postsum += p;
+		postsum2 += p*p;
+		sum += logl;
+		sum2 += logl*logl;
+		count++;
+	}
+
+	void Merge(const SiteLogLStat& from)	{
+		if (! from.count)	{
+			return;
+		}
+		if (! count)	{
+			*this = from;
+			return;
+		}
+		double fromcposum = from.cposum;
+		double fromcposum2 = from.cposum2;
+		if (from.minlogl < minlogl)	{
+			Rescale(cposum,cposum2,from.minlogl - minlogl);
+			minlogl = from.minlogl;
+		}
+		else	{
+			Rescale(fromcposum,fromcposum2,minlogl - from.minlogl);
+		}
+		double frompostsum = from.postsum;
+		double frompostsum2 = from.postsum2;
+		if (from.maxlogl > maxlogl)	{
+			Rescale(postsum,postsum2,maxlogl - from.maxlogl);
+			maxlogl = from.maxlogl;
+		}
+		else	{
+			Rescale(frompostsum,frompostsum2,from.maxlogl - maxlogl);
+		}
+		cposum += fromcposum;
+		cposum2 += fromcposum2;
+		postsum += frompostsum;
+		postsum2 += frompostsum2;
+		sum += from.sum;
+		sum2 += from.sum2;
+		count += from.count;
+	}
+
+	int GetCount() const {return count;}
+
+	double GetMean() const {return sum / count;}
+	double GetVar() const	{
+		double mean = sum / count;
+		return sum2 / count - mean * mean;
+	}
+
+	double GetLogCPO() const {return minlogl - log(cposum / count);}
+	double GetCPOESS() const {return cposum * cposum / cposum2;}
+
+	double GetLogPostMeanL() const {return log(postsum / count) + maxlogl;}
+	double GetPostMeanLESS() const {return postsum * postsum / postsum2;}
+
+	void ToArray(double* array) const	{
+		array[0] = count;
+		array[1] = sum;
+		array[2] = sum2;
+		array[3] = minlogl;
+		array[4] = cposum;
+		array[5] = cposum2;
+		array[6] = maxlogl;
+		array[7] = postsum;
+		array[8] = postsum2;
+	}
+
+	void FromArray(const double* array)	{
+		count = (int) array[0];
+		sum = array[1];
+		sum2 = array[2];
+		minlogl = array[3];
+		cposum = array[4];
+		cposum2 = array[5];
+		maxlogl = array[6];
+		postsum = array[7];
+		postsum2 = array[8];
+	}
+
+	private:
+
+	// multiply the terms of a sum (and of its sum of squares) by exp(shift)
+	static void Rescale(double& s, double& s2, double shift)	{
+		double f = exp(shift);
+		s *= f;
+		s2 *= f*f;
+	}
+
+	int count;
+	double sum;
+	double sum2;
+	double minlogl;
+	double cposum;
+	double cposum2;
+	double maxlogl;
+	double postsum;
+	double postsum2;
+};
+
+#endif
+
@@ -70,25 +70,35 @@ int SimpleStateSpace::GetState(string from) {
 		exit(1);
 	}
 	char c = from[0];
-	int p = 0;
-	while ((p < NAlphabetSet) && (c != AlphabetSet[p])) p++;
-	if (p == NAlphabetSet)	{
+	int state = GetByteState(c);
+	if (state == notastate)	{
 		cout << "error: does not recognise character " << c << '\n';
 		exit(1);
 	}
-	if (p >= 2*Nstate)	{
-		return unknown;
-	}
-	else	{
-		int k = 0;
-		for (int l=0; l<Nstate; l++)		{
-			if ((c == Alphabet[l]) || (c == Alphabet[l]+32))	{
-				k = l;
+	return state;
+}
+
+void SimpleStateSpace::MakeByteTable()	{
+	for (int b=0; b<256; b++)	{
+		char c = (char) b;
+		int p = 0;
+		while ((p < NAlphabetSet) && (c != AlphabetSet[p])) p++;
+		if (p == NAlphabetSet)	{
+			ByteState[b] = notastate;
+		}
+		else if (p >= 2*Nstate)	{
+			ByteState[b] = unknown;
+		}
+		else	{
+			int k = 0;
+			for (int l=0; l<Nstate; l++)		{
+				if ((c == Alphabet[l]) || (c == Alphabet[l]+32))	{
+					k = l;
+				}
 			}
+			ByteState[b] = k;
 		}
-		return k;
 	}
-	return 0;
 }
 
 DNAStateSpace::DNAStateSpace()	{
@@ -102,6 +112,7 @@ DNAStateSpace::DNAStateSpace()	{
 	for (int i=0; i<NAlphabetSet; i++)	{
 		AlphabetSet[i] = DNAset[i];
 	}
+	MakeByteTable();
 }
 
 DNAStateSpace::~DNAStateSpace()	{
@@ -121,6 +132,7 @@ RNAStateSpace::RNAStateSpace()	{
 	for (int i=0; i<NAlphabetSet; i++)	{
 		AlphabetSet[i] = RNAset[i];
 	}
+	MakeByteTable();
 }
 
 RNAStateSpace::~RNAStateSpace()	{
@@ -139,6 +151,7 @@ ProteinStateSpace::ProteinStateSpace()	{
 	for (int i=0; i<NAlphabetSet; i++)	{
 		AlphabetSet[i] = AAset[i];
 	}
+	MakeByteTable();
 }
 
 ProteinStateSpace::~ProteinStateSpace()	{
@@ -40,6 +40,9 @@ class SimpleStateSpace : public StateSpace	{
 
 	public:
 
+	// returned by GetByteState for characters that are not part of the alphabet set
+	static const int notastate = -2;
+
 	SimpleStateSpace() {}
 
 	SimpleStateSpace(int inNstate, int inNAlphabetSet, char* inAlphabet, char* inAlphabetSet)	{
@@ -54,10 +57,17 @@ class SimpleStateSpace : public StateSpace	{
 		for (int k=0; k<NAlphabetSet; k++)	{
 			AlphabetSet[k] = inAlphabetSet[k];
 		}
+		MakeByteTable();
 	}
 
 	int GetState(string from);
 
+	// one-letter decoding through a 256-entry lookup table:
+	// returns the state, unknown, or notastate
+	int GetByteState(unsigned char c) {return ByteState[c];}
+
+	int GetNAlphabetSet() {return NAlphabetSet;}
+
 	int GetNstate() {
 		return Nstate;
 	}
@@ -67,10 +77,15 @@ class SimpleStateSpace : public StateSpace	{
 	char GetCharState(int state) {return AlphabetSet[state];}
 
 	protected:
+
+	// fills ByteState, once Alphabet and AlphabetSet are known
+	void MakeByteTable();
+
 	int Nstate;
 	char* Alphabet;
 	int NAlphabetSet;
 	char* AlphabetSet;
+	int ByteState[256];
 };
 
 class DNAStateSpace : public SimpleStateSpace	{
@@ -36,7 +36,7 @@ void PhyloProcess::GlobalPrepareStepping(string name, int size, int rand)   {
     }
 
 	MESSAGE signal = PREPARESTEPPING;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
     bkdata = new SequenceAlignment(GetData());
 
     steppingrank = new int[GetNsite()];
@@ -55,13 +55,19 @@ void PhyloProcess::GlobalPrepareStepping(string name, int size, int rand)   {
                 steppingrank[i] = i;
             }
         }
-        ofstream os((name + ".siteranks").c_str());
-        for (int i=0; i<GetNsite(); i++)    {
-            os << steppingrank[i] << '\t';
+        // several groups (pb_mpi -stepgroup): all should use the order of the first one
+        if (NGROUP > 1) {
+            MPI_Bcast(steppingrank,GetNsite(),MPI_INT,0,MASTER_COMM);
+        }
+        if (! GROUPID)  {
+            ofstream os((name + ".siteranks").c_str());
+            for (int i=0; i<GetNsite(); i++)    {
+                os << steppingrank[i] << '\t';
+            }
+            os << '\n';
         }
-        os << '\n';
     }
-    MPI_Bcast(steppingrank,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+    MPI_Bcast(steppingrank,GetNsite(),MPI_INT,0,PROCESS_COMM);
 
 }
 
@@ -72,7 +78,7 @@ void PhyloProcess::SlavePrepareStepping()	{
     }
     bkdata = new SequenceAlignment(GetData());
     steppingrank = new int[GetNsite()];
-	MPI_Bcast(steppingrank,GetNsite(),MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(steppingrank,GetNsite(),MPI_INT,0,PROCESS_COMM);
     CreateSiteConditionalLikelihoods();
 }
 
@@ -81,14 +87,14 @@ void PhyloProcess::GlobalSetSteppingFraction(int cutoff1, int cutoff2)    {
     int cutoff[2];
     cutoff[0] = cutoff1;
     cutoff[1] = cutoff2;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(cutoff,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(cutoff,2,MPI_INT,0,PROCESS_COMM);
     SetSteppingFraction(cutoff1, cutoff2);
 }
 
 void PhyloProcess::SlaveSetSteppingFraction()    {
     int cutoff[2];
-	MPI_Bcast(cutoff,2,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(cutoff,2,MPI_INT,0,PROCESS_COMM);
     SetSteppingFraction(cutoff[0], cutoff[1]);
 }
 
@@ -114,21 +120,21 @@ void PhyloProcess::SetSteppingFraction(int cutoff1, int cutoff2)  {
 
 void PhyloProcess::GlobalSetEmpiricalFrac(double infrac)    {
 	MESSAGE signal = EMPIRICALFRAC;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&infrac,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&infrac,1,MPI_DOUBLE,0,PROCESS_COMM);
     SetEmpiricalFrac(infrac);
 }
 
 void PhyloProcess::SlaveSetEmpiricalFrac()  {
     double frac;
-	MPI_Bcast(&frac,1,MPI_DOUBLE,0,MPI_COMM_WORLD);
+	MPI_Bcast(&frac,1,MPI_DOUBLE,0,PROCESS_COMM);
     SetEmpiricalFrac(frac);
 }
 
 /*
 void PhyloProcess::GlobalCreateSiteDataStructures() {
 	MESSAGE signal = CREATESITE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
     // CreateSiteConditionalLikelihoods();
 }
 
@@ -138,7 +144,7 @@ void PhyloProcess::SlaveCreateSiteDataStructures()  {
 
 void PhyloProcess::GlobalDeleteSiteDataStructures() {
 	MESSAGE signal = DELETESITE;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
     // DeleteSiteConditionalLikelihoods();
 }
 
@@ -150,11 +156,11 @@ void PhyloProcess::SlaveDeleteSiteDataStructures()  {
 void PhyloProcess::CreateSiteConditionalLikelihoods()	{
 
 	if (! sitecondlmap)	{
-		sitecondlmap = new double**[GetNlink()];
+		sitecondlmap = new condl_t**[GetNlink()];
 		for (int j=0; j<GetNlink(); j++)	{
-			sitecondlmap[j] = new double*[GetMaxNrate()];
+			sitecondlmap[j] = new condl_t*[GetMaxNrate()];
 			for (int k=0; k<GetMaxNrate(); k++)	{
-				sitecondlmap[j][k] = new double[GetGlobalNstate()+1];
+				sitecondlmap[j][k] = new condl_t[GetGlobalNstate()+1];
 			}
 		}
 	}
@@ -212,9 +218,9 @@ void PhyloProcess::SitePostOrderPruning(int site, const Link* from)	{
 double PhyloProcess::GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int restore)   {
 
 	MESSAGE signal = STEPPINGSITELOGL;
-	MPI_Bcast(&signal,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&site,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&site,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
 	int width = GetNsite()/(GetNprocs()-1);
 	int smin[GetNprocs()-1];
@@ -243,20 +249,51 @@ double PhyloProcess::GlobalGetSiteSteppingLogLikelihood(int site, int nrep, int
 
     double ret;
 	MPI_Status stat;
-    MPI_Recv(&ret,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,MPI_COMM_WORLD,&stat);
+    MPI_Recv(&ret,1,MPI_DOUBLE,MPI_ANY_SOURCE,TAG1,PROCESS_COMM,&stat);
     return ret;
 }
 
 void PhyloProcess::SlaveGetSiteSteppingLogLikelihood()  {
 
     int site, nrep;
-	MPI_Bcast(&site,1,MPI_INT,0,MPI_COMM_WORLD);
-	MPI_Bcast(&nrep,1,MPI_INT,0,MPI_COMM_WORLD);
+	MPI_Bcast(&site,1,MPI_INT,0,PROCESS_COMM);
+	MPI_Bcast(&nrep,1,MPI_INT,0,PROCESS_COMM);
 
     double ret = 0;
     if ((site >= sitemin) && (site < sitemax))  {
         ret = SiteLogLikelihood(site);
-        MPI_Send(&ret,1,MPI_DOUBLE,0,TAG1,MPI_COMM_WORLD);
+        MPI_Send(&ret,1,MPI_DOUBLE,0,TAG1,PROCESS_COMM);
+    }
+}
+
+void PhyloProcess::GetSteppingSites(vector<int>& sites)	{
+    sites.clear();
+    for (int i=0; i<GetNsite(); i++)    {
+        if (ActiveSite(i))  {
+            sites.push_back(i);
+        }
+    }
+}
+
+double PhyloProcess::GlobalGetSteppingLogLikelihood(int nrep, int restore)   {
+
+	MESSAGE signal = STEPPINGLOGL;
+	MPI_Bcast(&signal,1,MPI_INT,0,PROCESS_COMM);
+
+    double zero = 0;
+    double tot = 0;
+    MPI_Reduce(&zero,&tot,1,MPI_DOUBLE,MPI_SUM,0,PROCESS_COMM);
+    return tot;
+}
+
+void PhyloProcess::SlaveGetSteppingLogLikelihood()  {
+
+    double tot = 0;
+    for (int i=sitemin; i<sitemax; i++) {
+        if (ActiveSite(i))  {
+            tot += SiteLogLikelihood(i);
+        }
     }
+    MPI_Reduce(&tot,0,1,MPI_DOUBLE,MPI_SUM,0,PROCESS_COMM);
 }
 
@@ -24,6 +24,10 @@ using namespace std;
 int SubMatrix::nuni = 0;
 int SubMatrix::nunimax = 0;
 int SubMatrix::nunisubcount = 0;
+int SubMatrix::nunireuse = 0;
+int SubMatrix::nunirow = 0;
+int SubMatrix::ndiag = 0;
+int SubMatrix::ndiagreuse = 0;
 
 // ---------------------------------------------------------------------------
 //		 SubMatrix()
@@ -72,6 +76,23 @@ void SubMatrix::Create()	{
 	v = new double[Nstate];
 	vi = new double[Nstate];
 
+	diagQ = new double*[Nstate];
+	for (int i=0; i<Nstate; i++)	{
+		diagQ[i] = new double[Nstate];
+	}
+	diagstat = new double[Nstate];
+	diagstamp = false;
+
+	diagwork = new double*[LinAlg::DiagWorkSize(Nstate)];
+	for (int i=0; i<LinAlg::DiagWorkSize(Nstate); i++)	{
+		diagwork[i] = new double[Nstate];
+	}
+
+	bkQ = 0;
+	bkstat = 0;
+	bkflagarray = 0;
+	bkstatflag = false;
+
 	mStationary = new double[Nstate];
 
 	UniMu = 1;
@@ -86,6 +107,17 @@ void SubMatrix::Create()	{
 		*/
 	}
 
+	unisupportsize = new int[Nstate];
+	unisupport = new int*[Nstate];
+	for (int i=0; i<Nstate; i++)	{
+		unisupport[i] = new int[Nstate];
+	}
+	rowpow = new int[Nstate];
+	for (int i=0; i<Nstate; i++)	{
+		rowpow[i] = 0;
+	}
+	npow = 0;
+
 	flagarray = new bool[Nstate];
 	diagflag = false;
 	statflag = false;
@@ -113,21 +145,40 @@ SubMatrix::~SubMatrix()	{
 	delete[] invu;
 
 	if (mPow)	{
-		for (int n=0; n<UniSubNmax; n++)	{
-			if (mPow[n])	{
-				for (int i=0; i<Nstate; i++)	{
-					delete[] mPow[n][i];
-				}
-				delete[] mPow[n];
-			}
-		}
+		FreePowers();
 		delete[] mPow;
 	}
+	delete[] rowpow;
 	delete[] mStationary;
 	delete[] flagarray;
 	delete[] v;
 	delete[] vi;
 
+	for (int i=0; i<Nstate; i++)	{
+		delete[] diagQ[i];
+	}
+	delete[] diagQ;
+	delete[] diagstat;
+	for (int i=0; i<LinAlg::DiagWorkSize(Nstate); i++)	{
+		delete[] diagwork[i];
+	}
+	delete[] diagwork;
+
+	if (bkQ)	{
+		for (int i=0; i<Nstate; i++)	{
+			delete[] bkQ[i];
+		}
+		delete[] bkQ;
+		delete[] bkstat;
+		delete[] bkflagarray;
+	}
+
+	for (int i=0; i<Nstate; i++)	{
+		delete[] unisupport[i];
+	}
+	delete[] unisupport;
+	delete[] unisupportsize;
+
 
 }
 
@@ -142,19 +193,104 @@ void	SubMatrix::ScalarMul(double e)	{
 		vi[i] *= e;
 	}
 	UniMu *= e;
+	diagstamp = false;
 }
 
 
+// ---------------------------------------------------------------------------
+//		 Backup() / Restore()
+// ---------------------------------------------------------------------------
+
+void SubMatrix::Backup()	{
+
+	if (! bkQ)	{
+		bkQ = new double*[Nstate];
+		for (int i=0; i<Nstate; i++)	{
+			bkQ[i] = new double[Nstate];
+		}
+		bkstat = new double[Nstate];
+		bkflagarray = new bool[Nstate];
+	}
+	for (int i=0; i<Nstate; i++)	{
+		if (flagarray[i])	{
+			for (int j=0; j<Nstate; j++)	{
+				bkQ[i][j] = Q[i][j];
+			}
+		}
+		bkflagarray[i] = flagarray[i];
+	}
+	for (int i=0; i<Nstate; i++)	{
+		bkstat[i] = mStationary[i];
+	}
+	bkstatflag = statflag;
+}
+
+void SubMatrix::Restore()	{
+
+	if (! bkQ)	{
+		cerr << "error in SubMatrix::Restore: no backup\n";
+		exit(1);
+	}
+	for (int i=0; i<Nstate; i++)	{
+		if (bkflagarray[i])	{
+			for (int j=0; j<Nstate; j++)	{
+				Q[i][j] = bkQ[i][j];
+			}
+		}
+		flagarray[i] = bkflagarray[i];
+	}
+	for (int i=0; i<Nstate; i++)	{
+		mStationary[i] = bkstat[i];
+	}
+	statflag = bkstatflag;
+	// eigen decomposition and powers are recomputed on demand
+	// (the diagonalization itself is skipped if Q is the one last diagonalised)
+	diagflag = false;
+	InactivatePowers();
+}
+
 // ---------------------------------------------------------------------------
 //		 Diagonalise()
 // ---------------------------------------------------------------------------
 
+// the generator and stationary probabilities of the last diagonalization are kept (diagQ, diagstat)
+// so that a matrix corrupted without actually changing
+// (e.g. a component whose profile was not touched by a move) is not diagonalized again
+
+bool SubMatrix::SameAsDiagonalised()	{
+
+	if (! diagstamp)	{
+		return false;
+	}
+	for (int i=0; i<Nstate; i++)	{
+		if (mStationary[i] != diagstat[i])	{
+			return false;
+		}
+	}
+	for (int i=0; i<Nstate; i++)	{
+		const double* q = Q[i];
+		const double* dq = diagQ[i];
+		for (int j=0; j<Nstate; j++)	{
+			if (q[j] != dq[j])	{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 int SubMatrix::Diagonalise()	{
 
 	if (! ArrayUpdated())	{
 		UpdateMatrix();
 	}
 
+	if (SameAsDiagonalised())	{
+		ndiagreuse++;
+		diagflag = true;
+		return 0;
+	}
+
 	// CheckQ();
 
 	int nmax = 1000;
@@ -180,7 +316,7 @@ int SubMatrix::Diagonalise()	{
 	bool failed;
 	int n;
 	if (!isnull)	{
-		n = LinAlg::DiagonalizeRateMatrix(Q,mStationary,Nstate,v,u,invu,nmax,epsilon);
+		n = LinAlg::DiagonalizeRateMatrix(Q,mStationary,Nstate,v,u,invu,nmax,epsilon,diagwork);
 		failed = (n == nmax);
 	}
 	else {	
@@ -229,7 +365,7 @@ int SubMatrix::Diagonalise()	{
 		}
 
 
-		n = LinAlg::DiagonalizeRateMatrix(reducedQ,reducedPi,reducedStateCount,reducedv,reducedu,reducedinvu,nmax,epsilon);
+		n = LinAlg::DiagonalizeRateMatrix(reducedQ,reducedPi,reducedStateCount,reducedv,reducedu,reducedinvu,nmax,epsilon,diagwork);
 		failed = (n == nmax);
 
 		LinAlg::Gauss(reducedu, reducedStateCount, reducedinvu);
@@ -297,6 +433,15 @@ int SubMatrix::Diagonalise()	{
 		exit(1);
 	}
 
+	for (int i=0; i<Nstate; i++)	{
+		diagstat[i] = mStationary[i];
+		for (int j=0; j<Nstate; j++)	{
+			diagQ[i][j] = Q[i][j];
+		}
+	}
+	diagstamp = true;
+	ndiag++;
+
 	diagflag = true;
 
 	return failed;
@@ -413,6 +558,16 @@ void SubMatrix::Normalise()	{
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+// the powers of the uniformized matrix are computed row by row, and only up to the order needed:
+// row i of mPow[n] is row i of mPow[n-1] times mPow[0],
+// and only the non-zero entries of mPow[0] (unisupport) enter the product
+// (summing the same terms in the same order as the full dense product, thus giving the same values).
+//
+// InactivatePowers (called by CorruptMatrix) only flags the powers as out of date;
+// upon the next activation, they are kept if the uniformized matrix turns out to be unchanged
+// (e.g. a component whose profile was not modified since the last collapse),
+// and freed otherwise.
+
 void SubMatrix::ActivatePowers()	{
 
 	if (! powflag)	{
@@ -420,34 +575,60 @@ void SubMatrix::ActivatePowers()	{
 			UpdateMatrix();
 		}
 
-		UniMu = 0;
+		double mu = 0;
 		for (int i=0; i<Nstate; i++)	{
-			if (UniMu < fabs(Q[i][i]))	{
-				UniMu = fabs(Q[i][i]);
+			if (mu < fabs(Q[i][i]))	{
+				mu = fabs(Q[i][i]);
 			}
 		}
 
-		CreatePowers(0);
-		for (int i=0; i<Nstate; i++)	{
-			for (int j=0; j<Nstate; j++)	{
-				mPow[0][i][j] = 0;
+		bool same = (mPow[0] != 0) && (mu == UniMu);
+		for (int i=0; same && (i<Nstate); i++)	{
+			for (int j=0; same && (j<Nstate); j++)	{
+				same = ((((double) (i == j)) + Q[i][j] / mu) == mPow[0][i][j]);
 			}
 		}
-		for (int i=0; i<Nstate; i++)	{
-			mPow[0][i][i] = 1;
+
+		if (same)	{
+			nunireuse++;
 		}
-		for (int i=0; i<Nstate; i++)	{
-			for (int j=0; j<Nstate; j++)	{
-				mPow[0][i][j] += Q[i][j] / UniMu;
-				if (mPow[0][i][j] < 0)	{
-					cerr << "error in SubMatrix::ComputePowers: negative prob : ";
-					cerr << i << '\t' << j << '\t' << mPow[0][i][j] << '\n';
-					cerr << "Nstate : " << Nstate << '\n';
-					exit(1);
+		else	{
+			FreePowers();
+			UniMu = mu;
+
+			CreatePowers(0);
+			for (int i=0; i<Nstate; i++)	{
+				mPow[0][i] = new double[Nstate];
+				for (int j=0; j<Nstate; j++)	{
+					mPow[0][i][j] = 0;
+				}
+				mPow[0][i][i] = 1;
+			}
+			for (int i=0; i<Nstate; i++)	{
+				for (int j=0; j<Nstate; j++)	{
+					mPow[0][i][j] += Q[i][j] / UniMu;
+					if (mPow[0][i][j] < 0)	{
+						cerr << "error in SubMatrix::ComputePowers: negative prob : ";
+						cerr << i << '\t' << j << '\t' << mPow[0][i][j] << '\n';
+						cerr << "Nstate : " << Nstate << '\n';
+						exit(1);
+					}
 				}
 			}
+			// non-zero entries of each row of the uniformized matrix
+			for (int i=0; i<Nstate; i++)	{
+				int n = 0;
+				for (int j=0; j<Nstate; j++)	{
+					if (mPow[0][i][j] != 0)	{
+						unisupport[i][n] = j;
+						n++;
+					}
+				}
+				unisupportsize[i] = n;
+				rowpow[i] = 1;
+			}
+			npow = 1;
 		}
-		npow = 1;
 		powflag = true;
 	}
 }
@@ -455,29 +636,35 @@ void SubMatrix::ActivatePowers()	{
 void SubMatrix::InactivatePowers()	{
 
 	if (powflag)	{
-		for (int n=0; n<UniSubNmax; n++)	{
-			if (mPow[n])	{
-				for (int i=0; i<Nstate; i++)	{
-					delete[] mPow[n][i];
-				}
-				delete [] mPow[n];
-				mPow[n] = 0;
-			}
-		}
 		nunimax += npow;
 		nuni++;
-
-		npow = 0;
 		powflag = false;
 	}
 }
 
+void SubMatrix::FreePowers()	{
+
+	for (int n=0; n<UniSubNmax; n++)	{
+		if (mPow[n])	{
+			for (int i=0; i<Nstate; i++)	{
+				delete[] mPow[n][i];
+			}
+			delete [] mPow[n];
+			mPow[n] = 0;
+		}
+	}
+	for (int i=0; i<Nstate; i++)	{
+		rowpow[i] = 0;
+	}
+	npow = 0;
+}
+
 void SubMatrix::CreatePowers(int n)	{
 
 	if (! mPow[n])	{
 		mPow[n] = new double*[Nstate];
 		for (int i=0; i<Nstate; i++)	{
-			mPow[n][i] = new double[Nstate];
+			mPow[n][i] = 0;
 		}
 	}
 }
@@ -502,8 +689,8 @@ double SubMatrix::Power(int n, int i, int j)	{
 	if (n > UniSubNmax)	{
 		return Stationary(j);
 	}
-	if (n > npow)	{
-		ComputePowers(n);
+	if (n > rowpow[i])	{
+		ComputeRowPowers(i,n);
 	}
 	return mPow[n-1][i][j];
 }
@@ -511,22 +698,43 @@ double SubMatrix::Power(int n, int i, int j)	{
 
 void SubMatrix::ComputePowers(int N)	{
 
+	for (int i=0; i<Nstate; i++)	{
+		ComputeRowPowers(i,N);
+	}
+}
+
+void SubMatrix::ComputeRowPowers(int i, int N)	{
+
 	if (! powflag)	{
 		ActivatePowers();
 	}
-	if (N>npow)	{
-		for (int n=npow; n<N; n++)	{
-			CreatePowers(n);
-			for (int i=0; i<Nstate; i++)	{
-				for (int j=0; j<Nstate; j++)	{
-					double& t = mPow[n][i][j];
-					t = 0;
-					for (int k=0; k<Nstate; k++)	{
-						t += mPow[n-1][i][k] * mPow[0][k][j];
-					}
+	for (int n=rowpow[i]; n<N; n++)	{
+		CreatePowers(n);
+		if (! mPow[n][i])	{
+			mPow[n][i] = new double[Nstate];
+		}
+		double* t = mPow[n][i];
+		const double* prev = mPow[n-1][i];
+		for (int j=0; j<Nstate; j++)	{
+			t[j] = 0;
+		}
+		for (int k=0; k<Nstate; k++)	{
+			double a = prev[k];
+			if (a != 0)	{
+				const double* p0 = mPow[0][k];
+				const int* support = unisupport[k];
+				int nsupport = unisupportsize[k];
+				for (int l=0; l<nsupport; l++)	{
+					t[support[l]] += a * p0[support[l]];
 				}
 			}
 		}
+		nunirow++;
+	}
+	if (rowpow[i] < N)	{
+		rowpow[i] = N;
+	}
+	if (npow < N)	{
 		npow = N;
 	}
 }
@@ -77,10 +77,27 @@ class SubMatrix  	{
 
 	static int		nunisubcount;
 
+	// activations for which the powers of the previous activation could be kept,
+	// and number of rows of powers computed
+	static int		nunireuse;
+	static int		nunirow;
+
 	static int		GetUniSubCount() {return nunisubcount;}
 
 	static double		GetMeanUni() {return ((double) nunimax) / nuni;}
 
+	static double		GetUniReuseRate() {return nuni ? ((double) nunireuse) / nuni : 0;}
+
+	static int		GetUniRowCount() {return nunirow;}
+
+	// diagonalizations actually performed, and avoided because the matrix had not changed
+	static int		ndiag;
+	static int		ndiagreuse;
+
+	static int		GetDiagCount() {return ndiag;}
+	static int		GetDiagReuseCount() {return ndiagreuse;}
+	static void		ResetDiagCount() {ndiag = 0; ndiagreuse = 0;}
+
 				SubMatrix(int Nstate, bool innormalise = false);
 	virtual 		~SubMatrix();
 
@@ -103,6 +120,11 @@ class SubMatrix  	{
 	void 			CorruptMatrix();
 	void 			UpdateMatrix();
 
+	// keeps a copy of the generator and stationary probabilities,
+	// which Restore puts back (instead of recomputing them) when a change of parameters is rejected
+	void			Backup();
+	void			Restore();
+
 	void			ActivatePowers();
 	void			InactivatePowers();
 	double 			Power(int n, int i, int j);
@@ -137,11 +159,14 @@ class SubMatrix  	{
 
 
 	void 			ComputePowers(int n);
+	void 			ComputeRowPowers(int i, int n);
 	void 			CreatePowers(int n);
+	void 			FreePowers();
 
 	bool			ArrayUpdated();
 
 	int 			Diagonalise();
+	bool			SameAsDiagonalised();
 
 	// data members
 	
@@ -154,7 +179,15 @@ class SubMatrix  	{
 	int npow;
 	double UniMu;
 
+	// mPow[n][i] : row i of the (n+1)-th power of the uniformized matrix (allocated on demand)
+	// rowpow[i] : number of powers currently computed for row i
 	double*** mPow;
+	int* rowpow;
+
+	// non-zero entries of each row of mPow[0] (in increasing order)
+	// for codon matrices, only the state itself and its single-nucleotide neighbours
+	int* unisupportsize;
+	int** unisupport;
 	
 	// Q : the infinitesimal generator matrix
 	double ** Q;
@@ -177,6 +210,20 @@ class SubMatrix  	{
 	double * v;
 	double * vi;
 
+	// Q and stationary probabilities at the time of the last diagonalization
+	double ** diagQ;
+	double * diagstat;
+	bool diagstamp;
+
+	// scratch space for LinAlg::DiagonalizeRateMatrix
+	double ** diagwork;
+
+	// copy made by Backup (allocated on first use)
+	double ** bkQ;
+	double * bkstat;
+	bool * bkflagarray;
+	bool bkstatflag;
+
 	int ndiagfailed;
 };
 
@@ -264,24 +311,29 @@ inline double SubMatrix::GetFiniteTimeTransitionProb(int stateup, int statedown,
 
 inline int SubMatrix::DrawUniformizedTransition(int state, int statedown, int n)	{
 
-	double* p = new double[GetNstate()];
+	if (! powflag)	{
+		ActivatePowers();
+	}
+	// only the states reachable in one step of the uniformized chain
+	int nsupport = unisupportsize[state];
+	const int* support = unisupport[state];
+	double p[nsupport];
 	double tot = 0;
-	for (int l=0; l<GetNstate(); l++)	{
-		tot += Power(1,state,l) * Power(n,l,statedown);
+	for (int l=0; l<nsupport; l++)	{
+		tot += mPow[0][state][support[l]] * Power(n,support[l],statedown);
 		p[l] = tot;
 	}
 
 	double s = tot * rnd::GetRandom().Uniform();
 	int k = 0;
-	while ((k<GetNstate()) && (s > p[k]))	{
+	while ((k<nsupport) && (s > p[k]))	{
 		k++;
 	}
-	if (k == GetNstate())	{
+	if (k == nsupport)	{
 		cerr << "error in DrawUniformizedTransition: overflow\n";
 		throw;
 	}
-	delete[] p;
-	return k;
+	return support[k];
 }
 
 
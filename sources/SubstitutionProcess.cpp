@@ -28,6 +28,8 @@ using namespace std;
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
 
+bool SubstitutionProcess::sitegrouping = false;
+
 //-------------------------------------------------------------------------
 //	* allocations / deallocations
 //-------------------------------------------------------------------------
@@ -52,6 +54,52 @@ void SubstitutionProcess::Delete() {
 	}
 };
 
+void SubstitutionProcess::UpdateSiteOrder()	{
+
+	int n = sitemax - sitemin;
+	if (! sitegrouping)	{
+		if (((int) siteorder.size()) != n)	{
+			siteorder.resize(n);
+			for (int i=0; i<n; i++)	{
+				siteorder[i] = sitemin + i;
+			}
+		}
+		return;
+	}
+
+	bool changed = (((int) siteordercomp.size()) != n);
+	if (changed)	{
+		siteordercomp.resize(n);
+	}
+	for (int i=0; i<n; i++)	{
+		int k = GetSiteComponent(sitemin + i);
+		if (siteordercomp[i] != k)	{
+			siteordercomp[i] = k;
+			changed = true;
+		}
+	}
+	if (changed)	{
+		// counting sort: sites of a component remain in alignment order
+		int ncomp = 0;
+		for (int i=0; i<n; i++)	{
+			if (ncomp <= siteordercomp[i])	{
+				ncomp = siteordercomp[i] + 1;
+			}
+		}
+		vector<int> start(ncomp+1,0);
+		for (int i=0; i<n; i++)	{
+			start[siteordercomp[i]+1]++;
+		}
+		for (int k=0; k<ncomp; k++)	{
+			start[k+1] += start[k];
+		}
+		siteorder.resize(n);
+		for (int i=0; i<n; i++)	{
+			siteorder[start[siteordercomp[i]]++] = sitemin + i;
+		}
+	}
+}
+
 void SubstitutionProcess::CreateCondSiteLogL()	{
 	if (condsitelogL)	{
 		cerr << "error in SubstitutionProcess::CreateSiteLogL\n";
@@ -82,16 +130,16 @@ void SubstitutionProcess::DeleteCondSiteLogL()	{
 	}
 }
 
-double*** SubstitutionProcess::CreateConditionalLikelihoodVector()	{
+condl_t*** SubstitutionProcess::CreateConditionalLikelihoodVector()	{
 	//cout << "VECTOR ALLOCATION: " << sitemax << "  " << sitemin << endl;
 	// double*** condl = new double**[sitemax - sitemin];
-	double*** condl = new double**[GetNsite()];
+	condl_t*** condl = new condl_t**[GetNsite()];
 	for (int i=sitemin; i<sitemax; i++)	{
 	// for (int i=0; i<GetNsite(); i++)	{
-		condl[i] = new double*[GetNrate(i)];
+		condl[i] = new condl_t*[GetNrate(i)];
 		for (int j=0; j<GetNrate(i); j++)	{
-			condl[i][j] = new double[GetNstate(i) + 1];
-			double* tmp = condl[i][j];
+			condl[i][j] = new condl_t[GetNstate(i) + 1];
+			condl_t* tmp = condl[i][j];
 			for (int k=0; k<GetNstate(i); k++)	{
 				tmp[k] = 1.0;
 			}
@@ -102,7 +150,7 @@ double*** SubstitutionProcess::CreateConditionalLikelihoodVector()	{
 	return condl;
 }
 
-void SubstitutionProcess::DeleteConditionalLikelihoodVector(double*** condl)	{
+void SubstitutionProcess::DeleteConditionalLikelihoodVector(condl_t*** condl)	{
 	for (int i=sitemin; i<sitemax; i++)	{
 	// for (int i=0; i<GetNsite(); i++)	{
 		for (int j=0; j<GetNrate(i); j++)	{
@@ -120,13 +168,13 @@ void SubstitutionProcess::DeleteConditionalLikelihoodVector(double*** condl)	{
 //-------------------------------------------------------------------------
 
 // set the vector uniformly to 1 
-void SubstitutionProcess::Reset(double*** t, bool condalloc, bool all)	{
+void SubstitutionProcess::Reset(condl_t*** t, bool condalloc, bool all)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         // if (ActiveSite(i))  {
         if (all || ActiveSite(i))  {
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmp = t[i][j];
+                    condl_t* tmp = t[i][j];
                     int nstate = GetNstate(i);
                     for (int k=0; k<nstate; k++)	{
                         (*tmp++) = 1.0;
@@ -143,12 +191,12 @@ void SubstitutionProcess::Reset(double*** t, bool condalloc, bool all)	{
 	
 // initialize the vector according to the data observed at a given leaf of the tree (contained in const int* state)
 // steta[i] == -1 means 'missing data'. in that case, conditional likelihoods are all 1
-void SubstitutionProcess::Initialize(double*** t, const int* state, bool condalloc)	{
+void SubstitutionProcess::Initialize(condl_t*** t, const int* state, bool condalloc)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmp = t[i][j];
+                    condl_t* tmp = t[i][j];
                     int nstate = GetNstate(i);
                     tmp[nstate] = 0;
                     if (state[i] == -1)	{
@@ -173,22 +221,30 @@ void SubstitutionProcess::Initialize(double*** t, const int* state, bool condall
 }
 
 // multiply two conditional likelihood vectors, term by term
-void SubstitutionProcess::Multiply(double*** from, double*** to, bool condalloc)	{
+void SubstitutionProcess::Multiply(condl_t*** from, condl_t*** to, bool condalloc)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmpfrom = from[i][j];
-                    double* tmpto = to[i][j];
+                    condl_t* tmpfrom = from[i][j];
+                    condl_t* tmpto = to[i][j];
                     int nstate = GetNstate(i);
+                    // products are rescaled when needed
+                    // (the vectors that are not offset along the pre-order traversals could otherwise underflow)
+                    double max = 0;
                     for (int k=0; k<nstate; k++)	{
-                        (*tmpto++) *= (*tmpfrom++);
+                        (*tmpto) *= (*tmpfrom++);
                         // tmpto[k] *= tmpfrom[k];
+                        if (max < (*tmpto))	{
+                            max = (*tmpto);
+                        }
+                        tmpto++;
                     }
                     *tmpto += *tmpfrom;
                     tmpto -= nstate;
                     tmpfrom -= nstate;
                     // tmpto[GetNstate(i)] += tmpfrom[GetNstate(i)];
+                    RescaleCondl(tmpto,nstate,max);
                 }
             }
         }
@@ -196,13 +252,13 @@ void SubstitutionProcess::Multiply(double*** from, double*** to, bool condalloc)
 }
 
 // multiply a conditional likelihood vector by the (possibly site-specific) stationary probabilities of the process
-void SubstitutionProcess::MultiplyByStationaries(double*** to, bool condalloc)	{
+void SubstitutionProcess::MultiplyByStationaries(condl_t*** to, bool condalloc)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
             const double* stat = GetStationary(i);
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmpto = to[i][j];
+                    condl_t* tmpto = to[i][j];
                     int nstate = GetNstate(i);
                     for (int k=0; k<nstate; k++)	{	
                         (*tmpto++) *= (*stat++);
@@ -216,22 +272,24 @@ void SubstitutionProcess::MultiplyByStationaries(double*** to, bool condalloc)	{
     }
 }
 
-// to avoid numerical errors: all entries for a given site and a given rate
-// are divided by the largest among them
-// and the residual is stored in the last entry of the vector
-void SubstitutionProcess::Offset(double*** t, bool condalloc)	{
+// to avoid numerical errors: when the largest entry for a given site and a given rate becomes too small,
+// all entries are divided by the power of 2 closest to it
+// and the binary exponent is accumulated in the last entry of the vector (see RescaleCondl)
+void SubstitutionProcess::Offset(condl_t*** t, bool condalloc)	{
 	for (int i=sitemin; i<sitemax; i++)	{
         if (ActiveSite(i))  {
             for (int j=0; j<GetNrate(i); j++)	{
                 if ((! condalloc) || (ratealloc[i] == j))	{
-                    double* tmp = t[i][j];
+                    condl_t* tmp = t[i][j];
                     double max = 0;
                     for (int k=0; k<GetNstate(i); k++)	{
-                        if (tmp[k] <0)	{
+#ifdef DEBUG_CONDL
+                        if ((tmp[k] < 0) || std::isnan(tmp[k]))	{
                             cerr << "error in pruning: negative prob : " << tmp[k] << "\n";
                             exit(1);
                             // tmp[k] = 0;
                         }
+#endif
                         if (max < tmp[k])	{
                             max = tmp[k];
                         }
@@ -241,16 +299,7 @@ void SubstitutionProcess::Offset(double*** t, bool condalloc)	{
                         max = 1e-12;
                     }
                     */
-                    if (max < 0)	{
-                        cerr << "error in pruning (offset function): null likelihood\n";
-                        exit(1);
-                    }
-                    if (max > 0)	{
-                        for (int k=0; k<GetNstate(i); k++)	{
-                            tmp[k] /= max;
-                        }
-                    }
-                    tmp[GetNstate(i)] += log(max);
+                    RescaleCondl(tmp,GetNstate(i),max);
                 }
             }
         }
@@ -262,7 +311,7 @@ void SubstitutionProcess::Offset(double*** t, bool condalloc)	{
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 
-double SubstitutionProcess::ComputeLikelihood(double*** aux, bool condalloc)	{
+double SubstitutionProcess::ComputeLikelihood(condl_t*** aux, bool condalloc)	{
 
 	for (int i=sitemin; i<sitemax; i++)	{
         sitelogL[i] = 0;
@@ -275,7 +324,7 @@ double SubstitutionProcess::ComputeLikelihood(double*** aux, bool condalloc)	{
         if (ActiveSite(i))  {
             if (condalloc)	{
                 int j = ratealloc[i];
-                double* t = aux[i][j];
+                condl_t* t = aux[i][j];
                 double tot = 0;
                 int nstate = GetNstate(i);
                 for (int k=0; k<nstate; k++)	{
@@ -285,14 +334,14 @@ double SubstitutionProcess::ComputeLikelihood(double*** aux, bool condalloc)	{
                     // dirty !
                     tot = 1e-12;
                 }
-                sitelogL[i] = log(tot) + (*t);
+                sitelogL[i] = log(tot) + CondlLogOffset(*t);
                 t -= nstate;
             }
             else	{
                 double max = 0;
                 double* logl = condsitelogL[i];
                 for (int j=0; j<GetNrate(i); j++)	{
-                    double* t = aux[i][j];
+                    condl_t* t = aux[i][j];
                     double tot = 0;
                     int nstate = GetNstate(i);
                     for (int k=0; k<nstate; k++)	{
@@ -315,7 +364,7 @@ double SubstitutionProcess::ComputeLikelihood(double*** aux, bool condalloc)	{
                         // dirty !
                         tot = 1e-12;
                     }
-                    logl[j] = log(tot) + (*t);
+                    logl[j] = log(tot) + CondlLogOffset(*t);
                     t -= nstate;
                     if ((!j) || (max < logl[j]))	{
                         max = logl[j];
@@ -360,12 +409,12 @@ double SubstitutionProcess::ComputeLikelihood(double*** aux, bool condalloc)	{
 }
 	
 
-void SubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(double*** aux,double*** statepostprob, int nodelabel, bool condalloc)	{
+void SubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(condl_t*** aux,double*** statepostprob, int nodelabel, bool condalloc)	{
 
 	for (int i=sitemin; i<sitemax; i++)	{
         if (condalloc)	{
             int j = ratealloc[i];
-            double* t = aux[i][j];
+            condl_t* t = aux[i][j];
             double* s = statepostprob[i][nodelabel];
             /*
             if (GetNstate(i) != GetNstate())	{
@@ -387,10 +436,21 @@ void SubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(double*** aux,d
             for (int k=0; k<GetNstate(i); k++)	{
                 s[k] =0;
             }
+            // the vectors of the rate categories are not normalized and have their own scaling offsets (see RescaleCondl)
+            // each of them is thus brought back to a common scale, and weighted by the prior weight of its category
+            int nstate = GetNstate(i);
+            double maxoffset = 0;
+            for (int j=0; j<GetNrate(i); j++)	{
+                double offset = CondlLogOffset(aux[i][j][nstate]);
+                if ((!j) || (maxoffset < offset))	{
+                    maxoffset = offset;
+                }
+            }
             for (int j=0; j<GetNrate(i); j++)	{
-                double* t = aux[i][j];
-                for (int k=0; k<GetNstate(i); k++)	{
-                    s[k] += t[k];
+                condl_t* t = aux[i][j];
+                double w = GetRateWeight(i,j) * exp(CondlLogOffset(t[nstate]) - maxoffset);
+                for (int k=0; k<nstate; k++)	{
+                    s[k] += w * t[k];
                 }
             }
             double total = 0;
@@ -413,7 +473,7 @@ void SubstitutionProcess::ConditionalLikelihoodsToStatePostProbs(double*** aux,d
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 
-void SubstitutionProcess::DrawAllocations(double*** aux)	{
+void SubstitutionProcess::DrawAllocations(condl_t*** aux)	{
 
 	if (aux)	{
 		ComputeLikelihood(aux);
@@ -436,7 +496,9 @@ void SubstitutionProcess::DrawAllocations(double*** aux)	{
                 cumul += GetRateWeight(i,j) * exp(logl[j] - max);
                 p[j] = cumul;
             }
+            rnd::GetRandom().OpenStream(i,Random::RATEALLOC);
             double u = rnd::GetRandom().Uniform() * cumul;
+            rnd::GetRandom().CloseStream();
             int j = 0;
             while ((j<GetNrate(i)) && (p[j] < u)) j++;
             if (j == GetNrate(i))	{
@@ -451,7 +513,9 @@ void SubstitutionProcess::DrawAllocations(double*** aux)	{
 void SubstitutionProcess::DrawAllocationsFromPrior()	{
 
 	for (int i=sitemin; i<sitemax; i++)	{
+        rnd::GetRandom().OpenStream(i,Random::RATEALLOC);
         int k = (int) (GetNrate(i) * rnd::GetRandom().Uniform());
+        rnd::GetRandom().CloseStream();
         ratealloc[i] = k;
 	}
 }
@@ -462,15 +526,17 @@ void SubstitutionProcess::DrawAllocationsFromPrior()	{
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 
-void SubstitutionProcess::ChooseStates(double*** t, int* states)	{
+void SubstitutionProcess::ChooseStates(condl_t*** t, int* states)	{
 	for (int i=sitemin; i<sitemax; i++)	{
 		int j = ratealloc[i];
-		double* tmp = t[i][j];
+		condl_t* tmp = t[i][j];
 		double total = 0;
 		for (int k=0; k<GetNstate(i); k++)	{
 			total += tmp[k];
 		}
+		rnd::GetRandom().OpenStream(i,Random::NODESTATE);
 		double u = rnd::GetRandom().Uniform() * total;
+		rnd::GetRandom().CloseStream();
 		double tot = tmp[0];
 		int k = 0;
 		while ((k<GetNstate(i)) && (tot < u))	{
@@ -504,7 +570,9 @@ void SubstitutionProcess::ChooseStatesAtEquilibrium(int* states)	{
 			cerr << "error in SubstitutionProcess::ChooseStatesAtEquilibrium: does not sum to 1: " << tot << '\n';
 			exit(1);
 		}
+		rnd::GetRandom().OpenStream(i,Random::NODESTATE);
 		double u = rnd::GetRandom().Uniform();
+		rnd::GetRandom().CloseStream();
 		int k = 0;
 		while ((k<nstate) && (u > cumul[k]))	{
 			k++;
@@ -517,10 +585,10 @@ void SubstitutionProcess::ChooseStatesAtEquilibrium(int* states)	{
 	}
 }
 
-void SubstitutionProcess::SetCondToStates(double*** t, int* states)	{
+void SubstitutionProcess::SetCondToStates(condl_t*** t, int* states)	{
 	for (int i=sitemin; i<sitemax; i++)	{
 		int j = ratealloc[i];
-		double* tmp = t[i][j];
+		condl_t* tmp = t[i][j];
 		for (int l=0; l<GetNstate(i); l++)	{
 			tmp[l] = 0;
 		}
@@ -542,10 +610,10 @@ void SubstitutionProcess::SetCondToStates(double*** t, int* states)	{
 //-------------------------------------------------------------------------
 
 // set the vector uniformly to 1 
-void SubstitutionProcess::SiteReset(int i, double** t, bool condalloc)	{
+void SubstitutionProcess::SiteReset(int i, condl_t** t, bool condalloc)	{
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmp = t[j];
+			condl_t* tmp = t[j];
 			int nstate = GetNstate(i);
 			for (int k=0; k<nstate; k++)	{
 				(*tmp++) = 1.0;
@@ -558,11 +626,11 @@ void SubstitutionProcess::SiteReset(int i, double** t, bool condalloc)	{
 	
 // initialize the vector according to the data observed at a given leaf of the tree (contained in const int* state)
 // steta[i] == -1 means 'missing data'. in that case, conditional likelihoods are all 1
-void SubstitutionProcess::SiteInitialize(int i, double** t, const int state, bool condalloc)	{
+void SubstitutionProcess::SiteInitialize(int i, condl_t** t, const int state, bool condalloc)	{
 
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmp = t[j];
+			condl_t* tmp = t[j];
 			int nstate = GetNstate(i);
 			tmp[nstate] = 0;
 			if (state == -1)	{
@@ -583,28 +651,34 @@ void SubstitutionProcess::SiteInitialize(int i, double** t, const int state, boo
 }
 
 // multiply two conditional likelihood vectors, term by term
-void SubstitutionProcess::SiteMultiply(int i, double** from, double** to, bool condalloc)	{
+void SubstitutionProcess::SiteMultiply(int i, condl_t** from, condl_t** to, bool condalloc)	{
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmpfrom = from[j];
-			double* tmpto = to[j];
+			condl_t* tmpfrom = from[j];
+			condl_t* tmpto = to[j];
 			int nstate = GetNstate(i);
+			double max = 0;
 			for (int k=0; k<nstate; k++)	{
-				(*tmpto++) *= (*tmpfrom++);
+				(*tmpto) *= (*tmpfrom++);
+				if (max < (*tmpto))	{
+					max = (*tmpto);
+				}
+				tmpto++;
 			}
 			*tmpto += *tmpfrom;
 			tmpto -= nstate;
 			tmpfrom -= nstate;
+			RescaleCondl(tmpto,nstate,max);
 		}
 	}
 }
 
 // multiply a conditional likelihood vector by the (possibly site-specific) stationary probabilities of the process
-void SubstitutionProcess::SiteMultiplyByStationaries(int i, double** to, bool condalloc)	{
+void SubstitutionProcess::SiteMultiplyByStationaries(int i, condl_t** to, bool condalloc)	{
 	const double* stat = GetStationary(i);
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmpto = to[j];
+			condl_t* tmpto = to[j];
 			int nstate = GetNstate(i);
 			for (int k=0; k<nstate; k++)	{	
 				(*tmpto++) *= (*stat++);
@@ -615,30 +689,24 @@ void SubstitutionProcess::SiteMultiplyByStationaries(int i, double** to, bool co
 	}
 }
 
-// to avoid numerical errors: all entries for a given site and a given rate
-// are divided by the largest among them
-// and the residual is stored in the last entry of the vector
-void SubstitutionProcess::SiteOffset(int i, double** t, bool condalloc)	{
+// to avoid numerical errors: same as Offset
+void SubstitutionProcess::SiteOffset(int i, condl_t** t, bool condalloc)	{
 	for (int j=0; j<GetNrate(i); j++)	{
 		if ((! condalloc) || (ratealloc[i] == j))	{
-			double* tmp = t[j];
+			condl_t* tmp = t[j];
 			double max = 0;
 			for (int k=0; k<GetNstate(i); k++)	{
-				if (tmp[k] <0)	{
+#ifdef DEBUG_CONDL
+				if ((tmp[k] < 0) || std::isnan(tmp[k]))	{
 					cerr << "error in pruning: negative prob : " << tmp[k] << "\n";
 					exit(1);
-					tmp[k] = 0;
 				}
+#endif
 				if (max < tmp[k])	{
 					max = tmp[k];
 				}
 			}
-			if (max > 0)	{
-				for (int k=0; k<GetNstate(i); k++)	{
-					tmp[k] /= max;
-				}
-			}
-			tmp[GetNstate(i)] += log(max);
+			RescaleCondl(tmp,GetNstate(i),max);
 		}
 	}
 }
@@ -648,12 +716,12 @@ void SubstitutionProcess::SiteOffset(int i, double** t, bool condalloc)	{
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 
-double SubstitutionProcess::SiteComputeLikelihood(int i, double** aux, bool condalloc)	{
+double SubstitutionProcess::SiteComputeLikelihood(int i, condl_t** aux, bool condalloc)	{
 
     double sitelogl = 0;
 	if (condalloc)	{
 		int j = ratealloc[i];
-		double* t = aux[j];
+		condl_t* t = aux[j];
 		double tot = 0;
 		int nstate = GetNstate(i);
 		for (int k=0; k<nstate; k++)	{
@@ -663,14 +731,14 @@ double SubstitutionProcess::SiteComputeLikelihood(int i, double** aux, bool cond
 			// dirty !
 			tot = 1e-12;
 		}
-		sitelogl = log(tot) + (*t);
+		sitelogl = log(tot) + CondlLogOffset(*t);
 		t -= nstate;
 	}
 	else	{
 		double max = 0;
 		double logl[GetNrate(i)];
 		for (int j=0; j<GetNrate(i); j++)	{
-			double* t = aux[j];
+			condl_t* t = aux[j];
 			double tot = 0;
 			int nstate = GetNstate(i);
 			for (int k=0; k<nstate; k++)	{
@@ -682,7 +750,7 @@ double SubstitutionProcess::SiteComputeLikelihood(int i, double** aux, bool cond
 				// dirty !
 				tot = 1e-12;
 			}
-			logl[j] = log(tot) + (*t);
+			logl[j] = log(tot) + CondlLogOffset(*t);
 			t -= nstate;
 			if ((!j) || (max < logl[j]))	{
 				max = logl[j];
@@ -714,6 +782,25 @@ double SubstitutionProcess::SiteComputeLikelihood(int i, double** aux, bool cond
 }
 	
 
+//-------------------------------------------------------------------------
+//	* same, batched over the components of a mixture, at a given site
+//	(CPU level 1 and 3)
+//-------------------------------------------------------------------------
+
+void SubstitutionProcess::SiteComponentPropagate(int i, int ncomp, condl_t*** from, condl_t*** to, double time)	{
+	for (int k=0; k<ncomp; k++)	{
+		SetSiteComponent(i,k);
+		SitePropagate(i,from[k],to[k],time);
+	}
+}
+
+void SubstitutionProcess::SiteComponentMultiplyByStationaries(int i, int ncomp, condl_t*** to)	{
+	for (int k=0; k<ncomp; k++)	{
+		SetSiteComponent(i,k);
+		SiteMultiplyByStationaries(i,to[k]);
+	}
+}
+
 //-------------------------------------------------------------------------
 //	* sample the allocation of each site to one of the available rate categories
 // 	for each site, the rate caegory is chosen with probability proportional
@@ -723,7 +810,7 @@ double SubstitutionProcess::SiteComputeLikelihood(int i, double** aux, bool cond
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 /*
-void SubstitutionProcess::SiteDrawAllocations(int i, double** aux)	{
+void SubstitutionProcess::SiteDrawAllocations(int i, condl_t** aux)	{
 
 	if (aux)	{
 		SiteComputeLikelihood(i,aux);
@@ -764,10 +851,10 @@ void SubstitutionProcess::SiteDrawAllocations(int i, double** aux)	{
 //	(CPU level 2)
 //-------------------------------------------------------------------------
 
-int SubstitutionProcess::SiteChooseState(int i, double** t)	{
+int SubstitutionProcess::SiteChooseState(int i, condl_t** t)	{
 
 	int j = ratealloc[i];
-	double* tmp = t[j];
+	condl_t* tmp = t[j];
 	double total = 0;
 	for (int k=0; k<GetNstate(i); k++)	{
 		total += tmp[k];
@@ -22,6 +22,59 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include "BranchSitePath.h"
 #include "Chrono.h"
 #include <algorithm>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+// ----
+// storage of the conditional likelihood vectors
+//
+// each vector (one per site and per rate category) has nstate entries,
+// followed by a scaling offset (see SubstitutionProcess::Offset)
+//
+// double precision by default;
+// when compiled with -DFLOAT_CONDL (see Makefile), single precision,
+// which halves the memory footprint and the memory traffic of the pruning.
+// in that case, sums and matrix products are still accumulated in double precision
+//
+// to avoid underflows, the entries of a vector are rescaled by a power of 2 (which is exact)
+// whenever their max falls below 2^-condlrescaleexponent
+// (which, in double precision, seldom happens more than a few times along the tree).
+// the offset accumulates the binary exponents (an integer, also exact in single precision),
+// and is converted into a log only when computing the likelihood (see CondlLogOffset)
+//
+// when compiled with -DDEBUG_CONDL, the entries are checked (no nan, no negative value) at each step of the pruning;
+// otherwise, numerical errors are caught at the end, by ComputeLikelihood
+
+#ifdef FLOAT_CONDL
+typedef float condl_t;
+const int condlrescaleexponent = 16;
+#else
+typedef double condl_t;
+const int condlrescaleexponent = 128;
+#endif
+
+// rescales the nstate entries of t, given their max, if it is below the threshold, and updates the offset accordingly
+inline void RescaleCondl(condl_t* t, int nstate, double max)	{
+	if (max > 0)	{
+		int e;
+		frexp(max,&e);
+		if (e <= -condlrescaleexponent)	{
+			for (int k=0; k<nstate; k++)	{
+				t[k] = ldexp(t[k],-e);
+			}
+			t[nstate] += e;
+		}
+	}
+	else	{
+		t[nstate] = -numeric_limits<condl_t>::infinity();
+	}
+}
+
+// log of the scaling factor stored in the offset of a vector
+inline double CondlLogOffset(condl_t offset)	{
+	return offset * log(2.0);
+}
 
 // ----
 // Substitution Process is the class gathering nearly all CPU-intensive methods of the program
@@ -87,6 +140,10 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 
 	int GetInfProbCount() {return infprobcount;}
 
+	// option -sitegroup: the per-site loops that use the matrices (Propagate, SamplePaths)
+	// visit the sites of each process grouped by mixture component, so that the matrix of a component stays in cache
+	static bool sitegrouping;
+
 	protected:
 
 	void Create(int innsite, int indim, int insitemin,int insitemax);
@@ -94,8 +151,8 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 
 	// basic modules for creating deleting arrays of conditional likelihoods
 	// used by PhyloProcess
-	double*** CreateConditionalLikelihoodVector();
-	void DeleteConditionalLikelihoodVector(double*** condl);
+	condl_t*** CreateConditionalLikelihoodVector();
+	void DeleteConditionalLikelihoodVector(condl_t*** condl);
 
 	double* CreateProbVector()	{
 		return new double[GetSiteMax() - GetSiteMin()];
@@ -113,7 +170,7 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 
 	// CPU : level 1
 	// if aux==0, assumes likelihoods have been computed
-	void DrawAllocations(double*** aux = 0);
+	void DrawAllocations(condl_t*** aux = 0);
 	void DrawAllocationsFromPrior();
 
 	// in the following
@@ -121,29 +178,29 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 	// only for the category specified for that site by double* ratealloc
 
 	// CPU : level 1
-	void Reset(double*** condl, bool condalloc = false, bool all = false);
-	void Multiply(double*** from, double*** to, bool condalloc = false);
-	void MultiplyByStationaries(double*** from, bool condalloc = false);
-	void Offset(double*** condl, bool condalloc = false);
-	virtual void Initialize(double*** condl, const int* leafstates, bool condalloc = false);
+	void Reset(condl_t*** condl, bool condalloc = false, bool all = false);
+	void Multiply(condl_t*** from, condl_t*** to, bool condalloc = false);
+	void MultiplyByStationaries(condl_t*** from, bool condalloc = false);
+	void Offset(condl_t*** condl, bool condalloc = false);
+	virtual void Initialize(condl_t*** condl, const int* leafstates, bool condalloc = false);
 
 	// CPU : level 2
-	double ComputeLikelihood(double*** aux, bool condalloc = false);
+	double ComputeLikelihood(condl_t*** aux, bool condalloc = false);
 
-	virtual void ConditionalLikelihoodsToStatePostProbs(double*** aux,double*** statepostprob, int nodelabel, bool condalloc = false);
+	virtual void ConditionalLikelihoodsToStatePostProbs(condl_t*** aux,double*** statepostprob, int nodelabel, bool condalloc = false);
 
 	// CPU : level 3
 	// implemented in GTR or POisson Substitution process
-	virtual void Propagate(double*** from, double*** to, double time, bool condalloc = false) = 0;
+	virtual void Propagate(condl_t*** from, condl_t*** to, double time, bool condalloc = false) = 0;
 
 	virtual void SimuPropagate(int* stateup, int* statedown, double time) = 0;
 
 	// CPU : level 1
 	// implemented in GTR or POisson Substitution process
 	// here, assumes that each site is under the rate category defined by double* ratealloc
-	virtual void ChooseStates(double*** aux, int* states);
+	virtual void ChooseStates(condl_t*** aux, int* states);
 	void ChooseStatesAtEquilibrium(int* states);
-	virtual void SetCondToStates(double*** aux, int* states);
+	virtual void SetCondToStates(condl_t*** aux, int* states);
 	
 	// CPU : level 3
 	// implemented in GTR or POisson Substitution process
@@ -164,21 +221,21 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 
 	// CPU : level 1
 	// if aux==0, assumes likelihoods have been computed
-	// void SiteDrawAllocations(int site, double** aux);
+	// void SiteDrawAllocations(int site, condl_t** aux);
 
 	// CPU : level 1
-	void SiteReset(int site, double** condl, bool condalloc = false);
-	void SiteMultiply(int site, double** from, double** to, bool condalloc = false);
-	void SiteMultiplyByStationaries(int site, double** from, bool condalloc = false);
-	void SiteOffset(int site, double** condl, bool condalloc = false);
-	virtual void SiteInitialize(int site, double** condl, const int leafstate, bool condalloc = false);
+	void SiteReset(int site, condl_t** condl, bool condalloc = false);
+	void SiteMultiply(int site, condl_t** from, condl_t** to, bool condalloc = false);
+	void SiteMultiplyByStationaries(int site, condl_t** from, bool condalloc = false);
+	void SiteOffset(int site, condl_t** condl, bool condalloc = false);
+	virtual void SiteInitialize(int site, condl_t** condl, const int leafstate, bool condalloc = false);
 
 	// CPU : level 2
-	double SiteComputeLikelihood(int site, double** aux, bool condalloc = false);
+	double SiteComputeLikelihood(int site, condl_t** aux, bool condalloc = false);
 
 	// CPU : level 3
 	// implemented in GTR or POisson Substitution process
-	virtual void SitePropagate(int site, double** from, double** to, double time, bool condalloc = false)	{
+	virtual void SitePropagate(int site, condl_t** from, condl_t** to, double time, bool condalloc = false)	{
 		cerr << "in SubstitutionProcess::SitePropagate\n";
 		exit(1);
 	}
@@ -186,7 +243,27 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 	// CPU : level 1
 	// implemented in GTR or POisson Substitution process
 	// here, assumes that each site is under the rate category defined by double* ratealloc
-	// virtual int SiteChooseState(int site, double** aux);
+	// virtual int SiteChooseState(int site, condl_t** aux);
+
+	// batched versions, over the first ncomp components of a mixture, at a given site
+	// (cross-validation and site log likelihoods)
+	// condl[k] is the site conditional likelihood vector (rate x state) under component k
+
+	// puts the site under component k: implemented by the mixture phylo processes
+	virtual void SetSiteComponent(int site, int k)	{
+		cerr << "in SubstitutionProcess::SetSiteComponent\n";
+		exit(1);
+	}
+
+	// called once per site, before the traversal
+	virtual void PrepareSiteComponents(int site, int ncomp) {}
+
+	// CPU : level 3
+	// default: component by component, through SetSiteComponent and SitePropagate
+	virtual void SiteComponentPropagate(int site, int ncomp, condl_t*** from, condl_t*** to, double time);
+
+	// CPU : level 1
+	virtual void SiteComponentMultiplyByStationaries(int site, int ncomp, condl_t*** to);
 
 
 	int sitemin;
@@ -199,6 +276,13 @@ class SubstitutionProcess : public virtual RateProcess, public virtual ProfilePr
 
 	int infprobcount;
 	int suboverflowcount;
+
+	// order in which the per-site loops of Propagate and SamplePaths visit the sites sitemin <= i < sitemax
+	// (natural order, or grouped by component with sitegrouping)
+	// refreshed by UpdateSiteOrder whenever the allocations have changed since the last call
+	void UpdateSiteOrder();
+	vector<int> siteorder;
+	vector<int> siteordercomp;
 };
 
 #endif
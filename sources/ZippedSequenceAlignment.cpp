@@ -160,6 +160,65 @@ void ZippedSequenceAlignment::ComputeZipArrays()	{
 		}
 	}
 
+	ComputeZipStats();
+}
+
+void ZippedSequenceAlignment::LoadZipArrays(const AlignmentCache* cache)	{
+
+	for (int i=0; i<Nsite; i++)	{
+
+		// observed states in increasing order, followed by the unobserved ones
+		OrbitSize[i] = 0;
+		for (int k=0; k<Nstate; k++)	{
+			Orbit[i][k] = cache->InOrbit(i,k);
+			if (Orbit[i][k])	{
+				Indices[i][OrbitSize[i]] = k;
+				OrbitSize[i]++;
+			}
+		}
+		int orbitsize = OrbitSize[i];
+		for (int k=0; k<Nstate; k++)	{
+			if (! Orbit[i][k])	{
+				Indices[i][orbitsize++] = k;
+			}
+		}
+
+		// reverse translation table
+		for (int j=0; j<OrbitSize[i]; j++)	{
+			ZipIndices[i][Indices[i][j]] = j;
+		}
+		for (int j=0; j<Nstate; j++)	{
+			if (! Orbit[i][j])	{
+				ZipIndices[i][j] = OrbitSize[i];
+			}
+		}	
+
+		if (OrbitSize[i] < Nstate)	{
+			ZipSize[i] = OrbitSize[i] + 1;
+		}
+		else	{
+			ZipSize[i] = OrbitSize[i];
+		}
+
+		for (int j=0; j<Ntaxa; j++)	{
+			int d = GetTemplate()->GetState(j,i);
+			if (d == unknown)	{
+				Data[j][i] = unknown;
+			}
+			else	{
+				if (! Orbit[i][d])	{
+					cerr << "error in zip data making: alignment cache does not match the data\n";
+					exit(1);
+				}
+				Data[j][i] = ZipIndices[i][d];
+			}
+		}
+	}
+	ComputeZipStats();
+}
+
+void ZippedSequenceAlignment::ComputeZipStats()	{
+
 	double temp = 0;
 	for (int i=0; i<Nsite; i++)	{
 		temp += ((double) ZipSize[i] * ZipSize[i]) / Nstate / Nstate;
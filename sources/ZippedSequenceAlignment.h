@@ -34,7 +34,12 @@ class ZippedSequenceAlignment : public SequenceAlignment	{
 		Nstate = statespace->GetNstate();
 
         CreateZipArrays();
-		ComputeZipArrays();
+		if (from->GetCache())	{
+			LoadZipArrays(from->GetCache());
+		}
+		else	{
+			ComputeZipArrays();
+		}
 	}
 
 	~ZippedSequenceAlignment()	{
@@ -61,6 +66,9 @@ class ZippedSequenceAlignment : public SequenceAlignment	{
 
     void CreateZipArrays();
     void DeleteZipArrays();
+	// same as ComputeZipArrays, but starting from the site orbits stored in the cache
+	void LoadZipArrays(const AlignmentCache* cache);
+	void ComputeZipStats();
 
 	SequenceAlignment* from;
 	int Nstate;
@@ -277,6 +277,30 @@ void Correlation::getParameters(string filename, int start, int stop)
   }
 }
 
+void Correlation::setParameters(string filename, const vector<string>& names, const vector<vector<double> >& values, int start, int stop)
+{
+  chainName=filename;
+  burnin=start;
+  nbsample=stop-burnin;
+  if(nbsample<=0)
+    {
+      cerr << "ERROR: in Correlation::setParameters, asking sampling from point " << start << " to point "<< stop <<", exiting\n";
+      cerr.flush();
+      exit(0);
+    }
+  nbparameter=names.size();
+  init();
+  for(int j=0;j<nbparameter;j++)
+    parameterName[j]=names[j];
+  createParameterBuffer();
+  createWeight();
+  for(int j=0;j<nbparameter;j++)
+    {
+      for(int i=burnin;i<stop;i++)
+	parameters[j][i-burnin]=values[j][i];
+    }
+}
+
 void Correlation::sortParameters()
 {
   for(int i=0;i < nbparameter; i++)
@@ -340,6 +364,93 @@ void Correlation::computeMean()
     }
 }
 
+// in-place radix-2 fft (n a power of 2)
+// inverse: sign = +1, without the 1/n normalisation
+static void fft(vector<complex<double> >& a, int sign)
+{
+  int n=a.size();
+  for(int i=1,j=0;i<n;i++)
+    {
+      int bit=n>>1;
+      for(;j&bit;bit>>=1)
+	j^=bit;
+      j^=bit;
+      if(i<j)
+	swap(a[i],a[j]);
+    }
+  for(int len=2;len<=n;len<<=1)
+    {
+      double angle=sign*2*M_PI/len;
+      complex<double> wlen(cos(angle),sin(angle));
+      for(int i=0;i<n;i+=len)
+	{
+	  complex<double> w(1);
+	  for(int k=0;k<len/2;k++)
+	    {
+	      complex<double> u=a[i+k];
+	      complex<double> v=a[i+k+len/2]*w;
+	      a[i+k]=u+v;
+	      a[i+k+len/2]=u-v;
+	      w*=wlen;
+	    }
+	}
+    }
+}
+
+// autocovariances of parameter j for lags 0 to nbsample/2-1,
+// through the fft of the centered series, zero-padded to avoid circular wrap-around
+// (lag 0, which gives the variance, is summed directly)
+void Correlation::computeAutoCovariance(int j)
+{
+  int ncov=nbsample/2;
+  if(isConstant[j]==Yes)
+    {
+      variance[j]=0;
+      for(int t=0;t<ncov;t++)
+	{
+	  covparam[j][t]=0;
+	  covnorm[j][t]=0;
+	}
+      return;
+    }
+
+  double cov0=0;
+  for(int i=0;i<nbsample;i++)
+    {
+      cov0+=(parameters[j][i]-meanparam[j])*(parameters[j][i]-meanparam[j]);
+    }
+  variance[j]=cov0/(double)(nbsample-1);
+
+  int n=1;
+  while(n<2*nbsample)
+    n<<=1;
+  vector<complex<double> > a(n);
+  for(int i=0;i<nbsample;i++)
+    {
+      a[i]=parameters[j][i]-meanparam[j];
+    }
+  fft(a,-1);
+  for(int k=0;k<n;k++)
+    {
+      a[k]=norm(a[k]);
+    }
+  fft(a,+1);
+
+  covparam[j][0]=cov0/(double)(nbsample);
+  for(int t=1;t<ncov;t++)
+    {
+      covparam[j][t]=a[t].real()/n/(double)(nbsample);
+    }
+  for(int t=0;t<ncov;t++)
+    {
+      // normalisation
+      if(covparam[j][0]!=0)
+	covnorm[j][t]=covparam[j][t]/covparam[j][0];
+      else
+	covnorm[j][t]=0;
+    }
+}
+
 void Correlation::computeCovariance()
 {
   if(nbsample==0)
@@ -351,35 +462,25 @@ void Correlation::computeCovariance()
       createCovarianceBuffer();
       computeMean();
 
-      for(int t=0;t<nbsample/2;t++)
+      // parameters are independent: dealt over threads
+      int nthread=thread::hardware_concurrency();
+      if(nthread<1)
+	nthread=1;
+      if(nthread>nbparameter)
+	nthread=nbparameter;
+      vector<thread> workers;
+      for(int k=0;k<nthread;k++)
 	{
-	  for(int j=0;j<nbparameter;j++)
-	    {
-	      for(int i=0;i<nbsample-t;i++)
-		{
-		  covparam[j][t]+=(parameters[j][i]-meanparam[j])*(parameters[j][i+t]-meanparam[j]);
-		}
-	      if(isConstant[j]==Yes)
-		covparam[j][t]=0;
-	    }
-	  if(t==0)
+	  workers.push_back(thread([this,k,nthread]()
 	    {
-	      for(int j=0;j<nbparameter;j++)
-		{
-		  variance[j]=covparam[j][0]/(double)(nbsample-1);
-		}
-	    } 
-	  for(int j=0;j<nbparameter;j++)
-	    {
-	      covparam[j][t]/=(double)(nbsample);
-	      // normalisation
-	      if(covparam[j][0]!=0)
-		covnorm[j][t]=covparam[j][t]/covparam[j][0];
-	      else
-		covnorm[j][t]=0;
-	    }
-	} // fin for t
-
+	      for(int j=k;j<nbparameter;j+=nthread)
+		computeAutoCovariance(j);
+	    }));
+	}
+      for(int k=0;k<nthread;k++)
+	{
+	  workers[k].join();
+	}
     }
 }
 
@@ -21,6 +21,9 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include <cstdlib>
 
 #include <cmath>
+#include <complex>
+#include <vector>
+#include <thread>
 //#include "phylobayes.h"
 
 using namespace std;
@@ -56,6 +59,7 @@ class Correlation{
   void createCovarianceBuffer();
   void createWeight();
   void computeMean();
+  void computeAutoCovariance(int j);
   void init();
 
 
@@ -67,6 +71,8 @@ class Correlation{
   Correlation(double ci=-1);
   ~Correlation();
   void getParameters(string chainName,int start,int stop);
+  // same as getParameters, from values already in memory (one vector per parameter)
+  void setParameters(string chainName, const vector<string>& names, const vector<vector<double> >& values, int start, int stop);
   void computeCovariance();
   void computeWeight();
   void computeEffectiveSize();
@@ -21,12 +21,21 @@ along with PhyloBayes. If not, see <http://www.gnu.org/licenses/>.
 #include <cmath>
 #include <iostream>
 
+#ifdef USE_LAPACK
+#include <vector>
+
+// LAPACK: eigenvalues and eigenvectors of a real symmetric matrix (relatively robust representations)
+extern "C" void dsyevr_(const char* jobz, const char* range, const char* uplo, const int* n, double* a, const int* lda,
+		const double* vl, const double* vu, const int* il, const int* iu, const double* abstol, int* m,
+		double* w, double* z, const int* ldz, int* isuppz, double* work, const int* lwork, int* iwork, const int* liwork, int* info);
+#endif
+
 using namespace std;
 
-void LinAlg::QR(double** u, int dim, double** ql, double** r)	{
+void LinAlg::QR(double** u, int dim, double** ql, double** r, double** work)	{
 
-	double* v = new double[dim];
-	double* c = new double[dim];
+	double* v = work ? work[0] : new double[dim];
+	double* c = work ? work[1] : new double[dim];
 
 	double** a = r;
 	for (int i=0; i<dim; i++)	{
@@ -103,15 +112,17 @@ void LinAlg::QR(double** u, int dim, double** ql, double** r)	{
 
 	}
 
-	delete[] v;
-	delete[] c;
+	if (! work)	{
+		delete[] v;
+		delete[] c;
+	}
 }
 
 
-void LinAlg::HouseHolder(double** u, int dim, double** a, double** ql)	{
+void LinAlg::HouseHolder(double** u, int dim, double** a, double** ql, double** work)	{
 
-	double* v = new double[dim];
-	double* c = new double[dim];
+	double* v = work ? work[0] : new double[dim];
+	double* c = work ? work[1] : new double[dim];
 
 	for (int i=0; i<dim; i++)	{
 		for (int j=0; j<dim; j++)	{
@@ -185,12 +196,69 @@ void LinAlg::HouseHolder(double** u, int dim, double** a, double** ql)	{
 		}
 	}
 
-	delete[] v;
-	delete[] c;
+	if (! work)	{
+		delete[] v;
+		delete[] c;
+	}
 }
 
 
-int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect)	{
+int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect, double** work)	{
+
+#ifdef USE_LAPACK
+	if (! LapackDiagonalizeSymmetricMatrix(u,dim,eigenval,eigenvect))	{
+		return 0;
+	}
+	// lapack failed: fall back on the built-in solver
+#endif
+	return QRDiagonalizeSymmetricMatrix(u,dim,nmax,epsilon,eigenval,eigenvect,work);
+}
+
+#ifdef USE_LAPACK
+int LinAlg::LapackDiagonalizeSymmetricMatrix(double** u, int dim, double* eigenval, double** eigenvect)	{
+
+	// column major copies and workspace, kept from one call to the next
+	static thread_local vector<double> a, z, work;
+	static thread_local vector<int> iwork, isuppz;
+	a.resize(dim*dim);
+	z.resize(dim*dim);
+	work.resize(26*dim);
+	iwork.resize(10*dim);
+	isuppz.resize(2*dim);
+
+	for (int i=0; i<dim; i++)	{
+		for (int j=0; j<dim; j++)	{
+			a[j*dim+i] = u[i][j];
+		}
+	}
+
+	const char jobz = 'V';
+	const char range = 'A';
+	const char uplo = 'U';
+	double vl = 0, vu = 0;
+	int il = 0, iu = 0;
+	// 0 : default tolerance (machine precision times the norm of the tridiagonal matrix)
+	double abstol = 0;
+	int m = 0;
+	int lwork = work.size();
+	int liwork = iwork.size();
+	int info = 0;
+	dsyevr_(&jobz,&range,&uplo,&dim,&a[0],&dim,&vl,&vu,&il,&iu,&abstol,&m,eigenval,&z[0],&dim,&isuppz[0],&work[0],&lwork,&iwork[0],&liwork,&info);
+
+	if (info || (m != dim))	{
+		return 1;
+	}
+	// columns of z are the eigenvectors
+	for (int i=0; i<dim; i++)	{
+		for (int j=0; j<dim; j++)	{
+			eigenvect[i][j] = z[j*dim+i];
+		}
+	}
+	return 0;
+}
+#endif
+
+int LinAlg::QRDiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect, double** work)	{
 
 	for (int i=0; i<dim; i++)	{
 		for (int j=0; j<dim; j++)	{
@@ -219,19 +287,27 @@ int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double eps
 		return 0;
 	}
 
-	double** a = new double*[dim];
-	double** q = new double*[dim];
-	double** r = new double*[dim];
+	double** a = work;
+	double** q = work ? work + dim : 0;
+	double** r = work ? work + 2*dim : 0;
+	double** vwork = work ? work + 3*dim : 0;
+	if (! work)	{
+		a = new double*[dim];
+		q = new double*[dim];
+		r = new double*[dim];
+		for (int i=0; i<dim; i++)	{
+			a[i] = new double[dim];
+			q[i] = new double[dim];
+			r[i] = new double[dim];
+		}
+	}
 	for (int i=0; i<dim; i++)	{
-		a[i] = new double[dim];
-		q[i] = new double[dim];
-		r[i] = new double[dim];
 		for (int j=0; j<dim; j++)	{
 			a[i][j] = u[i][j];
 		}
 	}
 
-	HouseHolder(u,dim,a,r);
+	HouseHolder(u,dim,a,r,vwork);
 
 	for (int i=0; i<dim; i++)	{
 		for (int j=0; j<dim; j++)	{
@@ -261,7 +337,7 @@ int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double eps
 			q[i][i] = 1;
 		}
 
-		QR(a,s+1,q,r);
+		QR(a,s+1,q,r,vwork);
 		// QR(a,dim,q,r);
 		n++;
 		for (int i=0; i<s+1; i++)	{
@@ -311,14 +387,16 @@ int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double eps
 		eigenval[i] = a[i][i];
 	}
 
-	for (int i=0; i<dim; i++)	{
-		delete[] a[i];
-		delete[] q[i];
-		delete[] r[i];
+	if (! work)	{
+		for (int i=0; i<dim; i++)	{
+			delete[] a[i];
+			delete[] q[i];
+			delete[] r[i];
+		}
+		delete[] a;
+		delete[] q;
+		delete[] r;
 	}
-	delete[] a;
-	delete[] q;
-	delete[] r;
 	return n;
 }
 
@@ -461,27 +539,23 @@ int LinAlg::DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double eps
 // diagonalize a reversible rate matrix
 // first transforms reversible matrix into a symmetric matrix
 // then use Householder's algorithm, com
-int LinAlg::DiagonalizeRateMatrix(double** u, double* pi, int dim, double* eigenval, double** eigenvect, double** inveigenvect, int nmax, double epsilon)	{
+int LinAlg::DiagonalizeRateMatrix(double** u, double* pi, int dim, double* eigenval, double** eigenvect, double** inveigenvect, int nmax, double epsilon, double** work)	{
 
-	double** a = new double*[dim];
+	double** a = work;
+	if (! work)	{
+		a = new double*[dim];
+		for (int i=0; i<dim; i++)	{
+			a[i] = new double[dim];
+		}
+	}
 	for (int i=0; i<dim; i++)	{
-		a[i] = new double[dim];
 		for (int j=0; j<dim; j++)	{
 			a[i][j] = u[i][j] * sqrt(pi[i] / pi[j]);
 		}
 	}
 
-	int n = DiagonalizeSymmetricMatrix(a,dim,nmax,epsilon,eigenval,eigenvect);
+	int n = DiagonalizeSymmetricMatrix(a,dim,nmax,epsilon,eigenval,eigenvect,work ? work + dim : 0);
 
-	for (int i=0; i<dim; i++)	{
-		for (int j=0; j<dim; j++)	{
-			double total = 0;
-			for (int k=0; k<dim; k++)	{
-				total += a[i][k] * eigenvect[k][j];
-			}
-		}
-	}
-	
 	for (int i=0; i<dim; i++)	{
 		for (int j=0; j<dim; j++)	{
 			inveigenvect[i][j] = eigenvect[j][i] * sqrt(pi[j]);
@@ -493,10 +567,12 @@ int LinAlg::DiagonalizeRateMatrix(double** u, double* pi, int dim, double* eigen
 		}
 	}
 
-	for (int i=0; i<dim; i++)	{
-		delete[] a[i];
+	if (! work)	{
+		for (int i=0; i<dim; i++)	{
+			delete[] a[i];
+		}
+		delete[] a;
 	}
-	delete[] a;
 
 	return n;
 }
@@ -24,7 +24,11 @@ class LinAlg {
 	// diagonalize a reversible rate matrix
 	// first transforms reversible matrix into a symmetric matrix
 	// then calls DiagonalizeSymmetricMatrix
-	static int DiagonalizeRateMatrix(double** u, double* pi, int dim, double* eigenval, double** eigenvect, double** inveigenvect, int nmax=1000, double epsilon = 1e-10);
+	// work (optional) : scratch space of DiagWorkSize(dim) rows of at least dim doubles each,
+	// so that repeated calls do not allocate (otherwise, allocated and freed at each call)
+	static int DiagonalizeRateMatrix(double** u, double* pi, int dim, double* eigenval, double** eigenvect, double** inveigenvect, int nmax=1000, double epsilon = 1e-10, double** work = 0);
+
+	static int DiagWorkSize(int dim) {return 4*dim + 2;}
 
 	// diagonalize a symmetric matrix
 	// first applying Householder transformation (tri-diagonal)
@@ -34,7 +38,28 @@ class LinAlg {
 	// epsilon : loops until non-diagonal elements are < epsilon in absolute value
 	// returns number of iterations
 	// eigenvect matrix is orthonormal (its transpose is its inverse)
-	static int DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect);
+	// work (optional) : scratch space of 3*dim+2 rows of at least dim doubles each
+	//
+	// when compiled with -DUSE_LAPACK, calls LapackDiagonalizeSymmetricMatrix,
+	// and only falls back on QRDiagonalizeSymmetricMatrix if lapack fails (then returns 0)
+	static int DiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect, double** work = 0);
+
+	// the built-in solver
+	static int QRDiagonalizeSymmetricMatrix(double** u, int dim, int nmax, double epsilon, double* eigenval, double** eigenvect, double** work = 0);
+
+#ifdef USE_LAPACK
+	// lapack's dsyevr (eigenvalues in increasing order)
+	// returns 0 upon success
+	static int LapackDiagonalizeSymmetricMatrix(double** u, int dim, double* eigenval, double** eigenvect);
+#endif
+
+	static bool HasLapack()	{
+#ifdef USE_LAPACK
+		return true;
+#else
+		return false;
+#endif
+	}
 
 	// computes inverse of matrix given as an input (a)
 	// by Gauss elimination
@@ -45,8 +70,9 @@ class LinAlg {
 
 	private:
 
-	static void QR(double** u, int dim, double** ql, double** r);
-	static void HouseHolder(double** u, int dim, double** a, double** ql);
+	// work (optional) : 2 scratch rows of at least dim doubles each
+	static void QR(double** u, int dim, double** ql, double** r, double** work = 0);
+	static void HouseHolder(double** u, int dim, double** a, double** ql, double** work = 0);
 
 };
 